@@ -0,0 +1,58 @@
+/* Test of the banded LU solver in RnSparse. The matrix is factored, changed
+with each of the element macros, and solved again, which has to use new
+factors rather than stale ones.
+
+gcc -Wall -O0 -g testsparse.c RnSparse.c -lm -o testsparse
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include "RnSparse.h"
+
+#define N 6
+
+/* checksolve */
+int checksolve(sparsematrix sprs,const char *label) {
+	double b[N],x[N],ax[N],err;
+	int i,er;
+
+	for(i=0;i<N;i++) b[i]=i+1;
+	er=sparseSolveM(sprs,b,x);
+	if(er) {
+		printf("%s: sparseSolveM returned %i\n",label,er);
+		return 1; }
+	sparseMultiplyMV(sprs,x,ax);
+	err=0;
+	for(i=0;i<N;i++) err+=fabs(ax[i]-b[i]);
+	printf("%s: residual %g\n",label,err);
+	return err>1e-10; }
+
+
+int main(void) {
+	sparsematrix sprs;
+	int i,fail;
+
+	sprs=sparseAllocBandM(NULL,N,1,0);
+	if(!sprs) return 2;
+	for(i=0;i<N;i++) {
+		sparseWriteM(sprs,i,i,4);
+		if(i>0) sparseWriteM(sprs,i,i-1,-1);
+		if(i<N-1) sparseWriteM(sprs,i,i+1,-2); }
+
+	fail=checksolve(sprs,"initial");
+	if(!sprs->LUvalid) {
+		printf("factors not kept after solving\n");
+		fail=1; }
+
+	sparseWriteM(sprs,2,2,7);
+	fail|=checksolve(sprs,"sparseWriteM");
+	sparseAddToM(sprs,3,4,1.5);
+	fail|=checksolve(sprs,"sparseAddToM");
+	sparseMultiplyBy(sprs,0,1,-3);
+	fail|=checksolve(sprs,"sparseMultiplyBy");
+	sparseAddIdentityM(sprs,2);
+	fail|=checksolve(sprs,"sparseAddIdentityM");
+
+	sparseFreeM(sprs);
+	printf(fail?"FAILED\n":"passed\n");
+	return fail; }
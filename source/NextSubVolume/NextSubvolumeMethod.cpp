@@ -11,6 +11,8 @@
 
 #include <numeric>
 #include <limits>
+#include <algorithm>
+#include <thread>
 //extern "C"
 //{
 #include "random2.h"
@@ -87,6 +89,7 @@ void ReactionList::add_reaction(const double rate, const ReactionEquation& eq) {
 	if (!added) {
 		reactions.push_back(ReactionsWithSameRateAndLHS(rate, sorted_lhs, eq.rhs));
 		propensities.push_back(0);
+		dependencies_valid = false;
         //std::cout << "added reaction with eq = "<<eq<<" compartment "<<eq.rhs[0].compartment_index<<std::endl;
 	}
 	my_size++;
@@ -95,6 +98,8 @@ void ReactionList::add_reaction(const double rate, const ReactionEquation& eq) {
 void ReactionList::clear() {
 	reactions.clear();
 	propensities.clear();
+	dependencies.clear();
+	dependencies_valid = false;
 	my_size = 0;
 }
 
@@ -123,6 +128,7 @@ double ReactionList::delete_reaction(const ReactionEquation& eq) {
 		if (reactions[i].all_rhs.size() == 0) {
 			reactions.erase(reactions.begin() + i);
 			propensities.erase(propensities.begin()+i);
+			dependencies_valid = false;
 		}
 		my_size--;
 	}
@@ -132,6 +138,7 @@ double ReactionList::delete_reaction(const ReactionEquation& eq) {
 ReactionEquation ReactionList::pick_random_reaction(const double rand) {
 	double last_sum_propensities = 0;
 	double sum_propensities = 0;
+	int last_nonzero = -1;
 	const int n = reactions.size();
 	const double rand_times_total_propensity = rand*total_propensity;
 	for (int i = 0; i < n; i++) {
@@ -141,9 +148,15 @@ ReactionEquation ReactionList::pick_random_reaction(const double rand) {
 			const double scaled_rand = (rand_times_total_propensity-last_sum_propensities)/(sum_propensities-last_sum_propensities);
 			return ReactionEquation(reactions[i].lhs,reactions[i].pick_random_rhs(scaled_rand));
 		}
+		if (propensities[i] > 0) last_nonzero = i;
 		last_sum_propensities = sum_propensities;
 	}
 
+	// total_propensity is a running sum, so round-off can leave rand just past the last reaction
+	if (last_nonzero >= 0) {
+		return ReactionEquation(reactions[last_nonzero].lhs,reactions[last_nonzero].pick_random_rhs(0));
+	}
+
 	throw std::runtime_error("ERROR: should have picked a reaction. rand is either not 0->1 or total_propensity != sum of propensities!!!!!!");
 	// exit(-1);
 	//std::cout << "returning reaction with lhs.size() = " << reactions[n].size()<<std::endl;
@@ -151,32 +164,53 @@ ReactionEquation ReactionList::pick_random_reaction(const double rand) {
 	//		return ReactionEquation(reactions[n].lhs,reactions[n].pick_random_rhs(rand));
 }
 
+double ReactionList::calculate_propensity(const int i) {
+	ReactionsWithSameRateAndLHS& rs = reactions[i];
+	double propensity = 1.0;
+	//int beta = 0;									// beta was being computed but not used, so it's commented out now
+	//for (auto& rc : rs.lhs) {
+	for (std::vector<ReactionComponent>::iterator rc=rs.lhs.begin();rc!=rs.lhs.end();rc++) {
+		int copy_number = rc->species->copy_numbers[rc->compartment_index];
+		//beta += rc->multiplier;
+		ASSERT(copy_number >= 0, "copy number is less than zero!!");
+		if (copy_number < rc->multiplier) {
+			return 0.0;
+		}
+		for (int k = 1; k < rc->multiplier; ++k) {
+			copy_number *= copy_number-k;
+		}
+		propensity *= copy_number;
+	}
+	propensity *= rs.size()*rs.rate;
+	ASSERT(propensity >= 0, "calculated propensity is less than zero!!");
+	return propensity;
+}
+
+void ReactionList::calculate_dependencies() {
+	dependencies.clear();
+	const int n = reactions.size();
+	for (int i = 0; i < n; i++) {
+		ReactionSide& lhs = reactions[i].lhs;
+		for (std::vector<ReactionComponent>::iterator rc=lhs.begin();rc!=lhs.end();rc++) {
+			dependencies.push_back(std::make_pair((const Species*)rc->species,i));
+		}
+	}
+	std::sort(dependencies.begin(),dependencies.end());
+	dependencies.erase(std::unique(dependencies.begin(),dependencies.end()),dependencies.end());
+	dependencies_valid = true;
+}
+
 double ReactionList::recalculate_propensities() {
+	if (!dependencies_valid) calculate_dependencies();
 	total_propensity = 0;
 	inv_total_propensity = 0;
+	num_nonzero = 0;
+	num_updates = 0;
 	const int n = reactions.size();
 	for (int i = 0; i < n; i++) {
-		ReactionsWithSameRateAndLHS& rs = reactions[i];
-		double& propensity = propensities[i];
-		propensity = 1.0;
-		//int beta = 0;									// beta was being computed but not used, so it's commented out now
-		//for (auto& rc : rs.lhs) {
-		for (std::vector<ReactionComponent>::iterator rc=rs.lhs.begin();rc!=rs.lhs.end();rc++) {
-			int copy_number = rc->species->copy_numbers[rc->compartment_index];
-			//beta += rc->multiplier;
-			ASSERT(copy_number >= 0, "copy number is less than zero!!");
-			if (copy_number < rc->multiplier) {
-				propensity = 0.0;
-				break;
-			}
-			for (int k = 1; k < rc->multiplier; ++k) {
-				copy_number *= copy_number-k;
-			}
-			propensity *= copy_number;
-		}
-		propensity *= rs.size()*rs.rate;
-		ASSERT(propensity >= 0, "calculated propensity is less than zero!!");
-		total_propensity += propensity;
+		propensities[i] = calculate_propensity(i);
+		if (propensities[i] != 0) num_nonzero++;
+		total_propensity += propensities[i];
 		//			if (reactions[i].lhs[0].compartment_index==0) {
 		//				std::cout << "reaction with neighbour "<<reactions[i].all_rhs[0][0].compartment_index<<" and num particles = " <<
 		//						reactions[i].lhs[0].species->copy_numbers[reactions[i].lhs[0].compartment_index] << " has propensity = "<<propensities[i]<<std::endl;
@@ -186,12 +220,130 @@ double ReactionList::recalculate_propensities() {
 	return inv_total_propensity;
 }
 
+/*
+ * recalculates only the propensities of reactions that have species s as a reactant,
+ * adjusting total_propensity by the difference. The total is summed afresh every
+ * UPDATES_BEFORE_RESUM updates to stop round-off error from accumulating.
+ */
+static const int UPDATES_BEFORE_RESUM = 1000;
+
+double ReactionList::update_propensities(const Species* s) {
+	if (!dependencies_valid) return recalculate_propensities();
+	std::vector<std::pair<const Species*,int> >::iterator d = std::lower_bound(dependencies.begin(),dependencies.end(),std::make_pair(s,0));
+	for (; d != dependencies.end() && d->first == s; d++) {
+		double& propensity = propensities[d->second];
+		const double new_propensity = calculate_propensity(d->second);
+		if (propensity != 0) num_nonzero--;
+		if (new_propensity != 0) num_nonzero++;
+		total_propensity += new_propensity-propensity;
+		propensity = new_propensity;
+		num_updates++;
+	}
+	if (num_nonzero == 0) {
+		total_propensity = 0;
+		num_updates = 0;
+	} else if (num_updates > UPDATES_BEFORE_RESUM) {
+		total_propensity = std::accumulate(propensities.begin(),propensities.end(),0.0);
+		num_updates = 0;
+	}
+	inv_total_propensity = 0;
+	if (total_propensity != 0) inv_total_propensity = 1.0/total_propensity;
+	return inv_total_propensity;
+}
+
+/*
+ * deterministic rate of reaction group i, from continuous mass action kinetics
+ */
+double ReactionList::calculate_rate(const int i) {
+	ReactionsWithSameRateAndLHS& rs = reactions[i];
+	double rate = rs.size()*rs.rate;
+	for (std::vector<ReactionComponent>::iterator rc=rs.lhs.begin();rc!=rs.lhs.end();rc++) {
+		const double amount = rc->species->amounts[rc->compartment_index];
+		for (int k = 0; k < rc->multiplier; ++k) {
+			rate *= amount;
+		}
+	}
+	return rate;
+}
+
+/*
+ * stores the deterministic rates of all reactions in propensities
+ */
+void ReactionList::calculate_rates() {
+	total_propensity = 0;
+	const int n = reactions.size();
+	for (int i = 0; i < n; i++) {
+		propensities[i] = calculate_rate(i);
+		total_propensity += propensities[i];
+	}
+}
+
+/*
+ * forward Euler update of the amounts using the rates from calculate_rates. Reaction
+ * extent towards products with negative compartment indices accumulates in unreleased,
+ * and each whole reaction is appended to released so that its particles can be created.
+ */
+void ReactionList::apply_rates(const double dt, std::vector<ReactionEquation>& released) {
+	if (total_propensity == 0) return;
+	const int n = reactions.size();
+	for (int i = 0; i < n; i++) {
+		if (propensities[i] == 0) continue;
+		ReactionsWithSameRateAndLHS& rs = reactions[i];
+		const double extent = propensities[i]*dt;
+		for (std::vector<ReactionComponent>::iterator rc=rs.lhs.begin();rc!=rs.lhs.end();rc++) {
+			rc->species->amounts[rc->compartment_index] -= rc->multiplier*extent;
+		}
+		const int nrhs = rs.all_rhs.size();
+		const double rhs_extent = extent/nrhs;
+		for (int j = 0; j < nrhs; j++) {
+			bool to_particle = false;
+			ReactionSide& rhs = rs.all_rhs[j];
+			for (std::vector<ReactionComponent>::iterator rc=rhs.begin();rc!=rhs.end();rc++) {
+				if (rc->compartment_index < 0) {
+					to_particle = true;
+				} else {
+					rc->species->amounts[rc->compartment_index] += rc->multiplier*rhs_extent;
+				}
+			}
+			if (to_particle) {
+				if (rs.unreleased.size() != rs.all_rhs.size()) rs.unreleased.assign(nrhs,0);
+				rs.unreleased[j] += rhs_extent;
+				for (; rs.unreleased[j] >= 1; rs.unreleased[j] -= 1) {
+					released.push_back(ReactionEquation(rs.lhs,rhs));
+				}
+			}
+		}
+	}
+}
+
+/*
+ * largest total rate of the first order reactions of one species, which bounds the
+ * stable forward Euler time step to 1/rate
+ */
+double ReactionList::get_max_first_order_rate() {
+	if (!dependencies_valid) calculate_dependencies();
+	double max_rate = 0;
+	double rate = 0;
+	const Species* s = NULL;
+	for (std::vector<std::pair<const Species*,int> >::iterator d=dependencies.begin();d!=dependencies.end();d++) {
+		if (d->first != s) {
+			max_rate = std::max(max_rate,rate);
+			rate = 0;
+			s = d->first;
+		}
+		ReactionsWithSameRateAndLHS& rs = reactions[d->second];
+		if ((rs.lhs.size() == 1) && (rs.lhs[0].multiplier == 1)) rate += rs.size()*rs.rate;
+	}
+	return std::max(max_rate,rate);
+}
+
 static const double LONGEST_TIME = 100000;
 
 
 NextSubvolumeMethod::NextSubvolumeMethod(StructuredGrid& subvolumes):
 		subvolumes(subvolumes),
-		time(0) {
+		time(0),
+		deterministic(false) {
 	const int n = subvolumes.size();
 	//std::cout << "created "<<n<<" subvolumes"<<std::endl;
 	heap.clear();
@@ -242,6 +394,7 @@ Species* NextSubvolumeMethod::get_species(const int id) {
 void NextSubvolumeMethod::add_diffusion(Species &s, const double rate) {
 	if (get_species(s.id) == NULL) {
 		diffusing_species.push_back(&s);
+		if (deterministic) s.amounts.assign(s.copy_numbers.begin(),s.copy_numbers.end());
 	} else {
 		return;
 	}
@@ -268,6 +421,7 @@ void NextSubvolumeMethod::add_diffusion(Species &s, const double rate) {
 void NextSubvolumeMethod::add_diffusion(Species &s) {
 	if (get_species(s.id) == NULL) {
 		diffusing_species.push_back(&s);
+		if (deterministic) s.amounts.assign(s.copy_numbers.begin(),s.copy_numbers.end());
 	} else {
 		return;
 	}
@@ -314,8 +468,23 @@ void NextSubvolumeMethod::reset_all_priorities() {
 }
 
 void NextSubvolumeMethod::reset_priority(const int i) {
-	const double inv_total_propensity = subvolume_reactions[i].recalculate_propensities();
+	if (deterministic) return;
+	sample_priority(i,subvolume_reactions[i].recalculate_propensities());
+}
+
+void NextSubvolumeMethod::sample_priority(const int i, const double inv_total_propensity) {
 	HeapNode& h = *(subvolume_heap_handles[i]);
+	if (!subdomains.empty()) {
+		Subdomain& sd = subdomains[subvolume_subdomain[i]];
+		if (inv_total_propensity != 0) {
+			h.time_at_next_reaction = sd.time - inv_total_propensity*log(sd.rand_open_closed());
+		} else {
+			h.time_at_next_reaction = sd.time + LONGEST_TIME;
+		}
+		h.time_at_last_random_sample = sd.time;
+		sd.heap.update(subvolume_heap_handles[i]);
+		return;
+	}
 	if (inv_total_propensity != 0) {
 		h.time_at_next_reaction = time - inv_total_propensity*log(randOCD());
 	} else {
@@ -329,30 +498,153 @@ void NextSubvolumeMethod::reset_priority(const int i) {
 }
 
 void NextSubvolumeMethod::recalc_priority(const int i) {
-	const double old_propensity = subvolume_reactions[i].get_propensity();
-	const double inv_total_propensity = subvolume_reactions[i].recalculate_propensities();
-	HeapNode& h = *(subvolume_heap_handles[i]);
-	if (inv_total_propensity != 0) {
-		//const double time_to_next_reaction = -inv_total_propensity*log(uni());
-		if (old_propensity == 0) {
-			h.time_at_next_reaction = time - inv_total_propensity*log(randOCD());
+	if (deterministic) return;
+	sample_priority(i,subvolume_reactions[i].recalculate_propensities());
+}
+
+/*
+ * splits the subvolumes into n slabs along the x axis, each with its own heap, which are
+ * then integrated in parallel. Diffusion between slabs and particle creation are
+ * synchronised at the end of each time step. n <= 1 restores the exact serial method.
+ */
+void NextSubvolumeMethod::set_subdomains(const int n) {
+	const int nsv = subvolumes.size();
+	const int nx = subvolumes.get_cells_along_axes()[0];
+	const int nsd = std::min(n,nx);
+
+	heap.clear();
+	subdomains.clear();
+	subvolume_subdomain.clear();
+	subvolume_heap_handles.clear();
+	if (nsd > 1) {
+		subdomains.resize(nsd);
+		for (int p = 0; p < nsd; ++p) {
+			subdomains[p].time = time;
+			subdomains[p].generator.seed(randULI());
+		}
+		subvolume_subdomain.resize(nsv);
+	}
+	for (int i = 0; i < nsv; ++i) {
+		if (nsd > 1) {
+			const int p = subvolumes.get_cell_indicies(i)[0]*nsd/nx;
+			subvolume_subdomain[i] = p;
+			subvolume_heap_handles.push_back(subdomains[p].heap.push(HeapNode(time + LONGEST_TIME,i,time)));
 		} else {
-			h.time_at_next_reaction = time - inv_total_propensity*log(randOCD());
+			subvolume_heap_handles.push_back(heap.push(HeapNode(time + LONGEST_TIME,i,time)));
+		}
+	}
+	reset_all_priorities();
+}
 
-			//h.time_at_next_reaction = time + old_propensity*inv_total_propensity*(h.time_at_next_reaction - h.time_at_last_random_sample);
+void NextSubvolumeMethod::integrate_subdomain(const int p, const double final_time) {
+	Subdomain& sd = subdomains[p];
+	while (sd.heap.top().time_at_next_reaction < final_time) {
+		const int sv_i = sd.heap.top().subvolume_index;
+		sd.time = sd.heap.top().time_at_next_reaction;
+		ReactionEquation r = subvolume_reactions[sv_i].pick_random_reaction(sd.rand_closed_open());
+		react_in_subdomain(r,p);
+	}
+	sd.time = final_time;
+}
+
+/*
+ * switches between the stochastic next subvolume method and a deterministic finite
+ * volume method that treats the same subvolume reactions as continuous fluxes
+ */
+void NextSubvolumeMethod::set_deterministic(const bool d) {
+	deterministic = d;
+	for (std::vector<Species*>::iterator s=diffusing_species.begin();s!=diffusing_species.end();s++) {
+		if (deterministic) {
+			(*s)->amounts.assign((*s)->copy_numbers.begin(),(*s)->copy_numbers.end());
+		} else {
+			(*s)->amounts.clear();
+		}
+	}
+	if (!deterministic) reset_all_priorities();
+}
+
+void NextSubvolumeMethod::calculate_rates_in(const int begin, const int end) {
+	for (int i = begin; i < end; ++i) {
+		subvolume_reactions[i].calculate_rates();
+	}
+}
+
+/*
+ * integrates the reaction-diffusion equations over dt with forward Euler. Diffusion
+ * reactions to neighbouring subvolumes make up the finite volume stencil, so surfaces,
+ * periodic boundaries and port interfaces are treated as in the stochastic method. The
+ * number of substeps keeps every first order rate times the substep at most 1. Rates are
+ * calculated in parallel over blocks of subvolumes if there are several subdomains.
+ */
+void NextSubvolumeMethod::integrate_deterministic(const double dt) {
+	const int n = subvolumes.size();
+	const int nthreads = get_num_subdomains();
+	double max_rate = 0;
+	for (int i = 0; i < n; ++i) {
+		max_rate = std::max(max_rate,subvolume_reactions[i].get_max_first_order_rate());
+	}
+	const int nsteps = std::max(1,int(ceil(dt*max_rate)));
+	const double h = dt/nsteps;
+
+	for (int step = 0; step < nsteps; ++step) {
+		if (nthreads > 1) {
+			std::vector<std::thread> threads;
+			for (int p = 1; p < nthreads; ++p) {
+				threads.push_back(std::thread(&NextSubvolumeMethod::calculate_rates_in,this,p*n/nthreads,(p+1)*n/nthreads));
+			}
+			calculate_rates_in(0,n/nthreads);
+			for (unsigned int p = 0; p < threads.size(); ++p) {
+				threads[p].join();
+			}
+		} else {
+			calculate_rates_in(0,n);
+		}
+		for (int i = 0; i < n; ++i) {
+			subvolume_reactions[i].apply_rates(h,released);
+		}
+		for (std::vector<Species*>::iterator s=diffusing_species.begin();s!=diffusing_species.end();s++) {
+			std::vector<double>& amounts = (*s)->amounts;
+			for (std::vector<double>::iterator a=amounts.begin();a!=amounts.end();a++) {
+				if (*a < 0) *a = 0;	// overshoot of fast higher order reactions
+			}
+		}
+	}
+
+	for (std::vector<ReactionEquation>::iterator eq=released.begin();eq!=released.end();eq++) {
+		for (std::vector<ReactionComponent>::iterator rc=eq->rhs.begin();rc!=eq->rhs.end();rc++) {
+			if (rc->compartment_index < 0) create_particles(*eq,*rc);
+		}
+	}
+	released.clear();
+
+	for (std::vector<Species*>::iterator s=diffusing_species.begin();s!=diffusing_species.end();s++) {
+		for (int i = 0; i < n; ++i) {
+			(*s)->copy_numbers[i] = int((*s)->amounts[i]+0.5);
 		}
-	} else {
-		h.time_at_next_reaction = time + LONGEST_TIME;
 	}
-//	if (i==929) {
-//		std::cout <<"recalcing priority for 929: time to next react = "<<h.time_at_next_reaction<<" total propensity = "<<1.0/inv_total_propensity<<std::endl;
-//	}
-	h.time_at_last_random_sample = time;
-	heap.update(subvolume_heap_handles[i]);
 }
 
 void NextSubvolumeMethod::operator ()(const double dt) {
 	const double final_time = time + dt;
+	if (deterministic) {
+		integrate_deterministic(dt);
+		time = final_time;
+		return;
+	}
+	if (!subdomains.empty()) {
+		const int nsd = subdomains.size();
+		std::vector<std::thread> threads;
+		for (int p = 1; p < nsd; ++p) {
+			threads.push_back(std::thread(&NextSubvolumeMethod::integrate_subdomain,this,p,final_time));
+		}
+		integrate_subdomain(0,final_time);
+		for (unsigned int p = 0; p < threads.size(); ++p) {
+			threads[p].join();
+		}
+		time = final_time;
+		exchange_between_subdomains();
+		return;
+	}
 	while (get_next_event_time() < final_time) {
 		const int sv_i = heap.top().subvolume_index;
 		time = heap.top().time_at_next_reaction;
@@ -471,40 +763,7 @@ void NextSubvolumeMethod::react(ReactionEquation& eq) {
 	for (std::vector<ReactionComponent>::iterator rc=eq.rhs.begin();rc!=eq.rhs.end();rc++) {
         //std::cout << "compartment index = "<<rc->compartment_index<<std::endl;
 		if (rc->compartment_index < 0) {
-            // test if this reaction is within the compartment and generates a particle
-            if (
-                (eq.lhs[0].compartment_index == -rc->compartment_index) || 
-                ((eq.lhs[0].compartment_index==0) && (eq.rhs[0].compartment_index == -std::numeric_limits<int>::max()))  
-               ) {
-                for (int i=0; i<rc->multiplier; i++) {
-                    Vect3d newr = get_grid().get_random_point(-rc->compartment_index);
-                    rc->species->particles.push_back(newr);
-				    rc->species->particlesx.push_back(newr);
-                }
-            // else must be an interface reaction
-            } else {
-
-//			const double step_length = rc.tmp;
-//			const double dt = pow(step_length,2)/(2.0*rc.species->D);
-//			const double kappa = 0.86*step_length/dt;
-//			const double h = subvolumes.get_distance_between(eq.lhs[0].compartment_index,-rc.compartment_index);
-//			const double P1 = kappa*h/rc.species->D;
-//			std::cout << "absorbing with P1 = "<<P1<<std::endl;
-//			if (uni() < P1) {
-				Rectangle r = subvolumes.get_face_between(eq.lhs[0].compartment_index,-rc->compartment_index);
-				Vect3d newr,newn;
-				r.get_random_point_and_normal_triangle(newr, newn);
-				const double P = randCCD();
-				const double P2 = pow(P,2);
-				const double step_length = rc->tmp;
-				const double dist_from_intersect = step_length*(0.729614*P - 0.70252*P2)/(1.0 - 1.47494*P + 0.484371*P2);
-				newr += newn*dist_from_intersect;
-				rc->species->particles.push_back(newr);
-				rc->species->particlesx.push_back(subvolumes.get_cell_centre(eq.lhs[0].compartment_index));
-//			} else {
-//				rc.species->copy_numbers[rc.compartment_index] += rc.multiplier;
-//			}
-            }
+			create_particles(eq,*rc);
 		} else {
 			rc->species->copy_numbers[rc->compartment_index] += rc->multiplier;
 		}
@@ -515,21 +774,131 @@ void NextSubvolumeMethod::react(ReactionEquation& eq) {
 	if (eq.lhs.size() == 0) {
 		// must be zeroth order rection
 		ASSERT(eq.rhs.size() > 0,"empty equation, cannot react");
-		reset_priority(eq.rhs[0].compartment_index);
+		const int i = eq.rhs[0].compartment_index;
+		sample_priority(i,update_propensities(i,eq));
 	} else {
-		reset_priority(eq.lhs[0].compartment_index);
+		const int i = eq.lhs[0].compartment_index;
+		sample_priority(i,update_propensities(i,eq));
 		if ((eq.rhs.size() == 1) && (eq.rhs[0].compartment_index >= 0) && (eq.lhs[0].compartment_index != eq.rhs[0].compartment_index)) {
 			//diffusion reaction
-			recalc_priority(eq.rhs[0].compartment_index);
+			const int j = eq.rhs[0].compartment_index;
+			sample_priority(j,update_propensities(j,eq));
+		}
+	}
+
+
+}
+
+/*
+ * performs an event in subdomain p, deferring products outside the subdomain
+ */
+void NextSubvolumeMethod::react_in_subdomain(ReactionEquation& eq, const int p) {
+	bool deferred = false;
+	for (std::vector<ReactionComponent>::iterator rc=eq.lhs.begin();rc!=eq.lhs.end();rc++) {
+		rc->species->copy_numbers[rc->compartment_index] -= rc->multiplier;
+	}
+	for (std::vector<ReactionComponent>::iterator rc=eq.rhs.begin();rc!=eq.rhs.end();rc++) {
+		if ((rc->compartment_index >= 0) && (subvolume_subdomain[rc->compartment_index] == p)) {
+			rc->species->copy_numbers[rc->compartment_index] += rc->multiplier;
+		} else {
+			deferred = true;
+		}
+	}
+	if (deferred) subdomains[p].deferred.push_back(eq);
+
+	if (eq.lhs.size() == 0) {
+		const int i = eq.rhs[0].compartment_index;
+		sample_priority(i,update_propensities(i,eq));
+	} else {
+		const int i = eq.lhs[0].compartment_index;
+		sample_priority(i,update_propensities(i,eq));
+		if ((eq.rhs.size() == 1) && (eq.rhs[0].compartment_index >= 0) && (eq.lhs[0].compartment_index != eq.rhs[0].compartment_index) && (subvolume_subdomain[eq.rhs[0].compartment_index] == p)) {
+			//diffusion reaction within the subdomain
+			const int j = eq.rhs[0].compartment_index;
+			sample_priority(j,update_propensities(j,eq));
+		}
+	}
+}
+
+/*
+ * completes the deferred events of all subdomains, at the end of a time step
+ */
+void NextSubvolumeMethod::exchange_between_subdomains() {
+	const int nsd = subdomains.size();
+	for (int p = 0; p < nsd; ++p) {
+		std::vector<ReactionEquation>& deferred = subdomains[p].deferred;
+		for (std::vector<ReactionEquation>::iterator eq=deferred.begin();eq!=deferred.end();eq++) {
+			for (std::vector<ReactionComponent>::iterator rc=eq->rhs.begin();rc!=eq->rhs.end();rc++) {
+				if (rc->compartment_index < 0) {
+					create_particles(*eq,*rc);
+				} else if (subvolume_subdomain[rc->compartment_index] != p) {
+					rc->species->copy_numbers[rc->compartment_index] += rc->multiplier;
+					sample_priority(rc->compartment_index,update_propensities(rc->compartment_index,*eq));
+				}
+			}
 		}
+		deferred.clear();
 	}
+}
 
+/*
+ * creates off-lattice particles for a product component with a negative compartment index
+ */
+void NextSubvolumeMethod::create_particles(ReactionEquation& eq, ReactionComponent& rc) {
+	// test if this reaction is within the compartment and generates a particle
+	if (
+		(eq.lhs[0].compartment_index == -rc.compartment_index) ||
+		((eq.lhs[0].compartment_index==0) && (eq.rhs[0].compartment_index == -std::numeric_limits<int>::max()))
+	   ) {
+		for (int i=0; i<rc.multiplier; i++) {
+			Vect3d newr = get_grid().get_random_point(-rc.compartment_index);
+			rc.species->particles.push_back(newr);
+			rc.species->particlesx.push_back(newr);
+		}
+	// else must be an interface reaction
+	} else {
 
+//		const double step_length = rc.tmp;
+//		const double dt = pow(step_length,2)/(2.0*rc.species->D);
+//		const double kappa = 0.86*step_length/dt;
+//		const double h = subvolumes.get_distance_between(eq.lhs[0].compartment_index,-rc.compartment_index);
+//		const double P1 = kappa*h/rc.species->D;
+//		std::cout << "absorbing with P1 = "<<P1<<std::endl;
+//		if (uni() < P1) {
+		Rectangle r = subvolumes.get_face_between(eq.lhs[0].compartment_index,-rc.compartment_index);
+		Vect3d newr,newn;
+		r.get_random_point_and_normal_triangle(newr, newn);
+		const double P = randCCD();
+		const double P2 = pow(P,2);
+		const double step_length = rc.tmp;
+		const double dist_from_intersect = step_length*(0.729614*P - 0.70252*P2)/(1.0 - 1.47494*P + 0.484371*P2);
+		newr += newn*dist_from_intersect;
+		rc.species->particles.push_back(newr);
+		rc.species->particlesx.push_back(subvolumes.get_cell_centre(eq.lhs[0].compartment_index));
+//		} else {
+//			rc.species->copy_numbers[rc.compartment_index] += rc.multiplier;
+//		}
+	}
+}
+
+/*
+ * updates the propensities of subvolume i for the species that eq changed in that subvolume
+ */
+double NextSubvolumeMethod::update_propensities(const int i, ReactionEquation& eq) {
+	ReactionList& reactions = subvolume_reactions[i];
+	double inv_total_propensity = reactions.get_inv_propensity();
+	for (std::vector<ReactionComponent>::iterator rc=eq.lhs.begin();rc!=eq.lhs.end();rc++) {
+		if (rc->compartment_index == i) inv_total_propensity = reactions.update_propensities(rc->species);
+	}
+	for (std::vector<ReactionComponent>::iterator rc=eq.rhs.begin();rc!=eq.rhs.end();rc++) {
+		if (rc->compartment_index == i) inv_total_propensity = reactions.update_propensities(rc->species);
+	}
+	return inv_total_propensity;
 }
 
 
 std::ostream& operator<< (std::ostream& out, NextSubvolumeMethod &b) {
-	out << "\tNext Subvolume Method:"<<std::endl;
+	out << (b.is_deterministic() ? "\tDeterministic Lattice Method:" : "\tNext Subvolume Method:")<<std::endl;
 	out << "\t\tStructured Grid:"<<std::endl;
 	out << "\t\t\tlow = "<<b.get_grid().get_low() << " high = "<<b.get_grid().get_high()<<std::endl;
 	out << "\t\t\tcompartment sizes = "<<b.get_grid().get_cell_size() << std::endl;
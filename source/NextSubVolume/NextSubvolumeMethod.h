@@ -25,6 +25,8 @@
 #ifndef NEXTSUBVOLUMEMETHOD_H_
 #define NEXTSUBVOLUMEMETHOD_H_
 
+#include <random>
+#include <utility>
 #include <vector>
 #if defined(HAVE_VTK)
 #include <vtkUnstructuredGrid.h>
@@ -66,6 +68,47 @@ struct HeapNode
 typedef boost::heap::fibonacci_heap<HeapNode> PriorityHeap;
 typedef boost::heap::fibonacci_heap<HeapNode>::handle_type HeapHandle;
 
+/*
+ * a slab of subvolumes that is integrated independently of the others over one time
+ * step, with its own heap, time and random number generator. Events with products in
+ * other subdomains (or off the lattice) are deferred until the end of the time step.
+ */
+struct Subdomain
+{
+    Subdomain()
+      : time(0)
+      , uniform(0.0, 1.0)
+    {}
+    double rand_closed_open() { return uniform(generator); }
+    double rand_open_closed() { return 1.0 - uniform(generator); }
+
+    PriorityHeap heap;
+    double time;
+    std::mt19937 generator;
+    std::uniform_real_distribution<double> uniform;
+    std::vector<ReactionEquation> deferred;
+};
+
+/*
+ * buffers for passing particles between the lattice and an off-lattice simulation. The
+ * position pointers refer to existing particle data rather than copies, and the buffers
+ * are kept between time steps so that exchanges don't allocate memory.
+ */
+struct ParticleExchange
+{
+    void clear()
+    {
+        species.clear();
+        positions.clear();
+        positionsx.clear();
+        dirty_indicies.clear();
+    }
+    std::vector<int> species;
+    std::vector<double*> positions;
+    std::vector<double*> positionsx;
+    std::vector<int> dirty_indicies;  // subvolumes whose copy numbers changed
+};
+
 struct ReactionsWithSameRateAndLHS
 {
     ReactionsWithSameRateAndLHS(const double rate,
@@ -90,6 +133,7 @@ struct ReactionsWithSameRateAndLHS
     ReactionSide lhs;
     double rate;
     std::vector<ReactionSide> all_rhs;
+    std::vector<double> unreleased;  // deterministic reaction extent not yet released as particles
 };
 
 class ReactionList
@@ -99,6 +143,9 @@ class ReactionList
       : total_propensity(0)
       , my_size(0)
       , inv_total_propensity(0)
+      , num_nonzero(0)
+      , num_updates(0)
+      , dependencies_valid(false)
     {}
     //	~ReactionList() {
     //		reactions.clear();
@@ -114,6 +161,9 @@ class ReactionList
         total_propensity = 0;
         inv_total_propensity = 0;
         my_size = arg.my_size;
+        num_nonzero = 0;
+        num_updates = 0;
+        dependencies_valid = false;
     }
 
 
@@ -123,21 +173,36 @@ class ReactionList
     void clear();
     ReactionEquation pick_random_reaction(const double rand);
     double recalculate_propensities();
+    double update_propensities(const Species* s);
     double get_propensity() { return total_propensity; }
+    double get_inv_propensity() { return inv_total_propensity; }
     int size() { return my_size; }
+    void calculate_rates();
+    void apply_rates(const double dt, std::vector<ReactionEquation>& released);
+    double get_max_first_order_rate();
 
   private:
+    double calculate_propensity(const int i);
+    double calculate_rate(const int i);
+    void calculate_dependencies();
     double total_propensity;
     double my_size;
     std::vector<ReactionsWithSameRateAndLHS> reactions;
     std::vector<double> propensities;
     double inv_total_propensity;
+    int num_nonzero;  // number of reactions with non-zero propensity
+    int num_updates;  // incremental updates since total_propensity was last summed
+    // (reactant species, reaction index) pairs, sorted by species
+    std::vector<std::pair<const Species*, int> > dependencies;
+    bool dependencies_valid;
 };
 
 class NextSubvolumeMethod
 {
   public:
     NextSubvolumeMethod(StructuredGrid& subvolumes);
+    void set_deterministic(const bool d);
+    bool is_deterministic() { return deterministic; }
     void integrate(const double dt) { (*this)(dt); }
     void reset();
     void list_reactions();
@@ -340,14 +405,25 @@ class NextSubvolumeMethod
     void reset_priority(const int i);
     void recalc_priority(const int i);
     double get_next_event_time() { return heap.top().time_at_next_reaction; }
+    void set_subdomains(const int n);
+    int get_num_subdomains() { return subdomains.size() > 0 ? subdomains.size() : 1; }
     double get_time() { return time; }
     void operator()(const double dt);
     StructuredGrid& get_grid() { return subvolumes; }
+    ParticleExchange& get_exchange() { return exchange; }
     friend std::ostream& operator<<(std::ostream& out, NextSubvolumeMethod& b);
     void add_reaction_to_compartment(const double rate, ReactionEquation eq, int i);
 
   private:
     void react(ReactionEquation& r);
+    void react_in_subdomain(ReactionEquation& eq, const int p);
+    void integrate_subdomain(const int p, const double final_time);
+    void exchange_between_subdomains();
+    void integrate_deterministic(const double dt);
+    void calculate_rates_in(const int begin, const int end);
+    void create_particles(ReactionEquation& eq, ReactionComponent& rc);
+    double update_propensities(const int i, ReactionEquation& eq);
+    void sample_priority(const int i, const double inv_total_propensity);
     StructuredGrid& subvolumes;
     PriorityHeap heap;
     // boost::variate_generator<base_generator_type&, boost::uniform_real<> > uni;
@@ -356,6 +432,11 @@ class NextSubvolumeMethod
     std::vector<ReactionList> subvolume_reactions;
     std::vector<ReactionList> saved_subvolume_reactions;
     std::vector<HeapHandle> subvolume_heap_handles;
+    std::vector<Subdomain> subdomains;     // empty for the exact serial method
+    std::vector<int> subvolume_subdomain;  // subdomain of each subvolume
+    ParticleExchange exchange;
+    bool deterministic;                     // finite volume method on Species::amounts
+    std::vector<ReactionEquation> released;  // deterministic reactions that create particles
 };
 
 std::ostream&
@@ -22,7 +22,7 @@ void Species::get_concentration(const StructuredGrid& calc_grid,
 			grid->get_overlap(calc_grid.get_low_point(i),calc_grid.get_high_point(i),indicies,volume_ratio);
 			const int noverlap = indicies.size();
 			for (int j = 0; j < noverlap; ++j) {
-				concentration[i] += copy_numbers[indicies[j]]*volume_ratio[j];
+				concentration[i] += get_amount(indicies[j])*volume_ratio[j];
 			}
 		}
 	}
@@ -39,6 +39,14 @@ public:
 	}
 	void clear() {
 		copy_numbers.assign(grid->size(),0);
+		if (!amounts.empty()) amounts.assign(grid->size(),0);
+	}
+	void add_copies(const int i, const int n) {
+		copy_numbers[i] += n;
+		if (!amounts.empty()) amounts[i] += n;
+	}
+	double get_amount(const int i) const {
+		return amounts.empty() ? copy_numbers[i] : amounts[i];
 	}
 	void get_concentration(const StructuredGrid& calc_grid, std::vector<double>& concentration) const;
 	std::string get_status_string();
@@ -46,6 +54,7 @@ public:
 	double D;
 	double step_length;
 	std::vector<int> copy_numbers;
+	std::vector<double> amounts;		// continuous copy numbers, only for deterministic lattices
 	std::vector<Vect3d> particles;
 	std::vector<Vect3d> particlesx;
 	const StructuredGrid* grid;
@@ -26,7 +26,7 @@
 #include "nsvc.h"
 #include "smoldynfuncs.h"
 #include <sstream>
-#include <set>
+#include <algorithm>
 #include <numeric>
 
 void nsv_init() {
@@ -297,34 +297,46 @@ void nsv_add_reaction(NextSubvolumeMethod* nsv,rxnstruct *reaction) {
 //	nsv->add_reaction(rate, lhs >> rhs);
 //}
 
+/*
+ * returns true if the line from pt1 to pt2 crosses a panel of one of the nsrf surfaces in
+ * srflist, from a face with action act for species ident. Only panels of shape ps are
+ * checked, or all shapes for PSall. Smoldyn's virtual boxes are used to find panels
+ * near the line, so the cost doesn't depend on the total number of panels.
+ */
+static bool nsv_line_crosses(simptr sim,double *pt1,double *pt2,int ident,surfaceptr *srflist,int nsrf,enum SrfAction act,enum PanelShape ps) {
+	double crsspt[DIMMAX];
+	enum PanelFace face1,face2;
+
+	for (boxptr bptr = pos2box(sim,pt1); bptr; bptr = line2nextbox(sim,pt1,pt2,bptr)) {
+		for (int p = 0; p < bptr->npanel; ++p) {
+			panelptr pnl = bptr->panel[p];
+			if (ps != PSall && pnl->ps != ps) continue;
+			int s = 0;
+			while (s < nsrf && srflist[s] != pnl->srf) s++;
+			if (s == nsrf) continue;
+			if (lineXpanel(pt1,pt2,pnl,sim->dim,crsspt,&face1,&face2,NULL,NULL,NULL,0)) {
+				if ((face1!=face2) && (pnl->srf->action[ident][MSsoln][face1]==act)) return true;
+			}
+		}
+	}
+	return false;
+}
+
 void nsv_integrate(NextSubvolumeMethod* nsv,double dt, portstruct *port, latticestruct *lattice) {
 	using namespace Kairos;
 	//std::cout << "running lattice dt"<<std::endl;
 	nsv->integrate(dt);
-		const int ns = nsv->get_diffusing_species().size();
-	int n = 0;
-	for (int i = 0; i < ns; ++i) {
-		n += nsv->get_diffusing_species()[i]->particles.size();
-	}
-
-	int *species = new int[n];
-	double **positions = new double*[n];
-	double **positionsx = new double*[n];
-
-	//const double lattice_lengthscale = 0.0001*std::min(lattice->dx[0],std::min(lattice->dx[1],lattice->dx[2]));
-    if (!port) return;
+	if (!port) return;
 
 	simptr sim = port->portss->sim;
-	n += sim->mols->nl[port->llport];
-	double *crsspt = new double[sim->dim];
-	enum PanelFace face1,face2;
+	const int ns = nsv->get_diffusing_species().size();
+	ParticleExchange& exchange = nsv->get_exchange();
+	exchange.clear();
 
 	/*
 	 * look in port for new particles
 	 */
-	std::set<int> dirty_indicies;
-	int nout = 0;
-	n = sim->mols->nl[port->llport];
+	const int n = sim->mols->nl[port->llport];
 	for (int i = 0; i < n; ++i) {
 		moleculeptr m = sim->mols->live[port->llport][i];
 
@@ -371,39 +383,20 @@ void nsv_integrate(NextSubvolumeMethod* nsv,double dt, portstruct *port, lattice
 		const int ci = nsv->get_grid().get_cell_index(newr);
 		Vect3d cc = nsv->get_grid().get_cell_centre(ci);
 
-		bool throw_back = false;
-
-		for (int i = 0; i < lattice->nsurfaces; ++i) {
-			if ((lattice->surfacelist[i]->action[m->ident][0][PFfront] != SAreflect) && (lattice->surfacelist[i]->action[m->ident][0][PFback] != SAreflect)) {
-				continue;
-			}
-			for (int j = 0; j < PSMAX; ++j) {
-				for (int k = 0; k < lattice->surfacelist[i]->npanel[j]; ++k) {
-					if (lineXpanel(m->posx,cc.data(),lattice->surfacelist[i]->panels[j][k],port->portss->sim->dim,crsspt,&face1,&face2,NULL,NULL,NULL,0)==1) {
-						//if particle crossed surface when adding to lattice, throw back through port
-						if ((face1!=face2) && (lattice->surfacelist[i]->action[m->ident][0][face1]==SAreflect)) throw_back = true;
-
-					}
-				}
-			}
-		}
-
-
-		if (throw_back) {
+		//if particle crossed surface when adding to lattice, throw back through port
+		if (nsv_line_crosses(sim,m->posx,cc.data(),m->ident,lattice->surfacelist,lattice->nsurfaces,SAreflect,PSall)) {
 			//std::cout << "throwing back particle at posx = ("<<m->posx[0]<<','<<m->posx[1]<<','<<m->posx[2]<<") and pos = ("<<m->pos[0]<<','<<m->pos[1]<<','<<m->pos[2]<<")"<<std::endl;
-			species[nout] = m->ident;
-			positions[nout] = m->posx;
-			positionsx[nout] = m->posx;
-			nout++;
+			exchange.species.push_back(m->ident);
+			exchange.positions.push_back(m->posx);
+			exchange.positionsx.push_back(m->posx);
 		} else {
-			nsv->get_species(m->ident)->copy_numbers[ci]++;
-			dirty_indicies.insert(ci);
+			nsv->get_species(m->ident)->add_copies(ci,1);
+			exchange.dirty_indicies.push_back(ci);
 		}
 	}
-	delete[] crsspt;
 
 
-	//delete particles in port
+	//delete particles in port (their data stays valid until new molecules are created)
 	int er = portgetmols(sim,port,-1,MSall,1);
 	if (er != n) simLog(NULL,11,"ERROR: failure in nsv_integrate (while deleting particles from port)\n");
 
@@ -414,57 +407,41 @@ void nsv_integrate(NextSubvolumeMethod* nsv,double dt, portstruct *port, lattice
 	for (int i = 0; i < ns; ++i) {
 		Species *s = nsv->get_diffusing_species()[i];
 		const int np = s->particles.size();
-		double *crsspt = new double[sim->dim];
-		enum PanelFace face1,face2;
 		for (int j = 0; j < np; ++j) {
 			//check if already gone back through port
-			bool in = true;
-            if (port->srf) {
-                for (int k = 0; k < port->srf->npanel[PSrect]; ++k) {
-                    if (lineXpanel(s->particlesx[j].data(),s->particles[j].data(),port->srf->panels[PSrect][k],sim->dim,crsspt,&face1,&face2,NULL,NULL,NULL,0)) {
-                        if ((face1!=face2) && (port->srf->action[s->id][0][face1]==SAport)) {
-                            in = false;
-                        }
-                    }
-                }
-            }
-
-			if (in) {
+			if (!port->srf || !nsv_line_crosses(sim,s->particlesx[j].data(),s->particles[j].data(),s->id,&port->srf,1,SAport,PSrect)) {
 				//std::cout <<" particle going back through port!!!"<<std::endl;
-				species[nout] = s->id;
-				positions[nout] = s->particles[j].data();
-//				if (positions[nout][0] <= -10) std::cout << "x <= -10: "<<positions[nout]<<std::endl;
-//				if (positions[nout][0] >= 10) std::cout << "x >= -10: "<<positions[nout]<<std::endl;
-//				if (positions[nout][1] <= -10) std::cout << "x <= -10: "<<positions[nout]<<std::endl;
-//				if (positions[nout][1] >= 10) std::cout << "x >= -10: "<<positions[nout]<<std::endl;
-				positionsx[nout] = s->particlesx[j].data();
-				nout++;
+				exchange.species.push_back(s->id);
+				exchange.positions.push_back(s->particles[j].data());
+				exchange.positionsx.push_back(s->particlesx[j].data());
 			} else {
 				//add to lattice
 				//std::cout << "adding particle of species "<<s->id<<" back into lattice at position "<<s->particles[j]<<std::endl;
 				const int ci = nsv->get_grid().get_cell_index(s->particles[j]);
-				//Vect3d cc = nsv->get_grid().get_cell_centre(ci);
-				nsv->get_species(s->id)->copy_numbers[ci]++;
-				dirty_indicies.insert(ci);
+				nsv->get_species(s->id)->add_copies(ci,1);
+				exchange.dirty_indicies.push_back(ci);
 			}
-
 		}
-		s->particles.clear();
-		s->particlesx.clear();
 	}
 
-	for (std::set<int>::iterator i=dirty_indicies.begin();i!=dirty_indicies.end();i++) {
+	std::vector<int>& dirty_indicies = exchange.dirty_indicies;
+	std::sort(dirty_indicies.begin(),dirty_indicies.end());
+	dirty_indicies.erase(std::unique(dirty_indicies.begin(),dirty_indicies.end()),dirty_indicies.end());
+	for (std::vector<int>::iterator i=dirty_indicies.begin();i!=dirty_indicies.end();i++) {
 		nsv->recalc_priority(*i);
 	}
 
 	//put particles back in port if needed
+	const int nout = exchange.species.size();
 	if (nout > 0) {
-		er = portputmols(sim,port,nout,species[0],species,positions,positionsx);
+		er = portputmols(sim,port,nout,exchange.species[0],&exchange.species[0],&exchange.positions[0],&exchange.positionsx[0]);
 		if (er != 0) simLog(NULL,11,"ERROR: failure in nsv_integrate (while putting particles in the port)\n");
 	}
 
-	delete[] species;
-	delete[] positions;
+	for (int i = 0; i < ns; ++i) {
+		nsv->get_diffusing_species()[i]->particles.clear();
+		nsv->get_diffusing_species()[i]->particlesx.clear();
+	}
 }
 
 vtkUnstructuredGrid* nsv_get_grid(NextSubvolumeMethod* nsv) {
@@ -514,7 +491,7 @@ double nsv_concentration_point(NextSubvolumeMethod* nsv,int id, double *point, i
 	}
 	const Species* s = nsv->get_species(id);
 	const int index = nsv->get_grid().get_cell_index(vpoint);
-	return s->copy_numbers[index]/nsv->get_grid().get_cell_volume(index);
+	return s->get_amount(index)/nsv->get_grid().get_cell_volume(index);
 }
 
 void nsv_molcount(NextSubvolumeMethod* nsv, int *ret_array) {
@@ -522,8 +499,12 @@ void nsv_molcount(NextSubvolumeMethod* nsv, int *ret_array) {
 
 	std::vector<Species*> species = nsv->get_diffusing_species();
 	for (unsigned int i = 0; i < species.size(); ++i) {
-		const int n = std::accumulate(species[i]->copy_numbers.begin(),species[i]->copy_numbers.end(),0) +
-						species[i]->particles.size();
+		int n = species[i]->particles.size();
+		if (species[i]->amounts.empty()) {
+			n += std::accumulate(species[i]->copy_numbers.begin(),species[i]->copy_numbers.end(),0);
+		} else {
+			n += int(std::accumulate(species[i]->amounts.begin(),species[i]->amounts.end(),0.0)+0.5);
+		}
 		ret_array[species[i]->id] = n;
 	}
 }
@@ -539,8 +520,11 @@ void nsv_kill_molecule(NextSubvolumeMethod* nsv,int id, double *point, int dim)
 	}
 	Species* s = nsv->get_species(id);
 	const int index = nsv->get_grid().get_cell_index(vpoint);
-    s->copy_numbers[index]--;
-    if (s->copy_numbers[index] < 0) {
+    s->add_copies(index,-1);
+    if (!s->amounts.empty()) {
+        if (s->amounts[index] < 0) s->amounts[index] = 0;		// continuous amounts can be fractional
+        s->copy_numbers[index] = int(s->amounts[index]+0.5);
+    } else if (s->copy_numbers[index] < 0) {
         simLog(NULL,11,"ERROR: lattice species became less than zero (in nsv_kill_molecule)\n");
     }
 	nsv->recalc_priority(index);
@@ -565,15 +549,31 @@ void nsv_add_mol(NextSubvolumeMethod* nsv,int id, double* pos, int dim) {
 	//nsv->get_species(id)->particles.push_back(newr);
 
 	const int ci = nsv->get_grid().get_cell_index(newr);
-	nsv->get_species(id)->copy_numbers[ci]++;
+	nsv->get_species(id)->add_copies(ci,1);
 	nsv->recalc_priority(ci);
 }
 
+/*
+ * splits the lattice into n subdomains that are integrated in parallel (1 for serial)
+ */
+void nsv_set_subdomains(NextSubvolumeMethod* nsv,int n) {
+	nsv->set_subdomains(n);
+}
+
+/*
+ * switches the lattice to the deterministic finite volume method (1) or back to the
+ * stochastic next subvolume method (0)
+ */
+void nsv_set_deterministic(NextSubvolumeMethod* nsv,int deterministic) {
+	nsv->set_deterministic(deterministic != 0);
+}
+
 /*
  * returns vector of copy numbers for each lattice site and positions of lattice sites
  *
  * return value = number of lattice sites returned for species "id"
  * copy_numbers = array of ints representing copy number of species "id" at each lattice site
+ * 					(rounded amounts for a deterministic lattice)
  * 					equals NULL if species does not exist
  * positions = array of doubles representing positions of each site. In lattice-site major order.
  * 		eg. x-coord of lattice site n is positions[3*n+0]
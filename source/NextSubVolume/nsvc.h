@@ -78,6 +78,8 @@ void nsv_kill_molecule(NextSubvolumeMethod* nsv,int id, double *point, int dim);
 extern void nsv_molcount(NextSubvolumeMethod* nsv, int *ret_array);
 extern int nsv_get_species_copy_numbers(NextSubvolumeMethod* nsv, int id, const int** copy_numbers, const double** positions);
 extern void nsv_add_mol(NextSubvolumeMethod* nsv,int id, double* pos, int dim);
+extern void nsv_set_subdomains(NextSubvolumeMethod* nsv,int n);
+extern void nsv_set_deterministic(NextSubvolumeMethod* nsv,int deterministic);
 
 extern vtkUnstructuredGrid* nsv_get_grid(NextSubvolumeMethod* nsv);
 
@@ -8,6 +8,7 @@
 #include <string.h>
 #include "../libSteve/List.h"
 #include "opengl2.h"
+#include "random2.h"
 #include "SimCommand.h"
 #include "string2.h"
 #include "List.h"
@@ -30,10 +31,10 @@
 #endif
 
 
-enum ErrorCode Liberrorcode=ECok;
-enum ErrorCode Libwarncode=ECok;
-char Liberrorfunction[STRCHARLONG]="";
-char Liberrorstring[STRCHARLONG]="";
+THREADLOCAL enum ErrorCode Liberrorcode=ECok;
+THREADLOCAL enum ErrorCode Libwarncode=ECok;
+THREADLOCAL char Liberrorfunction[STRCHARLONG]="";
+THREADLOCAL char Liberrorstring[STRCHARLONG]="";
 int Libdebugmode=1;
 int LibThrowThreshold=11;
 
@@ -233,11 +234,40 @@ extern CSTRING enum ErrorCode smolRunTimeStep(simptr sim) {
 	LCHECK(er!=11,funcname,ECerror,"Simulation terminated during filament dynamics");
 	LCHECK(er!=12,funcname,ECerror,"Simulation terminated during lattice simulation");
 	LCHECK(er!=13,funcname,ECerror,"Simulation terminated during reaction network expansion");
+	LCHECK(er!=14,funcname,ECnotify,"Simulation stopped by a step hook");
 	return Libwarncode;
  failure:
 	return Liberrorcode; }
 
 
+/* smolRunTimeSteps */
+extern CSTRING enum ErrorCode smolRunTimeSteps(simptr sim,int nsteps) {
+	const char *funcname="smolRunTimeSteps";
+	int er;
+
+	LCHECK(sim,funcname,ECmissing,"missing sim");
+	LCHECK(nsteps>=0,funcname,ECbounds,"nsteps cannot be < 0");
+	LCHECK(sim->dt>0,funcname,ECmissing,"time step has not been set");
+	if(nsteps==0) return ECok;
+	er=smolsimulatesteps(sim,nsteps);
+	LCHECK(er!=1,funcname,ECnotify,"Simulation complete");
+	LCHECK(er!=2,funcname,ECerror,"Simulation terminated during molecule assignment\n  Out of memory");
+	LCHECK(er!=3,funcname,ECerror,"Simulation terminated during order 0 reaction\n");
+	LCHECK(er!=4,funcname,ECerror,"Simulation terminated during order 1 reaction\n");
+	LCHECK(er!=5,funcname,ECerror,"Simulation terminated during order 2 reaction\n");
+	LCHECK(er!=6,funcname,ECerror,"Simulation terminated during molecule sorting\n  Out of memory");
+	LCHECK(er!=7,funcname,ECnotify,"Simulation stopped by a runtime command");
+	LCHECK(er!=8,funcname,ECerror,"Simulation terminated during simulation state updating\n  Out of memory");
+	LCHECK(er!=9,funcname,ECerror,"Simulation terminated during diffusion\n  Out of memory");
+	LCHECK(er!=11,funcname,ECerror,"Simulation terminated during filament dynamics");
+	LCHECK(er!=12,funcname,ECerror,"Simulation terminated during lattice simulation");
+	LCHECK(er!=13,funcname,ECerror,"Simulation terminated during reaction network expansion");
+	LCHECK(er!=14,funcname,ECnotify,"Simulation stopped by a step hook");
+	return er==10?ECok:Libwarncode;
+ failure:
+	return Liberrorcode; }
+
+
 /* smolRunSim */
 extern CSTRING enum ErrorCode smolRunSim(simptr sim) {
 	const char *funcname="smolRunSim";
@@ -247,7 +277,7 @@ extern CSTRING enum ErrorCode smolRunSim(simptr sim) {
 	er=smolOpenOutputFiles(sim, true);
 	LCHECK(!er,funcname,ECerror,"Cannot open output files for writing");
 
-	if(sim->graphss && sim->graphss->graphics>0 && !strchr(sim->flags,'t'))
+	if(sim->graphss && sim->graphss->graphics>0 && !sim->graphss->offscreen && !strchr(sim->flags,'t'))
 		smolsimulategl(sim);
 	else {
 		er=smolsimulate(sim);
@@ -259,7 +289,8 @@ extern CSTRING enum ErrorCode smolRunSim(simptr sim) {
 		LCHECK(er!=6,funcname,ECerror,"Simulation terminated during molecule sorting\n  Out of memory");
 		LCHECK(er!=7,funcname,ECnotify,"Simulation stopped by a runtime command");
 		LCHECK(er!=8,funcname,ECerror,"Simulation terminated during simulation state updating\n  Out of memory");
-		LCHECK(er!=9,funcname,ECerror,"Simulation terminated during diffusion\n  Out of memory"); }
+		LCHECK(er!=9,funcname,ECerror,"Simulation terminated during diffusion\n  Out of memory");
+		LCHECK(er!=14,funcname,ECnotify,"Simulation stopped by a step hook"); }
 
         // FIXME. If run() is called again, previous Liberrorcode does not
         // reset to ECok but remain stuck to ECnotify.
@@ -298,6 +329,35 @@ extern CSTRING enum ErrorCode smolDisplaySim(simptr sim) {
 	return ECok; }
 
 
+/* smolAddStepHook */
+extern CSTRING enum ErrorCode smolAddStepHook(simptr sim,stephookfnptr hookfn,void *userdata,int every) {
+	const char *funcname="smolAddStepHook";
+	int er;
+
+	LCHECK(sim,funcname,ECmissing,"missing sim");
+	LCHECK(hookfn,funcname,ECmissing,"missing hook function");
+	LCHECK(every>0,funcname,ECbounds,"every needs to be > 0");
+	er=simaddstephook(sim,hookfn,userdata,every);
+	LCHECK(!er,funcname,ECmemory,"out of memory adding step hook");
+	return ECok;
+ failure:
+	return Liberrorcode; }
+
+
+/* smolRemoveStepHook */
+extern CSTRING enum ErrorCode smolRemoveStepHook(simptr sim,stephookfnptr hookfn,void *userdata) {
+	const char *funcname="smolRemoveStepHook";
+	int er;
+
+	LCHECK(sim,funcname,ECmissing,"missing sim");
+	LCHECK(hookfn,funcname,ECmissing,"missing hook function");
+	er=simremovestephook(sim,hookfn,userdata);
+	LCHECK(!er,funcname,ECnonexist,"step hook not found");
+	return ECok;
+ failure:
+	return Liberrorcode; }
+
+
 /******************************************************************************/
 /************************** Read configuration file ***************************/
 /******************************************************************************/
@@ -330,6 +390,36 @@ extern CSTRING simptr smolPrepareSimFromFile(const char *filepath,const char *fi
 	return NULL; }
 
 
+/* smolPrepareSimFromFileWithSeed */
+extern CSTRING simptr smolPrepareSimFromFileWithSeed(const char *filepath,const char *filename,const char *flags,long int seed) {
+	const char *funcname="smolPrepareSimFromFileWithSeed";
+	int er;
+	char emptystring[STRCHAR];
+	simptr sim;
+
+	sim=NULL;
+	LCHECK(filename,funcname,ECmissing,"missing filename");
+
+	emptystring[0]='\0';
+	if(!filepath) filepath=emptystring;
+	if(!flags) flags=emptystring;
+	sim=simalloc(filepath);
+	LCHECK(sim,funcname,ECmemory,"allocating sim");
+	Simsetrandseed(sim,seed);									// before any molecules are placed
+#ifdef OPTION_VCELL
+	er=simInitAndLoad(filepath,filename,&sim,flags,new SimpleValueProviderFactory(),new SimpleMesh());
+#else
+	er=simInitAndLoad(filepath,filename,&sim,flags,NULL);
+#endif
+	LCHECKNT(!er,funcname,ECerror,ErrorLineAndString);
+	er=simUpdateAndDisplay(sim);
+	LCHECK(!er,funcname,ECerror,"Failed to update simulation");
+	return sim;
+ failure:
+	simfree(sim);
+	return NULL; }
+
+
 /* smolLoadSimFromFile */
 extern CSTRING enum ErrorCode smolLoadSimFromFile(const char *filepath,const char *filename,simptr *simpointer,const char *flags) {
 	const char *funcname="smolLoadSimFromFile";
@@ -520,12 +610,25 @@ extern CSTRING enum ErrorCode smolSetTiffParams(simptr sim,int timesteps,const c
 		LCHECK(er!=3,funcname,ECbug,"BUG: timesteps needs to be >=1"); }
 	if(tiffname) {
 		strcpy(nm1,sim->filepath);
-		strncat(nm1,tiffname,STRCHAR-1-strlen(nm1));
-		gl2SetOptionStr("TiffName",nm1); }
-	if(lowcount>=0) {
-		gl2SetOptionInt("TiffNumber",lowcount); }
-	if(highcount>=0) {
-		gl2SetOptionInt("TiffNumMax",highcount); }
+		strncat(nm1,tiffname,STRCHAR-1-strlen(nm1)); }
+	er=graphicssettiffparams(sim,tiffname?nm1:NULL,lowcount,highcount);
+	LCHECK(er!=1,funcname,ECmemory,"out of memory enabling graphics");
+	return ECok;
+ failure:
+	return Liberrorcode; }
+
+
+/* smolSetImageParams */
+extern CSTRING enum ErrorCode smolSetImageParams(simptr sim,const char *format,int width,int height) {
+	const char *funcname="smolSetImageParams";
+	int er;
+
+	LCHECK(sim,funcname,ECmissing,"missing sim");
+	er=graphicssetimage(sim,format,width,height);
+	LCHECK(er!=1,funcname,ECmemory,"out of memory enabling graphics");
+	LCHECK(er!=2,funcname,ECbug,"BUG: missing parameter");
+	LCHECK(er!=3,funcname,ECsyntax,"image format not recognized");
+	LCHECK(er!=4,funcname,ECbounds,"image width and height need to be between 1 and 65535, and the image at most 16777216 pixels");
 	return ECok;
  failure:
 	return Liberrorcode; }
@@ -778,6 +881,47 @@ extern CSTRING enum ErrorCode smolGetOutputData(simptr sim,char *dataname,int *n
 	return Liberrorcode; }
 
 
+/* smolGetOutputDataName */
+extern CSTRING char *smolGetOutputDataName(simptr sim,int dataindex,char *dataname) {
+	const char *funcname="smolGetOutputDataName";
+
+	LCHECK(sim,funcname,ECmissing,"missing sim");
+	LCHECK(dataindex>=0,funcname,ECbounds,"dataindex < 0");
+	LCHECK(dataname,funcname,ECmissing,"missing dataname");
+	if(!sim->cmds || dataindex>=sim->cmds->ndata) return NULL;		// end of list, not an error
+	strcpy(dataname,sim->cmds->dname[dataindex]);
+	return dataname;
+ failure:
+	return NULL; }
+
+
+/* smolGetOutputDataRows */
+extern CSTRING enum ErrorCode smolGetOutputDataRows(simptr sim,const char *dataname,int firstrow,int maxrow,int *nrowptr,int *ncolptr,double *array) {
+	const char *funcname="smolGetOutputDataRows";
+	int did,i,j,nrow;
+	listptrdd list;
+
+	LCHECK(sim,funcname,ECmissing,"missing sim");
+	LCHECK(dataname,funcname,ECmissing,"missing dataname");
+	LCHECK(firstrow>=0,funcname,ECbounds,"firstrow cannot be < 0");
+	LCHECK(sim->cmds && sim->cmds->ndata>0,funcname,ECerror,"no data files in the sim");
+	did=stringfind(sim->cmds->dname,sim->cmds->ndata,dataname);
+	LCHECK(did>=0,funcname,ECerror,"no data file of the requested name");
+	list=sim->cmds->data[did];
+
+	nrow=list->nrow>firstrow?list->nrow-firstrow:0;
+	if(nrowptr) *nrowptr=nrow;
+	if(ncolptr) *ncolptr=list->ncol;
+	if(!array) return ECok;
+	LCHECK(nrow<=maxrow,funcname,ECbounds,"more rows than maxrow");
+	for(i=0;i<nrow;i++)
+		for(j=0;j<list->ncol;j++)
+			array[i*list->ncol+j]=list->data[(firstrow+i)*list->maxcol+j];
+	return ECok;
+ failure:
+	return Liberrorcode; }
+
+
 extern CSTRING enum ErrorCode smolRunCommand(simptr sim,const char *commandstring) {
 	const char *funcname="smolRunCommand";
 	char stringcopy[STRCHARLONG];
@@ -837,7 +981,7 @@ extern CSTRING int smolGetSpeciesIndex(simptr sim,const char *species) {
 	LCHECK(species,funcname,ECmissing,"missing species name");
 	LCHECK(sim->mols,funcname,ECnonexist,"no species defined");
 	LCHECK(strcmp(species,"all"),funcname,ECall,"species is 'all'");
-	i=stringfind(sim->mols->spname,sim->mols->nspecies,species);
+	i=molfindspecies(sim->mols,species);
 	if(i<=0) {
 		char buffer[STRCHAR];
 		snprintf(buffer,STRCHAR,"species '%s' not found",species);
@@ -856,7 +1000,7 @@ extern CSTRING int smolGetSpeciesIndexNT(simptr sim,const char *species) {
 	LCHECKNT(species,funcname,ECmissing,"missing species name");
 	LCHECKNT(sim->mols,funcname,ECnonexist,"no species defined");
 	LCHECKNT(strcmp(species,"all"),funcname,ECall,"species cannot be 'all'");
-	i=stringfind(sim->mols->spname,sim->mols->nspecies,species);
+	i=molfindspecies(sim->mols,species);
 	if(i<=0) {
 		char buffer[STRCHAR];
 		snprintf(buffer,STRCHAR,"species '%s' not found",species);
@@ -894,7 +1038,7 @@ extern CSTRING int smolGetSpecies(simptr sim,int speciesindex,char *speciesname,
 	else {
 		LCHECK(speciesname,funcname,ECmissing,"missing species name");
 		LCHECK(strcmp(speciesname,"all"),funcname,ECall,"species is 'all'");
-		i=stringfind(sim->mols->spname,sim->mols->nspecies,speciesname);
+		i=molfindspecies(sim->mols,speciesname);
 		if(i<=0) {
 			char buffer[STRCHAR];
 			snprintf(buffer,STRCHAR,"species '%s' not found",speciesname);
@@ -1047,6 +1191,21 @@ extern CSTRING enum ErrorCode smolSetMaxMolecules(simptr sim,int maxmolecules) {
 	return Liberrorcode; }
 
 
+/* smolReserveMolecules */
+extern CSTRING enum ErrorCode smolReserveMolecules(simptr sim,int nmolecules) {
+	const char *funcname="smolReserveMolecules";
+	int er;
+
+	LCHECK(sim,funcname,ECmissing,"missing sim");
+	LCHECK(nmolecules>=0,funcname,ECbounds,"nmolecules cannot be < 0");
+	er=molreserve(sim,nmolecules);
+	LCHECK(er!=3,funcname,ECbounds,"nmolecules exceeds the maximum number of molecules");
+	LCHECK(!er,funcname,ECmemory,"out of memory allocating molecules");
+	return ECok;
+ failure:
+	return Liberrorcode; }
+
+
 /* smolAddSolutionMolecules */
 extern CSTRING enum ErrorCode smolAddSolutionMolecules(simptr sim,const char *species,int number,double *lowposition,double *highposition) {
 	const char *funcname="smolAddSolutionMolecules";
@@ -1068,6 +1227,7 @@ extern CSTRING enum ErrorCode smolAddSolutionMolecules(simptr sim,const char *sp
 	else
 		high=highposition;
 
+	randstreamuse(sim->randstate);
 	er=addmol(sim,number,i,low,high,0);
 	LCHECK(!er,funcname,ECmemory,"out of memory adding molecules");
 	return ECok;
@@ -1075,6 +1235,25 @@ extern CSTRING enum ErrorCode smolAddSolutionMolecules(simptr sim,const char *sp
 	return Liberrorcode; }
 
 
+/* smolAddMoleculesAtPositions */
+extern CSTRING enum ErrorCode smolAddMoleculesAtPositions(simptr sim,const char *species,enum MolecState state,int number,double *positions) {
+	const char *funcname="smolAddMoleculesAtPositions";
+	int er,i;
+
+	LCHECK(sim,funcname,ECmissing,"missing sim");
+	i=smolGetSpeciesIndexNT(sim,species);
+	LCHECK(i>0,funcname,ECsame,NULL);
+	LCHECK(state==MSsoln,funcname,ECsyntax,"only solution-phase molecules can be added at positions");
+	LCHECK(number>=0,funcname,ECbounds,"number cannot be < 0");
+	LCHECK(number==0 || positions,funcname,ECmissing,"missing positions");
+
+	er=addmolpositions(sim,number,i,positions,1);
+	LCHECK(!er,funcname,ECmemory,"out of memory adding molecules");
+	return ECok;
+ failure:
+	return Liberrorcode; }
+
+
 /* smolAddCompartmentMolecules */
 extern CSTRING enum ErrorCode smolAddCompartmentMolecules(simptr sim,const char *species,int number,const char *compartment) {
 	const char *funcname="smolAddCompartmentMolecules";
@@ -1086,6 +1265,7 @@ extern CSTRING enum ErrorCode smolAddCompartmentMolecules(simptr sim,const char
 	LCHECK(number>=0,funcname,ECbounds,"number < 0");
 	c=smolGetCompartmentIndexNT(sim,compartment);
 	LCHECK(c>=0,funcname,ECsame,NULL);
+	randstreamuse(sim->randstate);
 	er=addcompartmol(sim,number,i,sim->cmptss->cmptlist[c]);
 	LCHECK(er!=2,funcname,ECerror,"compartment volume is zero or nearly zero");
 	LCHECK(er!=3,funcname,ECmemory,"out of memory adding molecules");
@@ -1120,6 +1300,7 @@ extern CSTRING enum ErrorCode smolAddSurfaceMolecules(simptr sim,const char *spe
 		pnl=sim->srfss->srflist[s]->panels[panelshape][p]; }
 	else {
 		LCHECK(!position,funcname,ECsyntax,"a panel must be specified if position is entered"); }
+	randstreamuse(sim->randstate);
 	er=addsurfmol(sim,number,i,state,position,pnl,s,panelshape,NULL);
 	LCHECK(er!=1,funcname,ECmemory,"unable to allocate temporary storage space");
 	LCHECK(er!=2,funcname,ECbug,"panel name not recognized");
@@ -1130,6 +1311,23 @@ extern CSTRING enum ErrorCode smolAddSurfaceMolecules(simptr sim,const char *spe
 	return Liberrorcode; }
 
 
+/* smolKillMolecules */
+extern CSTRING enum ErrorCode smolKillMolecules(simptr sim,int number,const unsigned long long *serials,int *nkilledptr) {
+	const char *funcname="smolKillMolecules";
+	int nkilled;
+
+	LCHECK(sim,funcname,ECmissing,"missing sim");
+	LCHECK(number>=0,funcname,ECbounds,"number cannot be < 0");
+	LCHECK(number==0 || serials,funcname,ECmissing,"missing serials");
+
+	nkilled=molkillserials(sim,number,serials);
+	LCHECK(nkilled>=0,funcname,ECmemory,"out of memory sorting molecules");
+	if(nkilledptr) *nkilledptr=nkilled;
+	return ECok;
+ failure:
+	return Liberrorcode; }
+
+
 /* smolGetMoleculeCount */
 extern CSTRING int smolGetMoleculeCount(simptr sim,const char *species,enum MolecState state) {
 	const char *funcname="smolGetMoleculeCount";
@@ -1144,6 +1342,66 @@ extern CSTRING int smolGetMoleculeCount(simptr sim,const char *species,enum Mole
 	return (int)Liberrorcode; }
 
 
+/* smolGetMoleculeArrays */
+extern CSTRING enum ErrorCode smolGetMoleculeArrays(simptr sim,const char *species,enum MolecState state,const char *mollist,int maxmol,int *nmolptr,double *positions,int *identities,int *states,unsigned long long *serials) {
+	const char *funcname="smolGetMoleculeArrays";
+	int i,ll,ll1,ll2,m,nmol,dim,d,count;
+	moleculeptr mptr,*mlist;
+	molssptr mols;
+
+	LCHECK(sim,funcname,ECmissing,"missing sim");
+	LCHECK(nmolptr,funcname,ECmissing,"missing nmolptr");
+	*nmolptr=0;
+	if(!species || !strcmp(species,"all")) i=-5;
+	else {
+		i=smolGetSpeciesIndexNT(sim,species);
+		if(i==(int)ECall) {i=-5;smolClearError();}
+		else LCHECK(i>0,funcname,ECsame,NULL); }
+	LCHECK((state>=0 && state<MSMAX) || state==MSall,funcname,ECsyntax,"invalid state");
+	mols=sim->mols;
+	if(!mols || mols->condition==SCinit) return ECok;
+	if(mollist && mollist[0]!='\0') {
+		ll1=smolGetMolListIndexNT(sim,mollist);
+		LCHECK(ll1>=0,funcname,ECsame,NULL);
+		ll2=ll1+1; }
+	else {
+		ll1=0;
+		ll2=mols->nlist; }
+	if(!positions && !identities && !states && !serials) maxmol=0;
+
+	dim=sim->dim;
+	count=0;
+	for(ll=ll1;ll<ll2;ll++) {												// molecules in live lists
+		mlist=mols->live[ll];
+		nmol=mols->nl[ll];
+		for(m=0;m<nmol;m++) {
+			mptr=mlist[m];
+			if(mptr->ident<=0 || (i>0 && mptr->ident!=i) || (state!=MSall && mptr->mstate!=state)) continue;
+			if(count<maxmol) {
+				if(positions) for(d=0;d<dim;d++) positions[count*dim+d]=mptr->pos[d];
+				if(identities) identities[count]=mptr->ident;
+				if(states) states[count]=(int)mptr->mstate;
+				if(serials) serials[count]=mptr->serno; }
+			count++; }}
+	mlist=mols->dead;																	// resurrected molecules, not yet in live lists
+	for(m=mols->topd;m<mols->nd;m++) {
+		mptr=mlist[m];
+		if(mptr->ident<=0 || (i>0 && mptr->ident!=i) || (state!=MSall && mptr->mstate!=state)) continue;
+		if(mptr->list<ll1 || mptr->list>=ll2) continue;
+		if(count<maxmol) {
+			if(positions) for(d=0;d<dim;d++) positions[count*dim+d]=mptr->pos[d];
+			if(identities) identities[count]=mptr->ident;
+			if(states) states[count]=(int)mptr->mstate;
+			if(serials) serials[count]=mptr->serno; }
+		count++; }
+
+	*nmolptr=count;
+	LCHECK(maxmol==0 || count<=maxmol,funcname,ECbounds,"output arrays are too small");
+	return ECok;
+ failure:
+	return Liberrorcode; }
+
+
 /* smolSetMoleculeColor */
 extern "C" enum ErrorCode smolSetMoleculeColor(
     simptr sim, const char *species, enum MolecState state, double *color)
@@ -1828,13 +2086,13 @@ extern CSTRING int smolGetReactionIndex(simptr sim,int *orderptr,const char *rea
 	if(orderptr && *orderptr>=0 && *orderptr<MAXORDER) {
 		order=*orderptr;
 		LCHECK(sim->rxnss[order] && sim->rxnss[order]->totrxn,funcname,ECnonexist,"no reactions defined of this order");
-		r=stringfind(sim->rxnss[order]->rname,sim->rxnss[order]->totrxn,reaction);
+		r=rxnfindname(sim->rxnss[order],reaction);
 		LCHECK(r>=0,funcname,ECnonexist,"reaction not found"); }
 	else {
 		r=-1;
 		for(order=0;order<MAXORDER && r<0;order++)
 			if(sim->rxnss[order])
-				r=stringfind(sim->rxnss[order]->rname,sim->rxnss[order]->totrxn,reaction);
+				r=rxnfindname(sim->rxnss[order],reaction);
 		LCHECK(r>=0,funcname,ECnonexist,"reaction not found");
 		if(orderptr) *orderptr=order-1; }
 	return r;
@@ -1853,13 +2111,13 @@ extern CSTRING int smolGetReactionIndexNT(simptr sim,int *orderptr,const char *r
 	if(orderptr && *orderptr>=0 && *orderptr<MAXORDER) {
 		order=*orderptr;
 		LCHECKNT(sim->rxnss[order] && sim->rxnss[order]->totrxn,funcname,ECnonexist,"no reactions defined of this order");
-		r=stringfind(sim->rxnss[order]->rname,sim->rxnss[order]->totrxn,reaction);
+		r=rxnfindname(sim->rxnss[order],reaction);
 		LCHECKNT(r>=0,funcname,ECnonexist,"reaction not found"); }
 	else {
 		r=-1;
 		for(order=0;order<MAXORDER && r<0;order++)
 			if(sim->rxnss[order])
-				r=stringfind(sim->rxnss[order]->rname,sim->rxnss[order]->totrxn,reaction);
+				r=rxnfindname(sim->rxnss[order],reaction);
 		LCHECKNT(r>=0,funcname,ECnonexist,"reaction not found");
 		if(orderptr) *orderptr=order-1; }
 	return r;
@@ -49,14 +49,18 @@ char*          smolErrorCodeToString(enum ErrorCode erc,char *string);
 simptr         smolNewSim(int dim,double *lowbounds,double *highbounds);
 enum ErrorCode smolUpdateSim(simptr sim);
 enum ErrorCode smolRunTimeStep(simptr sim);
+enum ErrorCode smolRunTimeSteps(simptr sim,int nsteps);
 enum ErrorCode smolRunSim(simptr sim);
 enum ErrorCode smolRunSimUntil(simptr sim,double breaktime);
 enum ErrorCode smolFreeSim(simptr sim);
 enum ErrorCode smolDisplaySim(simptr sim);
+enum ErrorCode smolAddStepHook(simptr sim,stephookfnptr hookfn,void *userdata,int every);
+enum ErrorCode smolRemoveStepHook(simptr sim,stephookfnptr hookfn,void *userdata);
 
 /************************** Read configuration file ***************************/
 
 simptr         smolPrepareSimFromFile(const char *filepath,const char *filename,const char *flags);
+simptr         smolPrepareSimFromFileWithSeed(const char *filepath,const char *filename,const char *flags,long int seed);
 enum ErrorCode smolLoadSimFromFile(const char *filepath,const char *filename,simptr *simpointer,const char *flags);
 enum ErrorCode smolReadConfigString(simptr sim,const char *statement,char *parameters);
 
@@ -75,6 +79,7 @@ enum ErrorCode smolSetPartitions(simptr sim,const char *method,double value);
 
 enum ErrorCode smolSetGraphicsParams(simptr sim,const char *method,int timesteps,int delay);
 enum ErrorCode smolSetTiffParams(simptr sim,int timesteps,const char *tiffname,int lowcount,int highcount);
+enum ErrorCode smolSetImageParams(simptr sim,const char *format,int width,int height);
 enum ErrorCode smolSetLightParams(simptr sim,int lightindex,double *ambient,double *diffuse,double *specular,double *position);
 enum ErrorCode smolSetBackgroundStyle(simptr sim,double *color);
 enum ErrorCode smolSetFrameStyle(simptr sim,double thickness,double *color);
@@ -92,6 +97,8 @@ enum ErrorCode smolOpenOutputFiles(simptr sim, int overwrite);
 enum ErrorCode smolAddCommand(simptr sim,char type,double on,double off,double step,double multiplier,const char *commandstring);
 enum ErrorCode smolAddCommandFromString(simptr sim,char *string);
 enum ErrorCode smolGetOutputData(simptr sim,char *dataname,int *nrow,int *ncol,double **array,int erase);
+char*          smolGetOutputDataName(simptr sim,int dataindex,char *dataname);
+enum ErrorCode smolGetOutputDataRows(simptr sim,const char *dataname,int firstrow,int maxrow,int *nrowptr,int *ncolptr,double *array);
 enum ErrorCode smolRunCommand(simptr sim,const char *commandstring);
 
 /********************************* Molecules **********************************/
@@ -111,10 +118,14 @@ int            smolGetMolListIndexNT(simptr sim,const char *mollist);
 char*          smolGetMolListName(simptr sim,int mollistindex,char *mollist);
 enum ErrorCode smolSetMolList(simptr sim,const char *species,enum MolecState state,const char *mollist);
 enum ErrorCode smolSetMaxMolecules(simptr sim,int maxmolecules);
+enum ErrorCode smolReserveMolecules(simptr sim,int nmolecules);
 enum ErrorCode smolAddSolutionMolecules(simptr sim,const char *species,int number,double *lowposition,double *highposition);
+enum ErrorCode smolAddMoleculesAtPositions(simptr sim,const char *species,enum MolecState state,int number,double *positions);
 enum ErrorCode smolAddCompartmentMolecules(simptr sim,const char *species,int number,const char *compartment);
 enum ErrorCode smolAddSurfaceMolecules(simptr sim,const char *species,enum MolecState state,int number,const char *surface,enum PanelShape panelshape,const char *panel,double *position);
+enum ErrorCode smolKillMolecules(simptr sim,int number,const unsigned long long *serials,int *nkilledptr);
 int            smolGetMoleculeCount(simptr sim,const char *species,enum MolecState state);
+enum ErrorCode smolGetMoleculeArrays(simptr sim,const char *species,enum MolecState state,const char *mollist,int maxmol,int *nmolptr,double *positions,int *identities,int *states,unsigned long long *serials);
 enum ErrorCode smolSetMoleculeStyle(simptr sim,const char *species,enum MolecState state,double size,double *color);
 
 /********************************** Surfaces **********************************/
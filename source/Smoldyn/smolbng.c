@@ -714,7 +714,7 @@ int bngaddmonomer(bngptr bng,const char *name,enum MolecState ms) {
 		n=bng->nmonomer;
 		strcpy(bng->monomernames[n-1],name);					// put the new monomer at the end
 
-		j=stringfind(sim->mols->spname,sim->mols->nspecies,name);	// look for monomer in Smoldyn species list
+		j=molfindspecies(sim->mols,name);	// look for monomer in Smoldyn species list
 		if(j<=0) {																		// not there, so try Smoldyn species without dots
 			for(j=1;j<sim->mols->nspecies;j++) {
 				spname=sim->mols->spname[j];
@@ -912,7 +912,7 @@ double bngmakedifc(bngptr bng,int index,int totalmn) {
 
 	difc=-1;
 	sim=bng->bngss->sim;
-	j=stringfind(sim->mols->spname,sim->mols->nspecies,bng->bspshortnames[index]);	// look for species in Smoldyn species list
+	j=molfindspecies(sim->mols,bng->bspshortnames[index]);	// look for species in Smoldyn species list
 
 	if(j>0) {
 		ms=bng->bspstate[index];
@@ -944,7 +944,7 @@ double bngmakedisplaysize(bngptr bng,int index,int totalmn) {
 
 	displaysize=0;
 	sim=bng->bngss->sim;
-	j=stringfind(sim->mols->spname,sim->mols->nspecies,bng->bspshortnames[index]);	// look for species in Smoldyn species list
+	j=molfindspecies(sim->mols,bng->bspshortnames[index]);	// look for species in Smoldyn species list
 
 	if(j>0) {
 		ms=bng->bspstate[index];
@@ -973,7 +973,7 @@ int bngmakecolor(bngptr bng,int index,int totalmn,double *color) {
 
 	color[0]=color[1]=color[2]=0;
 	sim=bng->bngss->sim;
-	j=stringfind(sim->mols->spname,sim->mols->nspecies,bng->bspshortnames[index]);	// look for species in Smoldyn species list
+	j=molfindspecies(sim->mols,bng->bspshortnames[index]);	// look for species in Smoldyn species list
 
 	if(j>0) {
 		ms=bng->bspstate[index];
@@ -1015,7 +1015,7 @@ void bngmakesurfaction(bngptr bng,int index,int totalmn,enum SrfAction **srfacti
 	surfactionptr trialdet,currentdet;
 
 	sim=bng->bngss->sim;
-	j=stringfind(sim->mols->spname,sim->mols->nspecies,bng->bspshortnames[index]);	// look for species in Smoldyn species list
+	j=molfindspecies(sim->mols,bng->bspshortnames[index]);	// look for species in Smoldyn species list
 	for(s=0;s<bng->bngmaxsurface;s++)
 		srfaction[s][PFfront]=srfaction[s][PFback]=SAtrans;
 
@@ -1120,7 +1120,7 @@ int bngparsespecies(bngptr bng,int index) {
   if(i1==-1) return -1;         // out of memory
   else if(i1==-4) return -3;    // illegal name
   else if(i1==-5)               // already exists
-    i1=stringfind(sim->mols->spname,sim->mols->nspecies,bng->bspshortnames[index]);
+    i1=molfindspecies(sim->mols,bng->bspshortnames[index]);
   else if(i1==-6) return -3;    // illegal name
 
   bng->spindex[index]=i1;												// set spindex element
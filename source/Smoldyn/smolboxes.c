@@ -31,6 +31,7 @@ int panelinbox(simptr sim,panelptr pnl,boxptr bptr);
 boxptr boxalloc(int dim,int nlist);
 int expandbox(boxptr bptr,int n,int ll);
 int expandboxpanels(boxptr bptr,int n);
+int expandboxsegs(boxptr bptr,int n);
 void boxfree(boxptr bptr,int nlist);
 boxptr *boxesalloc(int nbox,int dim,int nlist);
 void boxesfree(boxptr *blist,int nbox,int nlist);
@@ -79,6 +80,24 @@ boxptr pos2box(simptr sim,const double *pos) {
 	return boxs->blist[b]; }
 
 
+/* boxdist2 */
+double boxdist2(simptr sim,const double *pos,boxptr bptr) {
+	int d,dim,*side;
+	double *size,*min,lo,hi,dist2;
+
+	dim=sim->dim;
+	size=sim->boxs->size;
+	min=sim->boxs->min;
+	side=sim->boxs->side;
+	dist2=0;
+	for(d=0;d<dim;d++) {													// edge boxes extend to infinity, like pos2box
+		lo=min[d]+bptr->indx[d]*size[d];
+		hi=lo+size[d];
+		if(pos[d]<lo && bptr->indx[d]>0) dist2+=(lo-pos[d])*(lo-pos[d]);
+		else if(pos[d]>hi && bptr->indx[d]<side[d]-1) dist2+=(pos[d]-hi)*(pos[d]-hi); }
+	return dist2; }
+
+
 /* boxrandpos */
 void boxrandpos(simptr sim,double *pos,boxptr bptr) {
 	int d;
@@ -91,6 +110,34 @@ void boxrandpos(simptr sim,double *pos,boxptr bptr) {
 	return; }
 
 
+/* boxrange */
+void boxrange(simptr sim,const double *poslo,const double *poshi,int *lo,int *hi) {
+	int d;
+	boxssptr boxs;
+
+	boxs=sim->boxs;
+	for(d=0;d<sim->dim;d++) {
+		lo[d]=(int)floor((poslo[d]-boxs->min[d])/boxs->size[d]);
+		hi[d]=(int)floor((poshi[d]-boxs->min[d])/boxs->size[d]);
+		if(lo[d]<0) lo[d]=0;
+		else if(lo[d]>=boxs->side[d]) lo[d]=boxs->side[d]-1;
+		if(hi[d]<0) hi[d]=0;
+		else if(hi[d]>=boxs->side[d]) hi[d]=boxs->side[d]-1; }
+	return; }
+
+
+/* boxrangenext */
+int boxrangenext(int *indx,const int *lo,const int *hi,int dim) {
+	int d;
+
+	for(d=dim-1;d>=0;d--) {
+		if(indx[d]<hi[d]) {
+			indx[d]++;
+			return 1; }
+		indx[d]=lo[d]; }
+	return 0; }
+
+
 /* panelinbox */
 int panelinbox(simptr sim,panelptr pnl,boxptr bptr) {
 	int dim,d,cross;
@@ -175,12 +222,52 @@ void boxremovemol(moleculeptr mptr,int ll) {
 	return; }
 
 
+/* boxaddsegment */
+int boxaddsegment(simptr sim,segmentptr segment) {
+	int d,dim,lo[DIMMAX],hi[DIMMAX],indx[DIMMAX];
+	boxptr bptr;
+
+	dim=sim->dim;
+	for(d=0;d<dim;d++) {
+		segment->boxlo[d]=(segment->xyzfront[d]<segment->xyzback[d]?segment->xyzfront[d]:segment->xyzback[d])-segment->thk;
+		segment->boxhi[d]=(segment->xyzfront[d]>segment->xyzback[d]?segment->xyzfront[d]:segment->xyzback[d])+segment->thk; }
+	boxrange(sim,segment->boxlo,segment->boxhi,lo,hi);
+	for(d=0;d<dim;d++) indx[d]=lo[d];
+	do {
+		bptr=sim->boxs->blist[indx2addZV(indx,sim->boxs->side,dim)];
+		if(bptr->nseg==bptr->maxseg)
+			if(expandboxsegs(bptr,bptr->maxseg+1)) return 1;
+		bptr->seg[bptr->nseg++]=segment; }
+	while(boxrangenext(indx,lo,hi,dim));
+	segment->inbox=1;
+	return 0; }
+
+
+/* boxremovesegment */
+void boxremovesegment(simptr sim,segmentptr segment) {
+	int d,dim,i,lo[DIMMAX],hi[DIMMAX],indx[DIMMAX];
+	boxptr bptr;
+
+	if(!segment->inbox) return;
+	dim=sim->dim;
+	boxrange(sim,segment->boxlo,segment->boxhi,lo,hi);
+	for(d=0;d<dim;d++) indx[d]=lo[d];
+	do {
+		bptr=sim->boxs->blist[indx2addZV(indx,sim->boxs->side,dim)];
+		for(i=0;i<bptr->nseg && bptr->seg[i]!=segment;i++);
+		if(i<bptr->nseg)
+			bptr->seg[i]=bptr->seg[--bptr->nseg]; }
+	while(boxrangenext(indx,lo,hi,dim));
+	segment->inbox=0;
+	return; }
+
+
 /* boxscansphere */
 boxptr boxscansphere(simptr sim,const double *pos,double radius,boxptr bptr,int *wrap) {
 	boxssptr boxs;
 	double boxmin[DIMMAX],boxmax[DIMMAX],v1[DIMMAX],dist;
 	int dim,d,b,index[DIMMAX],done,diam,keepgoing;
-	static int boxdiameter,startindex[DIMMAX],deltaindex[DIMMAX];
+	static THREADLOCAL int boxdiameter,startindex[DIMMAX],deltaindex[DIMMAX];
 
 	boxs=sim->boxs;
 	dim=sim->dim;
@@ -295,6 +382,9 @@ boxptr boxalloc(int dim,int nlist) {
 	bptr->maxpanel=0;
 	bptr->npanel=0;
 	bptr->panel=NULL;
+	bptr->maxseg=0;
+	bptr->nseg=0;
+	bptr->seg=NULL;
 	bptr->maxmol=NULL;
 	bptr->nmol=NULL;
 	bptr->mol=NULL;
@@ -357,6 +447,25 @@ int expandboxpanels(boxptr bptr,int n) {
 	return 0; }
 
 
+/* expandboxsegs */
+int expandboxsegs(boxptr bptr,int n) {
+	int maxseg,i;
+	segmentptr *seg;
+
+	if(n<=0) return 0;
+	maxseg=n+bptr->maxseg;
+	seg=(segmentptr*) calloc(maxseg,sizeof(segmentptr));
+	if(!seg) return 1;
+	for(i=0;i<bptr->nseg;i++)
+		seg[i]=bptr->seg[i];
+	for(;i<maxseg;i++)
+		seg[i]=NULL;
+	free(bptr->seg);
+	bptr->seg=seg;
+	bptr->maxseg=maxseg;
+	return 0; }
+
+
 /* boxfree */
 void boxfree(boxptr bptr,int nlist) {
 	int ll;
@@ -369,6 +478,7 @@ void boxfree(boxptr bptr,int nlist) {
 	free(bptr->nmol);
 	free(bptr->maxmol);
 	free(bptr->panel);
+	free(bptr->seg);
 	free(bptr->wlist);
 	free(bptr->wpneigh);
 	free(bptr->neigh);
@@ -490,6 +600,7 @@ void boxoutput(boxssptr boxs,int blo,int bhi,int dim) {
 			for(p=0;p<bptr->npanel;p++) {
 				simLog(sim,2," %s",bptr->panel[p]->pname); }}
 		simLog(sim,2,"\n");
+		if(bptr->nseg) simLog(sim,2,"  %i filament segments\n",bptr->nseg);
 
 		simLog(sim,2,"  %i live lists:\n",boxs->nlist);
 		simLog(sim,2,"   max:");
@@ -635,11 +746,12 @@ int boxesupdateparams(simptr sim) {
 	int m,mlo,mhi,nbox,b,ll,ll1,mxml,er,npanel;
 	boxssptr boxs;
 	boxptr *blist,bptr;
-	int nsrf,s,p;
+	int nsrf,s,p,ft,f;
 	surfaceptr srf;
 	moleculeptr mptr,*mlist;
 	enum PanelShape ps;
 	panelptr pnl;
+	filamentptr fil;
 
 	boxs=sim->boxs;
 	nbox=boxs->nbox;
@@ -669,6 +781,16 @@ int boxesupdateparams(simptr sim) {
 							if(panelinbox(sim,srf->panels[ps][p],bptr))
 								bptr->panel[bptr->npanel++]=srf->panels[ps][p]; }}}}
 
+	if(sim->filss) {											// segments are listed again when needed
+		for(b=0;b<nbox;b++)
+			blist[b]->nseg=0;
+		for(ft=0;ft<sim->filss->ntype;ft++)
+			for(f=0;f<sim->filss->filtypes[ft]->nfil;f++) {
+				fil=sim->filss->filtypes[ft]->fillist[f];
+				for(s=0;s<fil->maxseg;s++)
+					fil->segments[s]->inbox=0;
+				fil->boxvalid=0; }}
+
 	if(sim->mols) {												// mptr->box, box->maxmol, nmol, mol
 		if(sim->mols->condition<SCparams) return 2;
 		for(b=0;b<nbox;b++)									// clear out molecule lists in boxes
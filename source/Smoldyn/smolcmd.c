@@ -30,10 +30,7 @@
 
 
 /* Global variables */
-int Nvar;
-char **Varnames;
-double *Varvalues;
-char ErrString[STRCHAR];
+THREADLOCAL char ErrString[STRCHAR];
 
 
 /**********************************************************/
@@ -184,9 +181,8 @@ enum CMDcode docommand(void *simvd,cmdptr cmd,char *line) {
 	if(itct<=0) return CMDok;
 	line2=strnword(line,2);
 
-	Nvar=sim->nvar;
-	Varnames=sim->varnames;
-	Varvalues=sim->varvalues;
+	randstreamuse(sim->randstate);
+	strunitsuse(sim->unitstate);
 
 	// simulation control
 	if(!strcmp(word,"stop")) return cmdstop(sim,cmd,line2);
@@ -343,7 +339,7 @@ enum CMDcode cmdpause(simptr sim,cmdptr cmd,char *line2) {
 		return CMDok; }
 	tflag=strchr(sim->flags,'t')?1:0;
 	SCMDCHECK(sim->graphss && sim->graphss->graphics!=0 && !tflag,"pause doesn't work without graphics");
-	gl2State(1);
+	smolKeyPush(' ');
 	return CMDpause; }
 
 
@@ -367,7 +363,7 @@ enum CMDcode cmdkeypress(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(itct==1,"cannot read character");
 	tflag=strchr(sim->flags,'t')?1:0;
 	SCMDCHECK(sim->graphss && sim->graphss->graphics!=0 && !tflag,"keypress doesn't work without graphics");
-	gl2SetKeyPush((unsigned char) c);
+	smolKeyPush((unsigned char) c);
 	return CMDok; }
 
 
@@ -378,7 +374,7 @@ enum CMDcode cmdsetflag(simptr sim,cmdptr cmd,char *line2) {
 
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDcontrol;
 	SCMDCHECK(line2,"missing argument");
-	itct=strmathsscanf(line2,"%mlg|",Varnames,Varvalues,Nvar,&f1);
+	itct=strmathsscanf(line2,"%mlg|",sim->varnames,sim->varvalues,sim->nvar,&f1);
 	SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"cannot read flag value. %s",ErrString);
 	scmdsetflag(sim->cmds,f1);
 	return CMDok; }
@@ -421,7 +417,7 @@ enum CMDcode cmdsetgraphic_iter(simptr sim,cmdptr cmd,char *line2) {
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDcontrol;
 	if(!sim->graphss || sim->graphss->graphics==0) return CMDok;
 	SCMDCHECK(line2,"missing argument");
-	itct=strmathsscanf(line2,"%mi",Varnames,Varvalues,Nvar,&iter);
+	itct=strmathsscanf(line2,"%mi",sim->varnames,sim->varvalues,sim->nvar,&iter);
 	SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"cannot read graphics iterations. %s",ErrString);
 	SCMDCHECK(iter>0,"graphics iterations must be >0");
 	sim->graphss->graphicit=iter;
@@ -480,7 +476,7 @@ enum CMDcode cmdifflag(simptr sim,cmdptr cmd,char *line2) {
 
 	if(line2 && !strcmp(line2,"cmdtype")) return conditionalcmdtype(sim,cmd,2);
 	SCMDCHECK(line2,"missing arguments");
-	itct=strmathsscanf(line2,"%c %mlg|",Varnames,Varvalues,Nvar,&ch,&f1);
+	itct=strmathsscanf(line2,"%c %mlg|",sim->varnames,sim->varvalues,sim->nvar,&ch,&f1);
 	SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"cannot read comparison symbol or flag value. %s",ErrString);
 	SCMDCHECK(ch=='<' || ch=='=' || ch=='>',"comparison symbol has to be <, =, or >");
 	flag=scmdreadflag(sim->cmds);
@@ -496,7 +492,7 @@ enum CMDcode cmdifprob(simptr sim,cmdptr cmd,char *line2) {
 
 	if(line2 && !strcmp(line2,"cmdtype")) return conditionalcmdtype(sim,cmd,1);
 	SCMDCHECK(line2,"missing arguments");
-	itct=strmathsscanf(line2,"%mlg|",Varnames,Varvalues,Nvar,&f1);
+	itct=strmathsscanf(line2,"%mlg|",sim->varnames,sim->varvalues,sim->nvar,&f1);
 	SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"cannot read probability value. %s",ErrString);
 	SCMDCHECK(f1>=0 && f1<=1,"probability value needs to be between 0 and 1");
 	if(randCOD()<f1)
@@ -538,7 +534,7 @@ enum CMDcode cmdifless(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(i!=-4 || sim->ruless,"molecule name not recognized");
 	SCMDCHECK(i!=-7,"error allocating memory");
 	SCMDCHECK(line2=strnword(line2,2),"missing value argument");
-	itct=strmathsscanf(line2,"%mi",Varnames,Varvalues,Nvar,&min);
+	itct=strmathsscanf(line2,"%mi",sim->varnames,sim->varvalues,sim->nvar,&min);
 	SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"cannot read value argument. %s",ErrString);
 	count=(i==-4)?0:molcount(sim,i,index,ms,min);
 	if(count<min) return docommand(sim,cmd,strnword(line2,2));
@@ -560,7 +556,7 @@ enum CMDcode cmdifmore(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(i!=-4 || sim->ruless,"molecule name not recognized");
 	SCMDCHECK(i!=-7,"error allocating memory");
 	SCMDCHECK(line2=strnword(line2,2),"missing value argument");
-	itct=strmathsscanf(line2,"%mi",Varnames,Varvalues,Nvar,&min);
+	itct=strmathsscanf(line2,"%mi",sim->varnames,sim->varvalues,sim->nvar,&min);
 	SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"cannot read value argument. %s",ErrString);
 	count=(i==-4)?0:molcount(sim,i,index,ms,min+1);
 	if(count>min) return docommand(sim,cmd,strnword(line2,2));
@@ -575,8 +571,8 @@ enum CMDcode cmdifincmpt(simptr sim,cmdptr cmd,char *line2) {
 	compartssptr cmptss;
 	char ch;
 	moleculeptr mptr;
-	static compartptr cmpt=NULL;
-	static int inscan=0,count=0;
+	static THREADLOCAL compartptr cmpt=NULL;
+	static THREADLOCAL int inscan=0,count=0;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return conditionalcmdtype(sim,cmd,4);
@@ -592,7 +588,7 @@ enum CMDcode cmdifincmpt(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(i!=-4 || sim->ruless,"molecule name not recognized");
 	SCMDCHECK(i!=-7,"error allocating memory");
 	SCMDCHECK(line2=strnword(line2,2),"missing value argument");
-	itct=strmathsscanf(line2,"%c %mi %s",Varnames,Varvalues,Nvar,&ch,&min,cname);
+	itct=strmathsscanf(line2,"%c %mi %s",sim->varnames,sim->varvalues,sim->nvar,&ch,&min,cname);
 	SCMDCHECK(itct==3 && !strmatherror(ErrString,1),"cannot read symbol, value, and/or compartment arguments. %s",ErrString);
 	SCMDCHECK(ch=='<' || ch=='=' || ch=='>',"comparison symbol has to be <, =, or >");
 	c=stringfind(cmptss->cnames,cmptss->ncmpt,cname);
@@ -632,7 +628,7 @@ enum CMDcode cmdifchange(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(i!=-4 || sim->ruless,"molecule name not recognized");
 	SCMDCHECK(i!=-7,"error allocating memory");
 	SCMDCHECK(line2=strnword(line2,2),"missing value argument");
-	itct=strmathsscanf(line2,"%c %mi",Varnames,Varvalues,Nvar,&change,&num);
+	itct=strmathsscanf(line2,"%c %mi",sim->varnames,sim->varvalues,sim->nvar,&change,&num);
 	SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"cannot read change or number arguments. %s",ErrString);
   SCMDCHECK(line2=strnword(line2,3),"missing conditional command");
 
@@ -657,7 +653,7 @@ enum CMDcode cmdif(simptr sim,cmdptr cmd,char *line2) {
 	if(line2 && !strcmp(line2,"cmdtype")) {
 		return conditionalcmdtype(sim,cmd,2); }
 
-	itct=strmathsscanf(line2,"%mlg| %c %mlg|",Varnames,Varvalues,Nvar,&value1,&symbol,&value2);
+	itct=strmathsscanf(line2,"%mlg| %c %mlg|",sim->varnames,sim->varvalues,sim->nvar,&value1,&symbol,&value2);
 	SCMDCHECK(itct==3 && !strmatherror(ErrString,1),"cannot read command arguments. %s",ErrString);
   SCMDCHECK(line2=strnword(line2,4),"missing conditional command");
 
@@ -679,9 +675,9 @@ enum CMDcode cmdwarnescapee(simptr sim,cmdptr cmd,char *line2) {
 	moleculeptr mptr;
 	double *pos,*posx,*via;
 	char string[STRCHAR];
-	static int inscan=0;
-	static FILE *fptr=NULL;
-	static int dataid=-1;
+	static THREADLOCAL int inscan=0;
+	static THREADLOCAL FILE *fptr=NULL;
+	static THREADLOCAL int dataid=-1;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -732,10 +728,10 @@ enum CMDcode cmdwarnescapeecmpt(simptr sim,cmdptr cmd,char *line2) {
 	compartssptr cmptss;
 	double *pos,*posx,*via;
 	char string[STRCHAR],nm[STRCHAR];
-	static int inscan=0;
-	static compartptr cmpt=NULL;
-	static FILE *fptr=NULL;
-	static int dataid=-1;
+	static THREADLOCAL int inscan=0;
+	static THREADLOCAL compartptr cmpt=NULL;
+	static THREADLOCAL FILE *fptr=NULL;
+	static THREADLOCAL int dataid=-1;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -850,7 +846,7 @@ enum CMDcode cmdmolcount(simptr sim,cmdptr cmd,char *line2) {
 	int i,nspecies,*ctlat,ilat,er,dataid;
 	latticeptr lat;
 	moleculeptr mptr;
-	static int inscan=0,*ct=NULL;
+	static THREADLOCAL int inscan=0,*ct=NULL;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -889,8 +885,7 @@ enum CMDcode cmdmolcount(simptr sim,cmdptr cmd,char *line2) {
 			if(lat->type==LATTICEnsv) {
 				NSV_CALL(nsv_molcount(lat->nsv,ctlat)); }
 			else if(lat->type==LATTICEpde) {
-				//not implemented
-			}
+				NSV_CALL(nsv_molcount(lat->pde,ctlat)); }
 			for(i=1;i<nspecies;i++) {
 				ct[i]+=ctlat[i]; }}}
 
@@ -914,9 +909,9 @@ double fnmolcount(void *voidsim,char *erstr,char *line2) {
 	simptr sim;
 	enum MolecState ms;
 	int i,*index;
-	static char oldline2[STRCHAR]="\0";
-	static int inscan=0,ct;
-	static long int oldtouch=0;
+	static THREADLOCAL char oldline2[STRCHAR]="\0";
+	static THREADLOCAL int inscan=0,ct;
+	static THREADLOCAL long int oldtouch=0;
 
 	sim=(simptr) voidsim;
 	if(inscan) goto scanportion;
@@ -950,13 +945,13 @@ double fnmolcountonsurf(void *voidsim,char *erstr,char *line2) {
 	simptr sim;
 	enum MolecState ms;
 	int i,*index,s,comma,itct;
-	static int inscan=0,ct;
+	static THREADLOCAL int inscan=0,ct;
 	surfacessptr srfss;
 	char nm[STRCHAR];
-	static surfaceptr srf;
+	static THREADLOCAL surfaceptr srf;
 	moleculeptr mptr;
-	static long int oldtouch=0;
-	static char oldline2[STRCHAR]="\0";
+	static THREADLOCAL long int oldtouch=0;
+	static THREADLOCAL char oldline2[STRCHAR]="\0";
 
 	sim=(simptr) voidsim;
 	if(inscan) goto scanportion;
@@ -1001,8 +996,8 @@ enum CMDcode cmdmolcountinbox(simptr sim,cmdptr cmd,char *line2) {
 	FILE *fptr;
 	int d,dim,itct,i,nspecies,er,dataid;
 	moleculeptr mptr;
-	static double low[3]={0,0,0},high[3]={0,0,0};
-	static int inscan=0,*ct;
+	static THREADLOCAL double low[3]={0,0,0},high[3]={0,0,0};
+	static THREADLOCAL int inscan=0,*ct;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -1012,7 +1007,7 @@ enum CMDcode cmdmolcountinbox(simptr sim,cmdptr cmd,char *line2) {
 	dim=sim->dim;
 	for(d=0;d<dim;d++) {
 		SCMDCHECK(line2,"missing argument");
-		itct=strmathsscanf(line2,"%mlg|L %mlg|L",Varnames,Varvalues,Nvar,&low[d],&high[d]);
+		itct=strmathsscanf(line2,"%mlg|L %mlg|L",sim->varnames,sim->varvalues,sim->nvar,&low[d],&high[d]);
 		SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"read failure. %s",ErrString);
 		line2=strnword(line2,3); }
 	er=scmdgetfptr(sim->cmds,line2,3,&fptr,&dataid);
@@ -1057,8 +1052,8 @@ enum CMDcode cmdmolcountincmpt(simptr sim,cmdptr cmd,char *line2) {
 	compartssptr cmptss;
 	int itct,c,i,nspecies,er,dataid;
 	moleculeptr mptr;
-	static compartptr cmpt=NULL;
-	static int inscan=0,*ct;
+	static THREADLOCAL compartptr cmpt=NULL;
+	static THREADLOCAL int inscan=0,*ct;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -1114,8 +1109,8 @@ enum CMDcode cmdmolcountincmpts(simptr sim,cmdptr cmd,char *line2) {
 	compartssptr cmptss;
 	int itct,c,i,ic,er,dataid;
 	moleculeptr mptr;
-	static int inscan=0,*ct,ncmpt,nspecies;
-	static compartptr cmptlist[16];
+	static THREADLOCAL int inscan=0,*ct,ncmpt,nspecies;
+	static THREADLOCAL compartptr cmptlist[16];
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -1178,8 +1173,8 @@ enum CMDcode cmdmolcountincmpt2(simptr sim,cmdptr cmd,char *line2) {
 	int itct,c,i,nspecies,er,dataid;
 	moleculeptr mptr;
 	enum MolecState ms;
-	static compartptr cmpt;
-	static int inscan=0,*ct;
+	static THREADLOCAL compartptr cmpt;
+	static THREADLOCAL int inscan=0,*ct;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -1238,8 +1233,8 @@ enum CMDcode cmdmolcountonsurf(simptr sim,cmdptr cmd,char *line2) {
 	surfacessptr srfss;
 	int itct,s,i,nspecies,er,dataid;
 	moleculeptr mptr;
-	static int inscan=0,*ct;
-	static surfaceptr srf;
+	static THREADLOCAL int inscan=0,*ct;
+	static THREADLOCAL surfaceptr srf;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -1296,8 +1291,8 @@ enum CMDcode cmdmolcountspace(simptr sim,cmdptr cmd,char *line2) {
 	char axisstr[STRCHAR];
 	moleculeptr mptr;
 	latticeptr lat;
-	static double low[DIMMAX],high[DIMMAX],scale;
-	static int inscan=0,nbin,*ct,axis;
+	static THREADLOCAL double low[DIMMAX],high[DIMMAX],scale;
+	static THREADLOCAL int inscan=0,nbin,*ct,axis;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -1322,7 +1317,7 @@ enum CMDcode cmdmolcountspace(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(axis>=0 && axis<dim,"illegal axis value");
 	line2=strnword(line2,2);
 	SCMDCHECK(line2,"missing arguments");
-	itct=strmathsscanf(line2,"%mlg|L %mlg|L %mi",Varnames,Varvalues,Nvar,&low[axis],&high[axis],&nbin);
+	itct=strmathsscanf(line2,"%mlg|L %mlg|L %mi",sim->varnames,sim->varvalues,sim->nvar,&low[axis],&high[axis],&nbin);
 	SCMDCHECK(itct==3 && !strmatherror(ErrString,1),"cannot read arguments: low high bins. %s",ErrString);
 	SCMDCHECK(low[axis]<high[axis],"low value needs to be less than high value");
 	SCMDCHECK(nbin>0,"bins value needs to be > 0");
@@ -1331,13 +1326,13 @@ enum CMDcode cmdmolcountspace(simptr sim,cmdptr cmd,char *line2) {
 	for(d=0;d<dim-1;d++) {
 		if(ax2==axis) ax2++;
 		SCMDCHECK(line2,"missing position arguments");
-		itct=strmathsscanf(line2,"%mlg|L %mlg|L",Varnames,Varvalues,Nvar,&low[ax2],&high[ax2]);
+		itct=strmathsscanf(line2,"%mlg|L %mlg|L",sim->varnames,sim->varvalues,sim->nvar,&low[ax2],&high[ax2]);
 		SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"cannot read (or insufficient) position arguments. %s",ErrString);
 		SCMDCHECK(low[ax2]<=high[ax2],"low value needs to be less than or equal to high value");
 		line2=strnword(line2,3);
 		ax2++; }
 	SCMDCHECK(line2,"missing arguments");
-	itct=strmathsscanf(line2,"%mi",Varnames,Varvalues,Nvar,&average);
+	itct=strmathsscanf(line2,"%mi",sim->varnames,sim->varvalues,sim->nvar,&average);
 	SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"cannot read average number. %s",ErrString);
 	SCMDCHECK(average>=0,"illegal average value");
 	line2=strnword(line2,2);
@@ -1376,8 +1371,11 @@ enum CMDcode cmdmolcountspace(simptr sim,cmdptr cmd,char *line2) {
 						NSV_CALL(nsv_molcountspace(lat->nsv,index[PDMAX+j],low,high,dim,nbin,axis,ctlat));
 						for(bin=0;bin<nbin;++bin)
 							ct[bin]+=ctlat[bin]; }}
-				else if(lat->type==LATTICEpde) {			//not implemented
-					}}}}
+				else if(lat->type==LATTICEpde) {
+					for(j=0;j<index[PDnresults];j++) {
+						NSV_CALL(nsv_molcountspace(lat->pde,index[PDMAX+j],low,high,dim,nbin,axis,ctlat));
+						for(bin=0;bin<nbin;++bin)
+							ct[bin]+=ctlat[bin]; }}}}}
 
 	if(average<=1) {
 		scmdfprintf(cmd->cmds,fptr,"%g",sim->time);
@@ -1414,8 +1412,8 @@ enum CMDcode cmdmolcountspace2d(simptr sim,cmdptr cmd,char *line2) {
 	char axisstr[STRCHAR];
 	moleculeptr mptr;
 
-	static double low[DIMMAX],high[DIMMAX],scale1,scale2;
-	static int inscan=0,nbin1,nbin2,*ct,axis,axis1,axis2;
+	static THREADLOCAL double low[DIMMAX],high[DIMMAX],scale1,scale2;
+	static THREADLOCAL int inscan=0,nbin1,nbin2,*ct,axis,axis1,axis2;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -1444,7 +1442,7 @@ enum CMDcode cmdmolcountspace2d(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(line2,"missing arguments");
 	curaxis=0;
 	if(curaxis==axis) curaxis++;									// first parallel axis
-	itct=strmathsscanf(line2,"%mlg|L %mlg|L %mi",Varnames,Varvalues,Nvar,&low[curaxis],&high[curaxis],&nbin1);
+	itct=strmathsscanf(line2,"%mlg|L %mlg|L %mi",sim->varnames,sim->varvalues,sim->nvar,&low[curaxis],&high[curaxis],&nbin1);
 	SCMDCHECK(itct==3 && !strmatherror(ErrString,1),"cannot read arguments: low high bins. %s",ErrString);
 	SCMDCHECK(low[curaxis]<high[curaxis],"low value needs to be less than high value");
 	SCMDCHECK(nbin1>0,"bins value needs to be > 0");
@@ -1454,7 +1452,7 @@ enum CMDcode cmdmolcountspace2d(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(line2,"missing arguments");
 	curaxis++;
 	if(curaxis==axis) curaxis++;									// second parallel axis
-	itct=strmathsscanf(line2,"%mlg|L %mlg|L %mi",Varnames,Varvalues,Nvar,&low[curaxis],&high[curaxis],&nbin2);
+	itct=strmathsscanf(line2,"%mlg|L %mlg|L %mi",sim->varnames,sim->varvalues,sim->nvar,&low[curaxis],&high[curaxis],&nbin2);
 	SCMDCHECK(itct==3 && !strmatherror(ErrString,1),"cannot read arguments: low high bins. %s",ErrString);
 	SCMDCHECK(low[curaxis]<high[curaxis],"low value needs to be less than high value");
 	SCMDCHECK(nbin2>0,"bins value needs to be > 0");
@@ -1463,13 +1461,13 @@ enum CMDcode cmdmolcountspace2d(simptr sim,cmdptr cmd,char *line2) {
 
 	if(dim==3) {
 		curaxis=axis;																// perpendicular axis
-		itct=strmathsscanf(line2,"%mlg|L %mlg|L",Varnames,Varvalues,Nvar,&low[curaxis],&high[curaxis]);
+		itct=strmathsscanf(line2,"%mlg|L %mlg|L",sim->varnames,sim->varvalues,sim->nvar,&low[curaxis],&high[curaxis]);
 		SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"cannot read (or insufficient) position arguments. %s",ErrString);
 		SCMDCHECK(low[curaxis]<=high[curaxis],"low value needs to be less than or equal to high value");
 		line2=strnword(line2,3); }
 
 	SCMDCHECK(line2,"missing arguments");					// average
-	itct=strmathsscanf(line2,"%mi",Varnames,Varvalues,Nvar,&average);
+	itct=strmathsscanf(line2,"%mi",sim->varnames,sim->varvalues,sim->nvar,&average);
 	SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"cannot read average number. %s",ErrString);
 	SCMDCHECK(average>=0,"illegal average value");
 	line2=strnword(line2,2);
@@ -1537,8 +1535,8 @@ enum CMDcode cmdmolcountspaceradial(simptr sim,cmdptr cmd,char *line2) {
 	enum MolecState ms;
 	double radius,molrad;
 	moleculeptr mptr;
-	static double center[DIMMAX],scale,radius2;
-	static int inscan=0,nbin,*ct;
+	static THREADLOCAL double center[DIMMAX],scale,radius2;
+	static THREADLOCAL int inscan=0,nbin,*ct;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -1554,17 +1552,17 @@ enum CMDcode cmdmolcountspaceradial(simptr sim,cmdptr cmd,char *line2) {
 	line2=strnword(line2,2);
 	SCMDCHECK(line2,"missing arguments");
 	for(d=0;d<sim->dim;d++) {
-		itct=strmathsscanf(line2,"%mlg|L",Varnames,Varvalues,Nvar,&center[d]);
+		itct=strmathsscanf(line2,"%mlg|L",sim->varnames,sim->varvalues,sim->nvar,&center[d]);
 		SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"missing center value. %s",ErrString);
 		line2=strnword(line2,2);
 		SCMDCHECK(line2,"missing arguments"); }
-	itct=strmathsscanf(line2,"%mlg|L %mi",Varnames,Varvalues,Nvar,&radius,&nbin);
+	itct=strmathsscanf(line2,"%mlg|L %mi",sim->varnames,sim->varvalues,sim->nvar,&radius,&nbin);
 	SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"cannot read arguments: radius bins. %s",ErrString);
 	SCMDCHECK(radius>0,"radius needs to be greater than 0");
 	SCMDCHECK(nbin>0,"bins value needs to be > 0");
 	line2=strnword(line2,3);
 	SCMDCHECK(line2,"missing arguments");
-	itct=strmathsscanf(line2,"%mi",Varnames,Varvalues,Nvar,&average);
+	itct=strmathsscanf(line2,"%mi",sim->varnames,sim->varvalues,sim->nvar,&average);
 	SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"cannot read average number. %s",ErrString);
 	SCMDCHECK(average>=0,"illegal average value");
 	line2=strnword(line2,2);
@@ -1627,8 +1625,8 @@ enum CMDcode cmdmolcountspacepolarangle(simptr sim,cmdptr cmd,char *line2) {
 	enum MolecState ms;
 	double radiusmin,radiusmax,molrad,poleleninv,angle;
 	moleculeptr mptr;
-	static double center[DIMMAX],pole[DIMMAX],poleangle,scale,radiusmin2,radiusmax2;
-	static int inscan=0,nbin,*ct;
+	static THREADLOCAL double center[DIMMAX],pole[DIMMAX],poleangle,scale,radiusmin2,radiusmax2;
+	static THREADLOCAL int inscan=0,nbin,*ct;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -1644,21 +1642,21 @@ enum CMDcode cmdmolcountspacepolarangle(simptr sim,cmdptr cmd,char *line2) {
 	line2=strnword(line2,2);
 	SCMDCHECK(line2,"missing arguments");
 	for(d=0;d<sim->dim;d++) {
-		itct=strmathsscanf(line2,"%mlg|L",Varnames,Varvalues,Nvar,&center[d]);
+		itct=strmathsscanf(line2,"%mlg|L",sim->varnames,sim->varvalues,sim->nvar,&center[d]);
 		SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"missing center value. %s",ErrString);
 		line2=strnword(line2,2);
 		SCMDCHECK(line2,"missing arguments"); }
 	for(d=0;d<sim->dim;d++) {
-		itct=strmathsscanf(line2,"%mlg|L",Varnames,Varvalues,Nvar,&pole[d]);
+		itct=strmathsscanf(line2,"%mlg|L",sim->varnames,sim->varvalues,sim->nvar,&pole[d]);
 		SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"missing pole value. %s",ErrString);
 		line2=strnword(line2,2);
 		SCMDCHECK(line2,"missing arguments"); }
-	itct=strmathsscanf(line2,"%mlg|L %mlg|L %mi",Varnames,Varvalues,Nvar,&radiusmin,&radiusmax,&nbin);
+	itct=strmathsscanf(line2,"%mlg|L %mlg|L %mi",sim->varnames,sim->varvalues,sim->nvar,&radiusmin,&radiusmax,&nbin);
 	SCMDCHECK(itct==3 && !strmatherror(ErrString,1),"cannot read arguments: radius_min radius_max bins. %s",ErrString);
 	SCMDCHECK(nbin>0,"bins value needs to be > 0");
 	line2=strnword(line2,4);
 	SCMDCHECK(line2,"missing arguments");
-	itct=strmathsscanf(line2,"%mi",Varnames,Varvalues,Nvar,&average);
+	itct=strmathsscanf(line2,"%mi",sim->varnames,sim->varvalues,sim->nvar,&average);
 	SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"cannot read average number. %s",ErrString);
 	SCMDCHECK(average>=0,"illegal average value");
 	line2=strnword(line2,2);
@@ -1740,9 +1738,9 @@ enum CMDcode cmdradialdistribution(simptr sim,cmdptr cmd,char *line2) {
 	moleculeptr mptr,mptr2;
 	boxptr bptr;
 	double dist,scale2,rdf;
-	static double scale,radius,syswidth[DIMMAX];
-	static int inscan=0,nbin,*ct,i2,*index2,lllo,llhi,mcount;
-	static enum MolecState ms2;
+	static THREADLOCAL double scale,radius,syswidth[DIMMAX];
+	static THREADLOCAL int inscan=0,nbin,*ct,i2,*index2,lllo,llhi,mcount;
+	static THREADLOCAL enum MolecState ms2;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -1765,7 +1763,7 @@ enum CMDcode cmdradialdistribution(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(i2!=-7,"error allocating memory");
 	line2=strnword(line2,2);
 	SCMDCHECK(line2,"missing arguments");
-	itct=strmathsscanf(line2,"%mlg|L %mi %mi",Varnames,Varvalues,Nvar,&radius,&nbin,&average);
+	itct=strmathsscanf(line2,"%mlg|L %mi %mi",sim->varnames,sim->varvalues,sim->nvar,&radius,&nbin,&average);
 	SCMDCHECK(itct==3 && !strmatherror(ErrString,1),"cannot read arguments: radius bins average. %s",ErrString);
 	SCMDCHECK(radius>0,"radius needs to be greater than 0");
 	SCMDCHECK(nbin>0,"bins value needs to be > 0");
@@ -1854,9 +1852,9 @@ enum CMDcode cmdradialdistribution2(simptr sim,cmdptr cmd,char *line2) {
 	moleculeptr mptr,mptr2;
 	boxptr bptr;
 	double dist,scale2,rdf;
-	static double scale,radius,syswidth[DIMMAX],lowpos[DIMMAX],highpos[DIMMAX];
-	static int inscan=0,nbin,*ct,i2,*index2,lllo,llhi,mcount;
-	static enum MolecState ms2;
+	static THREADLOCAL double scale,radius,syswidth[DIMMAX],lowpos[DIMMAX],highpos[DIMMAX];
+	static THREADLOCAL int inscan=0,nbin,*ct,i2,*index2,lllo,llhi,mcount;
+	static THREADLOCAL enum MolecState ms2;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -1880,12 +1878,12 @@ enum CMDcode cmdradialdistribution2(simptr sim,cmdptr cmd,char *line2) {
 	line2=strnword(line2,2);
 	SCMDCHECK(line2,"missing arguments");
 	for(d=0;d<sim->dim;d++) {
-		itct=strmathsscanf(line2,"%mlg|L %mlg|L",Varnames,Varvalues,Nvar,&lowpos[d],&highpos[d]);
+		itct=strmathsscanf(line2,"%mlg|L %mlg|L",sim->varnames,sim->varvalues,sim->nvar,&lowpos[d],&highpos[d]);
 		SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"missing arguments. %s",ErrString);
 		SCMDCHECK(lowpos[d]<=highpos[d],"low position value needs to be <= high position value");
 		line2=strnword(line2,3);
 		SCMDCHECK(line2,"missing arguments"); }
-	itct=strmathsscanf(line2,"%mlg|L %mi %mi",Varnames,Varvalues,Nvar,&radius,&nbin,&average);
+	itct=strmathsscanf(line2,"%mlg|L %mi %mi",sim->varnames,sim->varvalues,sim->nvar,&radius,&nbin,&average);
 	SCMDCHECK(itct==3 && !strmatherror(ErrString,1),"cannot read arguments: radius bins average. %s",ErrString);
 	SCMDCHECK(radius>0,"radius needs to be greater than 0");
 	SCMDCHECK(nbin>0,"bins value needs to be > 0");
@@ -2045,9 +2043,9 @@ enum CMDcode cmdlistmols(simptr sim,cmdptr cmd,char *line2) {
 	int d,er;
 	char string[STRCHAR];
 	moleculeptr mptr;
-	static FILE *fptr;
-	static int inscan=0;
-	static int dataid=-1;
+	static THREADLOCAL FILE *fptr;
+	static THREADLOCAL int inscan=0;
+	static THREADLOCAL int dataid=-1;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -2079,8 +2077,8 @@ enum CMDcode cmdlistmols(simptr sim,cmdptr cmd,char *line2) {
 enum CMDcode cmdlistmols2(simptr sim,cmdptr cmd,char *line2) {
 	int d,er;
 	moleculeptr mptr;
-	static FILE *fptr;
-	static int inscan=0,invk,dataid=-1;
+	static THREADLOCAL FILE *fptr;
+	static THREADLOCAL int inscan=0,invk,dataid=-1;
 	char string[STRCHAR];
 
 	if(inscan) goto scanportion;
@@ -2115,8 +2113,8 @@ enum CMDcode cmdlistmols3(simptr sim,cmdptr cmd,char *line2) {
 	int i,*index,d,er;
 	moleculeptr mptr;
 	enum MolecState ms;
-	static FILE *fptr;
-	static int inscan=0,invk,dataid=-1;
+	static THREADLOCAL FILE *fptr;
+	static THREADLOCAL int inscan=0,invk,dataid=-1;
 	char string[STRCHAR];
 
 	if(inscan) goto scanportion;
@@ -2158,8 +2156,8 @@ enum CMDcode cmdlistmols4(simptr sim,cmdptr cmd,char *line2) {
 	int i,d,*index,er;
 	moleculeptr mptr;
 	enum MolecState ms;
-	static FILE *fptr;
-	static int inscan=0,invk,dataid=-1;
+	static THREADLOCAL FILE *fptr;
+	static THREADLOCAL int inscan=0,invk,dataid=-1;
 	char string[STRCHAR];
 
 	if(inscan) goto scanportion;
@@ -2203,9 +2201,9 @@ enum CMDcode cmdlistmolscmpt(simptr sim,cmdptr cmd,char *line2) {
 	enum MolecState ms;
 	char cname[STRCHAR],string[STRCHAR];
 	compartssptr cmptss;
-	static FILE *fptr;
-	static compartptr cmpt;
-	static int inscan=0,invk,dataid=-1;
+	static THREADLOCAL FILE *fptr;
+	static THREADLOCAL compartptr cmpt;
+	static THREADLOCAL int inscan=0,invk,dataid=-1;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -2258,9 +2256,9 @@ enum CMDcode cmdlistmolssurf(simptr sim,cmdptr cmd,char *line2) {
 	enum MolecState ms;
 	char sname[STRCHAR],string[STRCHAR];
 	surfacessptr srfss;
-	static FILE *fptr;
-	static surfaceptr srf;
-	static int inscan=0,invk,dataid=-1;
+	static THREADLOCAL FILE *fptr;
+	static THREADLOCAL surfaceptr srf;
+	static THREADLOCAL int inscan=0,invk,dataid=-1;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -2316,8 +2314,8 @@ enum CMDcode cmdmolpos(simptr sim,cmdptr cmd,char *line2) {
 	int i,d,*index,er;
 	moleculeptr mptr;
 	enum MolecState ms;
-	static FILE *fptr;
-	static int inscan=0,dataid=-1;
+	static THREADLOCAL FILE *fptr;
+	static THREADLOCAL int inscan=0,dataid=-1;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -2356,9 +2354,9 @@ enum CMDcode cmdtrackmol(simptr sim,cmdptr cmd,char *line2) {
 	int itct,d,c,er;
 	moleculeptr mptr;
 	char string[STRCHAR];
-	static FILE *fptr;
-	static unsigned long long serno;
-	static int inscan=0,dataid=-1;
+	static THREADLOCAL FILE *fptr;
+	static THREADLOCAL unsigned long long serno;
+	static THREADLOCAL int inscan=0,dataid=-1;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -2407,8 +2405,8 @@ enum CMDcode cmdmolmoments(simptr sim,cmdptr cmd,char *line2) {
 	FILE *fptr;
 	moleculeptr mptr;
 	enum MolecState ms;
-	static double v1[DIMMAX],m1[DIMMAX*DIMMAX];
-	static int inscan=0,ctr;
+	static THREADLOCAL double v1[DIMMAX],m1[DIMMAX*DIMMAX];
+	static THREADLOCAL int inscan=0,ctr;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -2510,8 +2508,8 @@ void cmdmeansqrdispfree(cmdptr cmd) {
 	long int *v1;
 	enum MolecState ms;
 	moleculeptr mptr;
-	static double sum,sum4;
-	static int inscan=0,ctr,msddim;
+	static THREADLOCAL double sum,sum4;
+	static THREADLOCAL int inscan=0,ctr,msddim;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -2617,8 +2615,8 @@ enum CMDcode cmdmeansqrdisp2(simptr sim,cmdptr cmd,char *line2) {
 	long int *v1;
 	enum MolecState ms;
 	char reportchar;
-	static char startchar;
-	static int inscan=0,maxmol,ctr;
+	static THREADLOCAL char startchar;
+	static THREADLOCAL int inscan=0,maxmol,ctr;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -2641,7 +2639,7 @@ enum CMDcode cmdmeansqrdisp2(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(msddim<sim->dim,"invalid dimension value");
 	line2=strnword(line2,2);
 	SCMDCHECK(line2,"insufficient arguments");
-	itct=strmathsscanf(line2,"%c %c %mi %mi",Varnames,Varvalues,Nvar,&startchar,&reportchar,&maxmol,&maxmoment);
+	itct=strmathsscanf(line2,"%c %c %mi %mi",sim->varnames,sim->varvalues,sim->nvar,&startchar,&reportchar,&maxmol,&maxmoment);
 	SCMDCHECK(itct==4 && !strmatherror(ErrString,1),"cannot read start, report, max_mol, or max_moment information. %s",ErrString);
 	SCMDCHECK(maxmol>0,"max_mol has to be at least 1");
 	SCMDCHECK(maxmoment>0,"maxmoment has to be at least 1");
@@ -2773,8 +2771,8 @@ enum CMDcode cmdmeansqrdisp3(simptr sim,cmdptr cmd,char *line2) {
 	long int *v1;
 	enum MolecState ms;
 	char reportchar;
-	static char startchar;
-	static int inscan=0,ctr,maxmol;
+	static THREADLOCAL char startchar;
+	static THREADLOCAL int inscan=0,ctr,maxmol;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -2797,7 +2795,7 @@ enum CMDcode cmdmeansqrdisp3(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(msddim<sim->dim,"invalid dimension value");
 	line2=strnword(line2,2);
 	SCMDCHECK(line2,"insufficient arguments");
-	itct=strmathsscanf(line2,"%c %c %i %mlg|",Varnames,Varvalues,Nvar,&startchar,&reportchar,&maxmol,&change);
+	itct=strmathsscanf(line2,"%c %c %i %mlg|",sim->varnames,sim->varvalues,sim->nvar,&startchar,&reportchar,&maxmol,&change);
 	SCMDCHECK(itct==4 && !strmatherror(ErrString,1),"cannot read start, report, max_mol, or change information. %s",ErrString);
 	SCMDCHECK(maxmol>0,"max_mol has to be at least 1");
 	line2=strnword(line2,5);
@@ -2933,8 +2931,8 @@ enum CMDcode cmdresidencetime(simptr sim,cmdptr cmd,char *line2) {
 	long int *v1;
 	enum MolecState ms;
 	char reportchar;
-	static char startchar;
-	static int inscan=0,ctr,maxmol;
+	static THREADLOCAL char startchar;
+	static THREADLOCAL int inscan=0,ctr,maxmol;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -2947,7 +2945,7 @@ enum CMDcode cmdresidencetime(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(i!=-7,"error allocating memory");
 	line2=strnword(line2,2);
 	SCMDCHECK(line2,"insufficient arguments");
-	itct=strmathsscanf(line2,"%c %c %mi %mi %mi",Varnames,Varvalues,Nvar,&startchar,&reportchar,&summaryout,&listout,&maxmol);
+	itct=strmathsscanf(line2,"%c %c %mi %mi %mi",sim->varnames,sim->varvalues,sim->nvar,&startchar,&reportchar,&summaryout,&listout,&maxmol);
 	SCMDCHECK(itct==5 && !strmatherror(ErrString,1),"cannot read start, report, summary_out, list_out, or max_mol information. %s",ErrString);
 	SCMDCHECK(maxmol>0,"max_mol has to be at least 1");
 	line2=strnword(line2,6);
@@ -3052,7 +3050,7 @@ enum CMDcode cmdresidencetime(simptr sim,cmdptr cmd,char *line2) {
 /* cmddiagnostics */
 enum CMDcode cmddiagnostics(simptr sim,cmdptr cmd,char *line2) {
 	int itct,order;
-	static char nm[STRCHAR];
+	static THREADLOCAL char nm[STRCHAR];
 	enum SmolStruct ss;
 
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -3108,7 +3106,7 @@ enum CMDcode cmdprintLattice(simptr sim,cmdptr cmd,char *line2) {
 	for(i=0;i<n;++i) {
 		lattice=sim->latticess->latticelist[i];
 		scmdfprintf(cmd->cmds,fptr,"Lattice %d: %s:\n",i,lattice->latticename);
-		NSV_CALL(nsv_print(lattice->nsv,&buffer));
+		NSV_CALL(nsv_print(lattice->type==LATTICEpde?lattice->pde:lattice->nsv,&buffer));
 		scmdfprintf(cmd->cmds,fptr,"%s",buffer?buffer:"Error");
 		buffer=NULL; }
 	scmdflush(fptr);
@@ -3187,8 +3185,8 @@ enum CMDcode cmdwriteVTK(simptr sim,cmdptr cmd,char *line2) {
 	char nm[STRCHAR];
 	moleculeptr mptr;
 	int itct;
-	static vtkUnstructuredGrid* grid;
-	static int inscan=0;
+	static THREADLOCAL vtkUnstructuredGrid* grid;
+	static THREADLOCAL int inscan=0;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
@@ -3207,7 +3205,7 @@ enum CMDcode cmdwriteVTK(simptr sim,cmdptr cmd,char *line2) {
 	vtkDeleteGrid(grid);
 
 #ifdef OPTION_NSV
-	static char nm2[STRCHAR];
+	static THREADLOCAL char nm2[STRCHAR];
 	latticeptr lattice;
 	int ll;
 
@@ -3220,7 +3218,7 @@ enum CMDcode cmdwriteVTK(simptr sim,cmdptr cmd,char *line2) {
           if (lattice->nsv) vtkWriteGrid(nm,nm2,cmd->invoke,nsv_get_grid(lattice->nsv));
           break;
         case LATTICEpde:
-          //not implemented
+          if (lattice->pde) vtkWriteGrid(nm,nm2,cmd->invoke,nsv_get_grid(lattice->pde));
           break;
         case LATTICEnone:
         break; }}}
@@ -3306,16 +3304,16 @@ enum CMDcode cmdpointsource(simptr sim,cmdptr cmd,char *line2) {
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
 	SCMDCHECK(line2,"missing argument");
 	SCMDCHECK(sim->mols,"molecules are undefined");
-	itct=strmathsscanf(line2,"%s %mi",Varnames,Varvalues,Nvar,nm,&num);
+	itct=strmathsscanf(line2,"%s %mi",sim->varnames,sim->varvalues,sim->nvar,nm,&num);
 	SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"read failure. %s",ErrString);
 	SCMDCHECK(num>=0,"number cannot be negative");
-	i=stringfind(sim->mols->spname,sim->mols->nspecies,nm);
+	i=molfindspecies(sim->mols,nm);
 	SCMDCHECK(i>=1,"name not recognized");
 	line2=strnword(line2,3);
 	SCMDCHECK(line2,"missing location");
-	if(sim->dim==1) itct=strmathsscanf(line2,"%mlg|L",Varnames,Varvalues,Nvar,&pos[0]);
-	else if(sim->dim==2) itct=strmathsscanf(line2,"%mlg|L %mlg|L",Varnames,Varvalues,Nvar,&pos[0],&pos[1]);
-	else itct=strmathsscanf(line2,"%mlg|L %mlg|L %mlg|L",Varnames,Varvalues,Nvar,&pos[0],&pos[1],&pos[2]);
+	if(sim->dim==1) itct=strmathsscanf(line2,"%mlg|L",sim->varnames,sim->varvalues,sim->nvar,&pos[0]);
+	else if(sim->dim==2) itct=strmathsscanf(line2,"%mlg|L %mlg|L",sim->varnames,sim->varvalues,sim->nvar,&pos[0],&pos[1]);
+	else itct=strmathsscanf(line2,"%mlg|L %mlg|L %mlg|L",sim->varnames,sim->varvalues,sim->nvar,&pos[0],&pos[1],&pos[2]);
 	SCMDCHECK(itct==sim->dim && !strmatherror(ErrString,1),"insufficient location dimensions. %s",ErrString);
 	SCMDCHECK(addmol(sim,num,i,pos,pos,1)==0,"not enough available molecules");
 	return CMDok; }
@@ -3330,18 +3328,18 @@ enum CMDcode cmdvolumesource(simptr sim,cmdptr cmd,char *line2) {
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
 	SCMDCHECK(line2,"missing argument");
 	SCMDCHECK(sim->mols,"molecules are undefined");
-	itct=strmathsscanf(line2,"%s %mlg|",Varnames,Varvalues,Nvar,nm,&numdbl);
+	itct=strmathsscanf(line2,"%s %mlg|",sim->varnames,sim->varvalues,sim->nvar,nm,&numdbl);
 	SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"read failure. %s",ErrString);
 	SCMDCHECK(numdbl>=0,"number cannot be negative");
 	num=(int) numdbl;
 	if(num!=numdbl) num=poisrandD(numdbl);
-	i=stringfind(sim->mols->spname,sim->mols->nspecies,nm);
+	i=molfindspecies(sim->mols,nm);
 	SCMDCHECK(i>=1,"name not recognized");
 	line2=strnword(line2,3);
 	SCMDCHECK(line2,"missing location");
 	for(d=0;d<sim->dim;d++) {
 		SCMDCHECK(line2,"missing argument");
-		itct=strmathsscanf(line2,"%mlg|L %mlg|L",Varnames,Varvalues,Nvar,&poslo[d],&poshi[d]);
+		itct=strmathsscanf(line2,"%mlg|L %mlg|L",sim->varnames,sim->varvalues,sim->nvar,&poslo[d],&poshi[d]);
 		SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"read failure. %s",ErrString);
 		line2=strnword(line2,3); }
 	SCMDCHECK(addmol(sim,num,i,poslo,poshi,1)==0,"not enough available molecules");
@@ -3359,18 +3357,18 @@ enum CMDcode cmdgaussiansource(simptr sim,cmdptr cmd,char *line2) {
 	dim=sim->dim;
 	SCMDCHECK(line2,"missing argument");
 	SCMDCHECK(sim->mols,"molecules are undefined");
-	itct=strmathsscanf(line2,"%s %mlg|",Varnames,Varvalues,Nvar,nm,&numdbl);
+	itct=strmathsscanf(line2,"%s %mlg|",sim->varnames,sim->varvalues,sim->nvar,nm,&numdbl);
 	SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"read failure. %s",ErrString);
 	SCMDCHECK(numdbl>=0,"number cannot be negative");
 	num=(int) numdbl;
 	if(num!=numdbl) num=poisrandD(numdbl);
-	i=stringfind(sim->mols->spname,sim->mols->nspecies,nm);
+	i=molfindspecies(sim->mols,nm);
 	SCMDCHECK(i>=1,"name not recognized");
 	line2=strnword(line2,3);
 	SCMDCHECK(line2,"missing location");
 	for(d=0;d<dim;d++) {
 		SCMDCHECK(line2,"missing argument");
-		itct=strmathsscanf(line2,"%mlg|L %mlg|L",Varnames,Varvalues,Nvar,&mean[d],&sigma[d]);
+		itct=strmathsscanf(line2,"%mlg|L %mlg|L",sim->varnames,sim->varvalues,sim->nvar,&mean[d],&sigma[d]);
 		SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"read failure. %s",ErrString);
 		line2=strnword(line2,3); }
 
@@ -3391,12 +3389,12 @@ enum CMDcode cmdmovesurfacemol(simptr sim,cmdptr cmd,char *line2) {
 	enum MolecState ms1;
 	moleculeptr mptr;
 	double pos[DIMMAX];
-	static panelptr pnl2;
-	static enum MolecState ms2;
-	static surfaceptr srf,srf2;
-	static double prob;
-	static enum PanelShape ps1,ps2;
-	static int inscan=0,p1,p2;
+	static THREADLOCAL panelptr pnl2;
+	static THREADLOCAL enum MolecState ms2;
+	static THREADLOCAL surfaceptr srf,srf2;
+	static THREADLOCAL double prob;
+	static THREADLOCAL enum PanelShape ps1,ps2;
+	static THREADLOCAL int inscan=0,p1,p2;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
@@ -3404,7 +3402,7 @@ enum CMDcode cmdmovesurfacemol(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(line2,"missing arguments");
 	SCMDCHECK(sim->mols,"molecules are undefined");
 	SCMDCHECK(sim->srfss,"surfaces are undefined");
-	itct=strmathsscanf(line2,"%s %mlg|",Varnames,Varvalues,Nvar,nm,&prob);
+	itct=strmathsscanf(line2,"%s %mlg|",sim->varnames,sim->varvalues,sim->nvar,nm,&prob);
 	SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"failed to read molecule name or probability. %s",ErrString);
 
 	i=molstring2index1(sim,line2,&ms1,&index);
@@ -3465,7 +3463,7 @@ enum CMDcode cmdkillmol(simptr sim,cmdptr cmd,char *line2) {
 	int i,*index;
 	moleculeptr mptr;
 	enum MolecState ms;
-	static int inscan=0;
+	static THREADLOCAL int inscan=0;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
@@ -3494,10 +3492,10 @@ enum CMDcode cmdkillmolprob(simptr sim,cmdptr cmd,char *line2) {
 	int itct,i,*index;
 	moleculeptr mptr;
 	enum MolecState ms;
-	static double prob;
-	static char probstr[STRCHAR];
-	static int xyzvar;
-	static int inscan=0;
+	static THREADLOCAL double prob;
+	static THREADLOCAL char probstr[STRCHAR];
+	static THREADLOCAL int xyzvar;
+	static THREADLOCAL int inscan=0;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
@@ -3515,7 +3513,7 @@ enum CMDcode cmdkillmolprob(simptr sim,cmdptr cmd,char *line2) {
 		strcpy(probstr,line2); }
 	else {
 		xyzvar=0;
-		itct=strmathsscanf(line2,"%mlg|",Varnames,Varvalues,Nvar,&prob);
+		itct=strmathsscanf(line2,"%mlg|",sim->varnames,sim->varvalues,sim->nvar,&prob);
 		SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"killmolprob format: name[(state)] probability. %s",ErrString);
 		SCMDCHECK(prob>=0 && prob<=1,"probability needs to be between 0 and 1"); }
 
@@ -3532,7 +3530,7 @@ enum CMDcode cmdkillmolprob(simptr sim,cmdptr cmd,char *line2) {
 		simsetvariable(sim,"x",mptr->pos[0]);
 		if(sim->dim>1) simsetvariable(sim,"y",mptr->pos[1]);
 		if(sim->dim>2) simsetvariable(sim,"z",mptr->pos[2]);
-		strmathsscanf(probstr,"%mlg|",Varnames,Varvalues,Nvar,&prob); }
+		strmathsscanf(probstr,"%mlg|",sim->varnames,sim->varvalues,sim->nvar,&prob); }
 	if(coinrandD(prob)) molkill(sim,mptr,mptr->list,-1);
 	return CMDok; }
 
@@ -3542,8 +3540,8 @@ enum CMDcode cmdkillmolinsphere(simptr sim,cmdptr cmd,char *line2) {
 	int itct,i,*index;
 	char nm[STRCHAR];
 	moleculeptr mptr;
-	static enum MolecState ms;
-	static int inscan=0,s;
+	static THREADLOCAL enum MolecState ms;
+	static THREADLOCAL int inscan=0,s;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
@@ -3584,8 +3582,8 @@ enum CMDcode cmdkillmolincmpt(simptr sim,cmdptr cmd,char *line2) {
 	moleculeptr mptr;
 	enum MolecState ms;
 	compartssptr cmptss;
-	static compartptr cmpt;
-	static int inscan=0;
+	static THREADLOCAL compartptr cmpt;
+	static THREADLOCAL int inscan=0;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
@@ -3625,7 +3623,7 @@ enum CMDcode cmdkillmoloutsidesystem(simptr sim,cmdptr cmd,char *line2) {
 	int i,*index;
 	moleculeptr mptr;
 	enum MolecState ms;
-	static int inscan=0;
+	static THREADLOCAL int inscan=0;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
@@ -3663,7 +3661,7 @@ enum CMDcode cmdfixmolcount(simptr sim,cmdptr cmd,char *line2) {
 	itct=sscanf(line2,"%s %i",nm,&num);
 	SCMDCHECK(itct==2,"read failure");
 	SCMDCHECK(num>=0,"number cannot be negative");
-	i=stringfind(sim->mols->spname,sim->mols->nspecies,nm);
+	i=molfindspecies(sim->mols,nm);
 	SCMDCHECK(i>=1,"name not recognized");
 
 	ll=sim->mols->listlookup[i][MSsoln];
@@ -3696,10 +3694,10 @@ enum CMDcode cmdfixmolcountrange(simptr sim,cmdptr cmd,char *line2) {
 
 	SCMDCHECK(line2,"missing argument");
 	SCMDCHECK(sim->mols,"molecules are undefined");
-	itct=strmathsscanf(line2,"%s %mi %mi",Varnames,Varvalues,Nvar,nm,&lownum,&highnum);
+	itct=strmathsscanf(line2,"%s %mi %mi",sim->varnames,sim->varvalues,sim->nvar,nm,&lownum,&highnum);
 	SCMDCHECK(itct==3 && !strmatherror(ErrString,1),"read failure. %s",ErrString);
 	SCMDCHECK(lownum>=0 && highnum>=0 && highnum>=lownum,"molecule numbers are out of bounds");
-	i=stringfind(sim->mols->spname,sim->mols->nspecies,nm);
+	i=molfindspecies(sim->mols,nm);
 	SCMDCHECK(i>=1,"species name not recognized");
 
 	ll=sim->mols->listlookup[i][MSsoln];
@@ -3742,7 +3740,7 @@ enum CMDcode cmdfixmolcountonsurf(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(ms!=MSsoln && ms!=MSbsoln,"molecule state needs to be surface-bound");
 	line2=strnword(line2,2);
 	SCMDCHECK(line2,"fixmolcountonsurf format: species(state) number surface");
-	itct=strmathsscanf(line2,"%mi %s",Varnames,Varvalues,Nvar,&num,nm);
+	itct=strmathsscanf(line2,"%mi %s",sim->varnames,sim->varvalues,sim->nvar,&num,nm);
 	SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"read failure. %s",ErrString);
 	SCMDCHECK(num>=0,"number cannot be negative");
 	SCMDCHECK(sim->srfss,"no surfaces defined");
@@ -3794,7 +3792,7 @@ enum CMDcode cmdfixmolcountrangeonsurf(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(ms!=MSsoln && ms!=MSbsoln,"molecule state needs to be surface-bound");
 	line2=strnword(line2,2);
 	SCMDCHECK(line2,"fixmolcountrangeonsurf format: species(state) low_number high_number surface");
-	itct=strmathsscanf(line2,"%mi %mi %s",Varnames,Varvalues,Nvar,&lownum,&highnum,nm);
+	itct=strmathsscanf(line2,"%mi %mi %s",sim->varnames,sim->varvalues,sim->nvar,&lownum,&highnum,nm);
 	SCMDCHECK(itct==3 && !strmatherror(ErrString,1),"read failure. %s",ErrString);
 	SCMDCHECK(lownum>=0 && highnum>=0 && highnum>=lownum,"molecule numbers are out of bounds");
 	SCMDCHECK(sim->srfss,"no surfaces defined");
@@ -3837,10 +3835,10 @@ enum CMDcode cmdfixmolcountincmpt(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(line2,"missing argument");
 	SCMDCHECK(sim->mols,"molecules are undefined");
 	SCMDCHECK(sim->cmptss,"compartments are undefined");
-	itct=strmathsscanf(line2,"%s %mi",Varnames,Varvalues,Nvar,nm,&num);
+	itct=strmathsscanf(line2,"%s %mi",sim->varnames,sim->varvalues,sim->nvar,nm,&num);
 	SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"read failure. %s",ErrString);
 	SCMDCHECK(num>=0,"number cannot be negative");
-	i=stringfind(sim->mols->spname,sim->mols->nspecies,nm);
+	i=molfindspecies(sim->mols,nm);
 	SCMDCHECK(i>=1,"molecule name not recognized");
 	line2=strnword(line2,3);
 	SCMDCHECK(line2,"compartment name missing");
@@ -3884,9 +3882,9 @@ enum CMDcode cmdfixmolcountrangeincmpt(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(line2,"missing argument");
 	SCMDCHECK(sim->mols,"molecules are undefined");
 	SCMDCHECK(sim->cmptss,"compartments are undefined");
-	itct=strmathsscanf(line2,"%s %mi %mi",Varnames,Varvalues,Nvar,nm,&lownum,&highnum);
+	itct=strmathsscanf(line2,"%s %mi %mi",sim->varnames,sim->varvalues,sim->nvar,nm,&lownum,&highnum);
 	SCMDCHECK(itct==3 && !strmatherror(ErrString,1),"read failure. %s",ErrString);
-	i=stringfind(sim->mols->spname,sim->mols->nspecies,nm);
+	i=molfindspecies(sim->mols,nm);
 	SCMDCHECK(i>=1,"molecule name not recognized");
 	line2=strnword(line2,4);
 	SCMDCHECK(line2,"compartment name missing");
@@ -3922,11 +3920,11 @@ enum CMDcode cmdfixmolcountrangeincmpt(simptr sim,cmdptr cmd,char *line2) {
 enum CMDcode cmdequilmol(simptr sim,cmdptr cmd,char *line2) {
 	int itct,*index;
 	moleculeptr mptr;
-	static enum MolecState ms1,ms2;
-	static double prob;
-	static int xyzvar;
-	static char probstr[STRCHAR];
-	static int inscan=0,i1,i2;
+	static THREADLOCAL enum MolecState ms1,ms2;
+	static THREADLOCAL double prob;
+	static THREADLOCAL int xyzvar;
+	static THREADLOCAL char probstr[STRCHAR];
+	static THREADLOCAL int inscan=0,i1,i2;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
@@ -3956,7 +3954,7 @@ enum CMDcode cmdequilmol(simptr sim,cmdptr cmd,char *line2) {
 		strcpy(probstr,line2); }
 	else {
 		xyzvar=0;
-		itct=strmathsscanf(line2,"%mlg|",Varnames,Varvalues,Nvar,&prob);
+		itct=strmathsscanf(line2,"%mlg|",sim->varnames,sim->varvalues,sim->nvar,&prob);
 		SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"failed to read probability. %s",ErrString);
 		SCMDCHECK(prob>=0 && prob<=1,"probability is out of bounds"); }
 
@@ -3972,7 +3970,7 @@ enum CMDcode cmdequilmol(simptr sim,cmdptr cmd,char *line2) {
 			simsetvariable(sim,"x",mptr->pos[0]);
 			if(sim->dim>1) simsetvariable(sim,"y",mptr->pos[1]);
 			if(sim->dim>2) simsetvariable(sim,"z",mptr->pos[2]);
-			strmathsscanf(probstr,"%mlg|",Varnames,Varvalues,Nvar,&prob); }
+			strmathsscanf(probstr,"%mlg|",sim->varnames,sim->varvalues,sim->nvar,&prob); }
 		if(coinrandD(prob))
 			molchangeident(sim,mptr,-1,-1,i2,ms2,mptr->pnl,NULL);
 		else
@@ -3985,11 +3983,11 @@ enum CMDcode cmdreplacemol(simptr sim,cmdptr cmd,char *line2) {
 	int itct,i1,*index1,*index2;
 	enum MolecState ms1;
 	moleculeptr mptr;
-	static enum MolecState ms2;
-	static double prob;
-	static char probstr[STRCHAR];
-	static int xyzvar;
-	static int inscan=0,i2;
+	static THREADLOCAL enum MolecState ms2;
+	static THREADLOCAL double prob;
+	static THREADLOCAL char probstr[STRCHAR];
+	static THREADLOCAL int xyzvar;
+	static THREADLOCAL int inscan=0,i2;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
@@ -4020,7 +4018,7 @@ enum CMDcode cmdreplacemol(simptr sim,cmdptr cmd,char *line2) {
 		xyzvar=1;
 	else {
 		xyzvar=0;
-		itct=strmathsscanf(line2,"%mlg|",Varnames,Varvalues,Nvar,&prob);
+		itct=strmathsscanf(line2,"%mlg|",sim->varnames,sim->varvalues,sim->nvar,&prob);
 		SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"cannot read fraction. %s",ErrString);
 		SCMDCHECK(prob>=0 && prob<=1,"fraction out of bounds"); }
 
@@ -4035,7 +4033,7 @@ enum CMDcode cmdreplacemol(simptr sim,cmdptr cmd,char *line2) {
 		simsetvariable(sim,"x",mptr->pos[0]);
 		if(sim->dim>1) simsetvariable(sim,"y",mptr->pos[1]);
 		if(sim->dim>2) simsetvariable(sim,"z",mptr->pos[2]);
-		strmathsscanf(probstr,"%mlg|",Varnames,Varvalues,Nvar,&prob); }
+		strmathsscanf(probstr,"%mlg|",sim->varnames,sim->varvalues,sim->nvar,&prob); }
 	if(coinrandD(prob))
 		molchangeident(sim,mptr,-1,-1,i2,ms2,mptr->pnl,NULL);
 	return CMDok; }
@@ -4061,9 +4059,9 @@ enum CMDcode cmdreplacexyzmol(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(ms!=MSall,"molecule state cannot be 'all'");
 	line2=strnword(line2,2);
 	SCMDCHECK(line2,"missing position information");
-	if(sim->dim==1) itct=strmathsscanf(line2,"%mlg|L",Varnames,Varvalues,Nvar,&pos[0]);
-	else if(sim->dim==2) itct=strmathsscanf(line2,"%mlg|L %mlg|L",Varnames,Varvalues,Nvar,&pos[0],&pos[1]);
-	else itct=strmathsscanf(line2,"%mlg|L %mlg|L %mlg|L",Varnames,Varvalues,Nvar,&pos[0],&pos[1],&pos[2]);
+	if(sim->dim==1) itct=strmathsscanf(line2,"%mlg|L",sim->varnames,sim->varvalues,sim->nvar,&pos[0]);
+	else if(sim->dim==2) itct=strmathsscanf(line2,"%mlg|L %mlg|L",sim->varnames,sim->varvalues,sim->nvar,&pos[0],&pos[1]);
+	else itct=strmathsscanf(line2,"%mlg|L %mlg|L %mlg|L",sim->varnames,sim->varvalues,sim->nvar,&pos[0],&pos[1],&pos[2]);
 	SCMDCHECK(itct==sim->dim && !strmatherror(ErrString,1),"insufficient dimensions entered. %s",ErrString);
 	bptr=pos2box(sim,pos);
 	ll=sim->mols->listlookup[i][ms];
@@ -4116,7 +4114,7 @@ enum CMDcode cmdreplacevolmol(simptr sim,cmdptr cmd,char *line2) {
 		xyzvar=1;
 	else {
 		xyzvar=0;
-		itct=strmathsscanf(line2,"%mlg|",Varnames,Varvalues,Nvar,&frac);
+		itct=strmathsscanf(line2,"%mlg|",sim->varnames,sim->varvalues,sim->nvar,&frac);
 		SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"cannot read fraction. %s",ErrString);
 		SCMDCHECK(frac>=0 && frac<=1,"fraction out of bounds"); }
 	line2=strnword(line2,2);
@@ -4124,7 +4122,7 @@ enum CMDcode cmdreplacevolmol(simptr sim,cmdptr cmd,char *line2) {
 	boxs=sim->boxs;
 	for(d=0;d<dim;d++) {
 		SCMDCHECK(line2,"missing argument");
-		itct=strmathsscanf(line2,"%mlg|L %mlg|L",Varnames,Varvalues,Nvar,&poslo[d],&poshi[d]);
+		itct=strmathsscanf(line2,"%mlg|L %mlg|L",sim->varnames,sim->varvalues,sim->nvar,&poslo[d],&poshi[d]);
 		SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"read failure. %s",ErrString);
 		line2=strnword(line2,3); }
 
@@ -4146,7 +4144,7 @@ enum CMDcode cmdreplacevolmol(simptr sim,cmdptr cmd,char *line2) {
 						simsetvariable(sim,"x",mptr->pos[0]);
 						if(sim->dim>1) simsetvariable(sim,"y",mptr->pos[1]);
 						if(sim->dim>2) simsetvariable(sim,"z",mptr->pos[2]);
-						strmathsscanf(probstr,"%mlg|",Varnames,Varvalues,Nvar,&frac); }
+						strmathsscanf(probstr,"%mlg|",sim->varnames,sim->varvalues,sim->nvar,&frac); }
 				 	if(coinrandD(frac)) {
 						molchangeident(sim,mptr,ll,-1,i2,ms2,mptr->pnl,NULL); }}}}}
 	return CMDok; }
@@ -4158,12 +4156,12 @@ enum CMDcode cmdreplacecmptmol(simptr sim,cmdptr cmd,char *line2) {
 	char nm[STRCHAR];
 	enum MolecState ms1;
 	moleculeptr mptr;
-	static enum MolecState ms2;
-	static compartptr cmpt;
-	static double frac;
-	static char probstr[STRCHAR];
-	static int xyzvar;
-	static int inscan=0,i2;
+	static THREADLOCAL enum MolecState ms2;
+	static THREADLOCAL compartptr cmpt;
+	static THREADLOCAL double frac;
+	static THREADLOCAL char probstr[STRCHAR];
+	static THREADLOCAL int xyzvar;
+	static THREADLOCAL int inscan=0,i2;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
@@ -4194,7 +4192,7 @@ enum CMDcode cmdreplacecmptmol(simptr sim,cmdptr cmd,char *line2) {
 		xyzvar=1;
 	else {
 		xyzvar=0;
-		itct=strmathsscanf(line2,"%mlg|",Varnames,Varvalues,Nvar,&frac);
+		itct=strmathsscanf(line2,"%mlg|",sim->varnames,sim->varvalues,sim->nvar,&frac);
 		SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"cannot read fraction. %s",ErrString);
 		SCMDCHECK(frac>=0 && frac<=1,"fraction out of bounds"); }
 	line2=strnword(line2,2);
@@ -4216,7 +4214,7 @@ enum CMDcode cmdreplacecmptmol(simptr sim,cmdptr cmd,char *line2) {
 			simsetvariable(sim,"x",mptr->pos[0]);
 			if(sim->dim>1) simsetvariable(sim,"y",mptr->pos[1]);
 			if(sim->dim>2) simsetvariable(sim,"z",mptr->pos[2]);
-			strmathsscanf(probstr,"%mlg|",Varnames,Varvalues,Nvar,&frac); }
+			strmathsscanf(probstr,"%mlg|",sim->varnames,sim->varvalues,sim->nvar,&frac); }
 	 	if(coinrandD(frac))
 			molchangeident(sim,mptr,-1,-1,i2,ms2,mptr->pnl,NULL); }
 	return CMDok; }
@@ -4227,9 +4225,9 @@ enum CMDcode cmdmodulatemol(simptr sim,cmdptr cmd,char *line2) {
 	int itct,*index;
 	moleculeptr mptr;
 	double freq,shift;
-	static double prob;
-	static enum MolecState ms1,ms2;
-	static int inscan=0,i1,i2;
+	static THREADLOCAL double prob;
+	static THREADLOCAL enum MolecState ms1,ms2;
+	static THREADLOCAL int inscan=0,i1,i2;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
@@ -4254,7 +4252,7 @@ enum CMDcode cmdmodulatemol(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK((ms1==MSsoln && ms2==MSsoln) || (ms1!=MSsoln && ms2!=MSsoln),"cannot equilibrate between solution and surface-bound");
 	line2=strnword(line2,2);
 	SCMDCHECK(line2,"missing frequency and shift");
-	itct=strmathsscanf(line2,"%mlg|/T %mlg|",Varnames,Varvalues,Nvar,&freq,&shift);
+	itct=strmathsscanf(line2,"%mlg|/T %mlg|",sim->varnames,sim->varvalues,sim->nvar,&freq,&shift);
 	SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"failure reading frequency or shift. %s",ErrString);
 
 	inscan=1;
@@ -4279,8 +4277,8 @@ enum CMDcode cmdreact1(simptr sim,cmdptr cmd,char *line2) {
 	char rnm[STRCHAR];
 	moleculeptr mptr;
 	enum MolecState ms;
-	static rxnptr rxn;
-	static int inscan=0;
+	static THREADLOCAL rxnptr rxn;
+	static THREADLOCAL int inscan=0;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
@@ -4297,7 +4295,7 @@ enum CMDcode cmdreact1(simptr sim,cmdptr cmd,char *line2) {
 	itct=sscanf(line2,"%s",rnm);
 	SCMDCHECK(itct==1,"cannot read reaction name");
 	SCMDCHECK(sim->rxnss[1],"no first order reactions defined");
-	r=stringfind(sim->rxnss[1]->rname,sim->rxnss[1]->totrxn,rnm);
+	r=rxnfindname(sim->rxnss[1],rnm);
 	SCMDCHECK(r>=0,"reaction not recognized");
 	rxn=sim->rxnss[1]->rxn[r];
 
@@ -4322,16 +4320,16 @@ enum CMDcode cmdsetrateint(simptr sim,cmdptr cmd,char *line2) {
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
 
 	SCMDCHECK(line2,"missing argument");
-	itct=strmathsscanf(line2,"%s %mlg|",Varnames,Varvalues,Nvar,rnm,&rateint);
+	itct=strmathsscanf(line2,"%s %mlg|",sim->varnames,sim->varvalues,sim->nvar,rnm,&rateint);
 	SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"read failure. %s",ErrString);
 	r=-1;
-	if(sim->rxnss[0]) r=stringfind(sim->rxnss[0]->rname,sim->rxnss[0]->totrxn,rnm);
+	if(sim->rxnss[0]) r=rxnfindname(sim->rxnss[0],rnm);
 	if(r>=0) order=0;
 	else {
-		if(sim->rxnss[1]) r=stringfind(sim->rxnss[1]->rname,sim->rxnss[1]->totrxn,rnm);
+		if(sim->rxnss[1]) r=rxnfindname(sim->rxnss[1],rnm);
 		if(r>=0) order=1;
 		else {
-			if(sim->rxnss[2]) r=stringfind(sim->rxnss[2]->rname,sim->rxnss[2]->totrxn,rnm);
+			if(sim->rxnss[2]) r=rxnfindname(sim->rxnss[2],rnm);
 			if(r>=0) order=2;
 			else SCMDCHECK(0,"reaction name not recognized"); }}
 	SCMDCHECK(rateint>=0,"internal rate cannot be negative");
@@ -4364,7 +4362,7 @@ enum CMDcode cmdshufflemollist(simptr sim,cmdptr cmd,char *line2) {
 
 /* cmdshufflereactions */
 enum CMDcode cmdshufflereactions(simptr sim,cmdptr cmd,char *line2) {
-	int itct,i,j,i1,i2,isym,j1,j2,*index1,*index2;
+	int itct,i,i1,i2,j1,j2,*index1,*index2,ident[2];
 	char nm1[STRCHAR],nm2[STRCHAR];
 	enum MolecState ms1,ms2;
 	rxnssptr rxnss;
@@ -4385,12 +4383,11 @@ enum CMDcode cmdshufflereactions(simptr sim,cmdptr cmd,char *line2) {
 		for(j2=0;j2<index2[PDnresults];j2++) {
 			i1=index1[PDMAX+j1];
 			i2=index2[PDMAX+j2];
-			i=i1*rxnss->maxspecies+i2;
-			if(rxnss->nrxn[i]) {
-				randshuffletableI(rxnss->table[i],rxnss->nrxn[i]);
-				isym=i2*rxnss->maxspecies+i1;
-				for(j=0;j<rxnss->nrxn[i];j++)
-					rxnss->table[isym][j]=rxnss->table[i][j]; }}
+			ident[0]=i1;
+			ident[1]=i2;
+			i=rxnfindset(rxnss,ident);
+			if(rxnss->nrxn[i])																// table is shared by i1+i2 and i2+i1
+				randshuffletableI(rxnss->table[i],rxnss->nrxn[i]); }
 
 	return CMDok; }
 
@@ -4403,7 +4400,7 @@ enum CMDcode cmdsettimestep(simptr sim,cmdptr cmd,char *line2) {
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
 
 	SCMDCHECK(line2,"missing argument");
-	itct=strmathsscanf(line2,"%mlg|T",Varnames,Varvalues,Nvar,&dt);
+	itct=strmathsscanf(line2,"%mlg|T",sim->varnames,sim->varvalues,sim->nvar,&dt);
 	SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"read failure. %s",ErrString);
 	SCMDCHECK(dt>0,"time step must be >0");
 
@@ -4448,7 +4445,7 @@ enum CMDcode cmdexcludebox(simptr sim,cmdptr cmd,char *line2) {
 	boxs=sim->boxs;
 	for(d=0;d<dim;d++) {
 		SCMDCHECK(line2,"missing argument");
-		itct=strmathsscanf(line2,"%mlg|L %mlg|L",Varnames,Varvalues,Nvar,&poslo[d],&poshi[d]);
+		itct=strmathsscanf(line2,"%mlg|L %mlg|L",sim->varnames,sim->varvalues,sim->nvar,&poslo[d],&poshi[d]);
 		SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"read failure. %s",ErrString);
 		line2=strnword(line2,3); }
 
@@ -4484,11 +4481,11 @@ enum CMDcode cmdexcludesphere(simptr sim,cmdptr cmd,char *line2) {
 	boxs=sim->boxs;
 	for(d=0;d<dim;d++) {
 		SCMDCHECK(line2,"missing center argument");
-		itct=strmathsscanf(line2,"%mlg|L",Varnames,Varvalues,Nvar,&poscent[d]);
+		itct=strmathsscanf(line2,"%mlg|L",sim->varnames,sim->varvalues,sim->nvar,&poscent[d]);
 		SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"failure reading center. %s",ErrString);
 		line2=strnword(line2,2); }
 	SCMDCHECK(line2,"missing radius");
-	itct=strmathsscanf(line2,"%mlg|L",Varnames,Varvalues,Nvar,&rad);
+	itct=strmathsscanf(line2,"%mlg|L",sim->varnames,sim->varvalues,sim->nvar,&rad);
 	SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"failure reading radius. %s",ErrString);
 
 	dist=rad*sqrt((double)dim);
@@ -4518,8 +4515,8 @@ enum CMDcode cmdexcludesphere(simptr sim,cmdptr cmd,char *line2) {
 enum CMDcode cmdincludeecoli(simptr sim,cmdptr cmd,char *line2) {
 	moleculeptr mptr;
 	wallptr *wlist;
-	static double rad,length,pos[DIMMAX];
-	static int inscan=0;
+	static THREADLOCAL double rad,length,pos[DIMMAX];
+	static THREADLOCAL int inscan=0;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
@@ -4559,14 +4556,14 @@ enum CMDcode cmdsetreactionratemolcount(simptr sim,cmdptr cmd,char *line2) {
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
 
 	SCMDCHECK(line2,"missing argument");
-	itct=strmathsscanf(line2,"%s %mlg|",Varnames,Varvalues,Nvar,nm1,&coeff);
+	itct=strmathsscanf(line2,"%s %mlg|",sim->varnames,sim->varvalues,sim->nvar,nm1,&coeff);
   SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"missing reaction name or coefficient c0. %s",ErrString);
   r=readrxnname(sim,nm1,&order,&rxn,&vlist,1);
   SCMDCHECK(r>=0,"unrecognized reaction name");
   line2=strnword(line2,3);
   rate=coeff;
   while(line2) {
-    itct=strmathsscanf(line2,"%mlg| %s",Varnames,Varvalues,Nvar,&coeff,nm1);
+    itct=strmathsscanf(line2,"%mlg| %s",sim->varnames,sim->varvalues,sim->nvar,&coeff,nm1);
     SCMDCHECK(itct==2 && !strmatherror(ErrString,1),"missing coefficient and/or species parameters. %s",ErrString);
 		i=molstring2index1(sim,nm1,&ms,&index);
 		SCMDCHECK(i!=-1,"species is missing or cannot be read");
@@ -4599,17 +4596,17 @@ enum CMDcode cmdexpandsystem(simptr sim,cmdptr cmd,char *line2) {
 	enum PanelFace face;
 	panelptr pnl;
 	compartptr cmpt;
-	static double expand[DIMMAX],center[DIMMAX];
-	static int inscan=0;
+	static THREADLOCAL double expand[DIMMAX],center[DIMMAX];
+	static THREADLOCAL int inscan=0;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
 
 	dim=sim->dim;
 	SCMDCHECK(line2,"missing arguments");
-	if(dim==1) itct=strmathsscanf(line2,"%mlg|",Varnames,Varvalues,Nvar,&expand[0]);
-	else if(dim==2) itct=strmathsscanf(line2,"%mlg| %mlg|",Varnames,Varvalues,Nvar,&expand[0],&expand[1]);
-	else itct=strmathsscanf(line2,"%mlg| %mlg| %mlg|",Varnames,Varvalues,Nvar,&expand[0],&expand[1],&expand[2]);
+	if(dim==1) itct=strmathsscanf(line2,"%mlg|",sim->varnames,sim->varvalues,sim->nvar,&expand[0]);
+	else if(dim==2) itct=strmathsscanf(line2,"%mlg| %mlg|",sim->varnames,sim->varvalues,sim->nvar,&expand[0],&expand[1]);
+	else itct=strmathsscanf(line2,"%mlg| %mlg| %mlg|",sim->varnames,sim->varvalues,sim->nvar,&expand[0],&expand[1],&expand[2]);
   SCMDCHECK(itct==dim && !strmatherror(ErrString,1),"cannot read or wrong number of expansion values. %s",ErrString);
 	systemcenter(sim,center);
 
@@ -4672,13 +4669,13 @@ enum CMDcode cmdtranslatecmpt(simptr sim,cmdptr cmd,char *line2) {
 	cmpt=cmptss->cmptlist[c];
 
 	SCMDCHECK(line2=strnword(line2,2),"second argument should be code value");;
-	itct=strmathsscanf(line2,"%mi",Varnames,Varvalues,Nvar,&code);
+	itct=strmathsscanf(line2,"%mi",sim->varnames,sim->varvalues,sim->nvar,&code);
 	SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"second argument should be code value. %s",ErrString);
 
 	SCMDCHECK(line2=strnword(line2,2),"missing arguments for translation amount");;
-	if(dim==1) itct=strmathsscanf(line2,"%mlg|L",Varnames,Varvalues,Nvar,&translate[0]);
-	else if(dim==2) itct=strmathsscanf(line2,"%mlg|L %mlg|L",Varnames,Varvalues,Nvar,&translate[0],&translate[1]);
-	else itct=strmathsscanf(line2,"%mlg|L %mlg|L %mlg|L",Varnames,Varvalues,Nvar,&translate[0],&translate[1],&translate[2]);
+	if(dim==1) itct=strmathsscanf(line2,"%mlg|L",sim->varnames,sim->varvalues,sim->nvar,&translate[0]);
+	else if(dim==2) itct=strmathsscanf(line2,"%mlg|L %mlg|L",sim->varnames,sim->varvalues,sim->nvar,&translate[0],&translate[1]);
+	else itct=strmathsscanf(line2,"%mlg|L %mlg|L %mlg|L",sim->varnames,sim->varvalues,sim->nvar,&translate[0],&translate[1],&translate[2]);
   SCMDCHECK(itct==dim && !strmatherror(ErrString,1),"cannot read translation values or wrong number of them. %s",ErrString);
 
 	comparttranslate(sim,cmpt,code,translate);
@@ -4707,18 +4704,18 @@ enum CMDcode cmddiffusecmpt(simptr sim,cmdptr cmd,char *line2) {
 	cmpt=cmptss->cmptlist[c];
 
 	SCMDCHECK(line2=strnword(line2,2),"second argument should be code value");;
-	itct=strmathsscanf(line2,"%mi",Varnames,Varvalues,Nvar,&code);
+	itct=strmathsscanf(line2,"%mi",sim->varnames,sim->varvalues,sim->nvar,&code);
 	SCMDCHECK(itct==1 && !strmatherror(ErrString,1),"second argument should be code value. %s",ErrString);
 
 	SCMDCHECK(line2=strnword(line2,2),"missing arguments for standard deviations");;
-	if(dim==1) itct=strmathsscanf(line2,"%mlg|L",Varnames,Varvalues,Nvar,&stddev[0]);
-	else if(dim==2) itct=strmathsscanf(line2,"%mlg|L %mlg|L",Varnames,Varvalues,Nvar,&stddev[0],&stddev[1]);
-	else itct=strmathsscanf(line2,"%mlg|L %mlg|L %mlg|L",Varnames,Varvalues,Nvar,&stddev[0],&stddev[1],&stddev[2]);
+	if(dim==1) itct=strmathsscanf(line2,"%mlg|L",sim->varnames,sim->varvalues,sim->nvar,&stddev[0]);
+	else if(dim==2) itct=strmathsscanf(line2,"%mlg|L %mlg|L",sim->varnames,sim->varvalues,sim->nvar,&stddev[0],&stddev[1]);
+	else itct=strmathsscanf(line2,"%mlg|L %mlg|L %mlg|L",sim->varnames,sim->varvalues,sim->nvar,&stddev[0],&stddev[1],&stddev[2]);
   SCMDCHECK(itct==dim && !strmatherror(ErrString,1),"cannot read standard deviation values or wrong number of them. %s",ErrString);
 
 	line2=strnword(line2,dim+1);
 	if(line2) {
-		itct=strmathsscanf(line2,"%s %mlg|L %mi",Varnames,Varvalues,Nvar,cname,&radius,&nsample);
+		itct=strmathsscanf(line2,"%s %mlg|L %mi",sim->varnames,sim->varvalues,sim->nvar,cname,&radius,&nsample);
 		SCMDCHECK(itct==3 && !strmatherror(ErrString,1),"cannot read bounding compartment name, radius, and/or number of samples. %s",ErrString);
 		c=stringfind(cmptss->cnames,cmptss->ncmpt,cname);
 		SCMDCHECK(c>=0,"bounding compartment name not recognized");
@@ -4766,11 +4763,11 @@ enum CMDcode cmdlongrangeforce(simptr sim,cmdptr cmd,char *line2) {
 	double dt,mobility,dist,delta[DIMMAX],force;
 	boxptr bptr;
 
-	static int inscan=0,i1,i2,*index1,*index2,rvar,lllo,llhi;
-	static enum MolecState ms1,ms2,mslo,mshi;
-	static double mobility1,mobility2,rmin,rmax,forcemag,syswidth[DIMMAX],force0[4]={0,0,0,0};
-	static char eqstring[STRCHAR];
-	static listptrULVD4 moleclist;
+	static THREADLOCAL int inscan=0,i1,i2,*index1,*index2,rvar,lllo,llhi;
+	static THREADLOCAL enum MolecState ms1,ms2,mslo,mshi;
+	static THREADLOCAL double mobility1,mobility2,rmin,rmax,forcemag,syswidth[DIMMAX],force0[4]={0,0,0,0};
+	static THREADLOCAL char eqstring[STRCHAR];
+	static THREADLOCAL listptrULVD4 moleclist;
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
@@ -4790,7 +4787,7 @@ enum CMDcode cmdlongrangeforce(simptr sim,cmdptr cmd,char *line2) {
 	SCMDCHECK(i2!=-7,"error allocating memory");
 	line2=strnword(line2,2);
 	SCMDCHECK(line2,"longrangeforce format: species1(state) species2(state) mobility1 mobility2 r_min r_max equation");
-	itct=strmathsscanf(line2,"%mlg|L/T %mlg|L/T %mlg|L %mlg|L %s",Varnames,Varvalues,Nvar,&mobility1,&mobility2,&rmin,&rmax,eqstring);
+	itct=strmathsscanf(line2,"%mlg|L/T %mlg|L/T %mlg|L %mlg|L %s",sim->varnames,sim->varvalues,sim->nvar,&mobility1,&mobility2,&rmin,&rmax,eqstring);
 	SCMDCHECK(itct==5 && !strmatherror(ErrString,1),"longrangeforce format: species1(state) species2(state) mobility1 mobility2 r_min r_max equation. %s",ErrString);
 	SCMDCHECK(rmin>0,"minimum radius needs to be >0");
 	SCMDCHECK(rmax>=0,"maximum radius needs to be >=0");
@@ -4800,7 +4797,7 @@ enum CMDcode cmdlongrangeforce(simptr sim,cmdptr cmd,char *line2) {
 		rvar=1;
 	else {
 		rvar=0;
-		forcemag=strmatheval(eqstring,Varnames,Varvalues,Nvar);
+		forcemag=strmatheval(eqstring,sim->varnames,sim->varvalues,sim->nvar);
 		SCMDCHECK(forcemag==forcemag,"cannot compute equation value"); }
 
 	lllo=llhi=-1;
@@ -4868,7 +4865,7 @@ enum CMDcode cmdlongrangeforce(simptr sim,cmdptr cmd,char *line2) {
 					if(dist>=rmin && dist<=rmax) {
 						if(rvar) {
 							simsetvariable(sim,"r",dist);
-							forcemag=strmatheval(eqstring,Varnames,Varvalues,Nvar); }
+							forcemag=strmatheval(eqstring,sim->varnames,sim->varvalues,sim->nvar); }
 						duplicate=molismatch(mptr2,i1,index1,ms1);
 						if(!duplicate) {
 							j2=ListInsertItemULVD4(moleclist,mptr2->serno,(void*)mptr2,force0,1);
@@ -4889,9 +4886,9 @@ enum CMDcode cmdtranslatemol(simptr sim,cmdptr cmd,char *line2) {
 	moleculeptr mptr;
 	double delta[DIMMAX];
 
-	static int inscan=0,i1,*index1;
-	static enum MolecState ms1;
-	static char eqstring[DIMMAX][STRCHAR];
+	static THREADLOCAL int inscan=0,i1,*index1;
+	static THREADLOCAL enum MolecState ms1;
+	static THREADLOCAL char eqstring[DIMMAX][STRCHAR];
 
 	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDmanipulate;
@@ -4924,7 +4921,7 @@ enum CMDcode cmdtranslatemol(simptr sim,cmdptr cmd,char *line2) {
 	if(dim>1) simsetvariable(sim,"y",mptr->pos[1]);
 	if(dim>2) simsetvariable(sim,"z",mptr->pos[2]);
 	for(d=0;d<dim;d++) {
-		delta[d]=strmatheval(eqstring[d],Varnames,Varvalues,Nvar);
+		delta[d]=strmatheval(eqstring[d],sim->varnames,sim->varvalues,sim->nvar);
 		if(!isfinite(delta[d])) delta[d]=0; }
 	molmovemol(sim,mptr,delta);
 	return CMDok;	}
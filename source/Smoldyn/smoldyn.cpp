@@ -113,7 +113,7 @@ int main(int argc,char **argv) {
 		er=simInitAndLoad(root,fname,&sim,flags,logfile);
 #endif
 		if(!er) {
-			if(!tflag && sim->graphss && sim->graphss->graphics!=0)
+			if(!tflag && sim->graphss && sim->graphss->graphics!=0 && !sim->graphss->offscreen)
 				gl2glutInit(&argc,argv);
 			er=simUpdateAndDisplay(sim); }
 		if(!oflag && !pflag && !er)
@@ -123,7 +123,7 @@ int main(int argc,char **argv) {
 		else {
 			fflush(stdout);
 			fflush(stderr);
-			if(tflag || !sim->graphss || sim->graphss->graphics==0) {
+			if(tflag || !sim->graphss || sim->graphss->graphics==0 || sim->graphss->offscreen) {
 				er=smolsimulate(sim);
 				endsimulate(sim,er); }
 			else {
@@ -299,11 +299,14 @@ typedef struct molsuperstruct
     int maxspecies;             // maximum number of species
     int nspecies;               // number of species, including empty mols.
     char** spname;              // names of molecular species [i]
+    struct molhashstruct* sphash; // hash table of species names
     int maxpattern;             // maximum number of patterns
     int npattern;               // actual number of patterns
     char** patlist;             // list of patterns [pat]
     int** patindex;             // species indices for patterns [pat][j]
     char** patrname;            // pattern reaction name if any [pat]
+    int* patnext;               // next pattern with same string [pat]
+    struct molhashstruct* pathash; // hash table of patterns
     double** difc;              // diffusion constants [i][ms]
     double** difstep;           // rms diffusion step [i][ms]
     double*** difm;             // diffusion matrix [i][ms][d]
@@ -317,6 +320,11 @@ typedef struct molsuperstruct
     int maxd;                   // size of dead molecule list
     int nd;                     // total number of molecules in dead list
     int topd;                   // index for dead list; above are resurrected
+    int maxreserve;             // requested preallocated molecule capacity
+    int maxslab;                // allocated number of molecule slabs
+    int nslab;                  // number of molecule slabs
+    moleculeptr* slab;          // blocks of molecule structures [slab]
+    double** slabdbl;           // blocks of molecule coordinates [slab]
     int maxlist;                // allocated number of live lists
     int nlist;                  // number of live lists
     int** listlookup;           // lookup table for live lists [i][ms]
@@ -354,6 +362,7 @@ typedef struct wallstruct
 // Increasing MAXPRODUCT value to 256
 // see https://github.com/ssandrews/Smoldyn/issues/18 for details.
 #define MAXPRODUCT 256
+#define RXNDENSEMAX 1024 // order 2 reactant sets also indexed densely up to this many species
 
 enum RevParam
 {
@@ -427,13 +436,21 @@ typedef struct rxnsuperstruct
     int order;                 // order of reactions listed: 0, 1, or 2
     int maxspecies;            // maximum number of species
     int maxlist;               // copy of maximum number of molecule lists
-    int* nrxn;                 // number of rxns for each reactant set [i]
-    int** table;               // lookup table for reaction numbers [i][j]
+    int* nrxn;                 // number of rxns for each reactant set [s]
+    int** table;               // lookup table for reaction numbers [s][j]
+    int maxset;                // allocated number of reactant sets
+    int nset;                  // number of reactant sets
+    int* npartner;             // number of reacting partners, order 2 [i]
+    int** partner;             // sorted reacting partners, order 2 [i][k]
+    int** partnerset;          // reactant set for each partner, order 2 [i][k]
+    int* denseset;             // reactant set of species pairs or NULL, order 2 [i*maxspecies+j]
     int maxrxn;                // allocated number of reactions
     int totrxn;                // total number of reactions listed
     char** rname;              // names of reactions [r]
+    struct molhashstruct* rnamehash; // hash table of reaction names
     rxnptr* rxn;               // list of reactions [r]
     int* rxnmollist;           // live lists that have reactions [ll]
+    double* rxnmolbindrad2;    // max squared binding radius for live lists [ll]
 } * rxnssptr;
 
 /********************************** Rules ***********************************/
@@ -634,6 +651,9 @@ typedef struct boxstruct
     int maxpanel;             // allocated number of panels in box
     int npanel;               // number of surface panels in box
     panelptr* panel;          // list of panels in box
+    int maxseg;               // allocated number of filament segments in box
+    int nseg;                 // number of filament segments in box
+    struct segmentstruct** seg; // list of filament segments in box
     int* maxmol;              // allocated size of live lists [ll]
     int* nmol;                // number of molecules in live lists [ll]
     moleculeptr** mol;        // lists of live molecules in the box [ll][m]
@@ -737,6 +757,7 @@ typedef struct latticestruct
     double max[DIMMAX];                   // upper spatial boundaries
     double dx[DIMMAX];                    // lattice lengthscale (subvolume width)
     char btype[DIMMAX];                   // boundary type (r)eflective or (p)eriodic
+    int nsubdomains;                      // number of subdomains integrated in parallel
     portptr port;                         // interface port (ref.)
     int** convert;           // convert to particle at port, 0 or 1 [lat.species][face] ??
     int maxreactions;        // maximum number of reactions
@@ -781,7 +802,15 @@ enum FilamentDynamics
     FDRK4,
     FDeulermat,
 		FDimplicitold,
-		FDimplicit
+		FDimplicit,
+		FDadaptive
+};
+
+enum FilamentMolAct
+{
+    FMAnone,
+    FMAexclude,
+    FMAbind
 };
 
 typedef struct segmentstruct {
@@ -794,20 +823,27 @@ typedef struct segmentstruct {
     double ypr[3];                    // relative ypr angles
     double qrel[4];                   // relative rotation quaternion
     double qabs[4];                   // absolute rotation quaternion
+    int inbox;                        // 1 if listed in virtual boxes
+    double boxlo[3];                  // low corner of box listing region
+    double boxhi[3];                  // high corner of box listing region
 } * segmentptr;
 
 typedef struct filamentworkstruct {
     struct filamentstruct *fil;       // owning filament
-    double ***wnodes;                 // working nodes (3,nseg+1,3)
-    double **wroll;                   // working rolls (3,nseg)
+    double ***wnodes;                 // working nodes (5,nseg+1,3)
+    double **wroll;                   // working rolls (5,nseg)
     double **flatnodes;               // flattened nodes (2,~(2 or 4)*nseg)
     double **flatforces;              // flattened forces (2,~(2 or 4)*nseg)
-    double **wseg0up;                 // seg. 0 up vector (3,3)
+    double **wseg0up;                 // seg. 0 up vector (5,3)
     double **forces;                  // forces on nodes (nseg+1,3)
     double *torques;                  // list of segment torques (nseg)
     sparsematrix forcemat;            // force matrix for implicit int.
     double thermtime;                 // time for thermal forces
     double **thermforce;              // thermal forces on nodes
+    struct randstatestruct *rng;      // thread RNG for thermal forces
+    double adaptdt;                   // last adaptive substep, or 0
+    int substeps;                     // adaptive substeps in last step
+    int subrejects;                   // rejected substeps in last step
 } *filamentworkptr;
 
 typedef struct filamentstruct {
@@ -831,6 +867,7 @@ typedef struct filamentstruct {
     int maxsequence;                    // allocated sequence characters
     int nsequence;                      // number of sequence characters
     char* sequence;                     // sequence code
+    int boxvalid;                       // 1 if box listings are current
 } * filamentptr;
 
 typedef struct filamenttypestruct
@@ -854,6 +891,12 @@ typedef struct filamenttypestruct
     double treadrate;                  // treadmilling rate constant
     double mobility;                   // mobility
     double filradius;                  // segment radius
+    int nthreads;                      // threads for dynamics
+    double adapttol;                   // error tolerance for adaptive dynamics
+    int maxspecies;                    // species allocated for molecule actions
+    enum FilamentMolAct* molact;       // action on each species [i]
+    double* molrate;                   // binding rate for each species [i]
+    int* molprod;                      // binding product for each species [i]
     int maxface;                       // filament faces allocated
     int nface;                         // number of filament faces
     char** facename;                   // list of face names
@@ -873,6 +916,12 @@ typedef struct filamentsuperstruct
     int ntype;                 // actual number of filament types
     char** ftnames;            // filament type names
     filamenttypeptr* filtypes; // list of filament types
+    int molactions;            // 1 if any type acts on molecules
+    double dynsegs;            // segment updates by dynamics
+    double dyntime;            // wall time for dynamics (s)
+    double adaptsteps;         // filament steps with adaptive dynamics
+    double substeps;           // accepted adaptive substeps
+    double subrejects;         // rejected adaptive substeps
 } * filamentssptr;
 
 
@@ -951,6 +1000,30 @@ enum LightParam
     LPnone
 };
 
+typedef struct molsnapstruct
+{
+    int maxmolpos;          // allocated size of molpos, in molecules
+    float* molpos;          // displayed molecule positions, grouped [3*m+d]
+    int maxmolgroup;        // allocated size of molgroup and groupstyle
+    int ngroup;             // number of groups
+    int* molgroup;          // group ends in molpos [g], with g=i*MSMAX+ms
+    float* groupstyle;      // display size and color of each group [4*g+c]
+    double time;            // simulation time of the snapshot
+    int tiff;               // 1 if the snapshot should be saved as a TIFF
+    char text[STRCHARLONG]; // text display for the snapshot
+    int graphics;           // graphics display level
+    double framepts;        // thickness of frame, 0 for no frame
+    double framecolor[4];   // frame color [c]
+    double framelo[3];      // low corner of frame [d]
+    double framehi[3];      // high corner of frame [d]
+    double gridpts;         // thickness of virtual box grid, 0 for none
+    double gridcolor[4];    // grid color [c]
+    double gridlo[3];       // low corner of grid [d]
+    double gridhi[3];       // high corner of grid [d]
+    int gridside[3];        // number of boxes on each side of grid [d]
+    double textcolor[4];    // text color [c]
+} * molsnapptr;
+
 typedef struct graphicssuperstruct
 {
     enum StructCond condition;             // structure condition
@@ -961,6 +1034,9 @@ typedef struct graphicssuperstruct
     int graphicit;                         // number of time steps per graphics update
     unsigned int graphicdelay;             // minimum delay (in ms) for graphics updates
     int tiffit;                            // number of time steps per tiff save
+    char tiffname[STRCHAR];                // image file name root, with path
+    int tiffnumber;                        // number of the next image file
+    int tiffnummax;                        // largest image file number
     double framepts;                       // thickness of frame for graphics
     double gridpts;                        // thickness of virtual box grid for graphics
     double framecolor[4];                  // frame color [c]
@@ -977,6 +1053,13 @@ typedef struct graphicssuperstruct
     double difflight[MAXLIGHTS][4];        // diffuse light color [lt][c]
     double speclight[MAXLIGHTS][4];        // specular light color [lt][c]
     double lightpos[MAXLIGHTS][4];         // light positions [lt][d]
+    int offscreen;                         // 1 to render frames without a window
+    int imageformat;                       // offscreen image format: 0=TIFF, 1=PNG
+    int imagesize[2];                      // offscreen image width and height
+    struct offscreenstruct* offscrn;       // offscreen renderer, or NULL
+    struct molsnapstruct snap[3];          // snapshots: drawn, latest, being filled
+    struct simthreadstruct* simthrd;       // simulation thread for OpenGL, or NULL
+    unsigned int spherelist;               // OpenGL display list for spheres, or 0
 } * graphicsssptr;
 
 /******************************** Simulation *******************************/
@@ -1023,6 +1106,14 @@ typedef int (*zeroreactfnptr)(struct simstruct*);
 typedef int (*unimolreactfnptr)(struct simstruct*);
 typedef int (*bimolreactfnptr)(struct simstruct*, int);
 typedef int (*checkwallsfnptr)(struct simstruct*, int, int, boxptr);
+typedef int (*stephookfnptr)(struct simstruct*, void*);
+
+typedef struct stephookstruct {
+    stephookfnptr fn; // function called after time steps
+    void* userdata;   // data passed to the function
+    int every;        // call every this many time steps
+    int count;        // time steps since the last call
+} * stephookptr;
 
 typedef struct simstruct
 {
@@ -1035,6 +1126,8 @@ typedef struct simstruct
     time_t clockstt;           // clock starting time of simulation
     double elapsedtime;        // elapsed time of simulation
     long int randseed;         // random number generator seed
+    void* randstate;           // random number stream for this simulation
+    void* unitstate;           // unit conversion tables for this simulation
     int eventcount[ETMAX];     // counter for simulation events
     int maxvar;                // allocated user-settable variables
     int nvar;                  // number of user-settable variables
@@ -1076,6 +1169,11 @@ typedef struct simstruct
     bimolreactfnptr bimolreactfn;               // function for second order reactions
     checkwallsfnptr checkwallsfn; // function for molecule collisions with walls
 
+    int maxhook;        // allocated step hooks
+    int nhook;          // number of step hooks
+    stephookptr hooks;  // step hooks [h]
+    int hookbusy;       // 1 while step hooks are being called
+
 #ifdef ENABLE_PYTHON_CALLBACK
 #ifdef __cplusplus
     CallbackFunc* callbacks[MAX_PY_CALLBACK]; // Python callback.
@@ -65,6 +65,10 @@ char *molserno2string(unsigned long long serno,char *string);
 unsigned long long molstring2serno(char *string);
 unsigned long long molfindserno(simptr sim,unsigned long long def,long int pserno,unsigned long long r1serno,unsigned long long r2serno,unsigned long long *sernolist);
 int molismobile(simptr sim,int species,enum MolecState ms);
+int molfindspecies(molssptr mols,const char *name);
+int molhashadd(struct molhashstruct **tableptr,const char *key,int index);
+int molhashfind(struct molhashstruct *table,const char *key);
+void molhashfree(struct molhashstruct **tableptr);
 int molstring2pattern(const char *str,enum MolecState *msptr,char *pat,int mode);
 int molreversepattern(const char *pattern,char *patternrev);
 int molpatternindex(simptr sim,const char *pattern,const char *rname,int isrule,int update,int **indexptr);
@@ -102,14 +106,17 @@ int molenablemols(simptr sim,int maxspecies);
 void molsetcondition(molssptr mols,enum StructCond cond,int upgrade);
 int addmollist(simptr sim,const char *nm,enum MolListType mlt);
 int molsetmaxmol(simptr sim,int max);
+int molreserve(simptr sim,int nmolecs);
 int moladdspecies(simptr sim,const char *nm);
 int molsetexpansionflag(simptr sim,int i,int flag);
 int molsupdate(simptr sim);
 
 // adding and removing molecules
 void molkill(simptr sim,moleculeptr mptr,int ll,int m);
+int molkillserials(simptr sim,int nserno,const unsigned long long *sernolist);
 moleculeptr getnextmol(molssptr mols);
 int addmol(simptr sim,int nmol,int ident,double *poslo,double *poshi,int sort);
+int addmolpositions(simptr sim,int nmol,int ident,double *poslist,int sort);
 int addsurfmol(simptr sim,int nmol,int ident,enum MolecState ms,double *pos,panelptr pnl,int surface,enum PanelShape ps,char *pname);
 int addcompartmol(simptr sim,int nmol,int ident,compartptr cmpt);
 
@@ -158,6 +165,8 @@ enum SpeciesRepresentation rxnstring2sr(const char *string);
 
 // low level utilities
 int readrxnname(simptr sim,const char *rname,int *orderptr,rxnptr *rxnpt,listptrv *vlistptr,int rxntype);
+int rxnfindname(rxnssptr rxnss,const char *rname);
+int rxnfindset(rxnssptr rxnss,const int *ident);
 int rxnisprod(simptr sim,int i,enum MolecState ms,int code);
 long int rxnstring2sernocode(char *pattern,int prd);
 char *rxnsernocode2string(long int pserno,char *pattern);
@@ -296,9 +305,14 @@ int checksurfacebound(simptr sim,int ll);
 
 // low level utilities
 boxptr pos2box(simptr sim,const double *pos);
+double boxdist2(simptr sim,const double *pos,boxptr bptr);
+void boxrange(simptr sim,const double *poslo,const double *poshi,int *lo,int *hi);
+int boxrangenext(int *indx,const int *lo,const int *hi,int dim);
 void boxrandpos(simptr sim,double *pos,boxptr bptr);
 int boxaddmol(moleculeptr mptr,int ll);
 void boxremovemol(moleculeptr mptr,int ll);
+int boxaddsegment(simptr sim,segmentptr segment);
+void boxremovesegment(simptr sim,segmentptr segment);
 boxptr boxscansphere(simptr sim,const double *pos,double radius,boxptr bptr,int *wrap);
 int boxdebug(simptr sim);
 
@@ -431,6 +445,8 @@ int filLoadFil(simptr sim,ParseFilePtr *pfpptr,char *line2);
 int filUpdate(simptr sim);
 
 // core simulation functions
+int filUpdateSegmentBoxes(simptr sim);
+int filMolecules(simptr sim);
 void filComputeForces(filamentptr fil,int nodemin,int nodemax);
 int filDynamics(simptr sim);
 
@@ -466,6 +482,7 @@ void graphicssetcondition(graphicsssptr graphss,enum StructCond cond,int upgrade
 int graphicsenablegraphics(simptr sim,const char *type);
 int graphicssetiter(simptr sim,int iter);
 int graphicssettiffiter(simptr sim,int iter);
+int graphicssettiffparams(simptr sim,const char *name,int number,int nummax);
 int graphicssetdelay(simptr sim,int delay);
 int graphicssetframethickness(simptr sim,double thickness);
 int graphicssetframecolor(simptr sim,double *color);
@@ -475,12 +492,16 @@ int graphicssetbackcolor(simptr sim,double *color);
 int graphicssettextcolor(simptr sim,double *color);
 int graphicssettextitem(simptr sim,char *itemname);
 int graphicssetlight(simptr sim,graphicsssptr graphss,int lt,enum LightParam ltparam,double *value);
+int graphicssetimage(simptr sim,const char *format,int width,int height);
 
 // structure update functions
 int graphicsupdate(simptr sim);
 
 // core simulation functions
 void smolPostRedisplay(void);
+void smolKeyPush(unsigned char key);
+void graphicsoffscreenframe(simptr sim);
+void graphicsoffscreenflush(simptr sim);
 
 // top level OpenGL functions
 void smolsimulategl(simptr sim);
@@ -521,6 +542,8 @@ void simsetcondition(simptr sim,enum StructCond cond,int upgrade);
 int simsetvariable(simptr sim,const char *name,double value);
 int simsetdim(simptr sim,int dim);
 int simsettime(simptr sim,double time,int code);
+int simaddstephook(simptr sim,stephookfnptr fn,void *userdata,int every);
+int simremovestephook(simptr sim,stephookfnptr fn,void *userdata);
 int simreadstring(simptr sim,ParseFilePtr pfp,const char *word,char *line2);
 int loadsim(simptr sim,const char *fileroot,const char *filename,const char *flags);
 int simupdate(simptr sim);
@@ -534,9 +557,11 @@ int simUpdateAndDisplay(simptr sim);
 // core simulation functions
 void debugcode(simptr sim,const char *prefix);
 int simdocommands(simptr sim);
+int simdostephooks(simptr sim);
 int simulatetimestep(simptr sim);
 void endsimulate(simptr sim,int er);
 int smolsimulate(simptr sim);
+int smolsimulatesteps(simptr sim,int nsteps);
 
 /********************************* Hybrid **********************************/
 double evaluateVolRnxRate(simptr sim, rxnptr reaction,  double* pos);
@@ -8,6 +8,7 @@
 #include <stdio.h>
 #include <math.h>
 #include <string.h>
+#include <time.h>
 #include "Geometry.h"
 #include "math2.h"
 #include "random2.h"
@@ -15,10 +16,15 @@
 #include "Sphere.h"
 #include "string2.h"
 #include "RnSparse.h"
+#include "Zn.h"
 
 #include "smoldyn.h"
 #include "smoldynfuncs.h"
 
+#ifdef HAVE_PTHREAD
+	#include <pthread.h>
+#endif
+
 
 #define FILMAXTRIES 100
 
@@ -72,6 +78,7 @@ int filtypeSetDrawForceArrows(filamenttypeptr filtype,double scale,const double
 int filtypeSetShiny(filamenttypeptr filtype,double shiny);
 int filtypeSetDynamics(filamenttypeptr filtype,enum FilamentDynamics fd);
 int filtypeAddFace(filamenttypeptr filtype,const char* facename);
+int filtypeSetMolAction(filamenttypeptr filtype,int ident,const int *index,enum FilamentMolAct act,double rate,int prod);
 filamenttypeptr filAddFilamentType(simptr sim,const char *ftname);
 
 // filament superstructure
@@ -123,8 +130,11 @@ int filCopyFilament(filamentptr filto,const filamentptr filfrom,const filamentty
 filamentptr filAddFilament(filamenttypeptr filtype,const char *filname);
 
 // Filament interactions
+int filUpdateSegmentBoxes(simptr sim);
 int filSegmentXSurface(const simptr sim,const segmentptr segment,panelptr *pnlptr);
 int filSegmentXFilament(const simptr sim,const segmentptr segment,filamentptr *filptr);
+segmentptr filPointInSegment(simptr sim,const double *pos,int ident,double *nearpt,double *distptr);
+int filMolecules(simptr sim);
 
 // Force computation
 void filAddStretchForces(filamentptr fil,int nodemin,int nodemax);
@@ -137,12 +147,16 @@ void filComputeDerivForceMat(filamentptr fil,double dtmu);
 
 // Dynamics functions
 void filStepDynamics(filamentptr fil,double dtmu,int in,int out);
-void filEulerDynamics(simptr sim,filamenttypeptr filtype);
-void filRK2Dynamics(simptr sim,filamenttypeptr filtype);
-void filRK4Dynamics(simptr sim,filamenttypeptr filtype);
-void filEulerMatDynamics(simptr sim,filamenttypeptr filtype);
-void filImplicitOldDynamics(simptr sim,filamenttypeptr filtype);
-void filImplicitDynamics(simptr sim,filamenttypeptr filtype);
+void filEulerDynamics(simptr sim,filamentptr fil);
+void filRK2Dynamics(simptr sim,filamentptr fil);
+void filRK4Step(filamentptr fil,double dtmu);
+void filRK4Dynamics(simptr sim,filamentptr fil);
+void filAdaptiveDynamics(simptr sim,filamentptr fil);
+void filEulerMatDynamics(simptr sim,filamentptr fil);
+void filImplicitOldDynamics(simptr sim,filamentptr fil);
+void filImplicitDynamics(simptr sim,filamentptr fil);
+void *filDynamicsThread(void *arg);
+void filTypeDynamics(simptr sim,filamenttypeptr filtype);
 int filDynamics(simptr sim);
 
 
@@ -159,6 +173,7 @@ char *filFD2string(enum FilamentDynamics fd,char *string) {
 	else if(fd==FDeulermat) strcpy(string,"EulerMat");
 	else if(fd==FDimplicitold) strcpy(string,"ImplicitOld");
 	else if(fd==FDimplicit) strcpy(string,"Implicit");
+	else if(fd==FDadaptive) strcpy(string,"Adaptive");
 	else strcpy(string,"none");
 	return string; }
 
@@ -174,6 +189,7 @@ enum FilamentDynamics filstring2FD(const char *string) {
 	else if(strbegin(string,"eulermat",0)) ans=FDeulermat;
 	else if(strbegin(string,"implicitold",0)) ans=FDimplicitold;
 	else if(strbegin(string,"implicit",0)) ans=FDimplicit;
+	else if(strbegin(string,"adaptive",0)) ans=FDadaptive;
 	else ans=FDnone;
 	return ans; }
 
@@ -269,6 +285,9 @@ segmentptr filSegmentAlloc() {
 	segment->ypr[0]=segment->ypr[1]=segment->ypr[2]=0;
 	Sph_One2Qtn(segment->qrel);
 	Sph_One2Qtn(segment->qabs);
+	segment->inbox=0;
+	segment->boxlo[0]=segment->boxlo[1]=segment->boxlo[2]=0;
+	segment->boxhi[0]=segment->boxhi[1]=segment->boxhi[2]=0;
 	return segment;
 
  failure:
@@ -285,7 +304,7 @@ void filSegmentFree(segmentptr segment) {
 /* filWorkAlloc */
 filamentworkptr filWorkAlloc(filamentptr fil,int maxseg) {
 	filamentworkptr filwork;
-	int dim,flatsize,seg,i;
+	int dim,flatsize,seg,i,w;
 	simptr sim;
 
 	if(fil->filwork) filWorkFree(fil->filwork,fil->maxseg);
@@ -307,28 +326,31 @@ filamentworkptr filWorkAlloc(filamentptr fil,int maxseg) {
 	filwork->forcemat=NULL;
 	filwork->thermtime=sim->time-sim->dt;
 	filwork->thermforce=NULL;
+	filwork->rng=NULL;
+	filwork->adaptdt=0;
+	filwork->substeps=0;
+	filwork->subrejects=0;
 
-	CHECKMEM(filwork->wnodes=(double***) calloc(3,sizeof(double**)));
+	CHECKMEM(filwork->wnodes=(double***) calloc(5,sizeof(double**)));	// 1 and 2 for RK, 3 and 4 for adaptive
 	filwork->wnodes[0]=fil->nodes;
-	filwork->wnodes[1]=filwork->wnodes[2]=NULL;
-	CHECKMEM(filwork->wnodes[1]=(double**) calloc(maxseg+1,sizeof(double*)));
-	CHECKMEM(filwork->wnodes[2]=(double**) calloc(maxseg+1,sizeof(double*)));
+	for(w=1;w<5;w++) filwork->wnodes[w]=NULL;
+	for(w=1;w<5;w++) {
+		CHECKMEM(filwork->wnodes[w]=(double**) calloc(maxseg+1,sizeof(double*)));
+		for(seg=0;seg<=maxseg;seg++) {
+			CHECKMEM(filwork->wnodes[w][seg]=(double*) calloc(3,sizeof(double)));
+			filwork->wnodes[w][seg][0]=filwork->wnodes[w][seg][1]=filwork->wnodes[w][seg][2]=0; }}
 	CHECKMEM(filwork->thermforce=(double**) calloc(maxseg+1,sizeof(double*)));
 	for(seg=0;seg<=maxseg;seg++) {
-		CHECKMEM(filwork->wnodes[1][seg]=(double*) calloc(3,sizeof(double)));
-		filwork->wnodes[1][seg][0]=filwork->wnodes[1][seg][1]=filwork->wnodes[1][seg][2]=0;
-		CHECKMEM(filwork->wnodes[2][seg]=(double*) calloc(3,sizeof(double)));
-		filwork->wnodes[2][seg][0]=filwork->wnodes[2][seg][1]=filwork->wnodes[2][seg][2]=0;
 		CHECKMEM(filwork->thermforce[seg]=(double*) calloc(3,sizeof(double)));
 		filwork->thermforce[seg][0]=filwork->thermforce[seg][1]=filwork->thermforce[seg][2]=0; }
 
-	CHECKMEM(filwork->wroll=(double**) calloc(3,sizeof(double*)));
+	CHECKMEM(filwork->wroll=(double**) calloc(5,sizeof(double*)));
 	filwork->wroll[0]=fil->roll;
-	filwork->wroll[1]=filwork->wroll[2]=NULL;
-	CHECKMEM(filwork->wroll[1]=(double*) calloc(maxseg,sizeof(double)));
-	CHECKMEM(filwork->wroll[2]=(double*) calloc(maxseg,sizeof(double)));
-	for(seg=0;seg<maxseg;seg++)
-		filwork->wroll[1][seg]=filwork->wroll[2][seg]=0;
+	for(w=1;w<5;w++) filwork->wroll[w]=NULL;
+	for(w=1;w<5;w++) {
+		CHECKMEM(filwork->wroll[w]=(double*) calloc(maxseg,sizeof(double)));
+		for(seg=0;seg<maxseg;seg++)
+			filwork->wroll[w][seg]=0; }
 
 	CHECKMEM(filwork->flatnodes=(double**) calloc(3,sizeof(double*)));
 	filwork->flatnodes[0]=filwork->flatnodes[1]=filwork->flatnodes[2]=NULL;
@@ -345,15 +367,13 @@ filamentworkptr filWorkAlloc(filamentptr fil,int maxseg) {
 	for(i=0;i<flatsize;i++)
 		filwork->flatforces[0][i]=filwork->flatforces[1][i]=0;
 
-	CHECKMEM(filwork->wseg0up=(double**) calloc(3,sizeof(double*)));
+	CHECKMEM(filwork->wseg0up=(double**) calloc(5,sizeof(double*)));
 	filwork->wseg0up[0]=fil->seg0up;
-	filwork->wseg0up[1]=filwork->wseg0up[2]=NULL;
-	CHECKMEM(filwork->wseg0up[1]=(double*) calloc(3,sizeof(double)));
-	filwork->wseg0up[1][0]=filwork->wseg0up[1][1]=0;
-	filwork->wseg0up[1][2]=1;
-	CHECKMEM(filwork->wseg0up[2]=(double*) calloc(3,sizeof(double)));
-	filwork->wseg0up[2][0]=filwork->wseg0up[2][1]=0;
-	filwork->wseg0up[2][2]=1;
+	for(w=1;w<5;w++) filwork->wseg0up[w]=NULL;
+	for(w=1;w<5;w++) {
+		CHECKMEM(filwork->wseg0up[w]=(double*) calloc(3,sizeof(double)));
+		filwork->wseg0up[w][0]=filwork->wseg0up[w][1]=0;
+		filwork->wseg0up[w][2]=1; }
 
 	CHECKMEM(filwork->forces=(double**) calloc(maxseg+1,sizeof(double*)));
 	for(seg=0;seg<=maxseg;seg++) {
@@ -376,21 +396,21 @@ filamentworkptr filWorkAlloc(filamentptr fil,int maxseg) {
 
 /* filWorkFree */
 void filWorkFree(filamentworkptr filwork,int maxseg) {
-	int seg;
+	int seg,w;
 
 	if(!filwork) return;
 
-	if(filwork->wnodes && filwork->wnodes[1] && filwork->wnodes[2]) {
-		for(seg=0;seg<=maxseg;seg++) {			// filwork doesn't own wnodes[0]
-			free(filwork->wnodes[1][seg]);
-			free(filwork->wnodes[2][seg]); }
-		free(filwork->wnodes[1]);
-		free(filwork->wnodes[2]);
+	if(filwork->wnodes) {
+		for(w=1;w<5;w++)										// filwork doesn't own wnodes[0]
+			if(filwork->wnodes[w]) {
+				for(seg=0;seg<=maxseg;seg++)
+					free(filwork->wnodes[w][seg]);
+				free(filwork->wnodes[w]); }
 		free(filwork->wnodes); }
 
 	if(filwork->wroll) {
-		free(filwork->wroll[1]);
-		free(filwork->wroll[2]);
+		for(w=1;w<5;w++)
+			free(filwork->wroll[w]);
 		free(filwork->wroll); }
 
 	if(filwork->flatnodes) {
@@ -405,8 +425,8 @@ void filWorkFree(filamentworkptr filwork,int maxseg) {
 		free(filwork->flatforces); }
 
 	if(filwork->wseg0up) {
-		free(filwork->wseg0up[1]);
-		free(filwork->wseg0up[2]);
+		for(w=1;w<5;w++)
+			free(filwork->wseg0up[w]);
 		free(filwork->wseg0up); }
 
 	if(filwork->forces) {
@@ -415,7 +435,10 @@ void filWorkFree(filamentworkptr filwork,int maxseg) {
 		free(filwork->forces); }
 
 	free(filwork->torques);
-	free(filwork->thermforce);
+	if(filwork->thermforce) {
+		for(seg=0;seg<=maxseg;seg++)
+			free(filwork->thermforce[seg]);
+		free(filwork->thermforce); }
 	sparseFreeM(filwork->forcemat);
 	free(filwork);
 	return; }
@@ -438,6 +461,7 @@ filamentptr filAlloc(filamentptr fil,int maxseg,int maxbranch,int maxsequence) {
 		fil->nseg=0;
 		fil->segments=NULL;
 		fil->nodes=NULL;
+		fil->filwork=NULL;
 		fil->nodesx=NULL;
 		fil->roll=NULL;
 		fil->nodemobility=NULL;
@@ -451,7 +475,8 @@ filamentptr filAlloc(filamentptr fil,int maxseg,int maxbranch,int maxsequence) {
 		fil->branches=NULL;
 		fil->maxsequence=0;
 		fil->nsequence=0;
-		fil->sequence=NULL; }
+		fil->sequence=NULL;
+		fil->boxvalid=0; }
 
 	if(maxseg>fil->maxseg) {
 		CHECKMEM(newsegments=(segmentptr*) calloc(maxseg,sizeof(struct segmentstruct)));
@@ -547,6 +572,7 @@ void filFree(filamentptr fil) {
 		for(seg=0;seg<=fil->maxseg;seg++)
 			free(fil->nodesx[seg]);
 		free(fil->nodesx); }
+	filWorkFree(fil->filwork,fil->maxseg);
 
 	free(fil->roll);
 	free(fil->nodemobility);
@@ -589,6 +615,12 @@ filamenttypeptr filamentTypeAlloc(filamenttypeptr filtype,int maxfil,int maxface
 		filtype->treadrate=0;
 		filtype->mobility=1;
 		filtype->filradius=1;
+		filtype->nthreads=1;
+		filtype->adapttol=0.001;
+		filtype->maxspecies=0;
+		filtype->molact=NULL;
+		filtype->molrate=NULL;
+		filtype->molprod=NULL;
 
 		filtype->maxface=0;
 		filtype->nface=0;
@@ -655,6 +687,9 @@ void filamentTypeFree(filamenttypeptr filtype) {
 			free(filtype->facename[fc]);
 		free(filtype->facename); }
 
+	free(filtype->molact);
+	free(filtype->molrate);
+	free(filtype->molprod);
 	free(filtype);
 	return; }
 
@@ -672,7 +707,13 @@ filamentssptr filssAlloc(filamentssptr filss,int maxtype) {
 		filss->maxtype=0;
 		filss->ntype=0;
 		filss->ftnames=NULL;
-		filss->filtypes=NULL; }
+		filss->filtypes=NULL;
+		filss->molactions=0;
+		filss->dynsegs=0;
+		filss->dyntime=0;
+		filss->adaptsteps=0;
+		filss->substeps=0;
+		filss->subrejects=0; }
 
 	if(maxtype>=filss->maxtype) {
 		CHECKMEM(newfiltypes=(filamenttypeptr*) calloc(maxtype,sizeof(filamenttypeptr)));
@@ -801,7 +842,7 @@ void filOutput(const filamentptr fil) {
 /* filtypeOutput */
 void filtypeOutput(const filamenttypeptr filtype) {
 	char string[STRCHAR];
-	int fc,f,dim;
+	int fc,f,dim,i;
 	simptr sim;
 
 	if(!filtype) {
@@ -841,6 +882,14 @@ void filtypeOutput(const filamenttypeptr filtype) {
 	simLog(sim,filtype->treadrate!=0?2:1,"  treadmilling rate: %g\n",filtype->treadrate);
 	simLog(sim,2,"  mobility: %g\n",filtype->mobility);
 	simLog(sim,2,"  filament radius: %g\n",filtype->filradius);
+	simLog(sim,filtype->nthreads>1?2:1,"  dynamics threads: %i\n",filtype->nthreads);
+	if(filtype->dynamics==FDadaptive) simLog(sim,2,"  adaptive substep tolerance: %g|L\n",filtype->adapttol);
+	if(sim && sim->mols)
+		for(i=1;i<filtype->maxspecies && i<sim->mols->nspecies;i++) {
+			if(filtype->molact[i]==FMAexclude)
+				simLog(sim,2,"  excludes %s\n",sim->mols->spname[i]);
+			else if(filtype->molact[i]==FMAbind)
+				simLog(sim,2,"  binds %s with rate %g to make %s\n",sim->mols->spname[i],filtype->molrate[i],sim->mols->spname[filtype->molprod[i]]); }
 
 	if(filtype->nface>0) {
 		simLog(sim,2,"  %i faces with twist of %g:",filtype->nface,filtype->facetwist);
@@ -910,6 +959,9 @@ int filCheckParams(const simptr sim,int *warnptr) {
 	if(filss->ntype==0) {warn++;simLog(sim,5,"WARNING: Filament superstructure is defined, but no filament types are defined\n");}
 	for(ft=0;ft<filss->ntype;ft++) {
 		filtype=filss->filtypes[ft];
+#ifndef HAVE_PTHREAD
+		if(filtype->nthreads>1) {warn++;simLog(sim,5,"WARNING: filament type %s requests %i threads, but Smoldyn was compiled without thread support\n",filtype->ftname,filtype->nthreads);}
+#endif
 		for(f=0;f<filtype->nfil;f++) {
 			fil=filtype->fillist[f];
 			for(seg=0;seg<fil->nseg;seg++) {
@@ -992,6 +1044,14 @@ int filtypeSetParam(filamenttypeptr filtype,const char *param,int index,double v
 	else if(!strcmp(param,"facetwist")) {
 		filtype->facetwist=value; }
 
+	else if(!strcmp(param,"nthreads")) {
+		if(value<1) er=2;
+		else filtype->nthreads=(int) value; }
+
+	else if(!strcmp(param,"adapttol")) {
+		if(value<=0) er=2;
+		else filtype->adapttol=value; }
+
 	return er; }
 
 
@@ -1066,6 +1126,59 @@ int filtypeAddFace(filamenttypeptr filtype,const char* facename) {
 	return 0; }
 
 
+/* filtypeSetMolAction */
+int filtypeSetMolAction(filamenttypeptr filtype,int ident,const int *index,enum FilamentMolAct act,double rate,int prod) {
+	int i,j,maxspecies;
+	enum FilamentMolAct *newmolact;
+	double *newmolrate;
+	int *newmolprod;
+	simptr sim;
+
+	sim=filtype->filss->sim;
+	if(!sim->mols) return 2;
+	maxspecies=sim->mols->maxspecies;
+	if(maxspecies>filtype->maxspecies) {
+		newmolact=(enum FilamentMolAct*) calloc(maxspecies,sizeof(enum FilamentMolAct));
+		newmolrate=(double*) calloc(maxspecies,sizeof(double));
+		newmolprod=(int*) calloc(maxspecies,sizeof(int));
+		if(!newmolact || !newmolrate || !newmolprod) {
+			free(newmolact);
+			free(newmolrate);
+			free(newmolprod);
+			return 1; }
+		for(i=0;i<maxspecies;i++) {
+			newmolact[i]=(i<filtype->maxspecies)?filtype->molact[i]:FMAnone;
+			newmolrate[i]=(i<filtype->maxspecies)?filtype->molrate[i]:0;
+			newmolprod[i]=(i<filtype->maxspecies)?filtype->molprod[i]:0; }
+		free(filtype->molact);
+		free(filtype->molrate);
+		free(filtype->molprod);
+		filtype->molact=newmolact;
+		filtype->molrate=newmolrate;
+		filtype->molprod=newmolprod;
+		filtype->maxspecies=maxspecies; }
+
+	if(ident>0) {
+		filtype->molact[ident]=act;
+		filtype->molrate[ident]=rate;
+		filtype->molprod[ident]=prod; }
+	else if(ident==-5) {
+		for(i=1;i<sim->mols->nspecies;i++) {
+			filtype->molact[i]=act;
+			filtype->molrate[i]=rate;
+			filtype->molprod[i]=prod; }}
+	else if(ident==0) {
+		for(j=0;j<index[PDnresults];j++) {
+			i=index[PDMAX+j];
+			filtype->molact[i]=act;
+			filtype->molrate[i]=rate;
+			filtype->molprod[i]=prod; }}
+	else return 2;
+
+	if(act!=FMAnone) filtype->filss->molactions=1;
+	return 0; }
+
+
 /* filAddFilamentType */
 filamenttypeptr filAddFilamentType(simptr sim,const char *ftname) {
 	int ft,er;
@@ -1171,6 +1284,8 @@ filamenttypeptr filtypeReadString(simptr sim,ParseFilePtr pfp,filamenttypeptr fi
 	double fltv1[9],f1;
 	enum DrawMode dm;
 	enum FilamentDynamics fd;
+	enum MolecState ms;
+	int *index;
 
 //	printf("%s %s\n",word,line2);//?? debug
 	dim=sim->dim;
@@ -1328,6 +1443,54 @@ filamenttypeptr filtypeReadString(simptr sim,ParseFilePtr pfp,filamenttypeptr fi
 		filtypeSetParam(filtype,"kypr",2,fltv1[2]);
 		CHECKS(!strnword(line2,4),"unexpected text following force_angle"); }
 
+	else if(!strcmp(word,"threads")) {					// threads
+		CHECKS(filtype,"need to enter filament type name before threads");
+		itct=strmathsscanf(line2,"%mi",varnames,varvalues,nvar,&i1);
+		CHECKS(itct==1,"threads format: number");
+		CHECKS(i1>=1,"number of threads needs to be at least 1");
+		filtypeSetParam(filtype,"nthreads",0,i1);
+		CHECKS(!strnword(line2,2),"unexpected text following threads"); }
+
+	else if(!strcmp(word,"adaptive_tolerance")) {	// adaptive_tolerance
+		CHECKS(filtype,"need to enter filament type name before adaptive_tolerance");
+		itct=strmathsscanf(line2,"%mlg|L",varnames,varvalues,nvar,&f1);
+		CHECKM(itct==1,"adaptive_tolerance format: value. ");
+		CHECKS(f1>0,"adaptive_tolerance value needs to be >0");
+		filtypeSetParam(filtype,"adapttol",0,f1);
+		CHECKS(!strnword(line2,2),"unexpected text following adaptive_tolerance"); }
+
+	else if(!strcmp(word,"exclude")) {					// exclude
+		CHECKS(filtype,"need to enter filament type name before exclude");
+		CHECKS(sim->mols,"need to enter species before exclude");
+		itct=sscanf(line2,"%s",nm);
+		CHECKS(itct==1,"exclude format: species");
+		i1=molstring2index1(sim,nm,&ms,&index);
+		CHECKS(i1>=0 || i1==-5,"in exclude, species name not recognized");
+		CHECKS(ms==MSsoln,"in exclude, only solution-phase molecules are allowed");
+		er=filtypeSetMolAction(filtype,i1,index,FMAexclude,0,0);
+		CHECKS(er!=1,"out of memory in exclude");
+		CHECKS(!strnword(line2,2),"unexpected text following exclude"); }
+
+	else if(!strcmp(word,"bind")) {							// bind
+		CHECKS(filtype,"need to enter filament type name before bind");
+		CHECKS(sim->mols,"need to enter species before bind");
+		itct=sscanf(line2,"%s",nm);
+		CHECKS(itct==1,"bind format: species rate product");
+		i1=molstring2index1(sim,nm,&ms,&index);
+		CHECKS(i1>=0 || i1==-5,"in bind, species name not recognized");
+		CHECKS(ms==MSsoln,"in bind, only solution-phase molecules are allowed");
+		line2=strnword(line2,2);
+		CHECKS(line2,"bind format: species rate product");
+		itct=strmathsscanf(line2,"%mlg|/T %s",varnames,varvalues,nvar,&f1,nm1);
+		CHECKS(itct==2,"bind format: species rate product");
+		CHECKS(f1>=0,"binding rate needs to be >=0");
+		i2=molstring2index1(sim,nm1,&ms,NULL);
+		CHECKS(i2>0,"in bind, product needs to be an individual species name");
+		CHECKS(ms==MSsoln,"in bind, product cannot have a state given with it");
+		er=filtypeSetMolAction(filtype,i1,index,FMAbind,f1,i2);
+		CHECKS(er!=1,"out of memory in bind");
+		CHECKS(!strnword(line2,3),"unexpected text following bind"); }
+
 //?? Need to add faces and facetwist
 
 	else {																				// unknown word
@@ -2167,6 +2330,7 @@ int filAddSegment(filamentptr fil,const double *x,double length,const double *an
 	if(fil->nseg==fil->maxseg) {
 		fil=filAlloc(fil,fil->maxseg*2+1,0,0);
 		if(!fil) return 1; }		// out of memory
+	fil->boxvalid=0;
 
 	if(endchar=='b') {
 		seg=fil->nseg;
@@ -2295,6 +2459,14 @@ int filAddOneRandomSegment(simptr sim,filamentptr fil,const double *x,double thi
 		tryagain=0;
 		if(constraints & 1) {	// check for surface crossing
 			cross=filSegmentXSurface(sim,segment,&pnl);
+			if(cross) {
+				len=filRandomLength(filtype,thickness,1);
+				filRandomAngle(filtype,fil->nseg,thickness,1,angle);
+				filLengthenSegment(fil,segment->index,len,endchar,'=');
+				filRotateVertex(fil,segment->index,angle,endchar,'=');
+				tryagain=1; }}
+		if(!tryagain && (constraints & 2)) {	// check for filament crossing
+			cross=filSegmentXFilament(sim,segment,NULL);
 			if(cross) {
 				len=filRandomLength(filtype,thickness,1);
 				filRandomAngle(filtype,fil->nseg,thickness,1,angle);
@@ -2329,6 +2501,7 @@ int filRemoveSegment(filamentptr fil,char endchar) {
 	double zero[3]={0,0,0};
 
 	if(fil->nseg==0) return -1;
+	fil->boxvalid=0;
 
 	if(endchar=='b')
 		fil->nseg--;
@@ -2371,6 +2544,7 @@ void filTranslate(filamentptr fil,const double *vect,char func) {
 		node[0]+=shift[0];
 		node[1]+=shift[1];
 		node[2]+=shift[2]; }
+	fil->boxvalid=0;
 
 	return; }
 
@@ -2395,6 +2569,7 @@ void filTranslateNode(filamentptr fil,int node,const double *vect,char func) {
 	fil->nodes[node][0]+=shift[0];
 	fil->nodes[node][1]+=shift[1];
 	fil->nodes[node][2]+=shift[2];
+	fil->boxvalid=0;
 
 	filNodes2Angles(fil,node-1,node+1);
 
@@ -2414,6 +2589,7 @@ int filLengthenSegment(filamentptr fil,int seg,double length,char endchar,char f
 	else lendelta=-length;
 
 	if(lenold+lendelta<=0) return 1;
+	fil->boxvalid=0;
 
 	Sph_QtniRotateUnitx(segment->qabs,xdelta,zero,lendelta);			// rotate to lab frame. Delta Delta x = Delta l * b_i xhat b_iT
 	nodes=fil->nodes;
@@ -2443,6 +2619,7 @@ int filChangeThickness(filamentptr fil,int seg,double thick,char func) {
 
 	if(thkold+thkdelta<0) return 1;
 	segment->thk+=thkdelta;
+	fil->boxvalid=0;
 
 	return 0; }
 
@@ -2454,6 +2631,7 @@ void filRotateVertex(filamentptr fil,int seg,const double *angle,char endchar,ch
 	segmentptr segment,segmentm1,segmentp1;
 
 	segment=fil->segments[seg];
+	fil->boxvalid=0;
 	Sph_Ypr2Qtn(angle,qtndelta);
 	if(func=='=') {
 		Sph_Qtn2Qtn(qtndelta,segment->qrel); }
@@ -2561,11 +2739,56 @@ filamentptr filAddFilament(filamenttypeptr filtype,const char *filname) {
 /******************************************************************************/
 
 
+/* filUpdateSegmentBoxes */
+int filUpdateSegmentBoxes(simptr sim) {
+	int ft,f,seg,b,nstale,ntotal;
+	filamentssptr filss;
+	filamenttypeptr filtype;
+	filamentptr fil;
+
+	filss=sim->filss;
+	if(!filss) return 0;
+	if(!sim->boxs || sim->boxs->condition!=SCok) return 2;
+
+	nstale=ntotal=0;
+	for(ft=0;ft<filss->ntype;ft++) {
+		filtype=filss->filtypes[ft];
+		for(f=0;f<filtype->nfil;f++) {
+			fil=filtype->fillist[f];
+			ntotal+=fil->nseg;
+			if(!fil->boxvalid) nstale+=fil->nseg; }}
+
+	if(2*nstale>ntotal) {											// most segments are stale, so clear all listings
+		for(b=0;b<sim->boxs->nbox;b++)
+			sim->boxs->blist[b]->nseg=0;
+		for(ft=0;ft<filss->ntype;ft++) {
+			filtype=filss->filtypes[ft];
+			for(f=0;f<filtype->nfil;f++) {
+				fil=filtype->fillist[f];
+				for(seg=0;seg<fil->maxseg;seg++)
+					fil->segments[seg]->inbox=0;
+				fil->boxvalid=0; }}}
+
+	for(ft=0;ft<filss->ntype;ft++) {
+		filtype=filss->filtypes[ft];
+		for(f=0;f<filtype->nfil;f++) {
+			fil=filtype->fillist[f];
+			if(!fil->boxvalid) {
+				for(seg=0;seg<fil->maxseg;seg++)
+					boxremovesegment(sim,fil->segments[seg]);
+				for(seg=0;seg<fil->nseg;seg++)
+					if(boxaddsegment(sim,fil->segments[seg])) return 1;
+				fil->boxvalid=1; }}}
+
+	return 0; }
+
+
 /* filSegmentXSurface */
 int filSegmentXSurface(const simptr sim,const segmentptr segment,panelptr *pnlptr) {
 	int s,p,cross;
 	surfaceptr srf;
 	panelptr pnl;
+	boxptr bptr;
 	double *pt1,*pt2,crosspt[3];
 	enum PanelShape ps;
 
@@ -2574,24 +2797,32 @@ int filSegmentXSurface(const simptr sim,const segmentptr segment,panelptr *pnlpt
 	pt2=segment->xyzback;
 
 	cross=0;
-	for(s=0;s<sim->srfss->nsrf && !cross;s++) {
-		srf=sim->srfss->srflist[s];
-		for(ps=(enum PanelShape)0;ps<PSMAX && !cross;ps=(enum PanelShape)(ps+1))
-			for(p=0;p<srf->npanel[ps] && !cross;p++) {
-				pnl=srf->panels[ps][p];
+	pnl=NULL;
+	if(sim->boxs && sim->boxs->condition==SCok) {		// only check panels in boxes along segment
+		for(bptr=pos2box(sim,pt1);bptr && !cross;bptr=line2nextbox(sim,pt1,pt2,bptr))
+			for(p=0;p<bptr->npanel && !cross;p++) {
+				pnl=bptr->panel[p];
 				cross=lineXpanel(pt1,pt2,pnl,sim->dim,crosspt,NULL,NULL,NULL,NULL,NULL,0); }}
+	else {
+		for(s=0;s<sim->srfss->nsrf && !cross;s++) {
+			srf=sim->srfss->srflist[s];
+			for(ps=(enum PanelShape)0;ps<PSMAX && !cross;ps=(enum PanelShape)(ps+1))
+				for(p=0;p<srf->npanel[ps] && !cross;p++) {
+					pnl=srf->panels[ps][p];
+					cross=lineXpanel(pt1,pt2,pnl,sim->dim,crosspt,NULL,NULL,NULL,NULL,NULL,0); }}}
 	if(cross && pnlptr) *pnlptr=pnl;
 	return cross; }
 
 
 /* filSegmentXFilament */
 int filSegmentXFilament(const simptr sim,const segmentptr segment,filamentptr *filptr) {
-	int f,i,ft,cross;
+	int f,i,ft,d,cross,lo[DIMMAX],hi[DIMMAX],indx[DIMMAX];
 	double thk,*ptf,*ptb,dist;
 	filamentssptr filss;
 	filamenttypeptr filtype;
 	filamentptr fil,fil2;
 	segmentptr segmentm1,segmentp1,segment2;
+	boxptr bptr;
 
 	fil=segment->fil;
 	ptf=segment->xyzfront;
@@ -2601,21 +2832,111 @@ int filSegmentXFilament(const simptr sim,const segmentptr segment,filamentptr *f
 	segmentp1=(segment->index==fil->nseg-1) ? NULL:fil->segments[segment->index+1];
 
 	cross=0;
+	fil2=NULL;
 	filss=sim->filss;
-	for(ft=0;ft<filss->ntype && !cross;ft++) {
-		filtype=filss->filtypes[ft];
-		for(f=0;f<filtype->nfil && !cross;f++) {
-			fil2=filtype->fillist[f];
-			for(i=0;i<fil2->nseg && !cross;i++) {
-				segment2=fil2->segments[i];
+	if(filUpdateSegmentBoxes(sim)==0 && segment->inbox) {	// only check segments listed in the same boxes
+		boxrange(sim,segment->boxlo,segment->boxhi,lo,hi);
+		for(d=0;d<sim->dim;d++) indx[d]=lo[d];
+		do {
+			bptr=sim->boxs->blist[indx2addZV(indx,sim->boxs->side,sim->dim)];
+			for(i=0;i<bptr->nseg && !cross;i++) {
+				segment2=bptr->seg[i];
 				if(!(segment2==segment || segment2==segmentm1 || segment2==segmentp1)) {
 					dist=Geo_NearestSeg2SegDist(ptf,ptb,segment2->xyzfront,segment2->xyzback);
-					if(dist<thk+segment2->thk) cross=1; }}}}
+					if(dist<thk+segment2->thk) {
+						cross=1;
+						fil2=segment2->fil; }}}}
+		while(!cross && boxrangenext(indx,lo,hi,sim->dim)); }
+	else {
+		for(ft=0;ft<filss->ntype && !cross;ft++) {
+			filtype=filss->filtypes[ft];
+			for(f=0;f<filtype->nfil && !cross;f++) {
+				fil2=filtype->fillist[f];
+				for(i=0;i<fil2->nseg && !cross;i++) {
+					segment2=fil2->segments[i];
+					if(!(segment2==segment || segment2==segmentm1 || segment2==segmentp1)) {
+						dist=Geo_NearestSeg2SegDist(ptf,ptb,segment2->xyzfront,segment2->xyzback);
+						if(dist<thk+segment2->thk) cross=1; }}}}}
 	if(cross && filptr)
 		*filptr=fil2;
 	return cross; }
 
 
+/* filPointInSegment */
+segmentptr filPointInSegment(simptr sim,const double *pos,int ident,double *nearpt,double *distptr) {
+	int i,d,dim;
+	double near[DIMMAX],dist2,dx,best;
+	boxptr bptr;
+	segmentptr segment,bestseg;
+	filamenttypeptr filtype;
+
+	dim=sim->dim;
+	bptr=pos2box(sim,pos);
+	bestseg=NULL;
+	best=0;
+	for(i=0;i<bptr->nseg;i++) {									// segments are listed in all boxes within thk of them
+		segment=bptr->seg[i];
+		filtype=segment->fil->filtype;
+		if(ident>0 && (ident>=filtype->maxspecies || filtype->molact[ident]==FMAnone)) continue;
+		Geo_NearestLineSegPt(segment->xyzfront,segment->xyzback,(double*)pos,near,dim,0);
+		dist2=0;
+		for(d=0;d<dim;d++) {
+			dx=pos[d]-near[d];
+			dist2+=dx*dx; }
+		if(dist2<segment->thk*segment->thk && (!bestseg || dist2<best)) {	// keep the closest axis, which is away from joints
+			bestseg=segment;
+			best=dist2;
+			if(nearpt)
+				for(d=0;d<dim;d++) nearpt[d]=near[d]; }}
+	if(bestseg && distptr) *distptr=sqrt(best);
+	return bestseg; }
+
+
+/* filMolecules */
+int filMolecules(simptr sim) {
+	int ll,m,d,dim,i,er;
+	double near[DIMMAX],scale,dist,prob;
+	moleculeptr mptr;
+	molssptr mols;
+	segmentptr segment;
+	filamenttypeptr filtype;
+
+	if(!sim->filss || !sim->filss->molactions || !sim->mols) return 0;
+	er=filUpdateSegmentBoxes(sim);
+	if(er) return er;
+
+	dim=sim->dim;
+	mols=sim->mols;
+	for(ll=0;ll<mols->nlist;ll++)
+		if(mols->diffuselist[ll])
+			for(m=0;m<mols->nl[ll];m++) {
+				mptr=mols->live[ll][m];
+				i=mptr->ident;
+				if(mptr->mstate!=MSsoln) continue;
+				segment=filPointInSegment(sim,mptr->pos,i,near,&dist);
+				if(!segment) continue;
+				filtype=segment->fil->filtype;
+
+				if(filtype->molact[i]==FMAbind && filtype->molrate[i]>0) {
+					prob=1.0-exp(-filtype->molrate[i]*sim->dt);
+					if(randCOD()<prob) {
+						if(dist>0)																// place product on segment surface
+							for(d=0;d<dim;d++)
+								mptr->pos[d]=near[d]+(mptr->pos[d]-near[d])*segment->thk/dist;
+						molchangeident(sim,mptr,ll,m,filtype->molprod[i],MSsoln,NULL,NULL);
+						continue; }}
+
+				if(!filPointInSegment(sim,mptr->posx,i,NULL,NULL)) {	// reject move into filament
+					for(d=0;d<dim;d++)
+						mptr->pos[d]=mptr->posx[d]; }
+				else if(dist>0) {																// segment moved onto molecule, so push it out
+					scale=segment->thk/dist;
+					for(d=0;d<dim;d++)
+						mptr->pos[d]=near[d]+(mptr->pos[d]-near[d])*scale; }}
+
+	return 0; }
+
+
 /******************************************************************************/
 /**************************** Force computation *************************/
 /******************************************************************************/
@@ -2719,6 +3040,7 @@ void filAddThermalForces(filamentptr fil,int nodemin,int nodemax) {
 	double **forces,*kypr,kT,stdlen,frms;
 	filamenttypeptr filtype;
 	filamentworkptr filwork;
+	randstateptr rng;
 	int dim,node;
 	simptr sim;
 
@@ -2735,15 +3057,16 @@ void filAddThermalForces(filamentptr fil,int nodemin,int nodemax) {
 		stdlen=filtype->stdlen;
 		kT=filtype->kT;
 		frms=sqrt(kypr[0]*kT)/stdlen;						//?? This equation is almost certainly incorrect
+		rng=filwork->rng;												// thread RNG if integrated in parallel
 		if(dim==2)
 			for(node=0;node<=fil->nseg;node++) {
-				filwork->thermforce[node][0]=2*frms*gaussrandD();
-				filwork->thermforce[node][1]=2*frms*gaussrandD(); }
+				filwork->thermforce[node][0]=2*frms*(rng?gaussrandDR(rng):gaussrandD());
+				filwork->thermforce[node][1]=2*frms*(rng?gaussrandDR(rng):gaussrandD()); }
 		else
 			for(node=0;node<=fil->nseg;node++) {
-				filwork->thermforce[node][0]=2*frms*gaussrandD();
-				filwork->thermforce[node][1]=2*frms*gaussrandD();
-				filwork->thermforce[node][2]=2*frms*gaussrandD(); }
+				filwork->thermforce[node][0]=2*frms*(rng?gaussrandDR(rng):gaussrandD());
+				filwork->thermforce[node][1]=2*frms*(rng?gaussrandDR(rng):gaussrandD());
+				filwork->thermforce[node][2]=2*frms*(rng?gaussrandDR(rng):gaussrandD()); }
 		filwork->thermtime=sim->time; }
 
 //??	torques=fil->torques;
@@ -2763,7 +3086,7 @@ void filAddThermalForces(filamentptr fil,int nodemin,int nodemax) {
 
 void filAddBendForces(filamentptr fil,int nodemin,int nodemax) {
 	double **forces,*torques,bendtorque[3],forcem1[3],forcep1[3],force[3],**nodes;
-	double xvect[3],xvectm1[3],len2inv,len2m1inv;
+	double xvect[3],xvectm1[3],len2inv,len2m1inv,kyaw,stdyaw;
 	int node,dim;
 
 	forces=fil->filwork->forces;
@@ -2775,12 +3098,14 @@ void filAddBendForces(filamentptr fil,int nodemin,int nodemax) {
 	if(nodemax<0 || nodemax>fil->nseg) nodemax=fil->nseg;
 
 	if(dim==2) {
+		kyaw=fil->filtype->kypr[0];
+		stdyaw=fil->filtype->stdypr[0];
 		node=nodemin;
 		xvect[0]=nodes[node+1][0]-nodes[node][0];
 		xvect[1]=nodes[node+1][1]-nodes[node][1];
 		len2inv=1.0/(xvect[0]*xvect[0]+xvect[1]*xvect[1]);					// inverse squared length of segment i
 		for(node=nodemin+1;node<nodemax;node++) {										// compute bending forces
-			filBendTorque(fil,node,bendtorque);												// get bending torque in system reference frame
+			bendtorque[2]=-kyaw*(fil->segments[node]->ypr[0]-stdyaw);	// bending torque, as in filBendTorque
 
 			xvectm1[0]=xvect[0];																			// Delta x_(i-1)
 			xvectm1[1]=xvect[1];
@@ -3013,7 +3338,7 @@ void filComputeDerivForceMat(filamentptr fil,double dtmu) {
 	else {
 		for(node=0;node<=fil->nseg;node++) {
 			for(d=0;d<4;d++) {
-				if(node==fil->nseg && d==4) break;
+				if(node==fil->nseg && d==3) break;
 				dx=flatnodes[1][4*node+d];
 				if(dx==0) break;
 				dxinv=1.0/dx;
@@ -3087,168 +3412,272 @@ void filStepDynamics(filamentptr fil,double dtmu,int in,int out) {
 
 
 /* filEulerDynamics */
-void filEulerDynamics(simptr sim,filamenttypeptr filtype) {
-	int f;
+void filEulerDynamics(simptr sim,filamentptr fil) {
 	double dtmu;
-	filamentptr fil;
 
-	dtmu=filtype->mobility*sim->dt;
-	for(f=0;f<filtype->nfil;f++) {
-		fil=filtype->fillist[f];
-		filComputeForces(fil,-1,-1);
-		filStepDynamics(fil,dtmu,0,0);
-		filNodes2Angles(fil,-1,-1); }
+	dtmu=fil->filtype->mobility*sim->dt;
+	filComputeForces(fil,-1,-1);
+	filStepDynamics(fil,dtmu,0,0);
+	filNodes2Angles(fil,-1,-1);
 	return; }
 
 
 /* filRK2Dynamics */
-void filRK2Dynamics(simptr sim,filamenttypeptr filtype) {
-	int f;
+void filRK2Dynamics(simptr sim,filamentptr fil) {
 	double dtmu;
-	filamentptr fil;
 
-	dtmu=filtype->mobility*sim->dt;
-	for(f=0;f<filtype->nfil;f++) {						// store initial state in nodes1 and roll1 and then take a half step
-		fil=filtype->fillist[f];
-		filComputeForces(fil,-1,-1);
-		filCopyWorkingNodes(fil,0,1);
-		filStepDynamics(fil,dtmu/2,0,0);
-		filNodes2Angles(fil,-1,-1); }
+	dtmu=fil->filtype->mobility*sim->dt;
+	filComputeForces(fil,-1,-1);						// store initial state in nodes1 and roll1 and then take a half step
+	filCopyWorkingNodes(fil,0,1);
+	filStepDynamics(fil,dtmu/2,0,0);
+	filNodes2Angles(fil,-1,-1);
+
+	filComputeForces(fil,-1,-1);						// compute force from new state and then take full step from initial state
+	filStepDynamics(fil,dtmu,1,0);
+	filNodes2Angles(fil,-1,-1);
+	return; }
+
+
+/* filRK4Step */
+void filRK4Step(filamentptr fil,double dtmu) {
+	filComputeForces(fil,-1,-1);						// copy initial state to nodes1/roll1, then take a half step and add to nodes2/roll2
+	filCopyWorkingNodes(fil,0,1);
+	filStepDynamics(fil,dtmu/6,0,2);
+	filStepDynamics(fil,dtmu/2,0,0);
+	filNodes2Angles(fil,-1,-1);
+
+	filComputeForces(fil,-1,-1);						// with new force, take half step from initial state, and add to nodes2/roll2
+	filStepDynamics(fil,dtmu/2,1,0);
+	filStepDynamics(fil,dtmu/3,2,2);
+	filNodes2Angles(fil,-1,-1);
 
-	for(f=0;f<filtype->nfil;f++) {							// compute force from new state and then take full step from initial state
-		fil=filtype->fillist[f];
-		filComputeForces(fil,-1,-1);
-		filStepDynamics(fil,dtmu,1,0);
-		filNodes2Angles(fil,-1,-1); }
+	filComputeForces(fil,-1,-1);						// with new force, take full step from initial state, and add to nodes2/roll2
+	filStepDynamics(fil,dtmu,1,0);
+	filStepDynamics(fil,dtmu/3,2,2);
+	filNodes2Angles(fil,-1,-1);
 
+	filComputeForces(fil,-1,-1);						// with new force, add to nodes2/roll2
+	filStepDynamics(fil,dtmu/6,2,0);
+	filNodes2Angles(fil,-1,-1);
 	return; }
 
 
 /* filRK4Dynamics */
-void filRK4Dynamics(simptr sim,filamenttypeptr filtype) {
-	int f;
-	double dtmu;
-	filamentptr fil;
+void filRK4Dynamics(simptr sim,filamentptr fil) {
+	filRK4Step(fil,fil->filtype->mobility*sim->dt);
+	return; }
+
 
-	dtmu=filtype->mobility*sim->dt;
-	for(f=0;f<filtype->nfil;f++) {						// copy initial state to nodes1/roll1, then take a half step and add to nodes2/roll2
-		fil=filtype->fillist[f];
-		filComputeForces(fil,-1,-1);
-		filCopyWorkingNodes(fil,0,1);
-		filStepDynamics(fil,dtmu/6,0,2);
-		filStepDynamics(fil,dtmu/2,0,0);
-		filNodes2Angles(fil,-1,-1); }
-
-	for(f=0;f<filtype->nfil;f++) {							// with new force, take half step from initial state, and add to nodes2/roll2
-		fil=filtype->fillist[f];
-		filComputeForces(fil,-1,-1);
-		filStepDynamics(fil,dtmu/2,1,0);
-		filStepDynamics(fil,dtmu/3,2,2);
-		filNodes2Angles(fil,-1,-1); }
-
-	for(f=0;f<filtype->nfil;f++) {							// with new force, take full step from initial state, and add to nodes2/roll2
-		fil=filtype->fillist[f];
-		filComputeForces(fil,-1,-1);
-		filStepDynamics(fil,dtmu,1,0);
-		filStepDynamics(fil,dtmu/3,2,2);
-		filNodes2Angles(fil,-1,-1); }
-
-	for(f=0;f<filtype->nfil;f++) {							// with new force, add to nodes2/roll2
-		fil=filtype->fillist[f];
-		filComputeForces(fil,-1,-1);
-		filStepDynamics(fil,dtmu/6,2,0);
-		filNodes2Angles(fil,-1,-1); }
+/* filAdaptiveDynamics */
+void filAdaptiveDynamics(simptr sim,filamentptr fil) {
+	double t,h,hmin,err,dx,fac,tol,mobility,**nodes,**nodes4;
+	int node,d,dim,last;
+	filamentworkptr filwork;
 
+	filwork=fil->filwork;
+	dim=sim->dim;
+	tol=fil->filtype->adapttol;
+	mobility=fil->filtype->mobility;
+	hmin=1e-6*sim->dt;
+	h=(filwork->adaptdt>0 && filwork->adaptdt<sim->dt)?filwork->adaptdt:sim->dt;
+	filwork->substeps=filwork->subrejects=0;
+	nodes=filwork->wnodes[0];
+	nodes4=filwork->wnodes[4];
+
+	for(t=0;t<sim->dt;) {
+		last=(t+h>=sim->dt);
+		if(last) h=sim->dt-t;
+		filCopyWorkingNodes(fil,0,3);												// save initial state in 3
+		filRK4Step(fil,mobility*h);													// one full step, saved in 4
+		filCopyWorkingNodes(fil,0,4);
+		filCopyWorkingNodes(fil,3,0);												// two half steps from initial state
+		if(dim==3) filCopyYpr2ToRoll(fil);
+		filNodes2Angles(fil,-1,-1);
+		filRK4Step(fil,mobility*h/2);
+		filRK4Step(fil,mobility*h/2);
+
+		err=0;																							// Richardson error estimate for RK4
+		for(node=0;node<=fil->nseg;node++)
+			for(d=0;d<dim;d++) {
+				dx=fabs(nodes[node][d]-nodes4[node][d]);
+				if(dx>err) err=dx; }
+		err/=15.0;
+
+		fac=(err>0)?0.9*pow(tol/err,0.2):5;
+		if(fac>5) fac=5;
+		else if(fac<0.2) fac=0.2;
+		if(err<=tol || h<=hmin) {														// accept
+			t=last?sim->dt:t+h;
+			filwork->substeps++;
+			if(!last || fac<1) filwork->adaptdt=h*fac; }
+		else {																							// reject and retry from initial state
+			filCopyWorkingNodes(fil,3,0);
+			if(dim==3) filCopyYpr2ToRoll(fil);
+			filNodes2Angles(fil,-1,-1);
+			filwork->subrejects++; }
+		h*=fac;
+		if(h<hmin) h=hmin; }
 	return; }
 
 
 /* filEulerMatDynamics */
-void filEulerMatDynamics(simptr sim,filamenttypeptr filtype) {	//?? This ignores nodemobility
+void filEulerMatDynamics(simptr sim,filamentptr fil) {	//?? This ignores nodemobility
 	double dtmu;
-	int f;
-	filamentptr fil;
 	filamentworkptr filwork;
 
-	for(f=0;f<filtype->nfil;f++) {
-		fil=filtype->fillist[f];
-		filwork=fil->filwork;
-
-		filComputeForceMatrix(fil);
-		filFlattenNodes(fil,0,0);
-		dtmu=filtype->mobility*sim->dt;
-		sparseMultiplyScalarM(filwork->forcemat,dtmu);
-		sparseAddIdentityM(filwork->forcemat,1);
-		sparseMultiplyMV(filwork->forcemat,filwork->flatnodes[0],filwork->flatnodes[1]);
-		filUnflattenNodes(fil,1,0);
-		filNodes2Angles(fil,-1,-1); }
-
+	filwork=fil->filwork;
+	filComputeForceMatrix(fil);
+	filFlattenNodes(fil,0,0);
+	dtmu=fil->filtype->mobility*sim->dt;
+	sparseMultiplyScalarM(filwork->forcemat,dtmu);
+	sparseAddIdentityM(filwork->forcemat,1);
+	sparseMultiplyMV(filwork->forcemat,filwork->flatnodes[0],filwork->flatnodes[1]);
+	filUnflattenNodes(fil,1,0);
+	filNodes2Angles(fil,-1,-1);
 	return; }
 
 
 /* filImplicitOldDynamics */
-void filImplicitOldDynamics(simptr sim,filamenttypeptr filtype) {	//?? This ignores nodemobility
+void filImplicitOldDynamics(simptr sim,filamentptr fil) {	//?? This ignores nodemobility
 	double dtmu;
-	int f;
-	filamentptr fil;
 	filamentworkptr filwork;
 	sparsematrix forcemat;
 
-	for(f=0;f<filtype->nfil;f++) {
-		fil=filtype->fillist[f];
-		filwork=fil->filwork;
-		forcemat=filwork->forcemat;
-		if(!forcemat->BiCGSTAB)
+	filwork=fil->filwork;
+	forcemat=filwork->forcemat;
+
+	filComputeForceMatrix(fil);
+	filFlattenNodes(fil,0,0);													// flatnodes[0] is current state
+	dtmu=fil->filtype->mobility*sim->dt;
+	sparseMultiplyScalarM(forcemat,dtmu);
+	sparseAddIdentityM(forcemat,1);										// forcemat is 1+dtmu*force
+	sparseMultiplyMV(forcemat,filwork->flatnodes[0],filwork->flatnodes[1]);	// flatnodes[1] is forward Euler next state
+
+	sparseMultiplyScalarM(forcemat,-1);
+	sparseAddIdentityM(forcemat,2);										// forcemat is 1-dtmu*force
+	if(sparseSolveM(forcemat,filwork->flatnodes[0],filwork->flatnodes[1])) {	// flatnodes[1] is backward Euler next state
+		if(!forcemat->BiCGSTAB)													// fall back to iterative solver for zero pivot
 			sparseAllocBandM(forcemat,-1,-1,1);
-
-		filComputeForceMatrix(fil);
-		filFlattenNodes(fil,0,0);													// flatnodes[0] is current state
-		dtmu=filtype->mobility*sim->dt;
-		sparseMultiplyScalarM(forcemat,dtmu);
-		sparseAddIdentityM(forcemat,1);										// forcemat is 1+dtmu*force
-		sparseMultiplyMV(forcemat,filwork->flatnodes[0],filwork->flatnodes[1]);	// flatnodes[1] is forward Euler next state
-
-		sparseMultiplyScalarM(forcemat,-1);
-		sparseAddIdentityM(forcemat,2);										// forcemat is 1-dtmu*force
-		sparseBiCGSTAB(forcemat,filwork->flatnodes[0],filwork->flatnodes[1],1e-9);	// flatnodes[1] is backward Euler next state
-		filUnflattenNodes(fil,1,0);
-		filNodes2Angles(fil,-1,-1); }
-
+		sparseBiCGSTAB(forcemat,filwork->flatnodes[0],filwork->flatnodes[1],1e-9); }
+	filUnflattenNodes(fil,1,0);
+	filNodes2Angles(fil,-1,-1);
 	return; }
 
 
 
 /* filImplicitDynamics */
-void filImplicitDynamics(simptr sim,filamenttypeptr filtype) {	//?? This ignores nodemobility
+void filImplicitDynamics(simptr sim,filamentptr fil) {	//?? This ignores nodemobility
 	double dtmu,**flatnodes,**flatforces;
-	int f,flatsize,dim;
-	filamentptr fil;
+	int flatsize,dim;
 	filamentworkptr filwork;
 	sparsematrix forcemat;
 
-	dim=filtype->filss->sim->dim;
-	for(f=0;f<filtype->nfil;f++) {
-		fil=filtype->fillist[f];
-		filwork=fil->filwork;
-		forcemat=filwork->forcemat;
-		flatnodes=filwork->flatnodes;
-		flatforces=filwork->flatforces;
-		flatsize=(dim==2) ? 2*(fil->nseg+1) : 4*(fil->nseg+1)-1;
-		if(!forcemat->BiCGSTAB)
+	dim=sim->dim;
+	filwork=fil->filwork;
+	forcemat=filwork->forcemat;
+	flatnodes=filwork->flatnodes;
+	flatforces=filwork->flatforces;
+	flatsize=(dim==2) ? 2*(fil->nseg+1) : 4*(fil->nseg+1)-1;
+
+	dtmu=fil->filtype->mobility*sim->dt;
+	filComputeDerivForceMat(fil,dtmu);															// nodes are in flatnodes[0], forces are in flatforces[0], F0 is in flatforces[1] and F1 is in forcemat
+	sumVD(1,flatnodes[0],dtmu,flatforces[0],flatnodes[1],flatsize);	// flatnodes[1] is forward Euler next state
+	sumVD(1,flatnodes[0],dtmu,flatforces[1],flatnodes[2],flatsize);	// flatnodes[2] is x(t)+dtmu*F0
+
+	sparseMultiplyScalarM(forcemat,-dtmu);
+	sparseAddIdentityM(forcemat,1);																	// forcemat is 1-dtmu*force
+	if(sparseSolveM(forcemat,flatnodes[2],flatnodes[1])) {					// flatnodes[1] is backward Euler next state
+		if(!forcemat->BiCGSTAB)																				// fall back to iterative solver for zero pivot
 			sparseAllocBandM(forcemat,-1,-1,1);
+		sparseBiCGSTAB(forcemat,flatnodes[2],flatnodes[1],1e-9); }
+	filUnflattenNodes(fil,1,0);
+	filNodes2Angles(fil,-1,-1);
+	return; }
 
-		dtmu=filtype->mobility*sim->dt;
-		filComputeDerivForceMat(fil,dtmu);															// nodes are in flatnodes[0], forces are in flatforces[0], F0 is in flatforces[1] and F1 is in forcemat
-		sumVD(1,flatnodes[0],dtmu,flatforces[0],flatnodes[1],flatsize);	// flatnodes[1] is forward Euler next state
-		sumVD(1,flatnodes[0],dtmu,flatforces[1],flatnodes[2],flatsize);	// flatnodes[2] is x(t)+dtmu*F0
 
-		sparseMultiplyScalarM(forcemat,-dtmu);
-		sparseAddIdentityM(forcemat,1);																	// forcemat is 1-dtmu*force
-		sparseBiCGSTAB(forcemat,flatnodes[2],flatnodes[1],1e-9);				// flatnodes[1] is backward Euler next state
-		filUnflattenNodes(fil,1,0);
-		filNodes2Angles(fil,-1,-1); }
+/* Work assignment for one thread of filament dynamics */
+typedef struct filthreadstruct {
+	simptr sim;												// simulation structure
+	filamenttypeptr filtype;					// filament type being integrated
+	void (*dynamics)(simptr,filamentptr);	// per-filament integrator
+	int fmin;													// first filament for this thread
+	int fmax;													// one past last filament for this thread
+	struct randstatestruct rng;				// RNG for thermal forces
+	} *filthreadptr;
+
+
+/* filDynamicsThread */
+void *filDynamicsThread(void *arg) {
+	filthreadptr thread;
+	filamentptr fil;
+	int f;
+
+	thread=(filthreadptr) arg;
+	for(f=thread->fmin;f<thread->fmax;f++) {
+		fil=thread->filtype->fillist[f];
+		fil->filwork->rng=&thread->rng;
+		thread->dynamics(thread->sim,fil);
+		fil->filwork->rng=NULL; }
+	return NULL; }
 
-	return; }
 
+/* filTypeDynamics */
+void filTypeDynamics(simptr sim,filamenttypeptr filtype) {
+	void (*dynamics)(simptr,filamentptr);
+	int f;
+#ifdef HAVE_PTHREAD
+	filthreadptr threads;
+	pthread_t *tids;
+	int nthreads,th,nstarted;
+#endif
+
+	if(filtype->dynamics==FDeuler) dynamics=filEulerDynamics;
+	else if(filtype->dynamics==FDRK2) dynamics=filRK2Dynamics;
+	else if(filtype->dynamics==FDRK4) dynamics=filRK4Dynamics;
+	else if(filtype->dynamics==FDeulermat) dynamics=filEulerMatDynamics;
+	else if(filtype->dynamics==FDimplicit) dynamics=filImplicitDynamics;
+	else if(filtype->dynamics==FDimplicitold) dynamics=filImplicitOldDynamics;
+	else if(filtype->dynamics==FDadaptive) dynamics=filAdaptiveDynamics;
+	else return;
+
+#ifdef HAVE_PTHREAD
+	nthreads=filtype->nthreads;
+	if(nthreads>filtype->nfil) nthreads=filtype->nfil;
+	threads=NULL;
+	tids=NULL;
+	if(nthreads>1) {													// if memory runs out, this falls back to serial
+		threads=(filthreadptr) calloc(nthreads,sizeof(struct filthreadstruct));
+		tids=(pthread_t*) calloc(nthreads,sizeof(pthread_t));
+		if(!threads || !tids) {
+			free(threads);
+			free(tids);
+			threads=NULL; }}
+
+	if(threads) {															// parallel, with filaments split into contiguous blocks
+		for(th=0;th<nthreads;th++) {
+			threads[th].sim=sim;
+			threads[th].filtype=filtype;
+			threads[th].dynamics=dynamics;
+			threads[th].fmin=th*filtype->nfil/nthreads;
+			threads[th].fmax=(th+1)*filtype->nfil/nthreads;
+			randseedR(&threads[th].rng,randULI()); }
+		nstarted=1;
+		for(th=1;th<nthreads;th++)
+			if(pthread_create(&tids[th],NULL,filDynamicsThread,&threads[th])==0) nstarted++;
+			else break;
+		filDynamicsThread(&threads[0]);
+		for(th=1;th<nstarted;th++)
+			pthread_join(tids[th],NULL);
+		for(;th<nthreads;th++)									// finish any blocks whose threads failed to start
+			filDynamicsThread(&threads[th]);
+		free(tids);
+		free(threads);
+		return; }
+#endif
+
+	for(f=0;f<filtype->nfil;f++)
+		dynamics(sim,filtype->fillist[f]);
+	return; }
 
 
 /* filDynamics */
@@ -3257,6 +3686,7 @@ int filDynamics(simptr sim) {
 	filamentptr fil;
 	filamenttypeptr filtype;
 	int f,ft,i,treadnum;
+	struct timespec tstart,tstop;
 
 	filss=sim->filss;
 	if(!filss) return 0;
@@ -3270,19 +3700,21 @@ int filDynamics(simptr sim) {
 				for(i=0;i<treadnum;i++)
 					filTreadmill(sim,fil,filtype->treadrate>0?'b':'f'); }}
 
-		if(filtype->dynamics==FDeuler)
-			filEulerDynamics(sim,filtype);
-		else if(filtype->dynamics==FDRK2)
-			filRK2Dynamics(sim,filtype);
-		else if(filtype->dynamics==FDRK4)
-			filRK4Dynamics(sim,filtype);
-		else if(filtype->dynamics==FDeulermat)
-			filEulerMatDynamics(sim,filtype);
-		else if(filtype->dynamics==FDimplicit)
-			filImplicitDynamics(sim,filtype);
-		else if(filtype->dynamics==FDimplicitold)
-			filImplicitOldDynamics(sim,filtype);
-			}
+		if(filtype->dynamics!=FDnone) {
+			timespec_get(&tstart,TIME_UTC);
+			filTypeDynamics(sim,filtype);
+			timespec_get(&tstop,TIME_UTC);
+			filss->dyntime+=difftime(tstop.tv_sec,tstart.tv_sec)+1e-9*(tstop.tv_nsec-tstart.tv_nsec);
+			for(f=0;f<filtype->nfil;f++) {
+				fil=filtype->fillist[f];
+				if(filtype->dynamics==FDadaptive) {
+					filss->dynsegs+=fil->nseg*fil->filwork->substeps;
+					filss->adaptsteps++;
+					filss->substeps+=fil->filwork->substeps;
+					filss->subrejects+=fil->filwork->subrejects; }
+				else
+					filss->dynsegs+=fil->nseg;
+				fil->boxvalid=0; }}}
 
 	return 0; }
 
@@ -24,6 +24,12 @@
 #include "smoldynfuncs.h"
 #include "smoldynconfigure.h"
 
+#ifdef HAVE_PTHREAD
+	#include <pthread.h>
+#endif
+
+#define MAXIMAGEPIXELS 16777216					// largest offscreen image, in pixels
+
 /******************************************************************************/
 /*********************************** Graphics *********************************/
 /******************************************************************************/
@@ -51,12 +57,26 @@ int graphicsupdatelists(simptr sim);
 int graphicsupdateparams(simptr sim);
 
 // core simulation functions
+int graphicssnapshot(simptr sim,molsnapptr snap);
 void RenderSurfaces(simptr sim);
 void RenderMolecs(simptr sim);
 void RenderText(simptr sim);
 void RenderSim(simptr sim,int swapbuffers);
 
+// offscreen rendering
+void offscreenfree(struct offscreenstruct *offscrn);
+#ifdef HAVE_PTHREAD
+void *offscreenthread(void *arg);
+#endif
+
 // top level OpenGL functions
+#ifdef HAVE_PTHREAD
+int simthreadstart(simptr sim);
+void *simthreadfunc(void *arg);
+void simthreadhold(struct simthreadstruct *thr,int hold);
+void simthreadstop(struct simthreadstruct *thr);
+int simthreaddefer(simptr sim);
+#endif
 
 /******************************************************************************/
 /******************************* enumerated types *****************************/
@@ -202,7 +222,7 @@ int graphicsreadcolor(char **stringptr,double *rgba) {
 /* graphssalloc */
 graphicsssptr graphssalloc(void) {
 	graphicsssptr graphss;
-	int lt;
+	int lt,i;
 
 	graphss=NULL;
 	CHECKMEM(graphss=(graphicsssptr) malloc(sizeof(struct graphicssuperstruct)));
@@ -214,6 +234,9 @@ graphicsssptr graphssalloc(void) {
 	graphss->graphicit=20;
 	graphss->graphicdelay=0;
 	graphss->tiffit=0;
+	gl2GetString("TiffNameDefault",graphss->tiffname);
+	graphss->tiffnumber=(int)gl2GetNumber("TiffNumberDefault");
+	graphss->tiffnummax=(int)gl2GetNumber("TiffNumMaxDefault");
 	graphss->framepts=2;
 	graphss->gridpts=0;
 
@@ -244,6 +267,28 @@ graphicsssptr graphssalloc(void) {
 	graphicssetlight(NULL,graphss,-1,LPauto,NULL);
 	for(lt=0;lt<MAXLIGHTS;lt++) graphicssetlight(NULL,graphss,lt,LPauto,NULL);
 
+	graphss->offscreen=0;
+	graphss->imageformat=0;
+	graphss->imagesize[0]=400;
+	graphss->imagesize[1]=400;
+	graphss->offscrn=NULL;
+
+	for(i=0;i<3;i++) {
+		graphss->snap[i].maxmolpos=0;
+		graphss->snap[i].molpos=NULL;
+		graphss->snap[i].maxmolgroup=0;
+		graphss->snap[i].ngroup=0;
+		graphss->snap[i].molgroup=NULL;
+		graphss->snap[i].groupstyle=NULL;
+		graphss->snap[i].time=0;
+		graphss->snap[i].tiff=0;
+		graphss->snap[i].text[0]='\0';
+		graphss->snap[i].graphics=0;
+		graphss->snap[i].framepts=0;
+		graphss->snap[i].gridpts=0; }
+	graphss->simthrd=NULL;
+	graphss->spherelist=0;
+
 	return graphss;
 	
 failure:
@@ -254,9 +299,17 @@ failure:
 
 /* graphssfree */
 void graphssfree(graphicsssptr graphss) {
-	int item;
+	int item,i;
 
 	if(!graphss) return;
+#ifdef HAVE_PTHREAD
+	simthreadstop(graphss->simthrd);
+#endif
+	offscreenfree(graphss->offscrn);
+	for(i=0;i<3;i++) {
+		free(graphss->snap[i].molpos);
+		free(graphss->snap[i].molgroup);
+		free(graphss->snap[i].groupstyle); }
 	for(item=0;item<graphss->maxtextitems;item++) free(graphss->textitems[item]);
 	free(graphss->textitems);
 	free(graphss);
@@ -281,10 +334,12 @@ void graphssoutput(simptr sim) {
 		return; }
 
 	simLog(sim,2," display: ");
-	if(graphss->graphics==1) simLog(sim,2,"OpenGL");
+	if(graphss->offscreen) simLog(sim,2,"offscreen%s",graphss->graphics==2?"_good":graphss->graphics==3?"_better":"");
+	else if(graphss->graphics==1) simLog(sim,2,"OpenGL");
 	else if(graphss->graphics==2) simLog(sim,2,"OpenGL_good");
 	else if(graphss->graphics==3) simLog(sim,2,"OpenGL_better");
-	simLog(sim,2,", every %i iterations\n",graphss->graphicit);
+	if(graphss->offscreen) simLog(sim,2,", %i x %i %s images\n",graphss->imagesize[0],graphss->imagesize[1],graphss->imageformat==1?"PNG":"TIFF");
+	else simLog(sim,2,", every %i iterations\n",graphss->graphicit);
 	if(graphss->graphicdelay>0) simLog(sim,2," delay per frame: %ui ms\n",graphss->graphicdelay);
 
 	simLog(sim,2," frame thickness: %g|L",graphss->framepts);
@@ -311,11 +366,10 @@ void graphssoutput(simptr sim) {
 			simLog(sim,2,"  diffuse: %g %g %g %g\n",graphss->difflight[lt][0],graphss->difflight[lt][1],graphss->difflight[lt][2],graphss->difflight[lt][3]);
 			simLog(sim,2,"  specular: %g %g %g %g\n",graphss->speclight[lt][0],graphss->speclight[lt][1],graphss->speclight[lt][2],graphss->speclight[lt][3]); }
 
-	gl2GetString("TiffName",string1);
 	gl2GetString("TiffNameDefault",string2);
-	i1=(int)gl2GetNumber("TiffNumber");
-	i2=(int)gl2GetNumber("TiffNumMax");
-	if(strcmp(string1,string2)) simLog(sim,2," TIFF name: %s\n",string1);
+	i1=graphss->tiffnumber;
+	i2=graphss->tiffnummax;
+	if(strcmp(graphss->tiffname,string2)) simLog(sim,2," TIFF name: %s\n",graphss->tiffname);
 	if(i1!=(int)gl2GetNumber("TiffNumberDefault") || i2!=(int)gl2GetNumber("TiffNumMaxDefault"))
 		simLog(sim,2," TIFFs numbered from %i to %i\n",i1,i2);
 	simLog(sim,2,"\n");
@@ -333,6 +387,7 @@ void writegraphss(simptr sim,FILE *fptr) {
 
 	fprintf(fptr,"# Graphics parameters\n");
 	if(graphss->graphics==0) fprintf(fptr,"graphics none\n");
+	else if(graphss->offscreen) fprintf(fptr,"graphics offscreen%s\n",graphss->graphics==2?"_good":graphss->graphics==3?"_better":"");
 	else if(graphss->graphics==1) fprintf(fptr,"graphics opengl\n");
 	else if(graphss->graphics==2) fprintf(fptr,"graphics opengl_good\n");
 	else if(graphss->graphics==3) fprintf(fptr,"graphics opengl_better\n");
@@ -340,9 +395,12 @@ void writegraphss(simptr sim,FILE *fptr) {
 	if(graphss->graphicdelay>0) fprintf(fptr,"graphic_delay %ui\n",graphss->graphicdelay);
 
 	if(graphss->tiffit>0) fprintf(fptr,"tiff_iter %i\n",graphss->tiffit);
-	fprintf(fptr,"tiff_name %s\n",gl2GetString("TiffName",string));
-	fprintf(fptr,"tiff_min %i\n",gl2SetOptionInt("TiffNumber",-1));
-	fprintf(fptr,"tiff_max %i\n",gl2SetOptionInt("TiffNumMax",-1));
+	fprintf(fptr,"tiff_name %s\n",graphss->tiffname);
+	fprintf(fptr,"tiff_min %i\n",graphss->tiffnumber);
+	fprintf(fptr,"tiff_max %i\n",graphss->tiffnummax);
+	if(graphss->offscreen) {
+		fprintf(fptr,"image_format %s\n",graphss->imageformat==1?"png":"tiff");
+		fprintf(fptr,"image_size %i %i\n",graphss->imagesize[0],graphss->imagesize[1]); }
 
 	fprintf(fptr,"frame_thickness %g\n",graphss->framepts);
 	fprintf(fptr,"frame_color %g %g %g %g\n",graphss->framecolor[0],graphss->framecolor[1],graphss->framecolor[2],graphss->framecolor[3]);
@@ -408,19 +466,23 @@ void graphicssetcondition(graphicsssptr graphss,enum StructCond cond,int upgrade
 /* graphicsenablegraphics */
 int graphicsenablegraphics(simptr sim,const char *type) {
 	graphicsssptr graphss;
-	int code;
+	int code,offscreen;
 
 	if(!sim) return 2;
 
+	offscreen=0;
 	if(type) {
 		if(!strcmp(type,"none")) code=0;
 		else if(!strcmp(type,"opengl")) code=1;
 		else if(!strcmp(type,"opengl_good")) code=2;
 		else if(!strcmp(type,"opengl_better")) code=3;
+		else if(!strcmp(type,"offscreen")) {code=1;offscreen=1;}
+		else if(!strcmp(type,"offscreen_good")) {code=2;offscreen=1;}
+		else if(!strcmp(type,"offscreen_better")) {code=3;offscreen=1;}
 		else return 3; }
 	else code=-1;
 
-	if(sim->graphss && (code==-1 || sim->graphss->graphics==code)) return 0;
+	if(sim->graphss && (code==-1 || (sim->graphss->graphics==code && sim->graphss->offscreen==offscreen))) return 0;
 	if(!sim->graphss && code==0) return 0;
 
 	if(!sim->graphss) {
@@ -429,7 +491,9 @@ int graphicsenablegraphics(simptr sim,const char *type) {
 		sim->graphss=graphss;
 		graphss->sim=sim; }
 	else graphss=sim->graphss;
-	if(code>=0) graphss->graphics=code;
+	if(code>=0) {
+		graphss->graphics=code;
+		graphss->offscreen=offscreen; }
 	graphicssetcondition(graphss,SClists,0);
 	return 0; }
 
@@ -456,6 +520,27 @@ int graphicssettiffiter(simptr sim,int iter) {
 	return 0; }
 
 
+/* graphicssettiffparams */
+int graphicssettiffparams(simptr sim,const char *name,int number,int nummax) {
+	int er;
+	graphicsssptr graphss;
+
+	er=graphicsenablegraphics(sim,NULL);
+	if(er) return er;
+	graphss=sim->graphss;
+	if(name) {																			// OpenGL window saves with the gl2 values
+		strncpy(graphss->tiffname,name,STRCHAR-1);
+		graphss->tiffname[STRCHAR-1]='\0';
+		gl2SetOptionStr("TiffName",name); }
+	if(number>=0) {
+		graphss->tiffnumber=number;
+		gl2SetOptionInt("TiffNumber",number); }
+	if(nummax>=0) {
+		graphss->tiffnummax=nummax;
+		gl2SetOptionInt("TiffNumMax",nummax); }
+	return 0; }
+
+
 /* graphicssetdelay */
 int graphicssetdelay(simptr sim,int delay) {
 	int er;
@@ -657,6 +742,25 @@ int graphicssetlight(simptr sim,graphicsssptr graphss,int lt,enum LightParam ltp
 	return 0; }
 
 
+/* graphicssetimage */
+int graphicssetimage(simptr sim,const char *format,int width,int height) {
+	int er,imageformat;
+
+	er=graphicsenablegraphics(sim,NULL);
+	if(er) return er;
+	imageformat=sim->graphss->imageformat;
+	if(format && format[0]) {
+		if(!strcmp(format,"tiff") || !strcmp(format,"tif")) imageformat=0;
+		else if(!strcmp(format,"png")) imageformat=1;
+		else return 3; }
+	if(width==0 || height==0 || width>65535 || height>65535) return 4;
+	if((double)(width>0?width:sim->graphss->imagesize[0])*(height>0?height:sim->graphss->imagesize[1])>MAXIMAGEPIXELS) return 4;
+	sim->graphss->imageformat=imageformat;
+	if(width>0) sim->graphss->imagesize[0]=width;
+	if(height>0) sim->graphss->imagesize[1]=height;
+	return 0; }
+
+
 /******************************************************************************/
 /************************** structure update functions ************************/
 /******************************************************************************/
@@ -671,7 +775,7 @@ int graphicsupdateinit(simptr sim) {
 
 	graphss=sim->graphss;
 	tflag=strchr(sim->flags,'t')?1:0;
-	if(tflag || graphss->graphics==0) return 0;
+	if(tflag || graphss->graphics==0 || graphss->offscreen) return 0;
 
 	qflag=strchr(sim->flags,'q')?1:0;
 	gl2glutInit(NULL,NULL);
@@ -701,7 +805,7 @@ int graphicsupdatelists(simptr sim) {
 
 	graphss=sim->graphss;
 	tflag=strchr(sim->flags,'t')?1:0;
-	if(tflag || graphss->graphics==0) return 0;
+	if(tflag || graphss->graphics==0 || graphss->offscreen) return 0;
 
 	if(graphss->graphics>=3) {
 		glEnable(GL_LIGHTING);
@@ -723,7 +827,7 @@ int graphicsupdateparams(simptr sim) {
 
 	graphss=sim->graphss;
 	tflag=strchr(sim->flags,'t')?1:0;
-	if(tflag || graphss->graphics==0) return 0;
+	if(tflag || graphss->graphics==0 || graphss->offscreen) return 0;
 
 	glClearColor((GLclampf)graphss->backcolor[0],(GLclampf)graphss->backcolor[1],(GLclampf)graphss->backcolor[2],(GLclampf)graphss->backcolor[3]);
 	if(graphss->graphics>=3) {
@@ -752,6 +856,9 @@ int graphicsupdate(simptr sim) {
 	graphicsssptr graphss;
 
 	graphss=sim->graphss;
+#ifdef HAVE_PTHREAD
+	if(graphss && graphss->condition!=SCok && simthreaddefer(sim)) return 0;
+#endif
 	if(graphss) {
 		if(graphss->condition==SCinit) {
 			er=graphicsupdateinit(sim);
@@ -1257,59 +1364,176 @@ void RenderFilaments(simptr sim) {
 	return; }
 
 
-/* RenderMolecs */
-void RenderMolecs(simptr sim) {
-#ifdef __gl_h_
+/* graphicssnapshot */
+int graphicssnapshot(simptr sim,molsnapptr snap) {
+	graphicsssptr graphss;
 	molssptr mols;
 	moleculeptr mptr;
-	int ll,m,i,dim;
-	double ymid,zmid;
+	boxssptr boxs;
+	int ll,m,i,g,ngroup,nmol,d,dim,item,*index;
 	enum MolecState ms;
-	GLfloat whitecolor[]={1,1,1,1};
-	GLfloat glf1[4];
+	float *newpos,*newstyle,*pos;
+	int *newgroup;
+	double ymid,zmid;
+	char *itemname,string[STRCHARLONG];
 
-	dim=sim->dim;
+	graphss=sim->graphss;
 	mols=sim->mols;
-	if(!mols) return;
+	boxs=sim->boxs;
+	dim=sim->dim;
+	snap->time=sim->time;
+	snap->tiff=0;
+
+	snap->graphics=graphss->graphics;									// display settings
+	snap->framepts=graphss->framepts;
+	snap->gridpts=boxs?graphss->gridpts:0;
+	for(i=0;i<4;i++) {
+		snap->framecolor[i]=graphss->framecolor[i];
+		snap->gridcolor[i]=graphss->gridcolor[i];
+		snap->textcolor[i]=graphss->textcolor[i]; }
+	for(d=0;d<3;d++) {
+		snap->framelo[d]=snap->framehi[d]=0;
+		snap->gridlo[d]=snap->gridhi[d]=0;
+		snap->gridside[d]=1; }
+	for(d=0;d<dim;d++) {
+		snap->framelo[d]=sim->wlist[2*d]->pos;
+		snap->framehi[d]=sim->wlist[2*d+1]->pos;
+		if(boxs) {
+			snap->gridlo[d]=boxs->min[d];
+			snap->gridhi[d]=boxs->min[d]+boxs->size[d]*boxs->side[d];
+			snap->gridside[d]=boxs->side[d]; }}
+
+	snap->text[0]='\0';																// text display
+	for(item=0;item<graphss->ntextitems;item++) {
+		itemname=graphss->textitems[item];
+		if(!strcmp(itemname,"time"))
+			 snprintf(string,STRCHARLONG,"time: %g",sim->time);
+		else if((i=molstring2index1(sim,itemname,&ms,&index))>=0 || i==-5)
+			snprintf(string,STRCHARLONG,"%s: %i",itemname,molcount(sim,i,index,ms,-1));
+		else if(sim->ruless)
+			snprintf(string,STRCHARLONG,"%s: 0",itemname);
+		else
+			snprintf(string,STRCHARLONG,"syntax error");
+
+		if(STRCHARLONG-strlen(snap->text)>strlen(string))
+			strcat(snap->text,string);
+		if(item+1<graphss->ntextitems)
+			strncat(snap->text,", ",STRCHARLONG-3-strlen(snap->text)); }
+
+	snap->ngroup=0;
+	if(!mols) return 0;
+	ngroup=mols->nspecies*MSMAX;
+	if(ngroup>snap->maxmolgroup) {
+		newgroup=(int*) realloc(snap->molgroup,ngroup*sizeof(int));
+		if(!newgroup) return 1;
+		snap->molgroup=newgroup;
+		newstyle=(float*) realloc(snap->groupstyle,4*ngroup*sizeof(float));
+		if(!newstyle) return 1;
+		snap->groupstyle=newstyle;
+		snap->maxmolgroup=ngroup; }
+	for(g=0;g<ngroup;g++) {
+		i=g/MSMAX;
+		ms=(enum MolecState) (g%MSMAX);
+		snap->molgroup[g]=0;
+		snap->groupstyle[4*g]=(float)mols->display[i][ms];
+		for(d=0;d<3;d++) snap->groupstyle[4*g+1+d]=(float)mols->color[i][ms][d]; }
+
+	for(ll=0;ll<mols->nlist;ll++)											// count displayed molecules in each group
+		if(mols->listtype[ll]==MLTsystem)
+			for(m=0;m<mols->nl[ll];m++) {
+				mptr=mols->live[ll][m];
+				if(mols->display[mptr->ident][mptr->mstate]>0)
+					snap->molgroup[mptr->ident*MSMAX+mptr->mstate]++; }
+	nmol=0;
+	for(g=0;g<ngroup;g++) {														// group starts
+		m=snap->molgroup[g];
+		snap->molgroup[g]=nmol;
+		nmol+=m; }
+
+	if(nmol>snap->maxmolpos) {
+		m=nmol>2*snap->maxmolpos?nmol:2*snap->maxmolpos;
+		newpos=(float*) realloc(snap->molpos,3*m*sizeof(float));
+		if(!newpos) return 1;
+		snap->molpos=newpos;
+		snap->maxmolpos=m; }
+
 	ymid=gl2GetNumber("ClipMidy");
 	zmid=gl2GetNumber("ClipMidz");
+	for(ll=0;ll<mols->nlist;ll++)											// copy positions, leaving group ends
+		if(mols->listtype[ll]==MLTsystem)
+			for(m=0;m<mols->nl[ll];m++) {
+				mptr=mols->live[ll][m];
+				i=mptr->ident;
+				ms=mptr->mstate;
+				if(mols->display[i][ms]>0) {
+					pos=snap->molpos+3*snap->molgroup[i*MSMAX+ms]++;
+					for(d=0;d<dim;d++) pos[d]=(float)mptr->pos[d];
+					if(dim<2) pos[1]=(float)ymid;
+					if(dim<3) pos[2]=(float)zmid; }}
+	snap->ngroup=ngroup;
+	return 0; }
 
-	if(sim->graphss->graphics==1) {
-		for(ll=0;ll<sim->mols->nlist;ll++)
-			if(sim->mols->listtype[ll]==MLTsystem)
-				for(m=0;m<mols->nl[ll];m++) {
-					mptr=mols->live[ll][m];
-					i=mptr->ident;
-					ms=mptr->mstate;
-					if(mols->display[i][ms]>0) {
-						glPointSize((GLfloat)mols->display[i][ms]);
-						glColor3fv(gl2Double2GLfloat(mols->color[i][ms],glf1,3));
-						glBegin(GL_POINTS);
-						if(dim==1) glVertex3d((GLdouble)mptr->pos[0],(GLdouble)ymid,(GLdouble)zmid);
-						else if(dim==2) glVertex3d((GLdouble)(mptr->pos[0]),(GLdouble)(mptr->pos[1]),(GLdouble)zmid);
-						else glVertex3fv(gl2Double2GLfloat(mptr->pos,glf1,3));
-						glEnd(); }}}
-
-	else if(sim->graphss->graphics>=2) {
+
+/* RenderMolecs */
+void RenderMolecs(simptr sim) {
+#ifdef __gl_h_
+	graphicsssptr graphss;
+	molsnapptr snap;
+	int g,k,start,end;
+	float *pos,*style;
+	GLfloat whitecolor[]={1,1,1,1};
+	GLdouble size;
+
+	graphss=sim->graphss;
+	snap=&graphss->snap[0];
+
+	if(snap->graphics==1) {
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glVertexPointer(3,GL_FLOAT,0,snap->molpos);
+		start=0;
+		for(g=0;g<snap->ngroup;g++) {
+			end=snap->molgroup[g];
+			if(end>start) {
+				style=snap->groupstyle+4*g;
+				glPointSize((GLfloat)style[0]);
+				glColor3fv(style+1);
+				glDrawArrays(GL_POINTS,start,end-start); }
+			start=end; }
+		glDisableClientState(GL_VERTEX_ARRAY); }
+
+	else if(snap->graphics>=2) {
+		if(!graphss->spherelist) {										// unit sphere is tessellated once
+			graphss->spherelist=glGenLists(1);
+			if(graphss->spherelist) {
+				glNewList(graphss->spherelist,GL_COMPILE);
+				glutSolidSphere(1.0,15,15);
+				glEndList(); }}
 		glMatrixMode(GL_MODELVIEW);
 		glPolygonMode(GL_FRONT_AND_BACK,GL_FILL);
-		if(sim->graphss->graphics>=3) {
+		glPushAttrib(GL_ENABLE_BIT);
+		glEnable(GL_NORMALIZE);
+		if(snap->graphics>=3) {
 			glMaterialfv(GL_FRONT,GL_SPECULAR,whitecolor);
 			glMateriali(GL_FRONT,GL_SHININESS,30); }
-		for(ll=0;ll<sim->mols->nlist;ll++)
-			if(sim->mols->listtype[ll]==MLTsystem)
-				for(m=0;m<mols->nl[ll];m++) {
-					mptr=mols->live[ll][m];
-					i=mptr->ident;
-					ms=mptr->mstate;
-					if(mols->display[i][ms]>0) {
-						glColor3fv(gl2Double2GLfloat(mols->color[i][ms],glf1,3));
-						glPushMatrix();
-						if(dim==1) glTranslated((GLdouble)(mptr->pos[0]),(GLdouble)ymid,(GLdouble)zmid);
-						else if(dim==2) glTranslated((GLdouble)(mptr->pos[0]),(GLdouble)(mptr->pos[1]),(GLdouble)zmid);
-						else glTranslated((GLdouble)(mptr->pos[0]),(GLdouble)(mptr->pos[1]),(GLdouble)(mptr->pos[2]));
-						glutSolidSphere((GLdouble)(mols->display[i][ms]),15,15);
-						glPopMatrix(); }}}
+		start=0;
+		for(g=0;g<snap->ngroup;g++) {
+			end=snap->molgroup[g];
+			if(end>start) {
+				style=snap->groupstyle+4*g;
+				size=(GLdouble)style[0];
+				glColor3fv(style+1);
+				for(k=start;k<end;k++) {
+					pos=snap->molpos+3*k;
+					glPushMatrix();
+					glTranslatef(pos[0],pos[1],pos[2]);
+					if(graphss->spherelist) {
+						glScaled(size,size,size);
+						glCallList(graphss->spherelist); }
+					else
+						glutSolidSphere(size,15,15);
+					glPopMatrix(); }}
+			start=end; }
+		glPopAttrib(); }
 
 #endif
 	return; }
@@ -1338,7 +1562,7 @@ void RenderLattice(simptr sim) {
 		n=0;
 		for(ilat=0;ilat<lattice->nspecies;ilat++) {		// ilat is the species identity
 			ismol=lattice->species_index[ilat];
-			NSV_CALL(n = nsv_get_species_copy_numbers(lattice->nsv, ismol,&copy_numbers,&positions));
+			NSV_CALL(n = nsv_get_species_copy_numbers(lattice->type==LATTICEpde?lattice->pde:lattice->nsv, ismol,&copy_numbers,&positions));
 			for (i=0;i<n;++i) {						// n is the total number of molecules of this species, copy_numbers is how many in each site, and positions are the site positions
 				if((mols->display[ismol][MSsoln]>0)&&(copy_numbers[i]>0)) {
 					poslo[0]=positions[3*i+0]-0.5*lattice->dx[0];
@@ -1363,28 +1587,9 @@ void RenderLattice(simptr sim) {
 void RenderText(simptr sim) {
 #ifdef __gl_h_
 	graphicsssptr graphss;
-	int item,i,*index;
-	char *itemname,string[STRCHAR],string2[STRCHAR];
-	enum MolecState ms;
 
 	graphss=sim->graphss;
-	string2[0]='\0';
-	for(item=0;item<graphss->ntextitems;item++) {
-		itemname=graphss->textitems[item];
-		if(!strcmp(itemname,"time"))
-			 snprintf(string,STRCHAR,"time: %g",sim->time);
-		else if((i=molstring2index1(sim,itemname,&ms,&index))>=0 || i==-5)
-			snprintf(string,STRCHAR,"%s: %i",itemname,molcount(sim,i,index,ms,-1));
-		else if(sim->ruless)
-			snprintf(string,STRCHAR,"%s: 0",itemname);
-		else
-			snprintf(string,STRCHAR,"syntax error");
-
-		if(STRCHAR-strlen(string2)>strlen(string))
-			strcat(string2,string);
-		if(item+1<graphss->ntextitems)
-			strncat(string2,", ",STRCHAR-3); }
-	gl2DrawTextD(5,95,graphss->textcolor,GLUT_BITMAP_HELVETICA_12,string2,-1);
+	gl2DrawTextD(5,95,graphss->snap[0].textcolor,GLUT_BITMAP_HELVETICA_12,graphss->snap[0].text,-1);
 #endif
 	return; }
 
@@ -1393,65 +1598,1178 @@ void RenderText(simptr sim) {
 void RenderSim(simptr sim,int swapbuffers) {
 #ifdef __gl_h_
 	graphicsssptr graphss;
-	double pt1[DIMMAX],pt2[DIMMAX];
+	molsnapptr snap;
 	int dim;
-	wallptr *wlist;
 	GLfloat glf1[4];
 
 	clock_t timenow;
 	static clock_t oldclocktime;
 	static double oldsimtime=NAN;
+	double simtime;
 
+	graphss=sim->graphss;
+	if(!graphss || graphss->graphics==0) return;
+	simtime=graphss->simthrd?graphss->snap[0].time:sim->time;
 	timenow=clock();
-	if(swapbuffers==1 && sim->time==oldsimtime && (double)(timenow-oldclocktime)/CLOCKS_PER_SEC < 0.005)
+	if(swapbuffers==1 && simtime==oldsimtime && (double)(timenow-oldclocktime)/CLOCKS_PER_SEC < 0.005)
 		return;																					// no need to redraw
-	oldsimtime=sim->time;
+	oldsimtime=simtime;
 	oldclocktime=timenow;
 
-	graphss=sim->graphss;
-	if(!graphss || graphss->graphics==0) return;
+	if(!graphss->simthrd && graphicssnapshot(sim,&graphss->snap[0]))
+		simLog(sim,7,"WARNING: out of memory for drawing molecules\n");
+	snap=&graphss->snap[0];
 	dim=sim->dim;
-	wlist=sim->wlist;
 	if(dim<3) glClear(GL_COLOR_BUFFER_BIT);
 	else glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
 
 	if(dim==3) RenderMolecs(sim);
 
-	if(graphss->framepts) {														// draw bounding box
-		pt1[0]=wlist[0]->pos;
-		pt2[0]=wlist[1]->pos;
-		pt1[1]=dim>1?wlist[2]->pos:0;
-		pt2[1]=dim>1?wlist[3]->pos:0;
-		pt1[2]=dim>2?wlist[4]->pos:0;
-		pt2[2]=dim>2?wlist[5]->pos:0;
-		glColor4fv(gl2Double2GLfloat(graphss->framecolor,glf1,4));
-		glLineWidth((GLfloat)graphss->framepts);
-		gl2DrawBoxD(pt1,pt2,dim); }
-
-	if(graphss->gridpts) {
-		pt1[0]=sim->boxs->min[0];
-		pt2[0]=pt1[0]+sim->boxs->size[0]*sim->boxs->side[0];
-		pt1[1]=dim>1?sim->boxs->min[1]:0;
-		pt2[1]=dim>1?pt1[1]+sim->boxs->size[1]*sim->boxs->side[1]:0;
-		pt1[2]=dim>2?sim->boxs->min[2]:0;
-		pt2[2]=dim>2?pt1[2]+sim->boxs->size[2]*sim->boxs->side[2]:0;
-		glColor4fv(gl2Double2GLfloat(graphss->gridcolor,glf1,4));
-		if(dim==1) glPointSize((GLfloat)graphss->gridpts);
-		else glLineWidth((GLfloat)graphss->gridpts);
-		gl2DrawGridD(pt1,pt2,sim->boxs->side,dim); }
+	if(snap->framepts) {															// draw bounding box
+		glColor4fv(gl2Double2GLfloat(snap->framecolor,glf1,4));
+		glLineWidth((GLfloat)snap->framepts);
+		gl2DrawBoxD(snap->framelo,snap->framehi,dim); }
+
+	if(snap->gridpts) {
+		glColor4fv(gl2Double2GLfloat(snap->gridcolor,glf1,4));
+		if(dim==1) glPointSize((GLfloat)snap->gridpts);
+		else glLineWidth((GLfloat)snap->gridpts);
+		gl2DrawGridD(snap->gridlo,snap->gridhi,snap->gridside,dim); }
 
 	if(dim<3) RenderMolecs(sim);
 
-	if(sim->srfss) RenderSurfaces(sim);
-	if(sim->filss) RenderFilaments(sim);
-	if(sim->latticess) RenderLattice(sim);
-	if(graphss->ntextitems) RenderText(sim);
+	if(sim->srfss || sim->filss || sim->latticess) {
+#ifdef HAVE_PTHREAD
+		simthreadhold(graphss->simthrd,1);						// these are drawn from the live system
+#endif
+		if(sim->srfss) RenderSurfaces(sim);
+		if(sim->filss) RenderFilaments(sim);
+		if(sim->latticess) RenderLattice(sim);
+#ifdef HAVE_PTHREAD
+		simthreadhold(graphss->simthrd,0);
+#endif
+		}
+	if(snap->text[0]) RenderText(sim);
 
 	if(swapbuffers) glutSwapBuffers();
 #endif
 	return; }
 
 
+/******************************************************************************/
+/***************************** Offscreen rendering ****************************/
+/******************************************************************************/
+
+/* The offscreen renderer writes TIFF or PNG frames without a window or an
+OpenGL context.  At each tiff_iter time step, the simulation thread copies
+what is drawn into a frame: molecules as a compact list, and the frame, grid,
+surfaces, filaments, and lattices as points, lines, and triangles in system
+coordinates.  Worker threads then project, rasterize, and write the frames, so
+the simulation only pays for the copy.  The view matches the initial OpenGL
+view: orthographic for 1-D and 2-D, and a 45 degree perspective looking down
+the z-axis for 3-D. */
+
+#define OFFSCREENFRAMES 3
+#define OFFSCREENTHREADS 2
+
+typedef struct offscreenmolstruct {
+	float pos[3];											// molecule position [d]
+	float size;												// size in pixels, or radius for spheres
+	unsigned char color[4];						// molecule color [c]
+	} *offscreenmolptr;
+
+typedef struct offscreenprimstruct {
+	char type;												// 'p' for point, 'l' line, 't' triangle
+	float pt[3][3];										// vertex positions [v][d]
+	float normal[3];									// front normal for triangles [d]
+	float size;												// point size or line width in pixels
+	unsigned char fcolor[4];					// front color [c]
+	unsigned char bcolor[4];					// back color for triangles [c]
+	} *offscreenprimptr;
+
+typedef struct offscreenframestruct {
+	int status;												// 0 free, 1 filling, 2 queued, 3 rendering
+	int error;												// 1 if frame could not be built or written
+	char filename[STRCHAR];						// output file name
+	int format;												// 0 for TIFF, 1 for PNG
+	int width;												// image width in pixels
+	int height;												// image height in pixels
+	int dim;													// system dimensionality
+	int graphics;											// graphics level
+	double mid[3];										// center of view [d]
+	double clipsize;									// size of viewed region
+	double near;											// eye to near plane distance, 3-D only
+	double backcolor[3];							// background color [c]
+	double ambient[3];								// ambient light for graphics 3 [c]
+	double diffuse[3];								// diffuse light for graphics 3 [c]
+	double light[3];									// direction towards light [d]
+	int maxmol;												// allocated molecules
+	int nmol;													// number of molecules
+	offscreenmolptr mols;							// molecule list [m]
+	int maxprim;											// allocated primitives
+	int nprim;												// number of primitives
+	int nprimback;										// primitives drawn before molecules
+	offscreenprimptr prims;						// primitive list [p]
+	int maxpix;												// allocated pixels
+	unsigned char *image;							// RGB image [3*pixel+c]
+	float *zbuf;											// depth buffer for 3-D [pixel]
+	} *offscreenframeptr;
+
+typedef struct offscreenstruct {
+	struct offscreenframestruct frames[OFFSCREENFRAMES];	// frame buffers
+	int nfailed;											// number of unwritten frames
+#ifdef HAVE_PTHREAD
+	pthread_mutex_t lock;							// lock for frame status
+	pthread_cond_t cond;							// signals frame status changes
+	pthread_t tids[OFFSCREENTHREADS];	// worker threads
+	int nthreads;											// number of worker threads
+	int quit;													// 1 tells workers to exit
+#endif
+	} *offscreenptr;
+
+
+/* offscreenalloc */
+offscreenptr offscreenalloc(void) {
+	offscreenptr offscrn;
+
+	offscrn=(offscreenptr) calloc(1,sizeof(struct offscreenstruct));
+	if(!offscrn) return NULL;
+#ifdef HAVE_PTHREAD
+	pthread_mutex_init(&offscrn->lock,NULL);
+	pthread_cond_init(&offscrn->cond,NULL);
+	for(offscrn->nthreads=0;offscrn->nthreads<OFFSCREENTHREADS;offscrn->nthreads++)
+		if(pthread_create(&offscrn->tids[offscrn->nthreads],NULL,offscreenthread,offscrn)) break;
+#endif
+	return offscrn; }
+
+
+/* offscreenfree */
+void offscreenfree(offscreenptr offscrn) {
+	int fr;
+	offscreenframeptr frame;
+
+	if(!offscrn) return;
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock(&offscrn->lock);
+	offscrn->quit=1;
+	pthread_cond_broadcast(&offscrn->cond);
+	pthread_mutex_unlock(&offscrn->lock);
+	while(offscrn->nthreads>0)
+		pthread_join(offscrn->tids[--offscrn->nthreads],NULL);
+	pthread_cond_destroy(&offscrn->cond);
+	pthread_mutex_destroy(&offscrn->lock);
+#endif
+	for(fr=0;fr<OFFSCREENFRAMES;fr++) {
+		frame=&offscrn->frames[fr];
+		free(frame->mols);
+		free(frame->prims);
+		free(frame->image);
+		free(frame->zbuf); }
+	free(offscrn);
+	return; }
+
+
+/* offscreencolor */
+void offscreencolor(const double *color,unsigned char *rgba) {
+	int c;
+	double value;
+
+	for(c=0;c<4;c++) {
+		value=color?color[c]:0;
+		if(value<0) value=0;
+		else if(value>1) value=1;
+		rgba[c]=(unsigned char)(255*value+0.5); }
+	return; }
+
+
+/* offscreenaddprim */
+offscreenprimptr offscreenaddprim(offscreenframeptr frame,char type,double size,const double *fcolor,const double *bcolor) {
+	offscreenprimptr prim,newprims;
+	int newmax;
+
+	if(frame->nprim==frame->maxprim) {
+		newmax=2*frame->maxprim+64;
+		newprims=(offscreenprimptr) realloc(frame->prims,newmax*sizeof(struct offscreenprimstruct));
+		if(!newprims) {
+			frame->error=1;
+			return NULL; }
+		frame->prims=newprims;
+		frame->maxprim=newmax; }
+	prim=&frame->prims[frame->nprim++];
+	prim->type=type;
+	prim->size=(float)size;
+	offscreencolor(fcolor,prim->fcolor);
+	offscreencolor(bcolor,prim->bcolor);
+	return prim; }
+
+
+/* offscreenaddpoint */
+void offscreenaddpoint(offscreenframeptr frame,const double *pt,double size,const double *color) {
+	offscreenprimptr prim;
+	int d;
+
+	prim=offscreenaddprim(frame,'p',size,color,NULL);
+	if(!prim) return;
+	for(d=0;d<3;d++) prim->pt[0][d]=(float)pt[d];
+	return; }
+
+
+/* offscreenaddline */
+void offscreenaddline(offscreenframeptr frame,const double *pt1,const double *pt2,double size,const double *color) {
+	offscreenprimptr prim;
+	int d;
+
+	prim=offscreenaddprim(frame,'l',size,color,NULL);
+	if(!prim) return;
+	for(d=0;d<3;d++) {
+		prim->pt[0][d]=(float)pt1[d];
+		prim->pt[1][d]=(float)pt2[d]; }
+	return; }
+
+
+/* offscreenaddtriangle */
+void offscreenaddtriangle(offscreenframeptr frame,const double *pt1,const double *pt2,const double *pt3,const double *normal,const double *fcolor,const double *bcolor) {
+	offscreenprimptr prim;
+	int d;
+
+	prim=offscreenaddprim(frame,'t',0,fcolor,bcolor);
+	if(!prim) return;
+	for(d=0;d<3;d++) {
+		prim->pt[0][d]=(float)pt1[d];
+		prim->pt[1][d]=(float)pt2[d];
+		prim->pt[2][d]=(float)pt3[d];
+		prim->normal[d]=(float)normal[d]; }
+	return; }
+
+
+/* offscreenaddpolygon */
+void offscreenaddpolygon(offscreenframeptr frame,int npt,double pts[][3],const double *normal,enum DrawMode dm,double size,const double *fcolor,const double *bcolor) {
+	int i;
+
+	if(dm==DMface)
+		for(i=2;i<npt;i++)
+			offscreenaddtriangle(frame,pts[0],pts[i-1],pts[i],normal,fcolor,bcolor);
+	else if(dm==DMedge)
+		for(i=0;i<npt;i++)
+			offscreenaddline(frame,pts[i],pts[(i+1)%npt],size,fcolor?fcolor:bcolor);
+	else if(dm==DMvert)
+		for(i=0;i<npt;i++)
+			offscreenaddpoint(frame,pts[i],size,fcolor?fcolor:bcolor);
+	return; }
+
+
+/* offscreenaddarc */
+void offscreenaddarc(offscreenframeptr frame,const double *cent,double radius,double theta1,double theta2,int slices,char style,double size,const double *color) {
+	double pt1[3],pt2[3],zaxis[3]={0,0,1};
+	int i,n;
+
+	n=(int)(slices*(theta2-theta1)/(2*PI)+0.5);
+	if(n<1) n=1;
+	pt2[0]=cent[0]+radius*cos(theta1);
+	pt2[1]=cent[1]+radius*sin(theta1);
+	pt1[2]=pt2[2]=cent[2];
+	for(i=1;i<=n;i++) {
+		pt1[0]=pt2[0];
+		pt1[1]=pt2[1];
+		pt2[0]=cent[0]+radius*cos(theta1+i*(theta2-theta1)/n);
+		pt2[1]=cent[1]+radius*sin(theta1+i*(theta2-theta1)/n);
+		if(style=='e') offscreenaddline(frame,pt1,pt2,size,color);
+		else if(style=='v') offscreenaddpoint(frame,pt1,size,color);
+		else if(style=='f') offscreenaddtriangle(frame,cent,pt1,pt2,zaxis,color,color); }
+	return; }
+
+
+/* offscreenbasis */
+void offscreenbasis(const double *w,double *u,double *v) {
+	double len;
+
+	if(fabs(w[0])<0.9) {u[0]=0;u[1]=w[2];u[2]=-w[1];}
+	else {u[0]=-w[2];u[1]=0;u[2]=w[0];}
+	len=sqrt(u[0]*u[0]+u[1]*u[1]+u[2]*u[2]);
+	u[0]/=len;
+	u[1]/=len;
+	u[2]/=len;
+	v[0]=w[1]*u[2]-w[2]*u[1];
+	v[1]=w[2]*u[0]-w[0]*u[2];
+	v[2]=w[0]*u[1]-w[1]*u[0];
+	return; }
+
+
+/* offscreenaddsurface3D */
+void offscreenaddsurface3D(offscreenframeptr frame,surfaceptr srf,enum DrawMode dm,const double *fcolor,const double *bcolor) {
+	int p,d,i,j,slices,stacks;
+	double **point,*front,pts[4][3],norm[3],u[3],v[3],w[3],cent[3];
+	double radius,sign,height,phi1,phi2,z1,z2,r1,r2,len;
+	double size;
+	const double *ecolor;
+
+	size=srf->edgepts;
+	ecolor=(dm==DMface)?NULL:fcolor?fcolor:bcolor;
+	if(dm!=DMface) fcolor=bcolor=ecolor;
+
+	for(p=0;p<srf->npanel[PSrect];p++) {								// rectangles
+		point=srf->panels[PSrect][p]->point;
+		front=srf->panels[PSrect][p]->front;
+		for(i=0;i<4;i++)
+			for(d=0;d<3;d++) pts[i][d]=point[i][d];
+		norm[0]=norm[1]=norm[2]=0;
+		norm[(int)front[1]]=front[0];
+		offscreenaddpolygon(frame,4,pts,norm,dm,size,fcolor,bcolor); }
+
+	for(p=0;p<srf->npanel[PStri];p++) {									// triangles
+		point=srf->panels[PStri][p]->point;
+		for(i=0;i<3;i++)
+			for(d=0;d<3;d++) pts[i][d]=point[i][d];
+		offscreenaddpolygon(frame,3,pts,srf->panels[PStri][p]->front,dm,size,fcolor,bcolor); }
+
+	for(p=0;p<srf->npanel[PSsph]+srf->npanel[PShemi];p++) {	// spheres and hemispheres
+		if(p<srf->npanel[PSsph]) {
+			point=srf->panels[PSsph][p]->point;
+			front=srf->panels[PSsph][p]->front;
+			w[0]=w[1]=0;
+			w[2]=1;
+			phi1=-PI/2; }
+		else {
+			point=srf->panels[PShemi][p-srf->npanel[PSsph]]->point;
+			front=srf->panels[PShemi][p-srf->npanel[PSsph]]->front;
+			len=sqrt(point[2][0]*point[2][0]+point[2][1]*point[2][1]+point[2][2]*point[2][2]);
+			for(d=0;d<3;d++) w[d]=-point[2][d]/len;
+			phi1=0; }
+		offscreenbasis(w,u,v);
+		radius=point[1][0];
+		slices=(int)point[1][1];
+		stacks=(int)point[1][2];
+		if(p<srf->npanel[PSsph]) stacks=2*(stacks/2);
+		if(slices<3) slices=3;
+		if(stacks<1) stacks=1;
+		sign=front[0]>0?1:-1;
+		for(i=0;i<stacks;i++) {
+			phi2=phi1+(PI/2-phi1)*(i+1)/stacks;
+			z1=radius*sin(phi1+(PI/2-phi1)*i/stacks);
+			r1=radius*cos(phi1+(PI/2-phi1)*i/stacks);
+			z2=radius*sin(phi2);
+			r2=radius*cos(phi2);
+			for(j=0;j<slices;j++) {
+				for(d=0;d<3;d++) {
+					pts[0][d]=point[0][d]+r1*cos(2*PI*j/slices)*u[d]+r1*sin(2*PI*j/slices)*v[d]+z1*w[d];
+					pts[1][d]=point[0][d]+r1*cos(2*PI*(j+1)/slices)*u[d]+r1*sin(2*PI*(j+1)/slices)*v[d]+z1*w[d];
+					pts[2][d]=point[0][d]+r2*cos(2*PI*(j+1)/slices)*u[d]+r2*sin(2*PI*(j+1)/slices)*v[d]+z2*w[d];
+					pts[3][d]=point[0][d]+r2*cos(2*PI*j/slices)*u[d]+r2*sin(2*PI*j/slices)*v[d]+z2*w[d];
+					norm[d]=sign*((pts[0][d]+pts[2][d])/2-point[0][d]); }
+				offscreenaddpolygon(frame,4,pts,norm,dm,size,fcolor,bcolor); }}}
+
+	for(p=0;p<srf->npanel[PScyl];p++) {									// cylinders
+		point=srf->panels[PScyl][p]->point;
+		front=srf->panels[PScyl][p]->front;
+		for(d=0;d<3;d++) w[d]=point[1][d]-point[0][d];
+		height=sqrt(w[0]*w[0]+w[1]*w[1]+w[2]*w[2]);
+		for(d=0;d<3;d++) w[d]/=height;
+		offscreenbasis(w,u,v);
+		radius=point[2][0];
+		slices=(int)point[2][1];
+		stacks=(int)point[2][2];
+		if(slices<3) slices=3;
+		if(stacks<1) stacks=1;
+		sign=front[0]>0?1:-1;
+		for(i=0;i<stacks;i++)
+			for(j=0;j<slices;j++) {
+				for(d=0;d<3;d++) {
+					pts[0][d]=point[0][d]+radius*(cos(2*PI*j/slices)*u[d]+sin(2*PI*j/slices)*v[d])+height*i/stacks*w[d];
+					pts[1][d]=point[0][d]+radius*(cos(2*PI*(j+1)/slices)*u[d]+sin(2*PI*(j+1)/slices)*v[d])+height*i/stacks*w[d];
+					pts[2][d]=pts[1][d]+height/stacks*w[d];
+					pts[3][d]=pts[0][d]+height/stacks*w[d];
+					norm[d]=sign*(cos(2*PI*(j+0.5)/slices)*u[d]+sin(2*PI*(j+0.5)/slices)*v[d]); }
+				offscreenaddpolygon(frame,4,pts,norm,dm,size,fcolor,bcolor); }}
+
+	for(p=0;p<srf->npanel[PSdisk];p++) {								// disks
+		point=srf->panels[PSdisk][p]->point;
+		front=srf->panels[PSdisk][p]->front;
+		offscreenbasis(front,u,v);
+		radius=point[1][0];
+		slices=(int)point[1][1];
+		if(slices<3) slices=3;
+		for(d=0;d<3;d++) cent[d]=point[0][d];
+		for(j=0;j<slices;j++) {
+			for(d=0;d<3;d++) {
+				pts[0][d]=cent[d]+radius*(cos(2*PI*j/slices)*u[d]+sin(2*PI*j/slices)*v[d]);
+				pts[1][d]=cent[d]+radius*(cos(2*PI*(j+1)/slices)*u[d]+sin(2*PI*(j+1)/slices)*v[d]); }
+			if(dm==DMface) offscreenaddtriangle(frame,cent,pts[0],pts[1],front,fcolor,bcolor);
+			else if(dm==DMedge) offscreenaddline(frame,pts[0],pts[1],size,ecolor);
+			else if(dm==DMvert) offscreenaddpoint(frame,pts[0],size,ecolor); }}
+	return; }
+
+
+/* offscreenaddsurfaces */
+void offscreenaddsurfaces(simptr sim,offscreenframeptr frame) {
+	surfacessptr srfss;
+	surfaceptr srf;
+	int s,p,c,ps,fdone,bdone;
+	double **point,*front,pts[2][3],cent[3],delta,deltax,deltay,ylo,yhi,zmid,theta,ppu,sign;
+	double flcolor[4],blcolor[4],*color;
+	enum DrawMode fdrawmode,bdrawmode,fdm,bdm;
+	char style;
+
+	srfss=sim->srfss;
+	if(!srfss) return;
+	ppu=(frame->width>frame->height?frame->width:frame->height)/frame->clipsize;
+	zmid=frame->mid[2];
+
+	if(sim->dim==1) {
+		ylo=frame->mid[1]-frame->clipsize/20;
+		yhi=frame->mid[1]+frame->clipsize/20;
+		pts[0][1]=ylo;
+		pts[1][1]=yhi;
+		pts[0][2]=pts[1][2]=zmid;
+		for(s=0;s<srfss->nsrf;s++) {
+			srf=srfss->srflist[s];
+			if(srf->fdrawmode==DMno) continue;
+			for(sign=1;sign>-2;sign-=2) {								// front, then back
+				delta=sign*srf->edgepts/ppu/2;
+				color=sign>0?srf->fcolor:srf->bcolor;
+				for(ps=0;ps<=2;ps++)
+					for(p=0;p<srf->npanel[ps];p++) {
+						point=srf->panels[ps][p]->point;
+						front=srf->panels[ps][p]->front;
+						pts[0][0]=pts[1][0]=point[0][0]+(ps==2?point[1][0]:0)+front[0]*delta;
+						offscreenaddline(frame,pts[0],pts[1],srf->edgepts,color);
+						if(ps==2) {
+							pts[0][0]=pts[1][0]=point[0][0]-point[1][0]-front[0]*delta;
+							offscreenaddline(frame,pts[0],pts[1],srf->edgepts,color); }}}}}
+
+	else if(sim->dim==2) {
+		pts[0][2]=pts[1][2]=cent[2]=zmid;
+		for(s=0;s<srfss->nsrf;s++) {
+			srf=srfss->srflist[s];
+			fdrawmode=srf->fdrawmode;
+			bdrawmode=srf->bdrawmode;
+			if(fdrawmode==DMno) continue;
+			for(sign=1;sign>-2;sign-=2) {								// front, then back
+				if(sign<0 && !(fdrawmode&DMedge || fdrawmode&DMface)) break;
+				color=sign>0?srf->fcolor:srf->bcolor;
+				if(fdrawmode&DMedge || fdrawmode&DMface) {
+					deltax=deltay=sign*srf->edgepts/ppu/2.5;
+					style='e'; }
+				else {
+					deltax=deltay=0;
+					style='v'; }
+				for(p=0;p<srf->npanel[PSrect];p++) {				// rectangles
+					point=srf->panels[PSrect][p]->point;
+					front=srf->panels[PSrect][p]->front;
+					for(c=0;c<2;c++) {
+						pts[c][0]=point[c][0]+(front[1]==0?front[0]*deltax:0);
+						pts[c][1]=point[c][1]+(front[1]==0?0:front[0]*deltay); }
+					if(style=='e') offscreenaddline(frame,pts[0],pts[1],srf->edgepts,color);
+					else {
+						offscreenaddpoint(frame,pts[0],srf->edgepts,color);
+						offscreenaddpoint(frame,pts[1],srf->edgepts,color); }}
+				for(p=0;p<srf->npanel[PStri];p++) {					// triangles
+					point=srf->panels[PStri][p]->point;
+					front=srf->panels[PStri][p]->front;
+					for(c=0;c<2;c++) {
+						pts[c][0]=point[c][0]+front[0]*deltax;
+						pts[c][1]=point[c][1]+front[1]*deltay; }
+					if(style=='e') offscreenaddline(frame,pts[0],pts[1],srf->edgepts,color);
+					else {
+						offscreenaddpoint(frame,pts[0],srf->edgepts,color);
+						offscreenaddpoint(frame,pts[1],srf->edgepts,color); }}
+				for(p=0;p<srf->npanel[PScyl];p++) {					// cylinders
+					point=srf->panels[PScyl][p]->point;
+					front=srf->panels[PScyl][p]->front;
+					for(delta=1;delta>-2;delta-=2) {
+						for(c=0;c<2;c++) {
+							pts[c][0]=point[c][0]+delta*(front[0]*point[2][0]+front[2]*front[0]*deltax);
+							pts[c][1]=point[c][1]+delta*(front[1]*point[2][0]+front[2]*front[1]*deltay); }
+						if(style=='e') offscreenaddline(frame,pts[0],pts[1],srf->edgepts,color);
+						else {
+							offscreenaddpoint(frame,pts[0],srf->edgepts,color);
+							offscreenaddpoint(frame,pts[1],srf->edgepts,color); }}}
+				for(p=0;p<srf->npanel[PSdisk];p++) {				// disks
+					point=srf->panels[PSdisk][p]->point;
+					front=srf->panels[PSdisk][p]->front;
+					pts[0][0]=point[0][0]+point[1][0]*front[1]+front[0]*deltax;
+					pts[0][1]=point[0][1]-point[1][0]*front[0]+front[1]*deltay;
+					pts[1][0]=point[0][0]-point[1][0]*front[1]+front[0]*deltax;
+					pts[1][1]=point[0][1]+point[1][0]*front[0]+front[1]*deltay;
+					if(style=='e') offscreenaddline(frame,pts[0],pts[1],srf->edgepts,color);
+					else {
+						offscreenaddpoint(frame,pts[0],srf->edgepts,color);
+						offscreenaddpoint(frame,pts[1],srf->edgepts,color); }}
+				for(p=0;p<srf->npanel[PSsph]+srf->npanel[PShemi];p++) {	// spheres and hemispheres
+					if(p<srf->npanel[PSsph]) {
+						point=srf->panels[PSsph][p]->point;
+						front=srf->panels[PSsph][p]->front;
+						theta=0; }
+					else {
+						point=srf->panels[PShemi][p-srf->npanel[PSsph]]->point;
+						front=srf->panels[PShemi][p-srf->npanel[PSsph]]->front;
+						theta=atan2(point[2][1],point[2][0])+PI/2.0; }
+					cent[0]=point[0][0];
+					cent[1]=point[0][1];
+					if(sign>0 && fdrawmode&DMvert) offscreenaddarc(frame,cent,point[1][0],theta,theta+(p<srf->npanel[PSsph]?2*PI:PI),(int)point[1][1],'v',srf->edgepts,color);
+					if(sign>0 && fdrawmode&DMface) offscreenaddarc(frame,cent,point[1][0],theta,theta+(p<srf->npanel[PSsph]?2*PI:PI),(int)point[1][1],'f',srf->edgepts,color);
+					if((sign>0 && fdrawmode&DMedge) || (sign<0 && bdrawmode&DMedge))
+						offscreenaddarc(frame,cent,point[1][0]+front[0]*deltax,theta,theta+(p<srf->npanel[PSsph]?2*PI:PI),(int)point[1][1],'e',srf->edgepts,color); }}}}
+
+	else {
+		for(s=0;s<srfss->nsrf;s++) {
+			srf=srfss->srflist[s];
+			fdrawmode=srf->fdrawmode;
+			bdrawmode=srf->bdrawmode;
+			for(c=0;c<4;c++) flcolor[c]=srf->fcolor[c];
+			for(c=0;c<4;c++) blcolor[c]=srf->bcolor[c];
+			fdm=fdrawmode&DMface?DMface:fdrawmode&DMedge?DMedge:fdrawmode&DMvert?DMvert:DMno;
+			bdm=bdrawmode&DMface?DMface:bdrawmode&DMedge?DMedge:bdrawmode&DMvert?DMvert:DMno;
+
+			while(fdm || bdm) {
+				if(fdm==DMface || bdm==DMface)
+					offscreenaddsurface3D(frame,srf,DMface,fdm==DMface?flcolor:NULL,bdm==DMface?blcolor:NULL);
+				if(fdm==DMedge || bdm==DMedge)
+					offscreenaddsurface3D(frame,srf,DMedge,fdm==DMedge?flcolor:NULL,bdm==DMedge?blcolor:NULL);
+				if(fdm==DMvert || bdm==DMvert)
+					offscreenaddsurface3D(frame,srf,DMvert,fdm==DMvert?flcolor:NULL,bdm==DMvert?blcolor:NULL);
+
+				fdone=0;
+				if(fdm==DMface && fdrawmode&DMedge) fdm=DMedge;
+				else if((fdm==DMface || fdm==DMedge) && fdrawmode&DMvert) fdm=DMvert;
+				else fdone=1;
+
+				bdone=0;
+				if(bdm==DMface && bdrawmode&DMedge) bdm=DMedge;
+				else if((bdm==DMface || bdm==DMedge) && bdrawmode&DMvert) bdm=DMvert;
+				else bdone=1;
+
+				if(fdone && bdone) fdm=bdm=DMno;
+				else {
+					for(c=0;c<3;c++) flcolor[c]=blcolor[c]=0;
+					flcolor[3]=blcolor[3]=1; }}}}
+	return; }
+
+
+/* offscreensnapshot */
+void offscreensnapshot(simptr sim,offscreenframeptr frame) {
+	graphicsssptr graphss;
+	molssptr mols;
+	moleculeptr mptr;
+	offscreenmolptr newmols;
+	filamentssptr filss;
+	filamenttypeptr filtype;
+	filamentptr fil;
+	latticeptr lattice;
+	wallptr *wlist;
+	int dim,d,a,b,c,i,j,ll,m,lt,ft,f,vtx,newmax,n[3],lat,ilat,ismol,nsite;
+	const int *copy_numbers;
+	const double *positions;
+	double lo[3],hi[3],pt1[3],pt2[3],pts[4][3],norm[3],len,size,scale;
+	enum MolecState ms;
+	enum DrawMode drawmode,dm;
+
+	graphss=sim->graphss;
+	dim=sim->dim;
+	wlist=sim->wlist;
+	frame->error=0;
+	frame->nmol=frame->nprim=frame->nprimback=0;
+	frame->format=graphss->imageformat;
+	frame->width=graphss->imagesize[0];
+	frame->height=graphss->imagesize[1];
+	frame->dim=dim;
+	frame->graphics=graphss->graphics;
+
+	for(d=0;d<3;d++) {
+		lo[d]=d<dim?wlist[2*d]->pos:0;
+		hi[d]=d<dim?wlist[2*d+1]->pos:0;
+		frame->mid[d]=(lo[d]+hi[d])/2; }
+	frame->clipsize=1.05*sqrt((hi[0]-lo[0])*(hi[0]-lo[0])+(hi[1]-lo[1])*(hi[1]-lo[1])+(hi[2]-lo[2])*(hi[2]-lo[2]));
+	if(frame->clipsize==0) frame->clipsize=1;
+	frame->near=frame->clipsize/2.0/tan(PI/8);		// 45 degree field of view
+	scale=(frame->width>frame->height?frame->width:frame->height)/frame->clipsize;
+	if(dim==3) scale*=frame->near/(frame->near+frame->clipsize/2);
+
+	for(c=0;c<3;c++) {
+		frame->backcolor[c]=graphss->backcolor[c];
+		frame->ambient[c]=graphss->roomstate==LPoff?0:graphss->ambiroom[c];
+		frame->diffuse[c]=0.8;
+		frame->light[c]=c==2?1:0; }						// headlight unless a light is on
+	for(lt=0;lt<MAXLIGHTS && graphss->lightstate[lt]!=LPon;lt++);
+	if(lt<MAXLIGHTS) {
+		for(c=0;c<3;c++) {
+			frame->diffuse[c]=graphss->difflight[lt][c];
+			frame->light[c]=graphss->lightpos[lt][c]-(graphss->lightpos[lt][3]!=0?frame->mid[c]:0); }
+		len=sqrt(frame->light[0]*frame->light[0]+frame->light[1]*frame->light[1]+frame->light[2]*frame->light[2]);
+		if(len>0)
+			for(c=0;c<3;c++) frame->light[c]/=len; }
+
+	if(graphss->framepts) {													// frame
+		if(dim==1) offscreenaddline(frame,lo,hi,graphss->framepts,graphss->framecolor);
+		else
+			for(a=0;a<dim;a++)
+				for(i=0;i<(dim==2?2:4);i++) {
+					b=(a+1)%dim;
+					c=(a+2)%dim;
+					for(d=0;d<3;d++) pt1[d]=lo[d];
+					pt1[b]=i&1?hi[b]:lo[b];
+					if(dim==3) pt1[c]=i&2?hi[c]:lo[c];
+					for(d=0;d<3;d++) pt2[d]=pt1[d];
+					pt2[a]=hi[a];
+					offscreenaddline(frame,pt1,pt2,graphss->framepts,graphss->framecolor); }}
+
+	if(graphss->gridpts && sim->boxs) {							// virtual box grid
+		for(d=0;d<3;d++) {
+			n[d]=d<dim?sim->boxs->side[d]:0;
+			pt1[d]=pt2[d]=frame->mid[d]; }
+		if(dim==1)
+			for(i=0;i<=n[0];i++) {
+				pt1[0]=sim->boxs->min[0]+i*sim->boxs->size[0];
+				offscreenaddpoint(frame,pt1,graphss->gridpts,graphss->gridcolor); }
+		else
+			for(a=0;a<dim;a++) {
+				b=(a+1)%dim;
+				c=(a+2)%dim;
+				for(i=0;i<=n[b];i++)
+					for(j=0;j<=(dim==3?n[c]:0);j++) {
+						pt1[b]=pt2[b]=sim->boxs->min[b]+i*sim->boxs->size[b];
+						if(dim==3) pt1[c]=pt2[c]=sim->boxs->min[c]+j*sim->boxs->size[c];
+						pt1[a]=sim->boxs->min[a];
+						pt2[a]=sim->boxs->min[a]+n[a]*sim->boxs->size[a];
+						offscreenaddline(frame,pt1,pt2,graphss->gridpts,graphss->gridcolor); }}}
+
+	if(dim<3) frame->nprimback=frame->nprim;				// molecules are drawn over frame and grid
+
+	mols=sim->mols;																	// molecules
+	if(mols)
+		for(ll=0;ll<mols->nlist;ll++)
+			if(mols->listtype[ll]==MLTsystem)
+				for(m=0;m<mols->nl[ll];m++) {
+					mptr=mols->live[ll][m];
+					i=mptr->ident;
+					ms=mptr->mstate;
+					if(mols->display[i][ms]>0) {
+						if(frame->nmol==frame->maxmol) {
+							newmax=2*frame->maxmol+1024;
+							newmols=(offscreenmolptr) realloc(frame->mols,newmax*sizeof(struct offscreenmolstruct));
+							if(!newmols) {
+								frame->error=1;
+								return; }
+							frame->mols=newmols;
+							frame->maxmol=newmax; }
+						for(d=0;d<3;d++) frame->mols[frame->nmol].pos[d]=(float)(d<dim?mptr->pos[d]:frame->mid[d]);
+						frame->mols[frame->nmol].size=(float)mols->display[i][ms];
+						offscreencolor(mols->color[i][ms],frame->mols[frame->nmol].color);
+						frame->mols[frame->nmol].color[3]=255;
+						frame->nmol++; }}
+
+	offscreenaddsurfaces(sim,frame);								// surfaces
+
+	filss=sim->filss;																// filaments
+	if(filss && dim>1)
+		for(ft=0;ft<filss->ntype;ft++) {
+			filtype=filss->filtypes[ft];
+			drawmode=filtype->drawmode;
+			if(drawmode&DMface) dm=dim==2?DMedge:DMface;
+			else if(drawmode&DMedge) dm=DMedge;
+			else if(drawmode&DMvert) dm=DMvert;
+			else dm=DMno;
+			for(d=0;d<3;d++) pt2[d]=frame->mid[d];
+			while(dm) {
+				if(dm==DMvert) size=2*filtype->edgepts;
+				else if(dm==DMedge) size=filtype->edgepts;
+				else size=2*filtype->edgepts*scale;		// tubes of radius edgepts
+				for(f=0;f<filtype->nfil;f++) {
+					fil=filtype->fillist[f];
+					for(vtx=0;vtx<=fil->nseg;vtx++) {
+						for(d=0;d<3;d++) pt1[d]=pt2[d];
+						if(vtx<fil->nseg)
+							for(d=0;d<3;d++) pt2[d]=d<dim?fil->segments[vtx]->xyzfront[d]:frame->mid[d];
+						else
+							for(d=0;d<3;d++) pt2[d]=d<dim?fil->segments[vtx-1]->xyzback[d]:frame->mid[d];
+						if(dm==DMvert) offscreenaddpoint(frame,pt2,size,filtype->color);
+						else if(vtx>0) offscreenaddline(frame,pt1,pt2,size,filtype->color); }}
+				if(dm==DMface && drawmode&DMedge) dm=DMedge;
+				else if(dm!=DMvert && drawmode&DMvert) dm=DMvert;
+				else dm=DMno; }
+
+			if(filtype->drawforcescale!=0)
+				for(f=0;f<filtype->nfil;f++) {
+					fil=filtype->fillist[f];
+					if(fil->filwork) {
+						filComputeForces(fil,-1,-1);
+						for(vtx=0;vtx<=fil->nseg;vtx++) {
+							for(d=0;d<3;d++) {
+								pt1[d]=d<dim?fil->nodes[vtx][d]:frame->mid[d];
+								pt2[d]=pt1[d]+(d<dim?filtype->drawforcescale*fil->filwork->forces[vtx][d]:0); }
+							offscreenaddline(frame,pt1,pt2,filtype->edgepts,filtype->drawforcecolor); }}}}
+
+	if(sim->latticess)															// lattices
+		for(lat=0;lat<sim->latticess->nlattice;lat++) {
+			lattice=sim->latticess->latticelist[lat];
+			for(ilat=0;ilat<lattice->nspecies;ilat++) {
+				ismol=lattice->species_index[ilat];
+				positions=NULL;
+				copy_numbers=NULL;
+				nsite=0;
+				NSV_CALL(nsite=nsv_get_species_copy_numbers(lattice->type==LATTICEpde?lattice->pde:lattice->nsv,ismol,&copy_numbers,&positions));
+				for(i=0;i<nsite;i++)
+					if(mols->display[ismol][MSsoln]>0 && copy_numbers[i]>0) {
+						for(d=0;d<3;d++) {
+							pt1[d]=d<dim?positions[3*i+d]-0.5*lattice->dx[d]:frame->mid[d];
+							pt2[d]=d<dim?positions[3*i+d]+0.5*lattice->dx[d]:frame->mid[d]; }
+						if(dim==1) {
+							pt1[1]-=0.025*frame->clipsize;
+							pt2[1]+=0.025*frame->clipsize; }
+						for(a=(dim==3?0:2);a<3;a++)							// box faces normal to axis a
+							for(j=0;j<(dim==3?2:1);j++) {
+								b=(a+1)%3;
+								c=(a+2)%3;
+								for(m=0;m<4;m++) {
+									pts[m][a]=j?pt2[a]:pt1[a];
+									pts[m][b]=(m==1 || m==2)?pt2[b]:pt1[b];
+									pts[m][c]=(m>=2)?pt2[c]:pt1[c]; }
+								norm[0]=norm[1]=norm[2]=0;
+								norm[a]=j?1:-1;
+								offscreenaddpolygon(frame,4,pts,norm,DMface,0,mols->color[ismol][MSsoln],mols->color[ismol][MSsoln]); }}}}
+	return; }
+
+
+/* offscreenproject */
+int offscreenproject(offscreenframeptr frame,const float *pt,double *xyz,double *scaleptr) {
+	double scale,dz;
+
+	scale=(frame->width>frame->height?frame->width:frame->height)/frame->clipsize;
+	if(frame->dim<3)
+		xyz[2]=0;
+	else {
+		dz=frame->mid[2]+frame->clipsize/2+frame->near-pt[2];
+		if(dz<frame->near*1e-3) return 0;										// behind the eye
+		scale*=frame->near/dz;
+		xyz[2]=dz; }
+	xyz[0]=frame->width/2.0+(pt[0]-frame->mid[0])*scale;
+	xyz[1]=frame->height/2.0-(pt[1]-frame->mid[1])*scale;
+	if(scaleptr) *scaleptr=scale;
+	return 1; }
+
+
+/* offscreenshade */
+void offscreenshade(offscreenframeptr frame,const double *normal,const unsigned char *color,int specular,double *rgba) {
+	int c;
+	double ndotl,half[3],len,spec;
+
+	if(frame->graphics<3 || !normal) {
+		for(c=0;c<4;c++) rgba[c]=color[c]/255.0;
+		return; }
+	ndotl=normal[0]*frame->light[0]+normal[1]*frame->light[1]+normal[2]*frame->light[2];
+	if(ndotl<0) ndotl=0;
+	spec=0;
+	if(specular && ndotl>0) {
+		for(c=0;c<3;c++) half[c]=frame->light[c]+(c==2?1:0);
+		len=sqrt(half[0]*half[0]+half[1]*half[1]+half[2]*half[2]);
+		if(len>0) {
+			spec=(normal[0]*half[0]+normal[1]*half[1]+normal[2]*half[2])/len;
+			spec=spec>0?pow(spec,30):0; }}
+	for(c=0;c<3;c++) {
+		rgba[c]=color[c]/255.0*(frame->ambient[c]+frame->diffuse[c]*ndotl)+spec*frame->diffuse[c];
+		if(rgba[c]>1) rgba[c]=1; }
+	rgba[3]=color[3]/255.0;
+	return; }
+
+
+/* offscreenpixel */
+void offscreenpixel(offscreenframeptr frame,int x,int y,double depth,const double *rgba) {
+	int i,c;
+	unsigned char *pixel;
+	double alpha;
+
+	if(x<0 || y<0 || x>=frame->width || y>=frame->height) return;
+	i=y*frame->width+x;
+	alpha=1;
+	if(frame->dim==3) {
+		if(depth>frame->zbuf[i]) return;
+		if(rgba[3]<1) alpha=rgba[3];
+		else frame->zbuf[i]=(float)depth; }
+	pixel=frame->image+3*i;
+	for(c=0;c<3;c++)
+		pixel[c]=(unsigned char)(255*alpha*rgba[c]+(1-alpha)*pixel[c]+0.5);
+	return; }
+
+
+/* offscreenstamp */
+void offscreenstamp(offscreenframeptr frame,double x,double y,double depth,double size,const double *rgba) {
+	int ix,iy,x0,y0,n;
+
+	n=(int)(size+0.5);
+	if(n<1) n=1;
+	x0=(int)floor(x-n/2.0+0.5);
+	y0=(int)floor(y-n/2.0+0.5);
+	for(iy=0;iy<n;iy++)
+		for(ix=0;ix<n;ix++)
+			offscreenpixel(frame,x0+ix,y0+iy,depth,rgba);
+	return; }
+
+
+/* offscreenrendermol */
+void offscreenrendermol(offscreenframeptr frame,offscreenmolptr mol) {
+	double xyz[3],scale,radius,dx,dy,d2,normal[3],rgba[4];
+	int x,y;
+
+	if(!offscreenproject(frame,mol->pos,xyz,&scale)) return;
+	if(frame->graphics==1) {
+		offscreenshade(frame,NULL,mol->color,0,rgba);
+		offscreenstamp(frame,xyz[0],xyz[1],xyz[2],mol->size,rgba);
+		return; }
+
+	radius=mol->size*scale;
+	if(radius<0.5) {
+		offscreenshade(frame,NULL,mol->color,0,rgba);
+		offscreenpixel(frame,(int)floor(xyz[0]),(int)floor(xyz[1]),xyz[2]-mol->size,rgba);
+		return; }
+	for(y=(int)floor(xyz[1]-radius);y<=(int)ceil(xyz[1]+radius);y++)
+		for(x=(int)floor(xyz[0]-radius);x<=(int)ceil(xyz[0]+radius);x++) {
+			dx=(x+0.5-xyz[0])/radius;
+			dy=(y+0.5-xyz[1])/radius;
+			d2=dx*dx+dy*dy;
+			if(d2>1) continue;
+			normal[0]=dx;
+			normal[1]=-dy;
+			normal[2]=sqrt(1-d2);
+			offscreenshade(frame,normal,mol->color,1,rgba);
+			offscreenpixel(frame,x,y,xyz[2]-normal[2]*mol->size,rgba); }
+	return; }
+
+
+/* offscreenrenderprim */
+void offscreenrenderprim(offscreenframeptr frame,offscreenprimptr prim) {
+	double xyz[3][3],rgba[4],normal[3],eye[3],area,w0,w1,w2,bias,len,px,py;
+	int v,x,y,n,k,xmin,xmax,ymin,ymax,front;
+	const unsigned char *color;
+
+	for(v=0;v<(prim->type=='p'?1:prim->type=='l'?2:3);v++)
+		if(!offscreenproject(frame,prim->pt[v],xyz[v],NULL)) return;
+	bias=1e-3*frame->clipsize;									// keeps edges in front of faces
+
+	if(prim->type=='p') {
+		if(prim->fcolor[3]==0) return;
+		offscreenshade(frame,NULL,prim->fcolor,0,rgba);
+		offscreenstamp(frame,xyz[0][0],xyz[0][1],xyz[0][2]-bias,prim->size,rgba); }
+
+	else if(prim->type=='l') {
+		if(prim->fcolor[3]==0) return;
+		offscreenshade(frame,NULL,prim->fcolor,0,rgba);
+		n=(int)ceil(fmax(fabs(xyz[1][0]-xyz[0][0]),fabs(xyz[1][1]-xyz[0][1])));
+		if(n<1) n=1;
+		for(k=0;k<=n;k++)
+			offscreenstamp(frame,xyz[0][0]+(xyz[1][0]-xyz[0][0])*k/n,xyz[0][1]+(xyz[1][1]-xyz[0][1])*k/n,xyz[0][2]+(xyz[1][2]-xyz[0][2])*k/n-bias,prim->size,rgba); }
+
+	else if(prim->type=='t') {
+		area=(xyz[1][0]-xyz[0][0])*(xyz[2][1]-xyz[0][1])-(xyz[2][0]-xyz[0][0])*(xyz[1][1]-xyz[0][1]);
+		if(fabs(area)<1e-12) return;
+		for(v=0;v<3;v++) normal[v]=prim->normal[v];
+		front=1;
+		if(frame->dim==3) {
+			eye[0]=frame->mid[0];
+			eye[1]=frame->mid[1];
+			eye[2]=frame->mid[2]+frame->clipsize/2+frame->near;
+			front=(normal[0]*(eye[0]-prim->pt[0][0])+normal[1]*(eye[1]-prim->pt[0][1])+normal[2]*(eye[2]-prim->pt[0][2])>=0); }
+		color=front?prim->fcolor:prim->bcolor;
+		if(color[3]==0) return;
+		len=sqrt(normal[0]*normal[0]+normal[1]*normal[1]+normal[2]*normal[2]);
+		if(len>0)
+			for(v=0;v<3;v++) normal[v]*=(front?1:-1)/len;
+		offscreenshade(frame,frame->dim==3 && len>0?normal:NULL,color,0,rgba);
+
+		xmin=(int)floor(fmin(xyz[0][0],fmin(xyz[1][0],xyz[2][0])));
+		xmax=(int)ceil(fmax(xyz[0][0],fmax(xyz[1][0],xyz[2][0])));
+		ymin=(int)floor(fmin(xyz[0][1],fmin(xyz[1][1],xyz[2][1])));
+		ymax=(int)ceil(fmax(xyz[0][1],fmax(xyz[1][1],xyz[2][1])));
+		if(xmin<0) xmin=0;
+		if(ymin<0) ymin=0;
+		if(xmax>frame->width-1) xmax=frame->width-1;
+		if(ymax>frame->height-1) ymax=frame->height-1;
+		for(y=ymin;y<=ymax;y++)
+			for(x=xmin;x<=xmax;x++) {
+				px=x+0.5;
+				py=y+0.5;
+				w1=((px-xyz[0][0])*(xyz[2][1]-xyz[0][1])-(xyz[2][0]-xyz[0][0])*(py-xyz[0][1]))/area;
+				w2=((xyz[1][0]-xyz[0][0])*(py-xyz[0][1])-(px-xyz[0][0])*(xyz[1][1]-xyz[0][1]))/area;
+				w0=1-w1-w2;
+				if(w0<0 || w1<0 || w2<0) continue;
+				offscreenpixel(frame,x,y,w0*xyz[0][2]+w1*xyz[1][2]+w2*xyz[2][2],rgba); }}
+	return; }
+
+
+/* offscreenwritetiff */
+int offscreenwritetiff(const char *filename,const unsigned char *image,int width,int height) {
+	FILE *fptr;
+	unsigned char header[192],*ptr;
+	int entry;
+	size_t nbytes;
+	const int tags[13][4]={{256,4,1,0},{257,4,1,0},{258,3,3,170},{259,3,1,1},{262,3,1,2},{273,4,1,192},{277,3,1,3},
+		{278,4,1,0},{279,4,1,0},{282,5,1,176},{283,5,1,184},{284,3,1,1},{296,3,1,2}};
+
+	nbytes=3*(size_t)width*height;
+	memset(header,0,sizeof(header));
+	header[0]=header[1]='I';												// little-endian baseline RGB TIFF
+	header[2]=42;
+	header[4]=8;
+	header[8]=13;
+	for(entry=0;entry<13;entry++) {
+		ptr=header+10+12*entry;
+		ptr[0]=tags[entry][0]&0xFF;
+		ptr[1]=tags[entry][0]>>8;
+		ptr[2]=tags[entry][1];
+		ptr[4]=tags[entry][2];
+		ptr[8]=tags[entry][3]&0xFF;
+		ptr[9]=tags[entry][3]>>8; }
+	ptr=header+10;																	// width, height, rows per strip, strip bytes
+	ptr[8]=width&0xFF;ptr[9]=(width>>8)&0xFF;ptr[10]=(width>>16)&0xFF;
+	ptr+=12;
+	ptr[8]=height&0xFF;ptr[9]=(height>>8)&0xFF;ptr[10]=(height>>16)&0xFF;
+	ptr=header+10+12*7;
+	ptr[8]=height&0xFF;ptr[9]=(height>>8)&0xFF;ptr[10]=(height>>16)&0xFF;
+	ptr+=12;
+	ptr[8]=nbytes&0xFF;ptr[9]=(nbytes>>8)&0xFF;ptr[10]=(nbytes>>16)&0xFF;ptr[11]=(nbytes>>24)&0xFF;
+	header[170]=header[172]=header[174]=8;					// bits per sample
+	header[176]=header[184]=72;											// 72 pixels per inch
+	header[180]=header[188]=1;
+
+	fptr=fopen(filename,"wb");
+	if(!fptr) return 1;
+	if(fwrite(header,1,sizeof(header),fptr)!=sizeof(header) || fwrite(image,1,nbytes,fptr)!=nbytes) {
+		fclose(fptr);
+		return 1; }
+	return fclose(fptr)?1:0; }
+
+
+/* offscreencrc */
+unsigned long offscreencrc(unsigned long crc,const unsigned char *data,size_t n) {
+	size_t i;
+	int k;
+
+	crc=~crc&0xFFFFFFFFUL;
+	for(i=0;i<n;i++) {
+		crc^=data[i];
+		for(k=0;k<8;k++)
+			crc=(crc>>1)^(0xEDB88320UL&(0-(crc&1))); }
+	return ~crc&0xFFFFFFFFUL; }
+
+
+/* offscreenputchunk */
+int offscreenputchunk(FILE *fptr,const char *type,const unsigned char *data,size_t n) {
+	unsigned char word[4];
+	unsigned long crc;
+
+	word[0]=(n>>24)&0xFF;word[1]=(n>>16)&0xFF;word[2]=(n>>8)&0xFF;word[3]=n&0xFF;
+	crc=offscreencrc(0,(const unsigned char*)type,4);
+	crc=offscreencrc(crc,data,n);
+	if(fwrite(word,1,4,fptr)!=4 || fwrite(type,1,4,fptr)!=4 || (n && fwrite(data,1,n,fptr)!=n)) return 1;
+	word[0]=(crc>>24)&0xFF;word[1]=(crc>>16)&0xFF;word[2]=(crc>>8)&0xFF;word[3]=crc&0xFF;
+	return fwrite(word,1,4,fptr)!=4; }
+
+
+/* offscreenwritepng */
+int offscreenwritepng(const char *filename,const unsigned char *image,int width,int height) {
+	FILE *fptr;
+	unsigned char *zdata,*ptr,ihdr[13];
+	const unsigned char signature[8]={137,80,78,71,13,10,26,10};
+	size_t rowbytes,nraw,nblock,i,n;
+	unsigned long s1,s2;
+	int y,er;
+
+	rowbytes=3*(size_t)width+1;											// filter byte and RGB row
+	nraw=rowbytes*height;
+	nblock=(nraw+65534)/65535;
+	zdata=(unsigned char*) malloc(2+5*nblock+nraw+4);
+	if(!zdata) return 1;
+
+	ptr=zdata;																			// zlib stream of stored deflate blocks
+	*ptr++=0x78;
+	*ptr++=0x01;
+	s1=1;
+	s2=0;
+	for(i=0;i<nraw;i+=n) {
+		n=nraw-i<65535?nraw-i:65535;
+		*ptr++=(i+n==nraw)?1:0;
+		*ptr++=n&0xFF;
+		*ptr++=(n>>8)&0xFF;
+		*ptr++=~n&0xFF;
+		*ptr++=(~n>>8)&0xFF;
+		for(y=0;y<(int)n;y++,ptr++) {
+			*ptr=(i+y)%rowbytes==0?0:image[((i+y)/rowbytes)*3*width+(i+y)%rowbytes-1];
+			s1=(s1+*ptr)%65521;
+			s2=(s2+s1)%65521; }}
+	*ptr++=(s2>>8)&0xFF;
+	*ptr++=s2&0xFF;
+	*ptr++=(s1>>8)&0xFF;
+	*ptr++=s1&0xFF;
+
+	for(i=0;i<4;i++) {
+		ihdr[i]=(width>>(24-8*i))&0xFF;
+		ihdr[4+i]=(height>>(24-8*i))&0xFF; }
+	ihdr[8]=8;																			// 8 bit RGB, no interlace
+	ihdr[9]=2;
+	ihdr[10]=ihdr[11]=ihdr[12]=0;
+
+	er=1;
+	fptr=fopen(filename,"wb");
+	if(fptr) {
+		er=fwrite(signature,1,8,fptr)!=8;
+		er=er || offscreenputchunk(fptr,"IHDR",ihdr,13);
+		er=er || offscreenputchunk(fptr,"IDAT",zdata,ptr-zdata);
+		er=er || offscreenputchunk(fptr,"IEND",NULL,0);
+		er=fclose(fptr) || er; }
+	free(zdata);
+	return er; }
+
+
+/* offscreenrender */
+int offscreenrender(offscreenframeptr frame) {
+	unsigned char *newimage,back[3];
+	float *newzbuf;
+	int npix,i,c,p,m;
+
+	npix=frame->width*frame->height;
+	if(npix>frame->maxpix) {
+		newimage=(unsigned char*) realloc(frame->image,3*npix);
+		if(!newimage) return 1;
+		frame->image=newimage;
+		newzbuf=(float*) realloc(frame->zbuf,npix*sizeof(float));
+		if(!newzbuf) return 1;
+		frame->zbuf=newzbuf;
+		frame->maxpix=npix; }
+
+	for(c=0;c<3;c++) back[c]=(unsigned char)(255*frame->backcolor[c]+0.5);
+	for(i=0;i<npix;i++) {
+		for(c=0;c<3;c++) frame->image[3*i+c]=back[c];
+		frame->zbuf[i]=FLT_MAX; }
+
+	for(p=0;p<frame->nprimback;p++)
+		offscreenrenderprim(frame,&frame->prims[p]);
+	for(m=0;m<frame->nmol;m++)
+		offscreenrendermol(frame,&frame->mols[m]);
+	for(;p<frame->nprim;p++)
+		offscreenrenderprim(frame,&frame->prims[p]);
+
+	if(frame->format==1) return offscreenwritepng(frame->filename,frame->image,frame->width,frame->height);
+	return offscreenwritetiff(frame->filename,frame->image,frame->width,frame->height); }
+
+
+#ifdef HAVE_PTHREAD
+
+/* offscreenthread */
+void *offscreenthread(void *arg) {
+	offscreenptr offscrn;
+	offscreenframeptr frame;
+	int fr,er;
+
+	offscrn=(offscreenptr) arg;
+	pthread_mutex_lock(&offscrn->lock);
+	while(1) {
+		for(fr=0;fr<OFFSCREENFRAMES && offscrn->frames[fr].status!=2;fr++);
+		if(fr==OFFSCREENFRAMES) {
+			if(offscrn->quit) break;
+			pthread_cond_wait(&offscrn->cond,&offscrn->lock);
+			continue; }
+		frame=&offscrn->frames[fr];
+		frame->status=3;
+		pthread_mutex_unlock(&offscrn->lock);
+		er=offscreenrender(frame);
+		pthread_mutex_lock(&offscrn->lock);
+		if(er) offscrn->nfailed++;
+		frame->status=0;
+		pthread_cond_broadcast(&offscrn->cond); }
+	pthread_mutex_unlock(&offscrn->lock);
+	return NULL; }
+
+#endif
+
+
+/* graphicsoffscreenframe */
+void graphicsoffscreenframe(simptr sim) {
+	graphicsssptr graphss;
+	offscreenptr offscrn;
+	offscreenframeptr frame;
+	int it,number,numbermax,er;
+	char format[2*STRCHAR];
+#ifdef HAVE_PTHREAD
+	int fr;
+#endif
+
+	graphss=sim->graphss;
+	if(!graphss || !graphss->offscreen || graphss->graphics==0 || graphss->tiffit<=0 || strchr(sim->flags,'t')) return;
+	it=graphss->currentit++;
+	if(it%graphss->tiffit) return;
+	number=graphss->tiffnumber;
+	numbermax=graphss->tiffnummax;
+	if(number>numbermax) return;
+
+	if(!graphss->offscrn) {
+		graphss->offscrn=offscreenalloc();
+		if(!graphss->offscrn) {
+			simLog(sim,7,"WARNING: out of memory for offscreen rendering\n");
+			return; }}
+	offscrn=graphss->offscrn;
+
+#ifdef HAVE_PTHREAD
+	frame=NULL;
+	pthread_mutex_lock(&offscrn->lock);
+	while(!frame) {																	// wait for a free frame buffer
+		for(fr=0;fr<OFFSCREENFRAMES && offscrn->frames[fr].status!=0;fr++);
+		if(fr<OFFSCREENFRAMES) frame=&offscrn->frames[fr];
+		else pthread_cond_wait(&offscrn->cond,&offscrn->lock); }
+	frame->status=1;
+	pthread_mutex_unlock(&offscrn->lock);
+#else
+	frame=&offscrn->frames[0];
+#endif
+
+	offscreensnapshot(sim,frame);
+	snprintf(format,2*STRCHAR,"%s%%0%ii.%s",graphss->tiffname,(int)log10((double)numbermax)+1,graphss->imageformat==1?"png":"tif");
+	snprintf(frame->filename,STRCHAR,format,number);
+	graphss->tiffnumber=number+1;
+
+#ifdef HAVE_PTHREAD
+	if(offscrn->nthreads>0) {
+		pthread_mutex_lock(&offscrn->lock);
+		if(frame->error) {
+			offscrn->nfailed++;
+			frame->status=0; }
+		else {
+			frame->status=2;
+			pthread_cond_broadcast(&offscrn->cond); }
+		pthread_mutex_unlock(&offscrn->lock);
+		return; }
+#endif
+
+	er=frame->error || offscreenrender(frame);
+	if(er) offscrn->nfailed++;
+	frame->status=0;
+	return; }
+
+
+/* graphicsoffscreenflush */
+void graphicsoffscreenflush(simptr sim) {
+	offscreenptr offscrn;
+	int nfailed;
+#ifdef HAVE_PTHREAD
+	int fr;
+#endif
+
+	if(!sim->graphss || !sim->graphss->offscrn) return;
+	offscrn=sim->graphss->offscrn;
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock(&offscrn->lock);
+	fr=0;
+	while(fr<OFFSCREENFRAMES) {											// wait for queued frames to be written
+		for(fr=0;fr<OFFSCREENFRAMES && offscrn->frames[fr].status==0;fr++);
+		if(fr<OFFSCREENFRAMES) pthread_cond_wait(&offscrn->cond,&offscrn->lock); }
+	nfailed=offscrn->nfailed;
+	offscrn->nfailed=0;
+	pthread_mutex_unlock(&offscrn->lock);
+#else
+	nfailed=offscrn->nfailed;
+	offscrn->nfailed=0;
+#endif
+	if(nfailed) simLog(sim,7,"WARNING: %i image files could not be written\n",nfailed);
+	return; }
+
+
 /******************************************************************************/
 /************************** Top level OpenGL functions ************************/
 /******************************************************************************/
@@ -1463,14 +2781,208 @@ void TimerFunction(int state);
 simptr Sim;
 
 
+#ifdef HAVE_PTHREAD
+
+/* With OpenGL graphics and no graphic_delay, the simulation runs on its own
+thread so that rendering doesn't slow it down.  The simulation thread copies
+the molecules into graphss->snap[2] and then exchanges it with snap[1], the
+latest snapshot.  TimerFunction, on the GLUT thread, exchanges snap[1] with
+snap[0], which is the one that is drawn.  Surfaces, filaments, and lattices
+are still drawn from the live system, so the renderer holds the simulation
+between time steps while it draws them.  Snapshots that are saved as TIFFs
+hold the simulation until they have been saved.  Display settings that the
+renderer uses are copied into the snapshots too.  OpenGL state can only be
+changed on the GLUT thread, so graphics updates that the simulation thread
+needs, such as from a "set background_color" command, are passed to
+TimerFunction, which does them while the simulation is held. */
+
+typedef struct simthreadstruct {
+	pthread_t tid;										// simulation thread
+	pthread_t glthread;								// GLUT thread
+	pthread_mutex_t lock;							// lock for this structure and snapshots
+	pthread_cond_t cond;							// signals changes to this structure
+	int runstate;											// requested state: 0 run, 1 pause, 2 stop
+	int hold;													// 1 if renderer needs the simulation held
+	int idle;													// 1 if simulation is held between steps
+	int fresh;												// 1 if snap[1] is newer than snap[0]
+	int tiffwait;											// 1 until TIFF of snap[1] has been saved
+	int redisplay;										// 1 if a command asked for a redisplay
+	int glupdate;											// 1 if OpenGL state needs updating
+	enum StructCond glcondition;			// lowest graphics condition to update
+	char keys[STRCHAR];								// key presses from commands
+	int done;													// 1 when the simulation thread is done
+	int state;												// final simulation state
+	} *simthreadptr;
+
+
+/* simthreadstart */
+int simthreadstart(simptr sim) {
+	simthreadptr thr;
+
+	thr=(simthreadptr) calloc(1,sizeof(struct simthreadstruct));
+	if(!thr) return 1;
+	pthread_mutex_init(&thr->lock,NULL);
+	pthread_cond_init(&thr->cond,NULL);
+	thr->glthread=pthread_self();
+	thr->runstate=gl2State(-1);
+	sim->graphss->simthrd=thr;
+	if(pthread_create(&thr->tid,NULL,simthreadfunc,sim)) {
+		sim->graphss->simthrd=NULL;
+		pthread_cond_destroy(&thr->cond);
+		pthread_mutex_destroy(&thr->lock);
+		free(thr);
+		return 1; }
+	return 0; }
+
+
+/* simthreadfunc */
+void *simthreadfunc(void *arg) {
+	simptr sim;
+	graphicsssptr graphss;
+	simthreadptr thr;
+	struct molsnapstruct snap;
+	int state,it,tiff,snapit,paused,er;
+
+	sim=(simptr) arg;
+	graphss=sim->graphss;
+	thr=graphss->simthrd;
+	state=0;
+	snapit=-1;
+	paused=0;
+	pthread_mutex_lock(&thr->lock);
+	while(!state) {
+		while(thr->runstate!=2 && (thr->hold || thr->tiffwait || thr->runstate==1)) {
+			if(thr->runstate==1 && !paused) {						// enter pause state
+				sim->elapsedtime+=difftime(time(NULL),sim->clockstt);
+				paused=1;
+				simLog(sim,2,"Simulation paused at simulation time: %g|T\n",sim->time); }
+			thr->idle=1;
+			pthread_cond_broadcast(&thr->cond);
+			pthread_cond_wait(&thr->cond,&thr->lock); }
+		thr->idle=0;
+		if(thr->runstate==2) break;
+		if(paused) {																// leave pause state
+			paused=0;
+			sim->clockstt=time(NULL);
+			simLog(sim,2,"Simulation running\n"); }
+
+		it=graphss->currentit;
+		tiff=graphss->tiffit>0 && !(it%graphss->tiffit);
+		if(it!=snapit && (tiff || thr->redisplay || !(it%graphss->graphicit))) {
+			pthread_mutex_unlock(&thr->lock);
+			er=graphicssnapshot(sim,&graphss->snap[2]);
+			pthread_mutex_lock(&thr->lock);
+			if(er) simLog(sim,7,"WARNING: out of memory for drawing molecules\n");
+			else {																		// publish the snapshot
+				snap=graphss->snap[1];
+				graphss->snap[1]=graphss->snap[2];
+				graphss->snap[2]=snap;
+				graphss->snap[1].tiff=tiff;
+				thr->fresh=1;
+				thr->tiffwait=tiff;
+				pthread_cond_broadcast(&thr->cond); }
+			thr->redisplay=0;
+			snapit=it;
+			continue; }
+
+		pthread_mutex_unlock(&thr->lock);
+		state=simulatetimestep(sim);
+		graphss->currentit++;
+		pthread_mutex_lock(&thr->lock); }
+
+	if(paused) sim->clockstt=time(NULL);					// elapsed time was added at pause
+	thr->done=1;
+	thr->state=state;
+	thr->idle=1;
+	pthread_cond_broadcast(&thr->cond);
+	pthread_mutex_unlock(&thr->lock);
+	return NULL; }
+
+
+/* simthreadhold */
+void simthreadhold(simthreadptr thr,int hold) {
+	if(!thr) return;
+	pthread_mutex_lock(&thr->lock);
+	thr->hold=hold;
+	pthread_cond_broadcast(&thr->cond);
+	if(hold)
+		while(!thr->idle) pthread_cond_wait(&thr->cond,&thr->lock);
+	pthread_mutex_unlock(&thr->lock);
+	return; }
+
+
+/* simthreadstop */
+void simthreadstop(simthreadptr thr) {
+	if(!thr) return;
+	pthread_mutex_lock(&thr->lock);
+	thr->runstate=2;
+	pthread_cond_broadcast(&thr->cond);
+	pthread_mutex_unlock(&thr->lock);
+	pthread_join(thr->tid,NULL);
+	pthread_cond_destroy(&thr->cond);
+	pthread_mutex_destroy(&thr->lock);
+	free(thr);
+	return; }
+
+
+/* simthreaddefer */
+int simthreaddefer(simptr sim) {
+	graphicsssptr graphss;
+	simthreadptr thr;
+
+	graphss=sim->graphss;
+	thr=graphss->simthrd;
+	if(!thr || pthread_equal(pthread_self(),thr->glthread)) return 0;
+	pthread_mutex_lock(&thr->lock);										// TimerFunction does the update
+	if(!thr->glupdate || graphss->condition<thr->glcondition)
+		thr->glcondition=graphss->condition;
+	thr->glupdate=1;
+	pthread_cond_broadcast(&thr->cond);
+	pthread_mutex_unlock(&thr->lock);
+	graphicssetcondition(graphss,SCok,1);
+	return 1; }
+
+#endif
+
+
 /* smolPostRedisplay */
 void smolPostRedisplay(void) {
+#ifdef HAVE_PTHREAD
+	simthreadptr thr;
+
+	thr=(Sim && Sim->graphss)?Sim->graphss->simthrd:NULL;
+	if(thr && !pthread_equal(pthread_self(),thr->glthread)) {
+		thr->redisplay=1;														// next snapshot is published
+		return; }
+#endif
 #ifdef __gl_h_
 	glutPostRedisplay();
 #endif
 	return; }
 
 
+/* smolKeyPush */
+void smolKeyPush(unsigned char key) {
+#ifdef HAVE_PTHREAD
+	simthreadptr thr;
+	size_t n;
+
+	thr=(Sim && Sim->graphss)?Sim->graphss->simthrd:NULL;
+	if(thr && !pthread_equal(pthread_self(),thr->glthread)) {
+		pthread_mutex_lock(&thr->lock);							// TimerFunction pushes the key
+		n=strlen(thr->keys);
+		if(n+1<STRCHAR) {
+			thr->keys[n]=(char)key;
+			thr->keys[n+1]='\0'; }
+		if(key==' ' && thr->runstate==0) thr->runstate=1;		// pause right away
+		pthread_cond_broadcast(&thr->cond);
+		pthread_mutex_unlock(&thr->lock);
+		return; }
+#endif
+	gl2SetKeyPush(key);
+	return; }
+
+
 /* RenderScene */
 void RenderScene(void) {
 	RenderSim(Sim,1);
@@ -1485,12 +2997,82 @@ void TimerFunction(int state) {
 	int it;
 	simptr sim;
 	graphicsssptr graphss;
+#ifdef HAVE_PTHREAD
+	simthreadptr thr;
+	struct molsnapstruct snap;
+	char keys[STRCHAR];
+	int i,fresh,done,glupdate;
+	enum StructCond glcondition;
+	struct timespec waituntil;
+#endif
 	
 	sim=Sim;
 	graphss=sim->graphss;
 	//qflag=strchr(sim->flags,'q')?1:0;
 	delay=graphss->graphicdelay;
 
+#ifdef HAVE_PTHREAD
+	thr=graphss->simthrd;
+	if(thr) {																					// simulation runs on its own thread
+		fresh=0;
+		pthread_mutex_lock(&thr->lock);
+		strcpy(keys,thr->keys);
+		thr->keys[0]='\0';
+		pthread_mutex_unlock(&thr->lock);
+		for(i=0;keys[i];i++) gl2SetKeyPush((unsigned char)keys[i]);
+
+		pthread_mutex_lock(&thr->lock);
+		if(thr->runstate!=gl2State(-1)) {
+			thr->runstate=gl2State(-1);
+			pthread_cond_broadcast(&thr->cond); }
+		glupdate=thr->glupdate;
+		glcondition=thr->glcondition;
+		thr->glupdate=0;
+		if(thr->fresh) {																// take the latest snapshot
+			snap=graphss->snap[0];
+			graphss->snap[0]=graphss->snap[1];
+			graphss->snap[1]=snap;
+			thr->fresh=0;
+			fresh=1; }
+		done=thr->done;
+		pthread_mutex_unlock(&thr->lock);
+
+		if(glupdate) {																	// OpenGL updates from the simulation thread
+			simthreadhold(thr,1);
+			if(glcondition<=SClists) graphicsupdatelists(sim);
+			graphicsupdateparams(sim);
+			simthreadhold(thr,0);
+			glutPostRedisplay(); }
+
+		if(fresh) {
+			if(graphss->snap[0].tiff) {
+				RenderSim(sim,0);
+				gl2SetKeyPush('T');
+				pthread_mutex_lock(&thr->lock);
+				thr->tiffwait=0;
+				pthread_cond_broadcast(&thr->cond);
+				pthread_mutex_unlock(&thr->lock); }
+			glutPostRedisplay(); }
+		if(!done && graphss->tiffit>0) {								// wait up to 10 ms for the next TIFF
+			clock_gettime(CLOCK_REALTIME,&waituntil);
+			waituntil.tv_nsec+=10000000;
+			if(waituntil.tv_nsec>=1000000000) {
+				waituntil.tv_sec++;
+				waituntil.tv_nsec-=1000000000; }
+			pthread_mutex_lock(&thr->lock);
+			while(!thr->fresh && !thr->done && !thr->glupdate && !thr->keys[0])
+				if(pthread_cond_timedwait(&thr->cond,&thr->lock,&waituntil)) break;
+			pthread_mutex_unlock(&thr->lock);
+			glutTimerFunc(0,TimerFunction,0);
+			return; }
+		if(!done) {
+			glutTimerFunc(10,TimerFunction,0);
+			return; }
+		state=thr->state;														// simulation thread is done
+		simthreadstop(thr);
+		graphss->simthrd=NULL; }
+#endif
+
 	if(oldstate==1 && gl2State(-1)==0) {							// leave pause state
 		oldstate=0;
 		sim->clockstt=time(NULL);
@@ -1538,6 +3120,9 @@ void smolsimulategl(simptr sim) {
 	sim->clockstt=time(NULL);
 	er=simdocommands(sim);
 	if(er) endsimulate(sim,er);
+#ifdef HAVE_PTHREAD
+	else if(sim->graphss->graphicdelay==0) simthreadstart(sim);
+#endif
 	glutDisplayFunc(RenderScene);
 	glutPostRedisplay();
 	glutMainLoop();
@@ -70,6 +70,7 @@ latticeptr latticealloc(int dim) {
 		lattice->max[d]=1;
 		lattice->dx[d]=1;
 		lattice->btype[d]='u'; }
+	lattice->nsubdomains=1;
 	lattice->port=NULL;
 	lattice->convert=NULL;
 	lattice->maxreactions=0;
@@ -99,6 +100,7 @@ void latticefree(latticeptr lattice) {
 
 	if(!lattice) return;
 	NSV_CALL(nsv_delete(lattice->nsv));
+	NSV_CALL(nsv_delete(lattice->pde));
 	if(lattice->mol_positions) {
 		for(i=0;i<lattice->maxspecies;i++)
 			if(lattice->mol_positions[i]) {
@@ -330,6 +332,8 @@ void latticeoutput(simptr sim) {
 		for(d=0;d<sim->dim;d++)
 			simLog(sim,2,"  Boundaries on axis %i: from %lg to %lg, step %lg, type %s\n",d,lattice->min[d],lattice->max[d],lattice->dx[d],lattice->btype[d]=='r'?"reflect":(lattice->btype[d]=='p'?"periodic":"undefined"));
 		simLog(sim,2,"  Interface port: %s\n",lattice->port?lattice->port->portname:"none");
+		if(lattice->nsubdomains>1)
+			simLog(sim,2,"  Subdomains integrated in parallel: %i\n",lattice->nsubdomains);
 
 		simLog(sim,2,"  Reactions (%i allocated, %i defined):\n",lattice->maxreactions,lattice->nreactions);
 		for(r=0;r<lattice->nreactions;r++) {
@@ -351,7 +355,10 @@ void latticeoutput(simptr sim) {
 			free(buffer);
 			buffer=NULL; }
 		if(lattice->pde) {
-      simLog(sim,2,"  ERROR: lattice is setup for PDE but this hasn't been implemented yet\n"); }}
+			NSV_CALL(nsv_print(lattice->pde,&buffer));
+			simLog(sim,2,"  External pde class description: %s",buffer?buffer:"Error");
+			free(buffer);
+			buffer=NULL; }}
 
 	simLog(sim,2,"\n");
 	return; }
@@ -386,6 +393,9 @@ void writelattices(simptr sim,FILE *fptr) {
 			fprintf(fptr," %lg",lattice->dx[d]); }
 		fprintf(fptr,"\n");
 
+		if(lattice->nsubdomains>1)
+			fprintf(fptr,"subdomains %i\n",lattice->nsubdomains);
+
     if(lattice->port)
       fprintf(fptr,"port %s\n",lattice->port->portname);
 
@@ -405,7 +415,7 @@ void writelattices(simptr sim,FILE *fptr) {
 					fprintf(fptr," %lg",lattice->mol_positions[i][m][d]);
 				fprintf(fptr,"\n"); }
 
-		NSV_CALL(n=nsv_get_species_copy_numbers(lattice->nsv,lattice->species_index[i], &copy_numbers, &positions));
+		NSV_CALL(n=nsv_get_species_copy_numbers(lattice->type==LATTICEpde?lattice->pde:lattice->nsv,lattice->species_index[i], &copy_numbers, &positions));
 		for (m = 0; m < n; ++m) {
 			fprintf(fptr,"mol %d %s",copy_numbers[m],sim->mols->spname[lattice->species_index[i]]);
 			for(d=0;d<sim->dim;d++)
@@ -773,6 +783,15 @@ latticeptr latticereadstring(simptr sim,ParseFilePtr pfp,latticeptr lattice,cons
       line2=strnword(line2,2); }
     CHECKS(!line2,"unexpected text following lengthscale"); }
 
+	else if(!strcmp(word,"subdomains")) {             // subdomains
+		CHECKS(lattice,"lattice name has to be entered before subdomains");
+		itct=strmathsscanf(line2,"%mi",varnames,varvalues,nvar,&i);
+		CHECKM(itct==1,"subdomains format: number. ");
+		CHECKS(i>=1,"number of subdomains needs to be at least 1");
+		lattice->nsubdomains=i;
+		latticesetcondition(lattice->latticess,SClists,0);
+		CHECKS(!strnword(line2,2),"unexpected text following subdomains"); }
+
 	else if(!strcmp(word,"port")) {                   // port
 
 		CHECKS(lattice,"lattice name has to be entered before import");
@@ -826,7 +845,7 @@ latticeptr latticereadstring(simptr sim,ParseFilePtr pfp,latticeptr lattice,cons
 				s=-1;
 				for(j=0;j<MAXORDER && s<0;++j)
 					if(sim->rxnss[j]) {
-						s=stringfind(sim->rxnss[j]->rname,sim->rxnss[j]->totrxn,nm);
+						s=rxnfindname(sim->rxnss[j],nm);
 						if (s >= 0) break;
 					}
 				CHECKS(s>=0,"reaction '%s' not recognized",nm);
@@ -1026,7 +1045,10 @@ int latticesupdateparams(simptr sim) {
                             NSV_CALL(nsv_add_interface(lattice->nsv,si,sim->dt,start,end,norm_back,sim->dim));
                     }
                     else if (lattice->type==LATTICEpde) {
-                        //not implemented
+                        if(lattice->convert[s][PFback])
+                            NSV_CALL(nsv_add_interface(lattice->pde,si,sim->dt,start,end,norm_front,sim->dim));
+                        if(lattice->convert[s][PFfront])
+                            NSV_CALL(nsv_add_interface(lattice->pde,si,sim->dt,start,end,norm_back,sim->dim));
                     }
                 }
             }
@@ -1050,7 +1072,7 @@ int latticesupdateparams(simptr sim) {
             if(lattice->type==LATTICEnsv) {
                 NSV_CALL(nsv_add_reaction(lattice->nsv,reaction)); }
             else if(lattice->type==LATTICEpde) {
-                //not implemented
+                NSV_CALL(nsv_add_reaction(lattice->pde,reaction));
             RxnSetValue(sim,"disable",reaction,lattice->reactionmove[j]?1:0); } // disable reactions in particle space if needed
         }
 
@@ -1081,7 +1103,7 @@ int latticesupdateparams(simptr sim) {
 				NSV_CALL(nsv_add_surface(lattice->nsv,surface));
             }
             else if(lattice->type==LATTICEpde) {
-				//not implemented
+				NSV_CALL(nsv_add_surface(lattice->pde,surface));
 			}
         }
     }
@@ -1109,11 +1131,25 @@ int latticesupdatelists(simptr sim) {
 
 				for(m=0;m<lattice->nmols[s];++m) {		// add molecules from mol_positions to new lattice
 					NSV_CALL(nsv_add_mol(lattice->nsv,si,lattice->mol_positions[s][m],sim->dim)); }
-				lattice->nmols[s]=0; }}
+				lattice->nmols[s]=0; }
+			if(lattice->nsubdomains>1)
+				NSV_CALL(nsv_set_subdomains(lattice->nsv,lattice->nsubdomains)); }
 
-		else if(lattice->type==LATTICEpde) {
-			//not implemented
-		}}
+		else if(lattice->type==LATTICEpde) {				// pde uses the nsv subvolumes with continuous amounts
+			if(lattice->pde)
+				NSV_CALL(nsv_delete(lattice->pde));
+			NSV_CALL(lattice->pde=nsv_new(lattice->min,lattice->max,lattice->dx,sim->dim));
+			NSV_CALL(nsv_set_deterministic(lattice->pde,1));
+
+			for(s=0;s<lattice->nspecies;++s) {
+				si=lattice->species_index[s];
+				NSV_CALL(nsv_add_species(lattice->pde,si,sim->mols->difc[si][MSsoln],lattice->btype,sim->dim));
+
+				for(m=0;m<lattice->nmols[s];++m) {
+					NSV_CALL(nsv_add_mol(lattice->pde,si,lattice->mol_positions[s][m],sim->dim)); }
+				lattice->nmols[s]=0; }
+			if(lattice->nsubdomains>1)
+				NSV_CALL(nsv_set_subdomains(lattice->pde,lattice->nsubdomains)); }}
 
 	return 0; }
 
@@ -1151,8 +1187,7 @@ int latticeruntimestep(simptr sim) {
 		if(lattice->type==LATTICEnsv) {
 			NSV_CALL(nsv_integrate(lattice->nsv,sim->dt,lattice->port,lattice)); }
 		else if(lattice->type==LATTICEpde) {
-			//not implemented
-		}}
+			NSV_CALL(nsv_integrate(lattice->pde,sim->dt,lattice->port,lattice)); }}
 
 	if(sim->mols) sim->mols->touch++;
 	return 0; }
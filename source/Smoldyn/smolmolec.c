@@ -17,6 +17,7 @@
 #include "Rn.h"
 #include "RnSort.h"
 #include "string2.h"
+#include "uthash.h"
 #include "Zn.h"
 
 #include "smoldyn.h"
@@ -27,6 +28,12 @@
 /*********************************** Molecules ********************************/
 /******************************************************************************/
 
+typedef struct molhashstruct {
+	const char *key;						// hashed string (reference, not owned)
+	int index;									// species or pattern index
+	UT_hash_handle hh;					// uthash handle
+	} *molhashptr;
+
 
 /******************************************************************************/
 /****************************** Local declarations ****************************/
@@ -36,12 +43,16 @@
 enum MolListType molstring2mlt(char *string);
 char *molmlt2string(enum MolListType mlt,char *string);
 
+// name hashing
+int molpatternlocate(molssptr mols,const char *pattern,const char *rname);
+int molpatternhashadd(molssptr mols,int pat);
+
 // low level utilities
 char *molpos2string(simptr sim,moleculeptr mptr,char *string);
 
 // memory management
-moleculeptr molalloc(int dim);
-void molfree(moleculeptr mptr);
+int molallocslab(molssptr mols,int dim,int nmolecs,moleculeptr *list);
+void molfreeslabs(molssptr mols);
 void molfreesurfdrift(double *****surfdrift,int maxspec,int maxsrf);
 molssptr molssalloc(molssptr mols,int maxspecies);
 int mollistalloc(molssptr mols,int maxlist,enum MolListType mlt);
@@ -58,6 +69,7 @@ int molsupdatelists(simptr sim);
 int molgeneratespecies(simptr sim,const char *name,int nparents,int parent1,int parent2);
 
 // adding and removing molecules
+int molsernocompare(const void *a,const void *b);
 moleculeptr newestmol(molssptr mols);
 int molgetexport(simptr sim,int ident,enum MolecState ms);
 int molputimport(simptr sim,int nmol,int ident,enum MolecState ms,panelptr pnl,enum PanelFace face);
@@ -121,6 +133,80 @@ char *molmlt2string(enum MolListType mlt,char *string) {
 	return string; }
 
 
+/******************************************************************************/
+/********************************* name hashing *******************************/
+/******************************************************************************/
+
+// uthash macros expand into switch fall-throughs and mixed-sign comparisons
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wimplicit-fallthrough"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#endif
+
+/* molhashadd */
+int molhashadd(molhashptr *tableptr,const char *key,int index) {
+	molhashptr entry;
+
+	entry=(molhashptr) malloc(sizeof(struct molhashstruct));
+	if(!entry) return 1;
+	entry->key=key;
+	entry->index=index;
+	HASH_ADD_KEYPTR(hh,*tableptr,entry->key,strlen(entry->key),entry);
+	return 0; }
+
+
+/* molhashfind */
+int molhashfind(molhashptr table,const char *key) {
+	molhashptr entry;
+
+	HASH_FIND_STR(table,key,entry);
+	return entry?entry->index:-1; }
+
+
+/* molhashfree */
+void molhashfree(molhashptr *tableptr) {
+	molhashptr entry;
+
+	while(*tableptr) {
+		entry=*tableptr;
+		HASH_DEL(*tableptr,entry);
+		free(entry); }
+	return; }
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+
+/* molfindspecies */
+int molfindspecies(molssptr mols,const char *name) {
+	return molhashfind(mols->sphash,name); }
+
+
+/* molpatternlocate */
+int molpatternlocate(molssptr mols,const char *pattern,const char *rname) {
+	int pat;
+
+	pat=molhashfind(mols->pathash,pattern);
+	if(rname)
+		while(pat>=0 && mols->patrname[pat] && strcmp(rname,mols->patrname[pat]))
+			pat=mols->patnext[pat];
+	return pat; }
+
+
+/* molpatternhashadd */
+int molpatternhashadd(molssptr mols,int pat) {
+	int pat2;
+
+	mols->patnext[pat]=-1;
+	pat2=molhashfind(mols->pathash,mols->patlist[pat]);
+	if(pat2<0) return molhashadd(&mols->pathash,mols->patlist[pat],pat);
+	while(mols->patnext[pat2]>=0) pat2=mols->patnext[pat2];
+	mols->patnext[pat2]=pat;
+	return 0; }
+
+
 /******************************************************************************/
 /******************************** molecule patterns ***************************/
 /******************************************************************************/
@@ -181,9 +267,9 @@ int molreversepattern(const char *pattern,char *patternrev) {
 /* molpatternindex */
 int molpatternindex(simptr sim,const char *pattern,const char *rname,int isrule,int update,int **indexptr) {
 	int npattern,pat,er,i,i1,i2,j,istart,jstart,matchwords,subwords,totalwords,nspecies,haswildcard,hasspeciesgroup;
-	int iword,ismatch,keepgoing,onthefly,imatch,imatch2;
-	int **patindex,*index,*patindextemp,*matchindex1,*matchindex2;
-	char **patlist,*patlisttemp,matchstr[STRCHAR],*substr,*newline,**patrname,*patrnametemp;
+	int iword,ismatch,keepgoing,onthefly,imatch,imatch2,isnew1,k;
+	int **patindex,*index,*matchindex1,*matchindex2,*newmatch2,nnewmatch2,nalt,isliteral;
+	char **patlist,matchstr[STRCHAR],*substr,*newline,**patrname,**altlist;
 	char teststring[STRCHAR],deststring[STRCHAR],tempstring[STRCHAR];
 	const char *newline2;
 	molssptr mols;
@@ -198,14 +284,9 @@ int molpatternindex(simptr sim,const char *pattern,const char *rname,int isrule,
 	else onthefly=0;
 	newline2=strchr(pattern,'\n');
 
-	if(npattern) {
-		pat=locateVstr(patlist,pattern,npattern,1);			// look for pattern in patlist list
-		if(rname) {																			// if a reaction, set pat to also get same reaction name
-			while(pat>=0 && !strcmp(patlist[pat],pattern) && patrname[pat] && strcmp(rname,patrname[pat]))
-				pat--; }}																		// if not located, pat should be at one below destination spot
-	else pat=-1;
+	pat=molpatternlocate(mols,pattern,rname);					// look for pattern in pattern hash table
 
-	index=(pat>=0 && !strcmp(patlist[pat],pattern))?patindex[pat]:NULL;
+	index=pat>=0?patindex[pat]:NULL;
 	if(update && index && isrule && index[PDrule]!=isrule) index[PDrule]=isrule;		// it wasn't a rule but is now
 	if(update==0 || (index && index[PDnspecies]<0) || (!(onthefly && newline2) && index && index[PDnspecies]>=mols->nspecies)) {
 		if(indexptr) *indexptr=index;										// no updating required, so just return results
@@ -213,7 +294,6 @@ int molpatternindex(simptr sim,const char *pattern,const char *rname,int isrule,
 
 	// check to see if this is a new pattern and put it in the lists if so
 	if(!index) {
-		pat++;
 		if(npattern==sim->mols->maxpattern) {						// expand pattern list if its already full
 			er=molpatternalloc(sim,2*npattern+2);
 			if(er) return -1;
@@ -221,23 +301,14 @@ int molpatternindex(simptr sim,const char *pattern,const char *rname,int isrule,
 			patindex=mols->patindex;
 			patrname=mols->patrname; }
 
-		patlisttemp=patlist[npattern];									// store new spot as patlisttemp
-		patindextemp=patindex[npattern];
-		patrnametemp=patrname[npattern];
-		for(j=npattern-1;j>=pat;j--) {									// shift the list up one so new pattern goes to correct spot
-			patlist[j+1]=patlist[j];
-			patindex[j+1]=patindex[j];
-			patrname[j+1]=patrname[j]; }
+		pat=npattern;																		// new pattern goes at end of list
 		mols->npattern++;
 		npattern=mols->npattern;
-
-		patlist[pat]=patlisttemp;												// put the new spot in the freed up space
-		patindex[pat]=patindextemp;
-		patrname[pat]=patrnametemp;
 		strcpy(patlist[pat],pattern);										// set initial patlist and header values
 		if(rname) {
 			patrname[pat]=StringCopy(rname);
 			if(!patrname[pat]) return -1; }
+		if(molpatternhashadd(mols,pat)) return -1;
 		index=patindex[pat];
 		index[PDnresults]=0;
 		index[PDnspecies]=0;
@@ -295,7 +366,7 @@ int molpatternindex(simptr sim,const char *pattern,const char *rname,int isrule,
 			index=patindex[pat];
 			if(er) return -1; }
 		sscanf(matchstr,"%s",tempstring);
-		i=stringfind(mols->spname,nspecies,tempstring);
+		i=molfindspecies(mols,tempstring);
 		if(i<0) {																				// not a current species name
 			index[PDnspecies]=nspecies;
 			if(indexptr) *indexptr=index;
@@ -305,20 +376,38 @@ int molpatternindex(simptr sim,const char *pattern,const char *rname,int isrule,
 		index[PDnspecies]=-1; }													// will never need updating
 
 	else if(!newline && matchwords==1) {							// single species name with wildcards
+		nalt=strexpandlogic(matchstr,0,-1,&altlist);		// expand logic into alternative patterns
+		if(nalt<0) return -10+nalt;
 		j=jstart;
-		for(i=istart;i<nspecies;i++) {
-			ismatch=strEnhWildcardMatch(matchstr,mols->spname[i]);
-			if(ismatch<0) return -10+ismatch;
-			if(ismatch==1) {
-				if(index[PDalloc]<PDMAX+j+1) {
-					er=molpatternindexalloc(&patindex[pat],PDMAX+2*(j+1));
-					index=patindex[pat];
-					if(er) return -1; }
-				index[PDMAX+j]=i;
-				j++;
-				index[PDnresults]=j; }}
-		index[PDnspecies]=nspecies;
-		sortVii(index+PDMAX,NULL,index[PDnresults]); }	// sort list
+		er=0;
+		for(k=0;k<nalt && !er;k++) {
+			isliteral=strpbrk(altlist[k],"*?[")?0:1;
+			if(isliteral) {																// literal alternative, so use hash lookup
+				i=molfindspecies(mols,altlist[k]);
+				if(i<istart) i=i2=0;
+				else i2=i+1; }
+			else {																				// wildcard alternative, so scan new species
+				i=istart;
+				i2=nspecies; }
+			for(;i<i2 && !er;i++) {
+				ismatch=isliteral?1:strwildcardmatch(altlist[k],mols->spname[i]);
+				if(ismatch<0) er=-10+ismatch;
+				else if(ismatch==1) {
+					if(index[PDalloc]<PDMAX+j+1) {
+						er=molpatternindexalloc(&patindex[pat],PDMAX+2*(j+1));
+						index=patindex[pat];
+						if(er) er=-1; }
+					if(!er) {
+						index[PDMAX+j]=i;
+						j++; }}}}
+		for(k=0;k<nalt;k++) free(altlist[k]);
+		free(altlist);
+		if(er) return er;
+		sortVii(index+PDMAX+jstart,NULL,j-jstart);			// sort new results and remove duplicates
+		for(i=i2=jstart;i<j;i++)
+			if(i==jstart || index[PDMAX+i]!=index[PDMAX+i2-1]) index[PDMAX+i2++]=index[PDMAX+i];
+		index[PDnresults]=i2;
+		index[PDnspecies]=nspecies; }
 
 	else if(!newline) {																// no newline but multiple matchwords
 		simLog(sim,7,"BUG in molpatternindex: pattern '%s' has multiple matchwords but no newline character\n",pattern); }
@@ -331,7 +420,7 @@ int molpatternindex(simptr sim,const char *pattern,const char *rname,int isrule,
 
 		for(iword=0;iword<subwords;iword++) {					// subwords
 			sscanf(strnword(substr,iword+1),"%s",tempstring);
-			i=stringfind(mols->spname,nspecies,tempstring);
+			i=molfindspecies(mols,tempstring);
 			if(i<0) {
 				if(!isrule) return -3;										// unknown substitute species
 				else {
@@ -352,7 +441,6 @@ int molpatternindex(simptr sim,const char *pattern,const char *rname,int isrule,
 			if(isrule && er==-2) {if(indexptr) *indexptr=index;er=0;}			// a matchword doesn't exist
 			return er; }
 		patindex=mols->patindex;
-		while(index!=patindex[pat]) pat++;							// prior molpatternindex call might have shifted pat
 		i1=matchindex1[PDMAX];
 
 		keepgoing=0;
@@ -364,7 +452,7 @@ int molpatternindex(simptr sim,const char *pattern,const char *rname,int isrule,
 			index[PDMAX]=i1;
 			for(iword=0;iword<subwords;iword++) {					// subwords
 				sscanf(strnword(substr,iword+1),"%s",tempstring);
-				i=stringfind(mols->spname,nspecies,tempstring);
+				i=molfindspecies(mols,tempstring);
 				if(i<0) {
 					if(!isrule) return -3;										// unknown substitute species
 					else {
@@ -385,7 +473,6 @@ int molpatternindex(simptr sim,const char *pattern,const char *rname,int isrule,
 			if(isrule && er==-2) {if(indexptr) *indexptr=index;er=0;}			// a matchword doesn't exist
 			return er; }
 		patindex=mols->patindex;
-		while(index!=patindex[pat]) pat++;							// prior molpatternindex call might have shifted pat
 		i1=matchindex1[PDMAX];
 		sscanf(strnword(matchstr,2),"%s",tempstring);
 		er=molpatternindex(sim,tempstring,NULL,0,2,&matchindex2);
@@ -393,7 +480,6 @@ int molpatternindex(simptr sim,const char *pattern,const char *rname,int isrule,
 			if(isrule && er==-2) {if(indexptr) *indexptr=index;er=0;}			// a matchword doesn't exist
 			return er; }
 		patindex=mols->patindex;
-		while(index!=patindex[pat]) pat++;							// prior molpatternindex call might have shifted pat
 		i2=matchindex2[PDMAX];
 
 		keepgoing=0;
@@ -407,7 +493,7 @@ int molpatternindex(simptr sim,const char *pattern,const char *rname,int isrule,
 			index[PDMAX+1]=i2;
 			for(iword=0;iword<subwords;iword++) {					// subwords
 				sscanf(strnword(substr,iword+1),"%s",tempstring);
-				i=stringfind(mols->spname,nspecies,tempstring);
+				i=molfindspecies(mols,tempstring);
 				if(i<0) {
 					if(!isrule) return -3;										// unknown substitute species
 					else {
@@ -429,7 +515,7 @@ int molpatternindex(simptr sim,const char *pattern,const char *rname,int isrule,
 				if(er) return -1; }
 			for(iword=0;iword<subwords;iword++) {
 				sscanf(strnword(deststring,iword+1),"%s",tempstring);
-				i=stringfind(mols->spname,mols->nspecies,tempstring);
+				i=molfindspecies(mols,tempstring);
 				if(i<0) {
 					if(!isrule) return -3;								// unknown substitute species
 					else {
@@ -449,7 +535,6 @@ int molpatternindex(simptr sim,const char *pattern,const char *rname,int isrule,
 			if(isrule && er==-2) {if(indexptr) *indexptr=index;er=0;}			// a matchword doesn't exist
 			return er; }
 		patindex=mols->patindex;
-		while(index!=patindex[pat]) pat++;							// prior molpatternindex call might have shifted pat
 		for(imatch=0;imatch<matchindex1[PDnresults];imatch++) {	// loop over all species that match to matchword
 			i1=matchindex1[PDMAX+imatch];									// species identity
 
@@ -468,7 +553,7 @@ int molpatternindex(simptr sim,const char *pattern,const char *rname,int isrule,
 					index[PDMAX+totalwords*j]=i1;
 					for(iword=0;iword<subwords;iword++) {
 						sscanf(strnword(deststring,iword+1),"%s",tempstring);
-						i=stringfind(mols->spname,mols->nspecies,tempstring);
+						i=molfindspecies(mols,tempstring);
 						if(i<0) {
 							if(!isrule) return -3;								// unknown substitute species
 							else {
@@ -488,17 +573,26 @@ int molpatternindex(simptr sim,const char *pattern,const char *rname,int isrule,
 			if(isrule && er==-2) {if(indexptr) *indexptr=index;er=0;}			// a matchword doesn't exist
 			return er; }
 		patindex=mols->patindex;
-		while(index!=patindex[pat]) pat++;							// prior molpatternindex call might have shifted pat
 		sscanf(strnword(matchstr,2),"%s",tempstring);
 		er=molpatternindex(sim,tempstring,NULL,0,2,&matchindex2);		// get index of matchword
 		if(er) {
 			if(isrule && er==-2) {if(indexptr) *indexptr=index;er=0;}			// a matchword doesn't exist
 			return er; }
 		patindex=mols->patindex;
-		while(index!=patindex[pat]) pat++;							// prior molpatternindex call might have shifted pat
-		for(imatch=0;imatch<matchindex1[PDnresults];imatch++)
-			for(imatch2=0;imatch2<matchindex2[PDnresults];imatch2++) {
-				i1=matchindex1[PDMAX+imatch];								// species identity
+		newmatch2=(int*) calloc(matchindex2[PDnresults]+1,sizeof(int));	// list second matchword species that are new
+		if(!newmatch2) return -1;
+		nnewmatch2=0;
+		for(imatch2=0;imatch2<matchindex2[PDnresults];imatch2++) {
+			i2=matchindex2[PDMAX+imatch2];
+			if(isrule && onthefly?mols->expand[i2]==1:i2>=istart)
+				newmatch2[nnewmatch2++]=imatch2; }
+
+		er=0;
+		for(imatch=0;imatch<matchindex1[PDnresults] && !er;imatch++) {
+			i1=matchindex1[PDMAX+imatch];									// species identity
+			isnew1=(isrule && onthefly)?mols->expand[i1]==1:i1>=istart;
+			for(k=0;k<(isnew1?matchindex2[PDnresults]:nnewmatch2) && !er;k++) {	// if i1 isn't new, only new i2 species can match
+				imatch2=isnew1?k:newmatch2[k];
 				i2=matchindex2[PDMAX+imatch2];
 
 				keepgoing=0;
@@ -507,32 +601,33 @@ int molpatternindex(simptr sim,const char *pattern,const char *rname,int isrule,
 					if(mols->expand[i2]==1 && mols->expand[i1]>0) keepgoing=1; }
 				else if(i1>=istart || i2>=istart) keepgoing=1;
 				if(keepgoing && i2<i1) {										// avoid double counting by removing reactions in which i2<i1 and both reactants are in both lists
-					for(i=0;i<matchindex1[PDnresults] && matchindex1[PDMAX+i]!=i2;i++);
-					if(matchindex1[PDMAX+i]==i2) {
-						for(i=0;i<matchindex2[PDnresults] && matchindex2[PDMAX+i]!=i1;i++);
-						if(matchindex2[PDMAX+i]==i1) keepgoing=0; }}
-
-			if(keepgoing) {
-				snprintf(teststring,STRCHAR,"%s %s",mols->spname[i1],mols->spname[i2]);
-				while((ismatch=strEnhWildcardMatchAndSub(matchstr,teststring,substr,deststring))>0) {
-					if(index[PDalloc]<PDMAX+totalwords*(j+1)) {
-						er=molpatternindexalloc(&patindex[pat],PDMAX+2*totalwords*(j+1));
-						index=patindex[pat];
-						if(er) return -1; }
-					index[PDMAX+totalwords*j]=i1;
-					index[PDMAX+totalwords*j+1]=i2;
-					for(iword=0;iword<subwords;iword++) {
-						sscanf(strnword(deststring,iword+1),"%s",tempstring);
-						i=stringfind(mols->spname,mols->nspecies,tempstring);
-						if(i<0) {
-							if(!isrule) return -3;								// unknown substitute species
-							else {
-								i=molgeneratespecies(sim,tempstring,2,i1,i2);
-								if(i<0) return -6; }}
-						index[PDMAX+totalwords*j+2+iword]=i; }
-					j++;
-					index[PDnresults]=j; }
-				if(ismatch<0) return -10+ismatch; }}				// wildcard expansion failure
+					if(locateVi(matchindex1+PDMAX,i2,matchindex1[PDnresults],0)>=0 && locateVi(matchindex2+PDMAX,i1,matchindex2[PDnresults],0)>=0)
+						keepgoing=0; }
+
+				if(keepgoing) {
+					snprintf(teststring,STRCHAR,"%s %s",mols->spname[i1],mols->spname[i2]);
+					while(!er && (ismatch=strEnhWildcardMatchAndSub(matchstr,teststring,substr,deststring))>0) {
+						if(index[PDalloc]<PDMAX+totalwords*(j+1)) {
+							er=molpatternindexalloc(&patindex[pat],PDMAX+2*totalwords*(j+1));
+							index=patindex[pat];
+							if(er) {er=-1;break;} }
+						index[PDMAX+totalwords*j]=i1;
+						index[PDMAX+totalwords*j+1]=i2;
+						for(iword=0;iword<subwords && !er;iword++) {
+							sscanf(strnword(deststring,iword+1),"%s",tempstring);
+							i=molfindspecies(mols,tempstring);
+							if(i<0) {
+								if(!isrule) er=-3;									// unknown substitute species
+								else {
+									i=molgeneratespecies(sim,tempstring,2,i1,i2);
+									if(i<0) er=-6; }}
+							index[PDMAX+totalwords*j+2+iword]=i; }
+						if(er) break;
+						j++;
+						index[PDnresults]=j; }
+					if(!er && ismatch<0) er=-10+ismatch; }}}			// wildcard expansion failure
+		free(newmatch2);
+		if(er) return er;
 		index[PDnspecies]=nspecies; }
 
 	else {
@@ -567,7 +662,7 @@ int moladdspeciesgroup(simptr sim,const char *group,char *species,int imol) {
 	int er,*gpindex,*spindex,isp,igp,gpnresults,pat;
 	enum MolecState ms;
 
-	if(stringfind(sim->mols->spname,sim->mols->nspecies,group)>=0) return -9;	// cannot use a species name as a group name
+	if(molfindspecies(sim->mols,group)>=0) return -9;	// cannot use a species name as a group name
 
 	er=molstring2index1(sim,group,&ms,&gpindex);	// get group index
 	if(er==-1 || er==-2 || er==-3 || er==-5 || er==-6 || er==-7) return er;
@@ -579,7 +674,7 @@ int moladdspeciesgroup(simptr sim,const char *group,char *species,int imol) {
 		if(ms!=MSsoln && ms!=MSall) return -8;
 
 		if(gpindex[PDalloc]<PDMAX+gpindex[PDnresults]+spindex[PDnresults]) {		// expand group index if needed
-			pat=locateVstr(sim->mols->patlist,group,sim->mols->npattern,0);			// look for pattern in patlist list
+			pat=molpatternlocate(sim->mols,group,NULL);			// look for pattern in pattern hash table
 			er=molpatternindexalloc(&(sim->mols->patindex[pat]),PDMAX+2*(gpindex[PDnresults]+spindex[PDnresults]));
 			gpindex=sim->mols->patindex[pat];
 			if(er) return -7; }
@@ -597,7 +692,7 @@ int moladdspeciesgroup(simptr sim,const char *group,char *species,int imol) {
 
 	if(imol) {
 		if(gpindex[PDalloc]<PDMAX+gpindex[PDnresults]+1) {		// expand group index if needed
-			pat=locateVstr(sim->mols->patlist,group,sim->mols->npattern,0);			// look for pattern in patlist list
+			pat=molpatternlocate(sim->mols,group,NULL);			// look for pattern in pattern hash table
 			er=molpatternindexalloc(&(sim->mols->patindex[pat]),PDMAX+2*(gpindex[PDnresults]+1));
 			gpindex=sim->mols->patindex[pat];
 			if(er) return -7; }
@@ -1488,46 +1583,66 @@ double MolCalcDifcSum(simptr sim,int i1,enum MolecState ms1,int i2,enum MolecSta
 /****************************** memory management *****************************/
 /******************************************************************************/
 
-/* molalloc */
-moleculeptr molalloc(int dim) {
-	moleculeptr mptr;
-	int d;
-
-	mptr=NULL;
-	CHECKMEM(mptr=(moleculeptr) malloc(sizeof(struct moleculestruct)));
-	mptr->serno=0;
-	mptr->list=-1;
-	mptr->pos=NULL;
-	mptr->posx=NULL;
-	mptr->via=NULL;
-	mptr->posoffset=NULL;
-	mptr->ident=0;
-	mptr->mstate=MSsoln;
-	mptr->box=NULL;
-	mptr->pnl=NULL;
-	mptr->pnlx=NULL;
-
-	CHECKMEM(mptr->pos=(double*) calloc(dim,sizeof(double)));
-	CHECKMEM(mptr->posx=(double*) calloc(dim,sizeof(double)));
-	CHECKMEM(mptr->via=(double*) calloc(dim,sizeof(double)));
-	CHECKMEM(mptr->posoffset=(double*) calloc(dim,sizeof(double)));
-	for(d=0;d<dim;d++)
-		mptr->pos[d]=mptr->posx[d]=mptr->via[d]=mptr->posoffset[d]=0;
-	return mptr;
+/* molallocslab */
+int molallocslab(molssptr mols,int dim,int nmolecs,moleculeptr *list) {
+	moleculeptr slab,*newslab;
+	double *dbl,**newslabdbl;
+	int m,d,sl,newmaxslab;
+
+	if(nmolecs<=0) return 0;
+	slab=NULL;
+	dbl=NULL;
+	if(mols->nslab==mols->maxslab) {							// expand slab lists
+		newmaxslab=2*mols->maxslab+1;
+		CHECKMEM(newslab=(moleculeptr*) realloc(mols->slab,newmaxslab*sizeof(moleculeptr)));
+		mols->slab=newslab;
+		CHECKMEM(newslabdbl=(double**) realloc(mols->slabdbl,newmaxslab*sizeof(double*)));
+		mols->slabdbl=newslabdbl;
+		for(sl=mols->maxslab;sl<newmaxslab;sl++) {
+			mols->slab[sl]=NULL;
+			mols->slabdbl[sl]=NULL; }
+		mols->maxslab=newmaxslab; }
+
+	CHECKMEM(slab=(moleculeptr) malloc(nmolecs*sizeof(struct moleculestruct)));
+	CHECKMEM(dbl=(double*) calloc(4*dim*nmolecs,sizeof(double)));
+	for(m=0;m<nmolecs;m++) {
+		slab[m].serno=0;
+		slab[m].list=-1;
+		slab[m].pos=dbl+(4*m)*dim;
+		slab[m].posx=dbl+(4*m+1)*dim;
+		slab[m].via=dbl+(4*m+2)*dim;
+		slab[m].posoffset=dbl+(4*m+3)*dim;
+		for(d=0;d<dim;d++)
+			slab[m].pos[d]=slab[m].posx[d]=slab[m].via[d]=slab[m].posoffset[d]=0;
+		slab[m].ident=0;
+		slab[m].mstate=MSsoln;
+		slab[m].box=NULL;
+		slab[m].pnl=NULL;
+		slab[m].pnlx=NULL;
+		list[m]=&slab[m]; }
+	mols->slab[mols->nslab]=slab;
+	mols->slabdbl[mols->nslab]=dbl;
+	mols->nslab++;
+	return 0;
  failure:
-	molfree(mptr);
-	simLog(NULL,10,"Unable to allocate memory in molalloc");
-	return NULL; }
+	free(slab);
+	free(dbl);
+	simLog(NULL,10,"Unable to allocate memory in molallocslab");
+	return 1; }
+
 
+/* molfreeslabs */
+void molfreeslabs(molssptr mols) {
+	int sl;
 
-/* molfree */
-void molfree(moleculeptr mptr) {
-	if(!mptr) return;
-	if(mptr->pos) free(mptr->pos);
-	if(mptr->posx) free(mptr->posx);
-	if(mptr->posoffset) free(mptr->posoffset);
-	if(mptr->via) free(mptr->via);
-	free(mptr);
+	for(sl=0;sl<mols->nslab;sl++) {
+		free(mols->slab[sl]);
+		free(mols->slabdbl[sl]); }
+	free(mols->slab);
+	free(mols->slabdbl);
+	mols->slab=NULL;
+	mols->slabdbl=NULL;
+	mols->maxslab=mols->nslab=0;
 	return; }
 
 
@@ -1607,6 +1722,7 @@ int molpatternalloc(simptr sim,int maxpattern) {
 	char **newpatlist;
 	int **newpatindex;
 	char **newpatrname;
+	int *newpatnext;
 
 	newpatlist=(char **) calloc(maxpattern,sizeof(char*));
 	if(!newpatlist) return 1;
@@ -1614,6 +1730,9 @@ int molpatternalloc(simptr sim,int maxpattern) {
 	if(!newpatindex) return 1;
 	newpatrname=(char **) calloc(maxpattern,sizeof(char*));
 	if(!newpatrname) return 1;
+	newpatnext=(int *) realloc(sim->mols->patnext,maxpattern*sizeof(int));
+	if(!newpatnext) return 1;
+	sim->mols->patnext=newpatnext;
 
 	for(i=0;i<sim->mols->maxpattern;i++) {
 		newpatlist[i]=sim->mols->patlist[i];
@@ -1626,7 +1745,8 @@ int molpatternalloc(simptr sim,int maxpattern) {
 		newpatindex[i]=NULL;
 		er=molpatternindexalloc(&newpatindex[i],PDMAX+1);
 		if(er) return 1;
-		newpatrname[i]=NULL; }
+		newpatrname[i]=NULL;
+		newpatnext[i]=-1; }
 
 	free(sim->mols->patlist);
 	free(sim->mols->patindex);
@@ -1658,11 +1778,14 @@ molssptr molssalloc(molssptr mols,int maxspecies) {
 		mols->maxspecies=0;
 		mols->nspecies=1;
 		mols->spname=NULL;
+		mols->sphash=NULL;
 		mols->maxpattern=0;
 		mols->npattern=0;
 		mols->patlist=NULL;
 		mols->patindex=NULL;
 		mols->patrname=NULL;
+		mols->patnext=NULL;
+		mols->pathash=NULL;
 		mols->difc=NULL;
 		mols->difstep=NULL;
 		mols->difm=NULL;
@@ -1676,6 +1799,11 @@ molssptr molssalloc(molssptr mols,int maxspecies) {
 		mols->maxd=0;
 		mols->nd=0;
 		mols->topd=0;
+		mols->maxreserve=0;
+		mols->maxslab=0;
+		mols->nslab=0;
+		mols->slab=NULL;
+		mols->slabdbl=NULL;
 		mols->maxlist=0;
 		mols->nlist=0;
 		mols->listlookup=NULL;
@@ -1703,6 +1831,8 @@ molssptr molssalloc(molssptr mols,int maxspecies) {
 			CHECKMEM(newspname[i]=EmptyString()); }
 
 		strncpy(newspname[0],"empty",STRCHAR-1);
+		if(oldmaxspecies==0) {
+			CHECKMEM(molhashadd(&mols->sphash,newspname[0],0)==0); }
 
 		CHECKMEM(newdifc=(double**) calloc(maxspecies,sizeof(double*)));
 		for(i=0;i<maxspecies;i++) newdifc[i]=NULL;
@@ -1863,7 +1993,8 @@ int mollistalloc(molssptr mols,int maxlist,enum MolListType mlt) {
 		if(mptr && mptr->list>=mols->maxlist && mptr->list<maxlist) maxl[mptr->list]++; }
 	for(ll=mols->maxlist;ll<maxlist;ll++) {
 		maxl[ll]*=2;
-		if(maxl[ll]>mols->maxd) maxl[ll]=mols->maxd; }
+		if(maxl[ll]>mols->maxd) maxl[ll]=mols->maxd;
+		if(maxl[ll]<mols->maxreserve) maxl[ll]=mols->maxreserve; }
 
 	for(ll=mols->maxlist;ll<maxlist;ll++) {			// allocate live lists
 		CHECKMEM(live[ll]=(moleculeptr*) calloc(maxl[ll],sizeof(moleculeptr)));
@@ -1909,7 +2040,7 @@ int mollistalloc(molssptr mols,int maxlist,enum MolListType mlt) {
 
 /* molexpandlist */
 int molexpandlist(molssptr mols,int dim,int ll,int nspaces,int nmolecs) {
-	moleculeptr *newlist,*oldlist;
+	moleculeptr *newlist;
 	int m,nold,maxold,maxnew;
 
 	if(!mols || ll>=mols->nlist) return 2;
@@ -1917,21 +2048,18 @@ int molexpandlist(molssptr mols,int dim,int ll,int nspaces,int nmolecs) {
 
 	maxold=ll<0?mols->maxd:mols->maxl[ll];				// maxold is previous allocated size
 	nold=ll<0?mols->nd:mols->nl[ll];							// nold is previous number of molecules
-	oldlist=ll<0?mols->dead:mols->live[ll];				// oldlist is previous list
+	newlist=ll<0?mols->dead:mols->live[ll];				// newlist is previous list
 
 	maxnew=nspaces>0?maxold+nspaces:2*maxold+1;		// maxnew is new allocated size
 	if(nold+nmolecs>maxnew) return 3;
 
-	newlist=(moleculeptr*) calloc(maxnew,sizeof(moleculeptr));
+	newlist=(moleculeptr*) realloc(newlist,maxnew*sizeof(moleculeptr));
 	CHECKMEM(newlist);
-	for(m=0;m<maxold;m++) newlist[m]=oldlist[m];
-	for(;m<maxnew;m++) newlist[m]=NULL;
+	for(m=maxold;m<maxnew;m++) newlist[m]=NULL;
 	if(ll<0) {
-		free(mols->dead);
 		mols->dead=newlist;
 		mols->maxd=maxnew; }
 	else {
-		free(mols->live[ll]);
 		mols->live[ll]=newlist;
 		mols->maxl[ll]=maxnew; }
 
@@ -1939,9 +2067,7 @@ int molexpandlist(molssptr mols,int dim,int ll,int nspaces,int nmolecs) {
 		for(m=mols->nd-1;m>=mols->topd;m--) {					// copy resurrected molecules higher on list
 			newlist[m+nmolecs]=newlist[m];
 			newlist[m]=NULL; }
-		for(m=mols->topd;m<mols->topd+nmolecs;m++) {		// create new empty molecules
-			newlist[m]=molalloc(dim);
-			if(!newlist[m]) return 4; }
+		if(molallocslab(mols,dim,nmolecs,newlist+mols->topd)) return 4;	// create new empty molecules
 		mols->topd+=nmolecs;
 		mols->nd+=nmolecs; }
 	return 0;
@@ -1952,7 +2078,7 @@ failure:
 
 /* molssfree */
 void molssfree(molssptr mols,int maxsrf) {
-	int m,ll,i,maxspecies;
+	int ll,i,maxspecies;
 	enum MolecState ms;
 
 	if(!mols) return;
@@ -1964,9 +2090,7 @@ void molssfree(molssptr mols,int maxsrf) {
 
 	for(ll=0;ll<mols->maxlist;ll++) {
 		if(mols->listname) free(mols->listname[ll]);
-		if(mols->live && mols->live[ll]) {
-			for(m=0;m<mols->nl[ll];m++) molfree(mols->live[ll][m]);
-			free(mols->live[ll]); }}
+		if(mols->live) free(mols->live[ll]); }
 	free(mols->diffuselist);
 	free(mols->sortl);
 	free(mols->topl);
@@ -1984,9 +2108,8 @@ void molssfree(molssptr mols,int maxsrf) {
 		for(i=0;i<maxspecies;i++) free(mols->exist[i]);
 		free(mols->exist); }
 
-	if(mols->dead) {
-		for(m=0;m<mols->nd;m++) molfree(mols->dead[m]);
-		free(mols->dead); }
+	free(mols->dead);
+	molfreeslabs(mols);
 
 	if(mols->color) {
 		for(i=0;i<maxspecies;i++)
@@ -2035,6 +2158,10 @@ void molssfree(molssptr mols,int maxsrf) {
 		for(i=0;i<mols->maxpattern;i++) free(mols->patlist[i]);
 		free(mols->patlist); }
 
+	free(mols->patnext);
+	molhashfree(&mols->pathash);
+	molhashfree(&mols->sphash);
+
 	if(mols->spname) {
 		for(i=0;i<maxspecies;i++) free(mols->spname[i]);
 		free(mols->spname); }
@@ -2177,6 +2304,7 @@ void molssoutput(simptr sim) {
 	if(mols->topd!=mols->nd) simLog(sim,1,", top value=%i",mols->topd);
 	simLog(sim,1,"\n");
 	if(mols->maxdlimit>=0) simLog(sim,1,"  limited to %i molecules\n",mols->maxdlimit);
+	if(mols->maxreserve>0) simLog(sim,1,"  preallocated for %i molecules in %i slabs\n",mols->maxreserve,mols->nslab);
 
 	simLog(sim,2," Overall spatial resolution:");
 	if(maxstep==-1 || mols->condition<SCok) simLog(sim,2," not computed\n");
@@ -2204,6 +2332,8 @@ void writemols(simptr sim,FILE *fptr) {
 	fprintf(fptr,"\n");
 	if(sim->mols->maxdlimit>=0)
 		fprintf(fptr,"max_mol %i\n",sim->mols->maxdlimit);
+	if(sim->mols->maxreserve>0)
+		fprintf(fptr,"reserve_mol %i\n",sim->mols->maxreserve);
 	fprintf(fptr,"gauss_table_size %i\n\n",mols->ngausstbl);
 
 	for(ll=0;ll<mols->nlist;ll++)
@@ -2465,6 +2595,29 @@ int molsetmaxmol(simptr sim,int max) {
 	return 0; }
 
 
+/* molreserve */
+int molreserve(simptr sim,int nmolecs) {
+	molssptr mols;
+	int ll,er;
+
+	if(!sim->mols) {
+		er=molenablemols(sim,-1);
+		if(er) return er; }
+	mols=sim->mols;
+	if(nmolecs<0) return 2;
+	if(mols->maxdlimit>=0 && nmolecs>mols->maxdlimit) return 3;
+
+	if(nmolecs>mols->maxd) {
+		er=molexpandlist(mols,sim->dim,-1,nmolecs-mols->maxd,nmolecs-mols->maxd);
+		if(er) return 1; }
+	for(ll=0;ll<mols->nlist;ll++)
+		if(mols->maxl[ll]<nmolecs) {
+			er=molexpandlist(mols,sim->dim,ll,nmolecs-mols->maxl[ll],0);
+			if(er) return 1; }
+	if(nmolecs>mols->maxreserve) mols->maxreserve=nmolecs;
+	return 0; }
+
+
 /* moladdspecies */
 int moladdspecies(simptr sim,const char *nm) {
 	molssptr mols;
@@ -2476,10 +2629,12 @@ int moladdspecies(simptr sim,const char *nm) {
 	if(!strcmp(nm,"empty")) return -4;
 	if(strchr(nm,'?') || strchr(nm,'*')) return -6;
 
-	found=stringfind(mols->spname,mols->nspecies,nm);
+	found=molfindspecies(mols,nm);
 	if(found>=0) return -5;
 
-	strncpy(mols->spname[mols->nspecies++],nm,STRCHAR);
+	strncpy(mols->spname[mols->nspecies],nm,STRCHAR-1);
+	if(molhashadd(&mols->sphash,mols->spname[mols->nspecies],mols->nspecies)) return -1;
+	mols->nspecies++;
 	molsetcondition(mols,SClists,0);
 	rxnsetcondition(sim,-1,SClists,0);
 	surfsetcondition(sim->srfss,SClists,0);
@@ -2689,6 +2844,47 @@ void molkill(simptr sim,moleculeptr mptr,int ll,int m) {
 	return; }
 
 
+/* molsernocompare */
+int molsernocompare(const void *a,const void *b) {
+	unsigned long long sa,sb;
+
+	sa=*(const unsigned long long*)a;
+	sb=*(const unsigned long long*)b;
+	return (sa>sb)-(sa<sb); }
+
+
+/* molkillserials */
+int molkillserials(simptr sim,int nserno,const unsigned long long *sernolist) {
+	molssptr mols;
+	moleculeptr mptr;
+	unsigned long long *sorted;
+	int ll,m,count;
+
+	mols=sim->mols;
+	if(!mols || nserno<=0) return 0;
+	sorted=(unsigned long long*) malloc(nserno*sizeof(unsigned long long));
+	if(!sorted) return -1;
+	memcpy(sorted,sernolist,nserno*sizeof(unsigned long long));
+	qsort(sorted,nserno,sizeof(unsigned long long),molsernocompare);
+
+	count=0;
+	for(ll=0;ll<mols->nlist;ll++)
+		for(m=0;m<mols->nl[ll];m++) {
+			mptr=mols->live[ll][m];
+			if(mptr->ident>0 && bsearch(&mptr->serno,sorted,nserno,sizeof(unsigned long long),molsernocompare)) {
+				molkill(sim,mptr,ll,m);
+				count++; }}
+	for(m=mols->topd;m<mols->nd;m++) {							// resurrected molecules
+		mptr=mols->dead[m];
+		if(mptr->ident>0 && bsearch(&mptr->serno,sorted,nserno,sizeof(unsigned long long),molsernocompare)) {
+			molkill(sim,mptr,-1,-1);
+			count++; }}
+	free(sorted);
+
+	if(count && molsort(sim,0)) return -1;
+	return count; }
+
+
 /* getnextmol */
 moleculeptr getnextmol(molssptr mols) {
 	moleculeptr mptr;
@@ -2740,6 +2936,31 @@ int addmol(simptr sim,int nmol,int ident,double *poslo,double *poshi,int sort) {
 	return 0; }
 
 
+/* addmolpositions */
+int addmolpositions(simptr sim,int nmol,int ident,double *poslist,int sort) {
+	int m,d,dim;
+	moleculeptr mptr;
+
+	dim=sim->dim;
+	for(m=0;m<nmol;m++) {
+		mptr=getnextmol(sim->mols);
+		if(!mptr) return 3;
+		mptr->ident=ident;
+		mptr->mstate=MSsoln;
+		mptr->list=sim->mols->listlookup[ident][MSsoln];
+		for(d=0;d<dim;d++)
+			mptr->posx[d]=mptr->pos[d]=poslist[m*dim+d];
+		if(sim->boxs && sim->boxs->nbox)
+			mptr->box=pos2box(sim,mptr->pos);
+		else mptr->box=NULL; }
+	if(nmol>0) {
+		molsetexist(sim,ident,MSsoln,1);
+		sim->mols->expand[ident]|=1; }
+	if(sort)
+		if(molsort(sim,1)) return 1;
+	return 0; }
+
+
 /* addsurfmol */
 int addsurfmol(simptr sim,int nmol,int ident,enum MolecState ms,double *pos,panelptr pnl,int surface,enum PanelShape ps,char *pname) {
 	int dim,m,d,totpanel,panel;
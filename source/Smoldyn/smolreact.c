@@ -50,6 +50,7 @@ int findreverserxn(simptr sim,int order,int r,int *optr,int *rptr);
 // memory management
 rxnptr rxnalloc(int order);
 rxnssptr rxnssalloc(rxnssptr rxnss,int order,int maxspecies);
+int rxnaddset(rxnssptr rxnss,const int *ident);
 
 // data structure output
 
@@ -59,6 +60,7 @@ int rxnsetproduct(simptr sim,int order,int r, char* errstr);
 int rxnsetproducts(simptr sim,int order, char* errstr);
 double rxncalcrate(simptr sim,int order,int r,double *pgemptr);
 void rxncalctau(simptr sim,int order);
+void rxnsetmolbindrad(simptr sim);
 
 // structure set up
 void RxnCopyRevparam(simptr sim,rxnptr rxn,const rxnptr templ);
@@ -164,7 +166,7 @@ int readrxnname(simptr sim,const char *rname,int *orderptr,rxnptr *rxnpt,listptr
 		r=-1;
 		for(order=0;order<MAXORDER;order++)					// look for a reaction with this name
 			if(sim->rxnss[order]) {
-				r=stringfind(sim->rxnss[order]->rname,sim->rxnss[order]->totrxn,rname);
+				r=rxnfindname(sim->rxnss[order],rname);
 				if(r>=0) {															// found a reaction with this name
 					if(orderptr) *orderptr=order;
 					if(rxnpt) *rxnpt=sim->rxnss[order]->rxn[r];
@@ -229,6 +231,12 @@ int readrxnname(simptr sim,const char *rname,int *orderptr,rxnptr *rxnpt,listptr
 	return -1; }
 
 
+/* rxnfindname */
+int rxnfindname(rxnssptr rxnss,const char *rname) {
+	if(!rxnss) return -1;
+	return molhashfind(rxnss->rnamehash,rname); }
+
+
 /* rxnpackident */
 int rxnpackident(int order,int maxspecies,const int *ident) {
 	if(order==0) return 0;
@@ -245,6 +253,24 @@ void rxnunpackident(int order,int maxspecies,int ipack,int *ident) {
 	return; }
 
 
+/* rxnfindset */
+int rxnfindset(rxnssptr rxnss,const int *ident) {
+	int lo,hi,mid,*partner;
+
+	if(rxnss->order==0) return 0;
+	if(rxnss->order==1) return ident[0];
+	if(rxnss->denseset) return rxnss->denseset[ident[0]*rxnss->maxspecies+ident[1]];
+	partner=rxnss->partner[ident[0]];								// binary search of sorted partner list
+	lo=0;
+	hi=rxnss->npartner[ident[0]];
+	while(lo<hi) {
+		mid=(lo+hi)>>1;
+		if(partner[mid]<ident[1]) lo=mid+1;
+		else hi=mid; }
+	if(lo<rxnss->npartner[ident[0]] && partner[lo]==ident[1]) return rxnss->partnerset[ident[0]][lo];
+	return 0; }
+
+
 /* rxnpackstate */
 enum MolecState rxnpackstate(int order,enum MolecState *mstate) {
 	if(order==0) return (enum MolecState)0;
@@ -358,7 +384,7 @@ int findreverserxn(simptr sim,int order,int r,int *optr,int *rptr) {
 	else {
 		orderr=rxn->nprod;
 		rxnssr=sim->rxnss[orderr];
-		identr=rxnpackident(orderr,rxnssr->maxspecies,rxn->prdident);
+		identr=rxnfindset(rxnssr,rxn->prdident);
 		mstater=rxnpackstate(orderr,rxn->prdstate);
 
 		rev=0;
@@ -367,7 +393,7 @@ int findreverserxn(simptr sim,int order,int r,int *optr,int *rptr) {
 			rxnr=rxnssr->rxn[rr];
 			if(rxnr->permit[mstater]) {
 				if(rev!=1 && rxnr->nprod==order && Zn_sameset(rxn->rctident,rxnr->prdident,work,order)) {
-					identrprd=rxnpackident(order,rxnss->maxspecies,rxnr->prdident);
+					identrprd=rxnfindset(rxnss,rxnr->prdident);
 					mstaterprd=rxnpackstate(order,rxnr->prdstate);
 					for(jr=0;jr<rxnss->nrxn[identrprd];jr++)
 						if(rxnss->table[identrprd][jr]==r && rxnss->rxn[r]->permit[mstaterprd]) {
@@ -612,7 +638,7 @@ void rxnfree(rxnptr rxn) {
 /* rxnssalloc */
 rxnssptr rxnssalloc(rxnssptr rxnss,int order,int maxspecies) {
 	int newni2o,oldni2o,i,i2,failfree;
-	int ilist[MAXORDER],*newnrxn,**newtable;
+	int ilist[MAXORDER],*newnrxn,**newtable,*newnpartner,**newpartner,**newpartnerset,*newdenseset,k;
 
 	failfree=0;
 	if(!rxnss) {																				// new reaction superstructure
@@ -626,14 +652,30 @@ rxnssptr rxnssalloc(rxnssptr rxnss,int order,int maxspecies) {
 		rxnss->maxlist=0;
 		rxnss->nrxn=NULL;
 		rxnss->table=NULL;
+		rxnss->maxset=0;
+		rxnss->nset=0;
+		rxnss->npartner=NULL;
+		rxnss->partner=NULL;
+		rxnss->partnerset=NULL;
+		rxnss->denseset=NULL;
 		rxnss->maxrxn=0;
 		rxnss->totrxn=0;
 		rxnss->rname=NULL;
+		rxnss->rnamehash=NULL;
 		rxnss->rxn=NULL;
-		rxnss->rxnmollist=NULL; }
+		rxnss->rxnmollist=NULL;
+		rxnss->rxnmolbindrad2=NULL;
+
+		if(order==2) {																		// reactant set 0 is the empty set
+			CHECKMEM(rxnss->nrxn=(int*) calloc(1,sizeof(int)));
+			rxnss->nrxn[0]=0;
+			CHECKMEM(rxnss->table=(int**) calloc(1,sizeof(int*)));
+			rxnss->table[0]=NULL;
+			rxnss->maxset=1;
+			rxnss->nset=1; }}
 
 	if(maxspecies>rxnss->maxspecies) {									// initialize or expand nrxn and table
-		if(order>0) {
+		if(order==1) {																		// order 1 sets are dense, indexed by packed identities
 			newni2o=intpower(maxspecies,order);							// allocate new stuff
 			CHECKMEM(newnrxn=(int*) calloc(newni2o,sizeof(int)));
 			for(i=0;i<newni2o;i++) newnrxn[i]=0;
@@ -650,7 +692,28 @@ rxnssptr rxnssalloc(rxnssptr rxnss,int order,int maxspecies) {
 			free(rxnss->nrxn);															// replace nrxn and table with new ones
 			rxnss->nrxn=newnrxn;
 			free(rxnss->table);
-			rxnss->table=newtable; }
+			rxnss->table=newtable;
+			rxnss->maxset=rxnss->nset=newni2o; }
+
+		else if(order==2) {																// order 2 sets are sparse, so just expand partner lists
+			CHECKMEM(newnpartner=(int*) realloc(rxnss->npartner,maxspecies*sizeof(int)));
+			rxnss->npartner=newnpartner;
+			CHECKMEM(newpartner=(int**) realloc(rxnss->partner,maxspecies*sizeof(int*)));
+			rxnss->partner=newpartner;
+			CHECKMEM(newpartnerset=(int**) realloc(rxnss->partnerset,maxspecies*sizeof(int*)));
+			rxnss->partnerset=newpartnerset;
+			for(i=rxnss->maxspecies;i<maxspecies;i++) {
+				rxnss->npartner[i]=0;
+				rxnss->partner[i]=NULL;
+				rxnss->partnerset[i]=NULL; }
+			newdenseset=NULL;																// dense index of sets for bireact, if small enough
+			if(maxspecies<=RXNDENSEMAX) {
+				CHECKMEM(newdenseset=(int*) calloc(maxspecies*maxspecies,sizeof(int)));
+				for(i=0;i<rxnss->maxspecies;i++)
+					for(k=0;k<rxnss->npartner[i];k++)
+						newdenseset[i*maxspecies+rxnss->partner[i][k]]=rxnss->partnerset[i][k]; }
+			free(rxnss->denseset);
+			rxnss->denseset=newdenseset; }
 		rxnss->maxspecies=maxspecies; }										// set maxspecies
 
 	return rxnss;
@@ -661,24 +724,76 @@ rxnssptr rxnssalloc(rxnssptr rxnss,int order,int maxspecies) {
 	return NULL; }
 
 
+/* rxnaddset */
+int rxnaddset(rxnssptr rxnss,const int *ident) {
+	int s,k,i,ip,ipartner,newmaxset,*newnrxn,**newtable,*newpartner,*newpartnerset;
+
+	s=rxnfindset(rxnss,ident);
+	if(s>0 || rxnss->order<2) return s;
+
+	if(rxnss->nset==rxnss->maxset) {										// expand reactant set list
+		newmaxset=2*rxnss->maxset+1;
+		newnrxn=(int*) realloc(rxnss->nrxn,newmaxset*sizeof(int));
+		if(!newnrxn) return -1;
+		rxnss->nrxn=newnrxn;
+		newtable=(int**) realloc(rxnss->table,newmaxset*sizeof(int*));
+		if(!newtable) return -1;
+		rxnss->table=newtable;
+		for(s=rxnss->maxset;s<newmaxset;s++) {
+			rxnss->nrxn[s]=0;
+			rxnss->table[s]=NULL; }
+		rxnss->maxset=newmaxset; }
+	s=rxnss->nset;
+
+	for(ip=0;ip<2;ip++) {																// add to sorted partner list of both reactants
+		i=ident[ip];
+		ipartner=ident[!ip];
+		if(ip==1 && i==ipartner) break;
+		newpartner=(int*) realloc(rxnss->partner[i],(rxnss->npartner[i]+1)*sizeof(int));
+		if(!newpartner) return -1;
+		rxnss->partner[i]=newpartner;
+		newpartnerset=(int*) realloc(rxnss->partnerset[i],(rxnss->npartner[i]+1)*sizeof(int));
+		if(!newpartnerset) return -1;
+		rxnss->partnerset[i]=newpartnerset;
+		for(k=rxnss->npartner[i];k>0 && newpartner[k-1]>ipartner;k--) {
+			newpartner[k]=newpartner[k-1];
+			newpartnerset[k]=newpartnerset[k-1]; }
+		newpartner[k]=ipartner;
+		newpartnerset[k]=s;
+		rxnss->npartner[i]++;
+		if(rxnss->denseset) rxnss->denseset[i*rxnss->maxspecies+ipartner]=s; }
+
+	rxnss->nset++;
+	return s; }
+
+
 /* rxnssfree */
 void rxnssfree(rxnssptr rxnss) {
-	int r,i,ni2o;
+	int r,i;
 
 	if(!rxnss) return;
 
 	free(rxnss->rxnmollist);
+	free(rxnss->rxnmolbindrad2);
 	if(rxnss->rxn)
 		for(r=0;r<rxnss->maxrxn;r++) rxnfree(rxnss->rxn[r]);
 	free(rxnss->rxn);
 	if(rxnss->rname)
 		for(r=0;r<rxnss->maxrxn;r++) free(rxnss->rname[r]);
 	free(rxnss->rname);
+	molhashfree(&rxnss->rnamehash);
 	if(rxnss->table) {
-		ni2o=intpower(rxnss->maxspecies,rxnss->order);
-		for(i=0;i<ni2o;i++) free(rxnss->table[i]);
+		for(i=0;i<rxnss->nset;i++) free(rxnss->table[i]);
 		free(rxnss->table); }
 	free(rxnss->nrxn);
+	if(rxnss->partner) {
+		for(i=0;i<rxnss->maxspecies;i++) {
+			free(rxnss->partner[i]);
+			free(rxnss->partnerset[i]); }
+		free(rxnss->partner);
+		free(rxnss->partnerset); }
+	free(rxnss->npartner);
+	free(rxnss->denseset);
 	free(rxnss);
 	return; }
 
@@ -704,7 +819,7 @@ int rxnexpandmaxspecies(simptr sim,int maxspecies) {
 /* rxnoutput */
 void rxnoutput(simptr sim,int order) {
 	rxnssptr rxnss;
-	int d,dim,maxlist,maxll2o,ll,ord,ni2o,i,j,r,rct,prd,rev,identlist[MAXORDER],orderr,rr,i1,i2,o2,r2;
+	int d,dim,maxlist,maxll2o,ll,ord,i,j,k,r,rct,prd,rev,identlist[MAXORDER],orderr,rr,i1,i2,o2,r2;
 	rxnptr rxn,revrxn;
 	enum MolecState ms,ms1,ms2,nms2o,statelist[MAXORDER];
 	double dsum,step,pgem,rate3,bindrad,ratio,smolmodelrate,actualrate,revunbindrad,chi,lambdap;
@@ -747,11 +862,11 @@ void rxnoutput(simptr sim,int order) {
 
 	if(order>0) {
 		simLog(sim,2," Reactants, sorted by molecule species:\n");
-		ni2o=intpower(rxnss->maxspecies,order);
-		for(i=0;i<ni2o;i++)
-			if(rxnss->nrxn[i]) {
-				rxnunpackident(order,rxnss->maxspecies,i,identlist);
-				if(Zn_issort(identlist,order)>=1) {
+		for(identlist[0]=0;identlist[0]<rxnss->maxspecies;identlist[0]++)
+			for(k=0;k<(order==1?1:rxnss->npartner[identlist[0]]);k++) {
+				if(order==2) identlist[1]=rxnss->partner[identlist[0]][k];
+				i=rxnfindset(rxnss,identlist);
+				if(rxnss->nrxn[i] && Zn_issort(identlist,order)>=1) {
 					simLog(sim,2,"  ");
 					for(ord=0;ord<order;ord++)
 						simLog(sim,2,"%s%s",sim->mols->spname[identlist[ord]],ord<order-1?"+":"");
@@ -925,7 +1040,7 @@ void rxnoutput(simptr sim,int order) {
 				simLog(sim,2,"\n"); }}
 
 		if(rxn->nprod==2 && sim->rxnss[2] && rxn->rparamt!=RPconfspread && rxn->rparamt!=RPbounce) {
-			i=rxnpackident(2,rxnss->maxspecies,rxn->prdident);
+			i=rxnfindset(sim->rxnss[2],rxn->prdident);
 			for(j=0;j<sim->rxnss[2]->nrxn[i];j++) {
 				rr=sim->rxnss[2]->table[i][j];
 				revrxn=sim->rxnss[2]->rxn[rr];
@@ -1039,7 +1154,7 @@ void writereactions(simptr sim,FILE *fptr) {
 
 /* checkrxnparams */
 int checkrxnparams(simptr sim,int *warnptr) {
-	int d,dim,warn,error,i1,i2,j,nspecies,r,i,ct,j1,j2,order,prd,vflag,prdparamflag;
+	int d,dim,warn,error,i1,i2,j,k,nspecies,r,i,ct,j1,j2,order,prd,vflag,prdparamflag;
 	int rev,o2,r2;
 	long int pserno,bitcode;
 	molssptr mols;
@@ -1095,8 +1210,9 @@ int checkrxnparams(simptr sim,int *warnptr) {
 	rxnss=sim->rxnss[2];															// check for multiple bimolecular reactions with same reactants
 	if(rxnss) {
 		for(i1=1;i1<nspecies;i1++)
-			for(i2=1;i2<=i1;i2++)	{
-				i=i1*rxnss->maxspecies+i2;
+			for(k=0;k<rxnss->npartner[i1] && rxnss->partner[i1][k]<=i1;k++)	{
+				i2=rxnss->partner[i1][k];
+				i=rxnss->partnerset[i1][k];
 				for(j1=0;j1<rxnss->nrxn[i];j1++) {
 					rxn1=rxnss->rxn[rxnss->table[i][j1]];
 					for(j2=0;j2<j1;j2++) {
@@ -1128,8 +1244,8 @@ int checkrxnparams(simptr sim,int *warnptr) {
 	if(rxnss)
 		for(i1=1;i1<nspecies;i1++)
 			if(mols->difm[i1][MSsoln])
-				for(i2=1;i2<i1;i2++)
-					for(j=0;j<rxnss->nrxn[i=i1*rxnss->maxspecies+i2];j++) {
+				for(k=0;k<rxnss->npartner[i1] && rxnss->partner[i1][k]<i1;k++)
+					for(j=0;j<rxnss->nrxn[i=rxnss->partnerset[i1][k]];j++) {
 						rxn=rxnss->rxn[rxnss->table[i][j]];
 						if(rxn->rate) {
 							simLog(sim,5," WARNING: diffusion matrix for %s was ignored for calculating rate for reaction %s\n",spname[i1],rxn->rname);
@@ -1139,8 +1255,8 @@ int checkrxnparams(simptr sim,int *warnptr) {
 	if(rxnss)
 		for(i1=1;i1<nspecies;i1++)
 			if(mols->drift[i1][MSsoln])
-				for(i2=1;i2<i1;i2++)
-					for(j=0;j<rxnss->nrxn[i=i1*rxnss->maxspecies+i2];j++) {
+				for(k=0;k<rxnss->npartner[i1] && rxnss->partner[i1][k]<i1;k++)
+					for(j=0;j<rxnss->nrxn[i=rxnss->partnerset[i1][k]];j++) {
 						rxn=rxnss->rxn[rxnss->table[i][j]];
 						if(rxn->rate) {
 							simLog(sim,5," WARNING: drift vector for %s was ignored for calculating rate for reaction %s\n",spname[i1],rxn->rname);
@@ -1149,7 +1265,7 @@ int checkrxnparams(simptr sim,int *warnptr) {
 	for(order=1;order<=2;order++) {									// product surface-bound states imply reactant surface-bound
 		rxnss=sim->rxnss[order];
 		if(rxnss) {
-			for(i=1;i<intpower(rxnss->maxspecies,order);i++)
+			for(i=1;i<rxnss->nset;i++)
 				for(j=0;j<rxnss->nrxn[i];j++) {
 					rxn=rxnss->rxn[rxnss->table[i][j]];
 					if(rxn->permit[order==1?MSsoln:MSsoln*MSMAX1+MSsoln]) {
@@ -1279,9 +1395,9 @@ int checkrxnparams(simptr sim,int *warnptr) {
 		vol2=0;
 		for(i=1;i<nspecies;i++) {
 			amax=0;
-			for(i1=1;i1<nspecies;i1++)
-				for(j=0;j<rxnss->nrxn[i*rxnss->maxspecies+i1];j++) {
-					r=rxnss->table[i*rxnss->maxspecies+i1][j];
+			for(k=0;k<rxnss->npartner[i];k++)
+				for(j=0;j<rxnss->nrxn[rxnss->partnerset[i][k]];j++) {
+					r=rxnss->table[rxnss->partnerset[i][k]][j];
 					rxn=rxnss->rxn[r];
 					if(amax<sqrt(rxn->bindrad2)) amax=sqrt(rxn->bindrad2); }
 			ct=molcount(sim,i,NULL,MSsoln,-1);
@@ -1635,9 +1751,9 @@ double rxncalcrate(simptr sim,int order,int r,double *pgemptr) {
 		else {
 			i1=rxn->rctident[0];
 			i2=rxn->rctident[1];
-			i=rxnpackident(order,rxnss->maxspecies,rxn->rctident);
+			i=rxnfindset(rxnss,rxn->rctident);
 			for(j=0;j<rxnss->nrxn[i] && rxnss->table[i][j]!=r;j++);
-			if(rxnss->table[i][j]!=r) return -1;
+			if(j==rxnss->nrxn[i]) return -1;
 			permit=rxnreactantstate(rxn,statelist,1);
 			ms1=statelist[0];
 			ms2=statelist[1];
@@ -1707,6 +1823,37 @@ void rxncalctau(simptr sim,int order) {
 	return; }
 
 
+/* rxnsetmolbindrad */
+void rxnsetmolbindrad(simptr sim) {
+	rxnssptr rxnss;
+	rxnptr rxn;
+	int r,maxlist,ll,ll1,ll2;
+	enum MolecState ms1,ms2;
+	double bindrad2;
+
+	rxnss=sim->rxnss[2];
+	if(!rxnss || !rxnss->rxnmolbindrad2) return;
+
+	maxlist=rxnss->maxlist;
+	for(ll=0;ll<maxlist*maxlist;ll++) rxnss->rxnmolbindrad2[ll]=-1;
+	for(r=0;r<rxnss->totrxn;r++) {
+		rxn=rxnss->rxn[r];
+		bindrad2=rxn->bindrad2;
+#ifdef OPTION_VCELL
+		if(rxn->rateValueProvider != NULL) bindrad2=DBL_MAX;				// rate is reevaluated during the simulation
+#endif
+		for(ms1=(enum MolecState)0;ms1<MSMAX1;ms1=(enum MolecState)(ms1+1))
+			for(ms2=(enum MolecState)0;ms2<MSMAX1;ms2=(enum MolecState)(ms2+1))
+				if(rxn->permit[ms1*MSMAX1+ms2]) {
+					ll1=sim->mols->listlookup[rxn->rctident[0]][ms1==MSbsoln?MSsoln:ms1];
+					ll2=sim->mols->listlookup[rxn->rctident[1]][ms2==MSbsoln?MSsoln:ms2];
+					if(bindrad2>rxnss->rxnmolbindrad2[ll1*maxlist+ll2]) {
+						rxnss->rxnmolbindrad2[ll1*maxlist+ll2]=bindrad2;
+						rxnss->rxnmolbindrad2[ll2*maxlist+ll1]=bindrad2; }}}
+
+	return; }
+
+
 /******************************************************************************/
 /****************************** structure set up ******************************/
 /******************************************************************************/
@@ -2064,10 +2211,10 @@ int RxnSetLog(simptr sim,char *filename,rxnptr rxn,listptrli list,int turnon) {
 rxnptr RxnAddReaction(simptr sim,const char *rname,int order,int *rctident,enum MolecState *rctstate,int nprod,int *prdident,enum MolecState *prdstate,compartptr cmpt,surfaceptr srf) {
 	char **newrname,string[STRCHAR];
 	rxnptr *newrxn;
-	int *newtable,identlist[MAXORDER],vflag;
+	int *newtable,vflag;
 	rxnssptr rxnss;
 	rxnptr rxn;
-	int maxrxn,maxspecies,i,j,r,rct,prd,d,k,done,freerxn;
+	int maxrxn,i,r,rct,prd,d,freerxn;
 
 	rxnss=NULL;
 	rxn=NULL;
@@ -2084,8 +2231,7 @@ rxnptr RxnAddReaction(simptr sim,const char *rname,int order,int *rctident,enum
 		rxnsetcondition(sim,order,SCinit,0);
 		rxnsetcondition(sim,-1,SClists,0); }
 	rxnss=sim->rxnss[order];
-	maxspecies=rxnss->maxspecies;
-	r=stringfind(rxnss->rname,rxnss->totrxn,rname);		// r is reaction index
+	r=rxnfindname(rxnss,rname);												// r is reaction index
 
 	if(r>=0) {
 		CHECKBUG(rxnss->rxn[r]->nprod==0,"RxnAddReaction cannot be called for a reaction that already has products");
@@ -2116,24 +2262,18 @@ rxnptr RxnAddReaction(simptr sim,const char *rname,int order,int *rctident,enum
 			for(rct=0;rct<order;rct++) rxn->rctstate[rct]=rctstate[rct];
 			RxnSetPermit(sim,rxn,order,rctstate,1); }
 
-		if(order>0) {																		// set up nrxn and table; table is automatically enlarged
-			k=0;
-			done=0;
-			while(!done) {
-				k=Zn_permute(rctident,identlist,order,k);
-				CHECKBUG(k!=-1,"SMOLDYN BUG: Zn_permute.\n");
-				if(k==0) done=1;
-				i=rxnpackident(order,maxspecies,identlist);
-				CHECKMEM(newtable=(int*)calloc(rxnss->nrxn[i]+1,sizeof(int)));
-				for(j=0;j<rxnss->nrxn[i];j++) newtable[j]=rxnss->table[i][j];
-				newtable[j]=rxnss->totrxn;
-				free(rxnss->table[i]);
-				rxnss->table[i]=newtable;
-				newtable=NULL;
-				rxnss->nrxn[i]++; }}
+		if(order>0) {																		// set up nrxn and table; both reactant orders share a set
+			i=rxnaddset(rxnss,rctident);
+			CHECKMEM(i>=0);
+			CHECKMEM(newtable=(int*)realloc(rxnss->table[i],(rxnss->nrxn[i]+1)*sizeof(int)));
+			newtable[rxnss->nrxn[i]]=rxnss->totrxn;
+			rxnss->table[i]=newtable;
+			newtable=NULL;
+			rxnss->nrxn[i]++; }
 
 		strncpy(rxnss->rname[rxnss->totrxn],rname,STRCHAR-1);		// plug in reaction
 		rxnss->rname[rxnss->totrxn][STRCHAR-1]='\0';
+		CHECKMEM(!molhashadd(&rxnss->rnamehash,rxnss->rname[rxnss->totrxn],rxnss->totrxn));
 		rxnss->totrxn++;
 		rxnss->rxn[rxnss->totrxn-1]=rxn; }
 	freerxn=0;
@@ -2180,7 +2320,7 @@ rxnptr RxnAddReaction(simptr sim,const char *rname,int order,int *rctident,enum
 
 /* RxnTestRxnExist */
 rxnptr RxnTestRxnExist(simptr sim,int order,const char *rname,const int *rctident,const enum MolecState *rctstate,int nprod,const int *prdident,const enum MolecState *prdstate,int exact) {
-	int i,j,maxspecies,work[MAXPRODUCT],r;
+	int i,j,work[MAXPRODUCT],r;
 	const char *chptr;
 	rxnssptr rxnss;
 	rxnptr rxn;
@@ -2189,11 +2329,10 @@ rxnptr RxnTestRxnExist(simptr sim,int order,const char *rname,const int *rctiden
 	rxnss=sim->rxnss[order];
 
 	if(exact) {																		// exact match so just check name
-		r=stringfind(rxnss->rname,rxnss->totrxn,rname);
+		r=rxnfindname(rxnss,rname);
 		if(r>=0) return rxnss->rxn[r];
 		else return NULL; }
 
-	maxspecies=rxnss->maxspecies;									// during expansion
 	if(order==0) {
 		for(j=0;j<rxnss->totrxn;j++) {
 			rxn=rxnss->rxn[j];												// rxn is same if same name or name portion and same reactants and same products
@@ -2204,7 +2343,7 @@ rxnptr RxnTestRxnExist(simptr sim,int order,const char *rname,const int *rctiden
 						if(Zn_sameset(prdident,rxn->prdident,work,nprod) && Zn_sameset((int*)prdstate,(int*)(rxn->prdstate),work,nprod))
 							return rxn; }}}
 	else {
-		i=rxnpackident(order,maxspecies,rctident);
+		i=rxnfindset(rxnss,rctident);
 		if(!rxnss->nrxn[i]) return NULL;
 		for(j=0;j<rxnss->nrxn[i];j++) {
 			rxn=rxnss->rxn[rxnss->table[i][j]];
@@ -2313,6 +2452,8 @@ int rxnsupdateparams(simptr sim) {
 		if(sim->rxnss[order] && sim->rxnss[order]->condition<=SCparams)
 			rxncalctau(sim,order);
 
+	rxnsetmolbindrad(sim);															// binding radii for box culling
+
 	return 0; }
 
 
@@ -2333,11 +2474,17 @@ int rxnsupdatelists(simptr sim,int order) {
 	if(maxlist!=sim->mols->maxlist) {
 		free(rxnss->rxnmollist);
 		rxnss->rxnmollist=NULL;
+		free(rxnss->rxnmolbindrad2);
+		rxnss->rxnmolbindrad2=NULL;
 		maxlist=sim->mols->maxlist;
 		if(maxlist>0) {
 			nl2o=intpower(maxlist,order);
 			rxnss->rxnmollist=(int*) calloc(nl2o,sizeof(int));
-			CHECKMEM(rxnss->rxnmollist); }
+			CHECKMEM(rxnss->rxnmollist);
+			if(order==2) {
+				rxnss->rxnmolbindrad2=(double*) calloc(nl2o,sizeof(double));
+				CHECKMEM(rxnss->rxnmolbindrad2);
+				for(ll=0;ll<nl2o;ll++) rxnss->rxnmolbindrad2[ll]=DBL_MAX; }}
 		rxnss->maxlist=maxlist; }
 
 	if(maxlist>0) {
@@ -2482,7 +2629,7 @@ int rxnparsereaction(simptr sim,const char *word,char *line2,char *errstr) {
 
 	for(order=0;order<MAXORDER;order++)				// check for whether reaction name is new
 		if(sim->rxnss[order]) {
-			CHECKS(stringfind(sim->rxnss[order]->rname,sim->rxnss[order]->totrxn,rname)<0,"reaction name has already been used"); }
+			CHECKS(rxnfindname(sim->rxnss[order],rname)<0,"reaction name has already been used"); }
 	CHECKS(line2=strnword(line2,2),"missing first reactant");
 
 	order=0;
@@ -3069,7 +3216,7 @@ int RxnHybridReact(simptr sim) {
 	rxnss=sim->rxnss[2];
 	if(!rxnss || !sim->latticess) return 0;
 	mols=sim->mols;
-	nsv=sim->latticess->latticelist[0]->nsv;
+	nsv=sim->latticess->latticelist[0]->type==LATTICEpde?sim->latticess->latticelist[0]->pde:sim->latticess->latticelist[0]->nsv;
 	dim=sim->dim;
 
 	for(r=0;r<rxnss->totrxn;r++) {
@@ -3199,9 +3346,9 @@ void setBiReactRateForHybrid(simptr sim,rxnptr rxn,moleculeptr mptr1,moleculeptr
 
 /* bireact */
 int bireact(simptr sim,int neigh) {
-	int dim,maxspecies,ll1,ll2,i,j,d,*nl,nmol2,b2,m1,m2,bmax,wpcode,nlist,maxlist;
+	int dim,ll1,ll2,i,j,d,*nl,nmol2,b2,m1,m2,bmax,wpcode,nlist,maxlist,ident[2];
 	int *nrxn,**table;
-	double dist2,vect[DIMMAX];
+	double dist2,vect[DIMMAX],bindrad2max;
 	rxnssptr rxnss;
 	rxnptr rxn,*rxnlist;
 	boxptr bptr;
@@ -3211,7 +3358,6 @@ int bireact(simptr sim,int neigh) {
 	if(!rxnss) return 0;
 	dim=sim->dim;
 	live=sim->mols->live;
-	maxspecies=rxnss->maxspecies;
 	maxlist=rxnss->maxlist;
 	nlist=sim->mols->nlist;
 	nrxn=rxnss->nrxn;
@@ -3230,7 +3376,9 @@ int bireact(simptr sim,int neigh) {
 						nmol2=bptr->nmol[ll2];
 						for(m2=0;m2<nmol2 && mlist2[m2]!=mptr1;m2++) {
 							mptr2=mlist2[m2];
-							i=mptr1->ident*maxspecies+mptr2->ident;
+							ident[0]=mptr1->ident;
+							ident[1]=mptr2->ident;
+							i=rxnfindset(rxnss,ident);
 							for(j=0;j<nrxn[i];j++) {
 								rxn=rxnlist[table[i][j]];
 #ifdef OPTION_VCELL
@@ -3248,7 +3396,8 @@ int bireact(simptr sim,int neigh) {
 	else {																					// neighbor box
 		for(ll1=0;ll1<nlist;ll1++)
 			for(ll2=ll1;ll2<nlist;ll2++)
-				if(rxnss->rxnmollist[ll1*maxlist+ll2])
+				if(rxnss->rxnmollist[ll1*maxlist+ll2]) {
+					bindrad2max=rxnss->rxnmolbindrad2?rxnss->rxnmolbindrad2[ll1*maxlist+ll2]:DBL_MAX;
 					for(m1=0;m1<nl[ll1];m1++) {
 						mptr1=live[ll1][m1];
 						bptr=mptr1->box;
@@ -3260,7 +3409,9 @@ int bireact(simptr sim,int neigh) {
 								wpcode=bptr->wpneigh[b2];
 								for(m2=0;m2<nmol2;m2++) {
 									mptr2=mlist2[m2];
-									i=mptr1->ident*maxspecies+mptr2->ident;
+									ident[0]=mptr1->ident;
+									ident[1]=mptr2->ident;
+									i=rxnfindset(rxnss,ident);
 									for(j=0;j<nrxn[i];j++) {
 										rxn=rxnlist[table[i][j]];
 #ifdef OPTION_VCELL
@@ -3274,10 +3425,14 @@ int bireact(simptr sim,int neigh) {
 												m2=nmol2;
 												b2=bmax; }}}}}
 
+							else if(nmol2==0 || boxdist2(sim,mptr1->pos,bptr->neigh[b2])>bindrad2max);	// neighbor box is beyond binding radii
+
 							else													// neighbor box, no wrapping
 								for(m2=0;m2<nmol2;m2++) {
 									mptr2=mlist2[m2];
-									i=mptr1->ident*maxspecies+mptr2->ident;
+									ident[0]=mptr1->ident;
+									ident[1]=mptr2->ident;
+									i=rxnfindset(rxnss,ident);
 									for(j=0;j<nrxn[i];j++) {
 										rxn=rxnlist[table[i][j]];
 #ifdef OPTION_VCELL
@@ -3291,7 +3446,7 @@ int bireact(simptr sim,int neigh) {
 											if(mptr1->ident==0) {
 												j=nrxn[i];
 												m2=nmol2;
-												b2=bmax; }}}}}}}
+												b2=bmax; }}}}}}}}
 
 	return 0; }
 
@@ -154,6 +154,7 @@ void simLog(simptr sim,int importance,const char* format, ...) {
 			if(word[wordlen-1]==')') {
 				word[wordlen-1]='\0';
 				wordlen--; }}
+		if(sim) strunitsuse(sim->unitstate);
 		ans=strunits(NULL,hasparen?word+2:word+1,0,hasparen?word+2:word+1,"getunits");
 		if(ans==1)
 			strMidCat(message,strptr-message,strptr-message+wordlen+(hasparen?1:0),NULL,0,0);
@@ -270,6 +271,8 @@ double simversionnumber(void) {
 /* Simsetrandseed */
 void Simsetrandseed(simptr sim,long int randseed) {
 	if(!sim) return;
+	if(!sim->randstate) sim->randstate=randstreamalloc();
+	randstreamuse(sim->randstate);
 	sim->randseed=randomize(randseed);
 	return; }
 
@@ -294,7 +297,9 @@ simptr simalloc(const char *fileroot) {
 	sim->flags=NULL;
 	sim->clockstt=time(NULL);
 	sim->elapsedtime=0;
+	sim->randstate=NULL;
 	Simsetrandseed(sim,-1);
+	sim->unitstate=NULL;
 	for(et=(EventType)0;et<ETMAX;et=(EventType)(et+1)) sim->eventcount[et]=0;
 	sim->maxvar=0;
 	sim->nvar=0;
@@ -330,11 +335,17 @@ simptr simalloc(const char *fileroot) {
 	sim->unimolreactfn=&unireact;
 	sim->bimolreactfn=&bireact;
 	sim->checkwallsfn=&checkwalls;
+	sim->maxhook=0;
+	sim->nhook=0;
+	sim->hooks=NULL;
+	sim->hookbusy=0;
 
 	CHECKMEM(sim->filepath=EmptyStringLong(STRCHARLONG));
 	CHECKMEM(sim->filename=EmptyStringLong(STRCHARLONG));
 	CHECKMEM(sim->flags=EmptyString());
 	CHECKMEM(sim->cmds=scmdssalloc(&docommand,(void*)sim,fileroot));
+	CHECKMEM(sim->unitstate=strunitsalloc());
+	strunitsuse(sim->unitstate);
 
 	simsetvariable(sim,"time",sim->time);
 	simsetvariable(sim,"x",dblnan());
@@ -386,15 +397,17 @@ void simfree(simptr sim) {
             free(sim->callbacks[v]);
 #endif
 
+	free(sim->hooks);
 	free(sim->varvalues);
 	free(sim->flags);
 	free(sim->filename);
 	free(sim->filepath);
 
 	simSetLogging(sim,NULL,NULL);
+	randstreamfree(sim->randstate);
+	strunitsfree(sim->unitstate);
 
 	free(sim);
-	strunits(NULL,NULL,0,NULL,"free");
 	return; }
 
 
@@ -451,6 +464,7 @@ void simoutput(simptr sim) {
 		simLog(sim,2," file: %s%s\n",sim->filepath,sim->filename);
 	simLog(sim,2," starting clock time: %s",ctime(&sim->clockstt));
 	simLog(sim,2," %i dimensions\n",sim->dim);
+	strunitsuse(sim->unitstate);
 	strunits(NULL,NULL,0,string,"getunits");
 	if(string[0]) simLog(sim,2," units: %s\n",string);
 	if(sim->accur<10) simLog(sim,2," Accuracy level: %g\n",sim->accur);
@@ -503,6 +517,7 @@ void writesim(simptr sim,FILE *fptr) {
 
 	fprintf(fptr,"# General simulation parameters\n");
 	fprintf(fptr,"# Configuration file: %s%s\n",sim->filepath,sim->filename);
+	strunitsuse(sim->unitstate);
 	strunits(NULL,NULL,0,string,"getunits");
 	if(string[0]) fprintf(fptr,"units %s\n",string);
 	else fprintf(fptr,"# No units listed\n");
@@ -622,12 +637,53 @@ int simsettime(simptr sim,double time,int code) {
 	return er; }
 
 
+/* simaddstephook */
+int simaddstephook(simptr sim,stephookfnptr fn,void *userdata,int every) {
+	int newmax;
+	stephookptr newhooks;
+
+	if(!fn) return 2;
+	if(every<1) return 3;
+	if(sim->nhook==sim->maxhook) {
+		newmax=2*sim->maxhook+2;
+		newhooks=(stephookptr) realloc(sim->hooks,newmax*sizeof(struct stephookstruct));
+		if(!newhooks) return 1;
+		sim->hooks=newhooks;
+		sim->maxhook=newmax; }
+	sim->hooks[sim->nhook].fn=fn;
+	sim->hooks[sim->nhook].userdata=userdata;
+	sim->hooks[sim->nhook].every=every;
+	sim->hooks[sim->nhook].count=0;
+	sim->nhook++;
+	return 0; }
+
+
+/* simremovestephook */
+int simremovestephook(simptr sim,stephookfnptr fn,void *userdata) {
+	int h,h2,found;
+
+	if(sim->hookbusy) {											// hooks are running, so only mark them
+		found=0;
+		for(h=0;h<sim->nhook;h++)
+			if(sim->hooks[h].fn==fn && sim->hooks[h].userdata==userdata) {
+				sim->hooks[h].fn=NULL;
+				found=1; }
+		return found?0:1; }
+
+	for(h=h2=0;h<sim->nhook;h++)
+		if(!(sim->hooks[h].fn==fn && sim->hooks[h].userdata==userdata))
+			sim->hooks[h2++]=sim->hooks[h];
+	if(h2==sim->nhook) return 1;
+	sim->nhook=h2;
+	return 0; }
+
+
 /* simreadstring */
 int simreadstring(simptr sim,ParseFilePtr pfp,const char *word,char *line2) {
 	char nm[STRCHAR],nm1[STRCHAR],shapenm[STRCHAR],ch,rname[STRCHAR],fname[STRCHAR],pattern[STRCHAR];
 	char str1[STRCHAR],str2[STRCHAR],str3[STRCHAR],str4[STRCHAR],str5[STRCHAR],str6[STRCHAR];
 	char errstr[STRCHARLONG];
-	int er,i,nmol,d,i1,s,c,ll,order,*index,ft;
+	int er,i,nmol,d,i1,i2,s,c,ll,order,*index,ft;
 	int rulelist[MAXORDER+MAXPRODUCT],r,ord,rct,prd,itct,prt,lt,detailsi[8];
 	long int pserno,sernolist[MAXPRODUCT];
 	double flt1,flt2,v1[DIMMAX*DIMMAX],v2[4],poslo[DIMMAX],poshi[DIMMAX],thick;
@@ -829,6 +885,15 @@ int simreadstring(simptr sim,ParseFilePtr pfp,const char *word,char *line2) {
 		CHECKS(er!=5,"more molecule already exist than are requested with max_mol");
 		CHECKS(!strnword(line2,2),"unexpected text following max_mol"); }
 
+	else if(!strcmp(word,"reserve_mol")) {				// reserve_mol
+		itct=strmathsscanf(line2,"%mi",varnames,varvalues,nvar,&i1);
+		CHECKM(itct==1,"reserve_mol needs to be an integer. ");
+		CHECKS(i1>=0,"reserve_mol value cannot be negative");
+		er=molreserve(sim,i1);
+		CHECKS(er!=1,"out of memory");
+		CHECKS(er!=3,"more molecules reserved than are permitted with max_mol");
+		CHECKS(!strnword(line2,2),"unexpected text following reserve_mol"); }
+
 	else if(!strcmp(word,"difc")) {								// difc
 		CHECKS(sim->mols,"need to enter species before difc");
 		er=molstring2index1(sim,line2,&ms,&index);
@@ -1380,21 +1445,41 @@ int simreadstring(simptr sim,ParseFilePtr pfp,const char *word,char *line2) {
 		strcpy(nm1,sim->filepath);
 		CHECKS(strlen(nm)<STRCHAR-strlen(nm1),"tiff name is too long");
 		strcat(nm1,nm);
-		gl2SetOptionStr("TiffName",nm1);
+		er=graphicssettiffparams(sim,nm1,-1,-1);
+		CHECKS(er!=1,"out of memory enabling graphics");
 		CHECKS(!strnword(line2,2),"unexpected text following tiff_name"); }
 
 	else if(!strcmp(word,"tiff_min")) {					// tiff_min
 		itct=strmathsscanf(line2,"%mi",varnames,varvalues,nvar,&i1);
 		CHECKM(itct==1,"tiff_min needs to be a number. ");
 		CHECKS(i1>=0,"tiff_min has to be at least 0");
-		gl2SetOptionInt("TiffNumber",i1);
+		er=graphicssettiffparams(sim,NULL,i1,-1);
+		CHECKS(er!=1,"out of memory enabling graphics");
 		CHECKS(!strnword(line2,2),"unexpected text following tiff_min"); }
 
+	else if(!strcmp(word,"image_format")) {				// image_format
+		itct=sscanf(line2,"%s",nm);
+		CHECKS(itct==1,"image_format needs to be tiff or png");
+		er=graphicssetimage(sim,nm,-1,-1);
+		CHECKS(er!=1,"out of memory enabling graphics");
+		CHECKS(er!=3,"image_format needs to be tiff or png");
+		CHECKS(!strnword(line2,2),"unexpected text following image_format"); }
+
+	else if(!strcmp(word,"image_size")) {					// image_size
+		itct=strmathsscanf(line2,"%mi %mi",varnames,varvalues,nvar,&i1,&i2);
+		CHECKS(itct==2,"image_size needs width and height in pixels");
+		CHECKS(i1>0 && i2>0,"image width and height need to be at least 1");
+		er=graphicssetimage(sim,NULL,i1,i2);
+		CHECKS(er!=1,"out of memory enabling graphics");
+		CHECKS(er!=4,"image width and height need to be at most 65535, and the image at most 16777216 pixels");
+		CHECKS(!strnword(line2,3),"unexpected text following image_size"); }
+
 	else if(!strcmp(word,"tiff_max")) {					// tiff_max
 		itct=strmathsscanf(line2,"%mi",varnames,varvalues,nvar,&i1);
 		CHECKM(itct==1,"tiff_max needs to be a number. ");
 		CHECKS(i1>=0,"tiff_max has to be at least 0");
-		gl2SetOptionInt("TiffNumMax",i1);
+		er=graphicssettiffparams(sim,NULL,-1,i1);
+		CHECKS(er!=1,"out of memory enabling graphics");
 		CHECKS(!strnword(line2,2),"unexpected text following tiff_max"); }
 
 	// about runtime commands
@@ -2284,6 +2369,7 @@ int loadsim(simptr sim,const char *fileroot,const char *filename,const char *fla
 		strncpy(sim->flags,SimFlags,STRCHAR); }
 	done=0;
 	ErrorLineAndString[0]='\0';
+	strunitsuse(sim->unitstate);
 
 	pfp=Parse_Start(fileroot,filename,errstring);
 	CHECKS(pfp,"%s",errstring);
@@ -2366,10 +2452,12 @@ int loadsim(simptr sim,const char *fileroot,const char *filename,const char *fla
 /* simupdate */
 int simupdate(simptr sim) {
 	int er;
-	static int recurs=0;
+	static THREADLOCAL int recurs=0;
 
 	if(sim->condition==SCok) {
 		return 0; }
+	randstreamuse(sim->randstate);									// updates can use random numbers
+	strunitsuse(sim->unitstate);
 	if(recurs>10) {
 		recurs=0;
 		return 2; }
@@ -2481,25 +2569,25 @@ int simInitAndLoad(const char *fileroot,const char *filename,simptr *smptr,const
 	int er,qflag,sflag;
 
 	sim=*smptr;
-	if(!sim) {
-		qflag=strchr(flags,'q')?1:0;
-		sflag=strchr(flags,'s')?1:0;
-		if(!qflag && !sflag) {
-			simLog(NULL,2,"--------------------------------------------------------------\n");
-			simLog(NULL,2,"Running Smoldyn %s\n",VERSION);
-			simLog(NULL,2,"\nCONFIGURATION FILE\n");
-			simLog(NULL,2," Path: '%s'\n",fileroot);
-			simLog(NULL,2," Name: '%s'\n",filename); }
+	qflag=strchr(flags,'q')?1:0;
+	sflag=strchr(flags,'s')?1:0;
+	if(!qflag && !sflag) {
+		simLog(NULL,2,"--------------------------------------------------------------\n");
+		simLog(NULL,2,"Running Smoldyn %s\n",VERSION);
+		simLog(NULL,2,"\nCONFIGURATION FILE\n");
+		simLog(NULL,2," Path: '%s'\n",fileroot);
+		simLog(NULL,2," Name: '%s'\n",filename); }
+	if(!sim) {																		// otherwise load into the caller's new sim
 		sim=simalloc(fileroot);
-		CHECKMEM(sim);
-		sim->valueProviderFactory = valueProviderFactory; //create value provider factory
-		sim->mesh = mesh;
-		er=loadsim(sim,fileroot,filename,flags);		// load sim
-		CHECK(!er);
-		if(sim && sim->valueProviderFactory) {
-			sim->valueProviderFactory->setSimptr(sim); }
+		CHECKMEM(sim); }
+	sim->valueProviderFactory = valueProviderFactory; //create value provider factory
+	sim->mesh = mesh;
+	er=loadsim(sim,fileroot,filename,flags);		// load sim
+	CHECK(!er);
+	if(sim && sim->valueProviderFactory) {
+		sim->valueProviderFactory->setSimptr(sim); }
 
-		simLog(sim,2," Loaded file successfully\n"); }
+	simLog(sim,2," Loaded file successfully\n");
 
 	*smptr=sim;
 	return 0;
@@ -2518,22 +2606,21 @@ int simInitAndLoad(const char *fileroot,const char *filename,simptr *smptr,const
 	int er;
 
 	sim=*smptr;
-	if(!sim) {
+	if(!sim) {																		// otherwise load into the caller's new sim
 		sim=simalloc(fileroot);
-		CHECKMEM(sim);
-		strncpy(sim->flags,flags,STRCHAR);
-		if(logfile) simSetLogging(sim,logfile,NULL);
-		simLog(sim,2,"--------------------------------------------------------------\n");
-		simLog(sim,2,"Running Smoldyn %s\n",VERSION);
-		simLog(sim,2,"\nCONFIGURATION FILE\n");
-		simLog(sim,2," Path: '%s'\n",fileroot);
-		simLog(sim,2," Name: '%s'\n",filename);
-		CHECKMEM(strloadmathfunctions()==0);
-		CHECKMEM(strunits(NULL,NULL,0,NULL,"initialize")==0);
-		CHECKMEM(loadsmolfunctions(sim)==0);
-		er=loadsim(sim,fileroot,filename,NULL);		// load sim
-		CHECK(!er);
-		simLog(sim,2," Loaded file successfully\n"); }
+		CHECKMEM(sim); }
+	strncpy(sim->flags,flags,STRCHAR);
+	if(logfile) simSetLogging(sim,logfile,NULL);
+	simLog(sim,2,"--------------------------------------------------------------\n");
+	simLog(sim,2,"Running Smoldyn %s\n",VERSION);
+	simLog(sim,2,"\nCONFIGURATION FILE\n");
+	simLog(sim,2," Path: '%s'\n",fileroot);
+	simLog(sim,2," Name: '%s'\n",filename);
+	CHECKMEM(strloadmathfunctions()==0);
+	CHECKMEM(loadsmolfunctions(sim)==0);
+	er=loadsim(sim,fileroot,filename,NULL);		// load sim
+	CHECK(!er);
+	simLog(sim,2," Loaded file successfully\n");
 
 	*smptr=sim;
 	return 0;
@@ -2582,6 +2669,28 @@ int simdocommands(simptr sim) {
 	return 0; }
 
 
+/* simdostephooks */
+int simdostephooks(simptr sim) {
+	int h,h2,nhook,stop;
+	stephookptr hook;
+
+	stop=0;
+	sim->hookbusy=1;
+	nhook=sim->nhook;												// hooks added by hooks start next step
+	for(h=0;h<nhook;h++) {
+		hook=&sim->hooks[h];										// hooks may be reallocated by adds
+		if(hook->fn && ++hook->count>=hook->every) {
+			hook->count=0;
+			if((*hook->fn)(sim,hook->userdata)) stop=1; }}
+	sim->hookbusy=0;
+
+	for(h=h2=0;h<sim->nhook;h++)						// remove hooks that hooks removed
+		if(sim->hooks[h].fn)
+			sim->hooks[h2++]=sim->hooks[h];
+	sim->nhook=h2;
+	return stop; }
+
+
 /* debugcode */
 void debugcode(simptr sim,const char *prefix) {
 	int m;
@@ -2607,6 +2716,10 @@ void debugcode(simptr sim,const char *prefix) {
 int simulatetimestep(simptr sim) {
 	int er,ll;
 
+	randstreamuse(sim->randstate);									// use this simulation's random numbers
+	strunitsuse(sim->unitstate);										// and its units
+	if(sim->graphss && sim->graphss->offscreen && sim->graphss->currentit==0)
+		graphicsoffscreenframe(sim);									// image of the starting state
 	er=RuleExpandRules(sim,-3);											// expand any reaction rules if needed
 	if(er && er!=-41) return 13;
 
@@ -2629,6 +2742,9 @@ int simulatetimestep(simptr sim) {
 				if(sim->mols->diffuselist[ll])
 					(*sim->checkwallsfn)(sim,ll,0,NULL); }
 
+	er=filMolecules(sim);														// filament binding and exclusion
+	if(er) return 11;
+
 	er=(*sim->assignmols2boxesfn)(sim,1,0);					// assign to boxes (diffusing molecs., not reborn)
 	if(er) return 2;
 
@@ -2670,19 +2786,17 @@ int simulatetimestep(simptr sim) {
 	if(er) return 11;
 
 #ifdef ENABLE_PYTHON_CALLBACK
-        for(unsigned int i = 0; i < sim->ncallbacks; i++) {
-            auto callback = sim->callbacks[i];
-            if((0 == (sim->simstep % callback->getStep())) && callback->isValid()) {
-                callback->evalAndUpdate(sim->time);
-            }
-        }
+        if(sim->ncallbacks)
+            CallbackFunc::evalAll(sim->callbacks, sim->ncallbacks, sim->simstep, sim->time);
         sim->simstep += 1;
 #endif
 	sim->time+=sim->dt;													// --- end of time step ---
 	simsetvariable(sim,"time",sim->time);
 	er=simdocommands(sim);
+	if(sim->graphss && sim->graphss->offscreen)
+		graphicsoffscreenframe(sim);									// image of the state after this step
 	if(er) return er;
-
+	if(sim->nhook && simdostephooks(sim)) return 14;
 
 	if(sim->time>=sim->tmax) return 1;
 	if(sim->time>=sim->tbreak) return 10;
@@ -2708,9 +2822,10 @@ void endsimulate(simptr sim,int er) {
 	else if(er==7) simLog(sim,5,"Simulation stopped by a runtime command\n");
 	else if(er==8) simLog(sim,5,"Simulation terminated during simulation state updating\n  Out of memory\n");
 	else if(er==9) simLog(sim,5,"Simulation terminated during diffusion\n  Out of memory\n");
-	else if(er==11) simLog(sim,5,"Simulation terminated during filament dynamics\n");
+	else if(er==11) simLog(sim,5,"Simulation terminated during filament dynamics or filament-molecule interactions\n");
 	else if(er==12) simLog(sim,5,"Simulation terminated during lattice simulation\n");
 	else if(er==13) simLog(sim,5,"Simulation terminated during reaction network expansion\n");
+	else if(er==14) simLog(sim,5,"Simulation stopped by a step hook\n");
 	else simLog(sim,2,"Simulation stopped by user\n");
 	simLog(sim,2,"Current simulation time: %f\n",sim->time);
 
@@ -2726,6 +2841,12 @@ void endsimulate(simptr sim,int er) {
 	if(eventcount[ETrxn2hybrid]) simLog(sim,2,"%i bybrid bimolecular reactions\n",eventcount[ETrxn2hybrid]);
 	if(eventcount[ETimport]) simLog(sim,2,"%i imported molecules\n",eventcount[ETimport]);
 	if(eventcount[ETexport]) simLog(sim,2,"%i exported molecules\n",eventcount[ETexport]);
+	if(sim->filss && sim->filss->dynsegs>0) {
+		simLog(sim,2,"%g filament segment updates in %g seconds",sim->filss->dynsegs,sim->filss->dyntime);
+		if(sim->filss->dyntime>0) simLog(sim,2,", %g per second",sim->filss->dynsegs/sim->filss->dyntime);
+		simLog(sim,2,"\n"); }
+	if(sim->filss && sim->filss->adaptsteps>0)
+		simLog(sim,2,"%g adaptive filament substeps, %g rejected, %g per filament time step\n",sim->filss->substeps,sim->filss->subrejects,sim->filss->substeps/sim->filss->adaptsteps);
 
 	simLog(sim,2,"total execution time: %g seconds\n",sim->elapsedtime);
 
@@ -2738,7 +2859,7 @@ void endsimulate(simptr sim,int er) {
   if(dontPrompt != NULL && strlen(dontPrompt) > 0)
     sim->quitatend = 1;
 
-  if(sim->graphss && sim->graphss->graphics>0 && !tflag && !sim->quitatend && !sflag)
+  if(sim->graphss && sim->graphss->graphics>0 && !sim->graphss->offscreen && !tflag && !sim->quitatend && !sflag)
     fprintf(stderr,"\nTo quit: Activate graphics window, then press shift-Q.\a\n");
   return; }
 
@@ -2757,5 +2878,28 @@ int smolsimulate(simptr sim) {
 		scmdpop(sim->cmds,sim->tmax);
 		scmdexecute(sim->cmds,sim->time,sim->dt,-1,1);
 		scmdsetcondition(sim->cmds,0,0); }
+	graphicsoffscreenflush(sim);
 	sim->elapsedtime+=difftime(time(NULL),sim->clockstt);
 	return er; }
+
+
+/* smolsimulatesteps */
+int smolsimulatesteps(simptr sim,int nsteps) {
+	int er;
+	double tbreak;
+
+	tbreak=sim->tbreak;
+	sim->tbreak=sim->time+(nsteps-0.5)*sim->dt;
+	if(sim->time<=sim->tmin)
+		er=smolsimulate(sim);
+	else {																	// commands at this time already ran at the end of the previous step
+		sim->clockstt=time(NULL);
+		while((er=simulatetimestep(sim))==0);
+		if(er!=10) {
+			scmdpop(sim->cmds,sim->tmax);
+			scmdexecute(sim->cmds,sim->time,sim->dt,-1,1);
+			scmdsetcondition(sim->cmds,0,0); }
+		graphicsoffscreenflush(sim);
+		sim->elapsedtime+=difftime(time(NULL),sim->clockstt); }
+	sim->tbreak=tbreak;
+	return er; }
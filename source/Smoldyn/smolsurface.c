@@ -3383,7 +3383,7 @@ surfaceptr surfreadstring(simptr sim,ParseFilePtr pfp,surfaceptr srf,const char
 		if(line2) {
 			itct=sscanf(line2,"%s",nm);
 			CHECKS(itct==1,"cannot read new species name");
-			i3=stringfind(sim->mols->spname,sim->mols->nspecies,nm);
+			i3=molfindspecies(sim->mols,nm);
 			CHECKS(i3!=-1,"new species name not recognized");
 			line2=strnword(line2,2); }
 #ifdef OPTION_VCELL
@@ -3445,7 +3445,7 @@ surfaceptr surfreadstring(simptr sim,ParseFilePtr pfp,surfaceptr srf,const char
 			itct=sscanf(line2,"%s",nm);
 			CHECKS(itct==1,"cannot read new species name");
 			CHECKS(sim->mols,"need to enter molecules first");
-			i3=stringfind(sim->mols->spname,sim->mols->nspecies,nm);
+			i3=molfindspecies(sim->mols,nm);
 			CHECKS(i3!=-1,"new species name not recognized");
 			line2=strnword(line2,2); }
 		detailsi[0]=srf->selfindex;
@@ -3631,7 +3631,7 @@ surfaceptr surfreadstring(simptr sim,ParseFilePtr pfp,surfaceptr srf,const char
 		CHECKS(itct==3,"format for unbounded_emitter: face species amount position");
 		face=surfstring2face(facenm);
 		CHECKS(face==PFfront || face==PFback,"face must be 'front' or 'back'");
-		i=stringfind(sim->mols->spname,sim->mols->nspecies,nm);
+		i=molfindspecies(sim->mols,nm);
 		CHECKS(i>0,"unrecognized species name");
 		line2=strnword(line2,4);
 		CHECKS(line2,"format for unbounded_emitter: face species amount position");
@@ -4936,7 +4936,7 @@ int dosurfinteract(simptr sim,moleculeptr mptr,int ll,int m,panelptr pnl,enum Pa
 	moleculeptr mptr2;
 	panelptr oldpnl;
 	char string[STRCHAR];
-	static int errorcount=0;
+	static THREADLOCAL int errorcount=0;
 
 	dim=sim->dim;
 	done=0;
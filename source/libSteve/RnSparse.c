@@ -26,7 +26,9 @@ sparsematrix sparseAllocBandM(sparsematrix sprs, int maxrows, int bandsize, int
 		sprs->col1=NULL;
 		sprs->matrix=NULL;
 		sprs->BiCGSTAB=0;
-		sprs->BiC=NULL; }
+		sprs->BiC=NULL;
+		sprs->LUmat=NULL;
+		sprs->LUvalid=0; }
 
 	if(maxrows>=0 && (sprs->maxrows!=maxrows || sprs->ccols!=2*bandsize+1)) {
 		ccols=2*bandsize+1;
@@ -43,6 +45,9 @@ sparsematrix sparseAllocBandM(sparsematrix sprs, int maxrows, int bandsize, int
 		free(sprs->col0);
 		free(sprs->col1);
 		free(sprs->matrix);
+		free(sprs->LUmat);
+		sprs->LUmat=NULL;
+		sprs->LUvalid=0;
 		sprs->maxrows=maxrows;
 		sprs->nrows=maxrows;
 		sprs->fcols=maxrows;
@@ -80,6 +85,7 @@ void sparseFreeM(sparsematrix sprs) {
 	free(sprs->col0);
 	free(sprs->col1);
 	free(sprs->matrix);
+	free(sprs->LUmat);
 	free(sprs);
 	return; }
 
@@ -121,6 +127,7 @@ void sparsePrintM(const sparsematrix sprs,int full) {
 void sparseSetSizeM(sparsematrix sprs,int nrows,int fcols) {
 	sprs->nrows=nrows;
 	sprs->fcols=fcols;
+	sprs->LUvalid=0;
 	return; }
 
 
@@ -135,6 +142,7 @@ void sparseClearM(sparsematrix sprs) {
 	for(i=0;i<nrows;i++) {
 		for(j=0;j<ccols;j++)
 			matrix[i*ccols+j]=0; }
+	sprs->LUvalid=0;
 	return; }
 
 
@@ -159,6 +167,7 @@ void sparseAddIdentityM(sparsematrix sprs,double factor) {
 	nrows=sprs->nrows;
 	for(i=0;i<nrows;i++)
 		sparseAddToM(sprs,i,i,factor);
+	sprs->LUvalid=0;
 	return; }
 
 
@@ -172,9 +181,11 @@ void sparseMultiplyScalarM(sparsematrix sprs,double scalar) {
 	for(i=0;i<nrows;i++)
 		for(j=col0[i];j<col1[i];j++)
 			sparseMultiplyBy(sprs,i,j,scalar);
+	sprs->LUvalid=0;
 	return; }
 
 
+/* sparseBiCGSTAB */
 void sparseBiCGSTAB(const sparsematrix sprs,const double *b,double *x,double tolerance) {
 	double *ax,*r,*rhat,rho,*p,*nu,alpha,*h,*s,*t,omega,rhop,beta,numer,denom,size;
 	int i,iter,nrows;
@@ -236,3 +247,67 @@ void sparseBiCGSTAB(const sparsematrix sprs,const double *b,double *x,double tol
 	return; }
 
 
+#define sparseLU(a,i,j) (a->LUmat[(a->ccols)*(i)+(j)-(a->col0[i])])
+
+/* sparseLUFactorM */
+int sparseLUFactorM(sparsematrix sprs) {
+	int i,j,k,nrows,ccols,band,imax,jmax;
+	double pivot,l;
+
+	nrows=sprs->nrows;
+	ccols=sprs->ccols;
+	band=(ccols-1)/2;
+	if(!sprs->LUmat) {
+		sprs->LUmat=(double*) calloc(sprs->maxrows*ccols,sizeof(double));
+		if(!sprs->LUmat) return 1; }
+	memcpy(sprs->LUmat,sprs->matrix,nrows*ccols*sizeof(double));
+	sprs->LUvalid=0;
+
+	for(k=0;k<nrows;k++) {					// Doolittle elimination without pivoting; L and U stay within the band
+		pivot=sparseLU(sprs,k,k);
+		if(pivot==0) return 2;
+		imax=(k+band<nrows)?k+band:nrows-1;
+		jmax=imax;
+		for(i=k+1;i<=imax;i++) {
+			l=sparseLU(sprs,i,k)/pivot;
+			sparseLU(sprs,i,k)=l;
+			if(l!=0)
+				for(j=k+1;j<=jmax;j++)
+					sparseLU(sprs,i,j)-=l*sparseLU(sprs,k,j); }}
+
+	sprs->LUvalid=1;
+	return 0; }
+
+
+/* sparseLUSolveM */
+void sparseLUSolveM(const sparsematrix sprs,const double *b,double *x) {
+	int i,j,nrows,band,jmin,jmax;
+	double sum;
+
+	nrows=sprs->nrows;
+	band=(sprs->ccols-1)/2;
+	for(i=0;i<nrows;i++) {					// forward substitution with unit lower triangle, L.y = b
+		jmin=(i-band>0)?i-band:0;
+		sum=b[i];
+		for(j=jmin;j<i;j++)
+			sum-=sparseLU(sprs,i,j)*x[j];
+		x[i]=sum; }
+	for(i=nrows-1;i>=0;i--) {				// back substitution with upper triangle, U.x = y
+		jmax=(i+band<nrows)?i+band:nrows-1;
+		sum=x[i];
+		for(j=i+1;j<=jmax;j++)
+			sum-=sparseLU(sprs,i,j)*x[j];
+		x[i]=sum/sparseLU(sprs,i,i); }
+	return; }
+
+
+/* sparseSolveM */
+int sparseSolveM(sparsematrix sprs,const double *b,double *x) {
+	int er;
+
+	if(!sprs->LUvalid) {
+		er=sparseLUFactorM(sprs);
+		if(er) return er; }
+	sparseLUSolveM(sprs,b,x);
+	return 0; }
+
@@ -24,6 +24,8 @@ typedef struct sparsematrixstruct{
   double *matrix;            // actual matrix data
   int BiCGSTAB;              // 1 if allocatad for BiCGSTAB
   double **BiC;	             // BiCSTAB vectors
+  double *LUmat;             // LU factors of matrix, compressed
+  int LUvalid;               // 1 if LUmat is factored from matrix
   } *sparsematrix;
 
 
@@ -31,9 +33,9 @@ typedef struct sparsematrixstruct{
 #include <stdio.h>
 
 #define sparseReadM(a,i,j) (a->matrix[(a->ccols)*(i)+(j)-(a->col0[i])])
-#define sparseWriteM(a,i,j,x) ((a->matrix[(a->ccols)*(i)+(j)-(a->col0[i])])=(x))
-#define sparseAddToM(a,i,j,x) ((a->matrix[(a->ccols)*(i)+(j)-(a->col0[i])])+=(x))
-#define sparseMultiplyBy(a,i,j,x) ((a->matrix[(a->ccols)*(i)+(j)-(a->col0[i])])*=(x))
+#define sparseWriteM(a,i,j,x) ((a)->LUvalid=0,(a->matrix[(a->ccols)*(i)+(j)-(a->col0[i])])=(x))
+#define sparseAddToM(a,i,j,x) ((a)->LUvalid=0,(a->matrix[(a->ccols)*(i)+(j)-(a->col0[i])])+=(x))
+#define sparseMultiplyBy(a,i,j,x) ((a)->LUvalid=0,(a->matrix[(a->ccols)*(i)+(j)-(a->col0[i])])*=(x))
 
 // Memory allocation and freeing
 sparsematrix sparseAllocBandM(sparsematrix sprs, int maxrows, int bandsize, int BiCGSTAB);
@@ -49,6 +51,9 @@ void sparseMultiplyMV(const sparsematrix sprs,const double *vect,double *ans);
 void sparseAddIdentityM(sparsematrix sprs,double factor);
 void sparseMultiplyScalarM(sparsematrix sprs,double scalar);
 void sparseBiCGSTAB(const sparsematrix sprs,const double *b,double *x,double tolerance);
+int sparseLUFactorM(sparsematrix sprs);
+void sparseLUSolveM(const sparsematrix sprs,const double *b,double *x);
+int sparseSolveM(sparsematrix sprs,const double *b,double *x);
 
 #ifdef __cplusplus
 }
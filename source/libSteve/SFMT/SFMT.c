@@ -11,6 +11,7 @@
  * The new BSD License is applied to this software, see LICENSE.txt
  */
 #include <string.h>
+#include <stdlib.h>
 #include <assert.h>
 #include "SFMT.h"
 #include "SFMT-params.h"
@@ -68,19 +69,38 @@ typedef struct W128_T w128_t;
   FILE GLOBAL VARIABLES
   internal state, index counter and flag 
   --------------------------------------*/
-/** the 128-bit internal state array */
-static w128_t sfmt[N];
+#if defined(_MSC_VER)
+  #define SFMT_THREADLOCAL __declspec(thread)
+#else
+  #define SFMT_THREADLOCAL __thread
+#endif
+
+/** internal state of one generator */
+struct SFMT_STATE_T {
+    /** the 128-bit internal state array */
+    w128_t sfmt[N];
+    /** index counter to the 32-bit internal state array */
+    int idx;
+    /** a flag: it is 0 if and only if the internal state is not yet
+     * initialized. */
+    int initialized;
+};
+/** the state that is used when no other state has been selected */
+static sfmt_t sfmtdefault;
+/** the state that is used by the current thread */
+static SFMT_THREADLOCAL sfmt_t *sfmtstate = &sfmtdefault;
+
+/** the state members of the current generator, named as in the
+ * original code */
+#define sfmt (sfmtstate->sfmt)
+#define idx (sfmtstate->idx)
+#define initialized (sfmtstate->initialized)
 /** the 32bit integer pointer to the 128-bit internal state array */
-static uint32_t *psfmt32 = &sfmt[0].u[0];
+#define psfmt32 (&sfmt[0].u[0])
 #if !defined(BIG_ENDIAN64) || defined(ONLY64)
 /** the 64bit integer pointer to the 128-bit internal state array */
-static uint64_t *psfmt64 = (uint64_t *)&sfmt[0].u[0];
+#define psfmt64 ((uint64_t *)&sfmt[0].u[0])
 #endif
-/** index counter to the 32-bit internal state array */
-static int idx;
-/** a flag: it is 0 if and only if the internal state is not yet
- * initialized. */
-static int initialized = 0;
 /** a parity check vector which certificate the period of 2^{MEXP} */
 static uint32_t parity[4] = {PARITY1, PARITY2, PARITY3, PARITY4};
 
@@ -618,3 +638,41 @@ void init_by_array(uint32_t *init_key, int key_length) {
     period_certification();
     initialized = 1;
 }
+
+/**
+ * This function allocates a new generator state, which is not initialized.
+ * Select it with sfmt_state_select before seeding it or drawing from it.
+ * @return the new state, or NULL if memory could not be allocated.
+ */
+sfmt_t *sfmt_state_alloc(void) {
+    return (sfmt_t *)calloc(1, sizeof(sfmt_t));
+}
+
+/**
+ * This function frees a generator state. If it is selected in the
+ * calling thread, that thread reverts to the default state.
+ * @param state the state to free, which may be NULL.
+ */
+void sfmt_state_free(sfmt_t *state) {
+    if (!state)
+	return;
+    if (sfmtstate == state)
+	sfmtstate = &sfmtdefault;
+    free(state);
+}
+
+/**
+ * This function selects the generator state that is used by all
+ * subsequent calls from the calling thread. Other threads are not
+ * affected. NULL selects the default state, which is shared by all
+ * threads that have not selected a state of their own.
+ * @param state the state to use, or NULL.
+ * @return the previously selected state.
+ */
+sfmt_t *sfmt_state_select(sfmt_t *state) {
+    sfmt_t *old;
+
+    old = sfmtstate;
+    sfmtstate = state ? state : &sfmtdefault;
+    return old;
+}
@@ -74,6 +74,10 @@
   #define PRE_ALWAYS inline
 #endif
 
+/** generator state, for applications that need several independent
+ * streams */
+typedef struct SFMT_STATE_T sfmt_t;
+
 uint32_t gen_rand32(void);
 uint64_t gen_rand64(void);
 void fill_array32(uint32_t *array, int size);
@@ -83,6 +87,9 @@ void init_by_array(uint32_t *init_key, int key_length);
 const char *get_idstring(void);
 int get_min_array_size32(void);
 int get_min_array_size64(void);
+sfmt_t *sfmt_state_alloc(void);
+void sfmt_state_free(sfmt_t *state);
+sfmt_t *sfmt_state_select(sfmt_t *state);
 
 /* These real versions are due to Isaku Wada */
 /** generates a random number on [0,1]-real-interval */
@@ -906,7 +906,7 @@ int scmdopenfiles(cmdssptr cmds,int overwrite) {
 /* scmdoverwrite */
 int scmdoverwrite(cmdssptr cmds,char *line2) {
 	int itct,fid;
-	static char fname[STRCHAR],str1[STRCHAR];
+	char fname[STRCHAR],str1[STRCHAR];
 
 	if(!line2) return 0;
 	itct=sscanf(line2,"%s",fname);
@@ -925,7 +925,7 @@ int scmdoverwrite(cmdssptr cmds,char *line2) {
 /* scmdincfile */
 int scmdincfile(cmdssptr cmds,char *line2) {
 	int itct,fid;
-	static char fname[STRCHAR],str1[STRCHAR];
+	char fname[STRCHAR],str1[STRCHAR];
 
 	if(!line2) return 0;
 	itct=sscanf(line2,"%s",fname);
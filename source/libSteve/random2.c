@@ -9,6 +9,67 @@ of the Gnu Lesser General Public License (LGPL). */
 #include "math2.h"
 
 
+/* Random number stream.  gaussrandD and gaussrandF make deviates in pairs and
+store the second one, which belongs to the stream that made it. */
+typedef struct randstreamstruct {
+	void *gen;									// generator state, or NULL for the default
+	int isetD;									// 1 if gsetD holds a Gaussian deviate
+	double gsetD;								// stored double Gaussian deviate
+	int isetF;									// 1 if gsetF holds a Gaussian deviate
+	float gsetF;								// stored float Gaussian deviate
+	} *randstreamptr;
+
+static THREADLOCAL struct randstreamstruct RandStreamDefault;
+static THREADLOCAL randstreamptr RandStreamUse=NULL;
+
+
+void *randstreamalloc(void) {
+	randstreamptr stream;
+
+	stream=(randstreamptr) calloc(1,sizeof(struct randstreamstruct));
+	if(!stream) return NULL;
+#ifdef SFMT_H
+	stream->gen=(void*) sfmt_state_alloc();
+	if(!stream->gen) {
+		free(stream);
+		return NULL; }
+#endif
+	return (void*) stream; }
+
+
+void randstreamfree(void *stream) {
+	randstreamptr rs;
+
+	rs=(randstreamptr) stream;
+	if(!rs) return;
+	if(RandStreamUse==rs) RandStreamUse=NULL;
+#ifdef SFMT_H
+	sfmt_state_free((sfmt_t*) rs->gen);
+#endif
+	free(rs);
+	return; }
+
+
+void *randstreamuse(void *stream) {
+	randstreamptr old;
+
+	old=RandStreamUse;
+	RandStreamUse=(randstreamptr) stream;
+#ifdef SFMT_H
+	sfmt_state_select(RandStreamUse?(sfmt_t*) RandStreamUse->gen:NULL);
+#endif
+	return (void*) old; }
+
+
+void randstreamreset(void) {
+	randstreamptr rs;
+
+	rs=RandStreamUse?RandStreamUse:&RandStreamDefault;
+	rs->isetD=0;
+	rs->isetF=0;
+	return; }
+
+
 double unirandsumCCD(int n,double m,double s) {
 	double x=0;
 	int i;
@@ -56,7 +117,7 @@ int intrandpF(int n,float *p) {
 
 
 int poisrandD(double xm) {
-	static double sq,alxm,g,oldm=-1.0;
+	static THREADLOCAL double sq,alxm,g,oldm=-1.0;
 	float em,t,y;
 
 	if(xm<=0) return 0;
@@ -83,7 +144,7 @@ int poisrandD(double xm) {
 
 
 int poisrandF(float xm) {
-	static float sq,alxm,g,oldm=-1.0;
+	static THREADLOCAL float sq,alxm,g,oldm=-1.0;
 	float em,t,y;
 
 	if(xm<=0) return 0;
@@ -112,8 +173,8 @@ int poisrandF(float xm) {
 float binomialrandF(float p,int n) {
 	int swap,j;
 	float am,bnl,g,t,sq,angle,y,em;
-	static float nold=-1,pold=-1;
-	static float en,oldg,pc,plog,pclog;
+	static THREADLOCAL float nold=-1,pold=-1;
+	static THREADLOCAL float en,oldg,pc,plog,pclog;
 
 	if(n<1) return 0;
 	if(p>1) return n;
@@ -160,43 +221,43 @@ float binomialrandF(float p,int n) {
 
 
 double gaussrandD() {
-	static int iset=0;
-	static double gset;
+	randstreamptr rs;
 	double fac,r,v1,v2;
 
-	if(!iset) {
+	rs=RandStreamUse?RandStreamUse:&RandStreamDefault;
+	if(!rs->isetD) {
 		do {
 			v1=2.0*randCOD()-1.0;
 			v2=2.0*randCOD()-1.0;
 			r=v1*v1+v2*v2; }
 			while(r>=1||r==0);
 		fac=sqrt(-2.0*log(r)/r);
-		gset=v1*fac;
-		iset=1;
+		rs->gsetD=v1*fac;
+		rs->isetD=1;
 		return v2*fac; }
 	else {
-		iset=0;
-		return gset; }}
+		rs->isetD=0;
+		return rs->gsetD; }}
 
 
 float gaussrandF() {
-	static int iset=0;
-	static float gset;
+	randstreamptr rs;
 	float fac,r,v1,v2;
 
-	if(!iset) {
+	rs=RandStreamUse?RandStreamUse:&RandStreamDefault;
+	if(!rs->isetF) {
 		do {
 			v1=2.0*randCOF()-1.0;
 			v2=2.0*randCOF()-1.0;
 			r=v1*v1+v2*v2; }
 			while(r>=1||r==0);
 		fac=sqrt(-2.0*log(r)/r);
-		gset=v1*fac;
-		iset=1;
+		rs->gsetF=v1*fac;
+		rs->isetF=1;
 		return v2*fac; }
 	else {
-		iset=0;
-		return gset; }}
+		rs->isetF=0;
+		return rs->gsetF; }}
 
 
 double gaussrandtruncOCD(double mean,double stddev,double low, double high) {
@@ -262,8 +323,8 @@ void ballrandCCD(double *x,int dim,double radius) {
 
 
 void trianglerandCD(double *pt1,double *pt2,double *pt3,int dim,double *ans) {
-	static double x,y;
-	static int xd,yd;
+	static THREADLOCAL double x,y;
+	static THREADLOCAL int xd,yd;
 	double x0,y0,x1,y1,x2,y2,m01,m02,m12,area,yx1,yy;
 	int d,dsmall,zd;
 	double range,smrange,swap,coefx,coefy,coefz,coefk;
@@ -418,6 +479,52 @@ void randshuffletableV(void **a,int n) {
 	return; }
 
 
+void randseedR(randstateptr rs,unsigned long int seed) {
+	unsigned long long z;
+	int i;
+
+	z=(unsigned long long)seed;
+	for(i=0;i<2;i++) {						// splitmix64 to fill the state
+		z+=0x9E3779B97F4A7C15ULL;
+		rs->s[i]=z;
+		rs->s[i]=(rs->s[i]^(rs->s[i]>>30))*0xBF58476D1CE4E5B9ULL;
+		rs->s[i]=(rs->s[i]^(rs->s[i]>>27))*0x94D049BB133111EBULL;
+		rs->s[i]=rs->s[i]^(rs->s[i]>>31); }
+	if(rs->s[0]==0 && rs->s[1]==0) rs->s[0]=1;
+	rs->iset=0;
+	rs->gset=0;
+	return; }
+
+
+double randCODR(randstateptr rs) {
+	unsigned long long s0,s1;
+
+	s1=rs->s[0];
+	s0=rs->s[1];
+	rs->s[0]=s0;
+	s1^=s1<<23;
+	rs->s[1]=s1^s0^(s1>>17)^(s0>>26);
+	return (double)((rs->s[1]+s0)>>11)*(1.0/9007199254740992.0); }
+
+
+double gaussrandDR(randstateptr rs) {
+	double fac,r,v1,v2;
+
+	if(!rs->iset) {
+		do {
+			v1=2.0*randCODR(rs)-1.0;
+			v2=2.0*randCODR(rs)-1.0;
+			r=v1*v1+v2*v2; }
+			while(r>=1||r==0);
+		fac=sqrt(-2.0*log(r)/r);
+		rs->gset=v1*fac;
+		rs->iset=1;
+		return v2*fac; }
+	else {
+		rs->iset=0;
+		return rs->gset; }}
+
+
 void showdist(int n,float low,float high,int bin) {
 	int i,a[100],uflow=0,oflow=0,b;
 	float x,sum=0,sum2=0;
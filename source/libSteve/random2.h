@@ -17,6 +17,15 @@ extern "C" {
 #include <stdlib.h>
 #include <math.h>
 
+/* Storage class for variables that need a separate copy in each thread */
+#ifndef THREADLOCAL
+	#if defined(_MSC_VER)
+		#define THREADLOCAL __declspec(thread)
+	#else
+		#define THREADLOCAL __thread
+	#endif
+#endif
+
 /* Definitions of basic random number generators */
 #ifdef SFMT_H
 
@@ -52,9 +61,12 @@ extern "C" {
 	inline static unsigned long int randULI(void) {
 		return (unsigned long int) gen_rand32(); }
 
+	void randstreamreset(void);
+
 	inline static long int randomize(long int seed) {
 		if(seed<0) seed=(long int) time(NULL);
 		init_gen_rand((uint32_t)seed);
+		randstreamreset();
 		return seed; }
 
 #else
@@ -97,9 +109,12 @@ extern "C" {
 	inline static unsigned long int randULI(void) {
 		return rand30(); }
 
+	void randstreamreset(void);
+
 	inline static long int randomize(long int seed) {
 		if(seed<0) seed=(unsigned int) time(NULL);
 		srand((unsigned int)seed);
+		randstreamreset();
 		return seed; }
 
 #endif
@@ -195,6 +210,23 @@ void randshuffletableI(int *a,int n);
 void randshuffletableV(void **a,int n);
 void showdist(int n,float low,float high,int bin);
 
+/* Random number streams, one per simulation, which hold the generator state
+and the stored Gaussian deviates */
+void *randstreamalloc(void);
+void randstreamfree(void *stream);
+void *randstreamuse(void *stream);
+
+/* Reentrant random number generators, with state owned by the caller */
+typedef struct randstatestruct {
+	unsigned long long s[2];		// xorshift128+ state
+	int iset;										// 1 if gset holds a Gaussian deviate
+	double gset;								// stored Gaussian deviate
+	} *randstateptr;
+
+void randseedR(randstateptr rs,unsigned long int seed);
+double randCODR(randstateptr rs);
+double gaussrandDR(randstateptr rs);
+
 #ifdef __cplusplus
 }
 #endif
@@ -32,8 +32,8 @@ of the Gnu Lesser General Public License (LGPL). */
 
 #define CHECK(A)		if(!(A)) {goto failure;} else (void)0
 
-char StrErrorString[STRCHAR];
-int MathParseError=0;
+THREADLOCAL char StrErrorString[STRCHAR];
+THREADLOCAL int MathParseError=0;
 
 int permutelex(int *seq,int n);
 int allocresults(char ***resultsptr,int *maxrptr,int nchar);
@@ -1137,9 +1137,9 @@ int strexpandlogic(const char *pat,int start,int stop,char ***resultsptr) {
 
 /* strEnhWildcardMatch */
 int strEnhWildcardMatch(const char *pat,const char *str) {
-	static char *localpat=NULL;
-	static char **results=NULL;
-	static int nr=0;
+	static THREADLOCAL char *localpat=NULL;
+	static THREADLOCAL char **results=NULL;
+	static THREADLOCAL int nr=0;
 	int i;
 
 	if(!pat || !localpat || strcmp(pat,localpat)) {								// create list of patterns
@@ -1169,9 +1169,9 @@ int strEnhWildcardMatch(const char *pat,const char *str) {
 
 /* strEnhWildcardMatchAndSub */
 int strEnhWildcardMatchAndSub(const char *pat,const char *str,const char *destpat,char *dest) {
-	static char *localpat=NULL,*localdestpat=NULL;
-	static char **patlist=NULL,**destlist=NULL;
-	static int npr=0,ndr=0,iresults=0,starextra=0;
+	static THREADLOCAL char *localpat=NULL,*localdestpat=NULL;
+	static THREADLOCAL char **patlist=NULL,**destlist=NULL;
+	static THREADLOCAL int npr=0,ndr=0,iresults=0,starextra=0;
 	int i,ismatch,destwords;
 
 	if(!pat || !localpat || strcmp(pat,localpat)) {
@@ -1423,7 +1423,7 @@ double strevalfunction(const char *expression,char *parameters,void *voidptr,voi
 
 /* strmatheval */
 double strmatheval(const char *expression,char **varnames,const double *varvalues,int nvar) {
-  static int unarysymbol=0;
+  static THREADLOCAL int unarysymbol=0;
   int length,i1,i2;
   double answer,term;
   char *ptr,*ptr2,ptrchar,ptr2char,expr[STRCHAR+1];
@@ -1631,22 +1631,64 @@ int strmathsscanf(const char *str,const char *format,char **varnames,const doubl
 /********** Unit conversions *********************/
 /*****************************************************/
 
+typedef struct unitsstruct {
+	int workUnits[3];								// indices of working units
+	int dimUnit[3];									// powers of units, only used for recursion
+	int haveWorkUnits;							// flag for whether already have working units
+	int numUnits[3];								// number of units defined for each type
+	char **unitNames[3];						// list of unit names for each type
+	double *unitRatios[3];					// list of conversion factors for each type
+	int unitStack[3][64];						// stack of unit indices
+	char *nameStack[64];						// stack of file names
+	int numStack;										// elements in stacks
+	} *unitsptr;
+
+static THREADLOCAL struct unitsstruct UnitsDefault;	// used if none selected
+static THREADLOCAL unitsptr UnitsUse=NULL;				// tables selected for this thread
+
+
+/* strunitsalloc */
+void *strunitsalloc(void) {
+	unitsptr units,old;
+
+	units=(unitsptr) calloc(1,sizeof(struct unitsstruct));
+	if(!units) return NULL;
+	old=(unitsptr) strunitsuse(units);
+	if(strunits(NULL,NULL,0,NULL,"initialize")!=0) {
+		strunitsfree(units);
+		units=NULL; }
+	strunitsuse(old);
+	return (void*) units; }
+
+
+/* strunitsfree */
+void strunitsfree(void *units) {
+	unitsptr old;
+
+	if(!units) return;
+	old=(unitsptr) strunitsuse(units);
+	strunits(NULL,NULL,0,NULL,"free");
+	strunitsuse(old==units?NULL:old);
+	free(units);
+	return; }
+
+
+/* strunitsuse */
+void *strunitsuse(void *units) {
+	unitsptr old;
+
+	old=UnitsUse;
+	UnitsUse=(unitsptr) units;
+	return (void*) old; }
+
 
 /* strunits */
 double strunits(const char *unitstring,const char *dimstring,double value,char *outstring,const char* function) {
-	static int numType=3;												// number of unit types
-	static int maxUnits=64;											// maximum number of units for each type
-	static int maxUnitChars=32;									// maximum characters in each unit name
-	static int maxStack=64;											// allocated size of unit stack
-	static int workUnits[3]={0,0,0};						// indices of working units
-	static int dimUnit[3]={0,0,0};							// powers of units, only used for recursion
-	static int haveWorkUnits=0;									// flag for whether already have working units
-	static int numUnits[3]={0,0,0};							// number of units defined for each type
-	static char **unitNames[3]={NULL,NULL,NULL};		// list of unit names for each type
-	static double *unitRatios[3]={NULL,NULL,NULL};	// list of conversion factors for each type
-	static int unitStack[3][64];								// stack of unit indices
-	static char *nameStack[64];									// stack of file names
-	static int numStack=0;											// elements in stacks
+	static const int numType=3;									// number of unit types
+	static const int maxUnits=64;								// maximum number of units for each type
+	static const int maxUnitChars=32;						// maximum characters in each unit name
+	static const int maxStack=64;								// allocated size of unit stack
+	unitsptr us;
 
 	int ut,ui,count,is;
 	int tempunit[3],mult,power;
@@ -1654,9 +1696,10 @@ double strunits(const char *unitstring,const char *dimstring,double value,char *
 	char *strptr;
 	double factor,answer;
 
-//	printf("* strunits. function='%s' unitstring='%s', dimstring='%s', value=%lg, numStack=%i\n",function,unitstring,dimstring,value,numStack);// debug ??
+	us=UnitsUse?UnitsUse:&UnitsDefault;						// tables selected by strunitsuse, if any
+//	printf("* strunits. function='%s' unitstring='%s', dimstring='%s', value=%lg, numStack=%i\n",function,unitstring,dimstring,value,us->numStack);// debug ??
 
-	if(!unitstring && !haveWorkUnits && !strcmp(function,"convert"))	// file isn't using units
+	if(!unitstring && !us->haveWorkUnits && !strcmp(function,"convert"))	// file isn't using units
 		return value;
 
 	answer=0;																// initialize values and copy over input strings
@@ -1674,185 +1717,186 @@ double strunits(const char *unitstring,const char *dimstring,double value,char *
 	if(!strcmp(function,"convert")) {				// convert value from entered units to working units
 		answer=value;
 		if(ustring[0]) {
-			CHECKS(haveWorkUnits==1,"Working units need to be defined before unit conversion can be done");
+			CHECKS(us->haveWorkUnits==1,"Working units need to be defined before unit conversion can be done");
 			CHECKS(dstring[0],"Incompatible units: is '%s' but should be unitless",unitstring); }
 		if(dstring[0]) {
 			strunits(dstring,NULL,1,NULL,"parse");
 			for(ut=0;ut<numType;ut++)
-				tempunit[ut]=dimUnit[ut]; }
+				tempunit[ut]=us->dimUnit[ut]; }
 		if(ustring[0])
 			answer=strunits(ustring,NULL,value,NULL,"parse");
 
 		if(dstring[0] && ustring[0]) {							// have ustring so conversion is already done, but first check unit compatibility
 			for(ut=0;ut<numType;ut++)
-				CHECKS(tempunit[ut]==dimUnit[ut],"Incompatible units: is '%s' but should be '%s'",unitstring,dimstring); }
-		else if(dstring[0] && numStack>0) {					// no ustring so perform conversion using default units listed in stack
+				CHECKS(tempunit[ut]==us->dimUnit[ut],"Incompatible units: is '%s' but should be '%s'",unitstring,dimstring); }
+		else if(dstring[0] && us->numStack>0) {					// no ustring so perform conversion using default units listed in stack
 			factor=1;
 			for(ut=0;ut<numType;ut++) {
-				ui=unitStack[ut][numStack-1];
-				factor*=pow(unitRatios[ut][ui]/unitRatios[ut][workUnits[ut]],tempunit[ut]); }
+				ui=us->unitStack[ut][us->numStack-1];
+				factor*=pow(us->unitRatios[ut][ui]/us->unitRatios[ut][us->workUnits[ut]],tempunit[ut]); }
 			answer=value*factor; }}										// if no ustring and no current default units, then no conversion and hope for the best (this arises for runtime commands)
 
 	else if(!strcmp(function,"getunits")) {
 		outstring[0]='\0';
-		if(!haveWorkUnits)
+		if(!us->haveWorkUnits)
 			answer=1;
 		else {
 			if(dstring[0]) {													// return working units for some combination of input units, e.g. dstring="L2/T" and returns "um2/ms"
 				strunits(dstring,NULL,1,NULL,"parse");
 				for(ut=0;ut<numType;ut++) {
 					count=strlen(outstring);
-					if(dimUnit[ut]!=0) {
-						if(count>0 && dimUnit[ut]>0) strcat(outstring,".");
-						else if(dimUnit[ut]<0) strcat(outstring,"/");
-						strcat(outstring,unitNames[ut][workUnits[ut]]);
-						if(dimUnit[ut]>1) sprintf(outstring+strlen(outstring),"%i",dimUnit[ut]);
-						else if(dimUnit[ut]<-1) sprintf(outstring+strlen(outstring),"%i",-dimUnit[ut]); }}}
+					if(us->dimUnit[ut]!=0) {
+						if(count>0 && us->dimUnit[ut]>0) strcat(outstring,".");
+						else if(us->dimUnit[ut]<0) strcat(outstring,"/");
+						strcat(outstring,us->unitNames[ut][us->workUnits[ut]]);
+						if(us->dimUnit[ut]>1) sprintf(outstring+strlen(outstring),"%i",us->dimUnit[ut]);
+						else if(us->dimUnit[ut]<-1) sprintf(outstring+strlen(outstring),"%i",-us->dimUnit[ut]); }}}
 			else {																		// return list of working units, e.g. um ms
 				for(ut=0;ut<numType;ut++) {
 					if(ut>0) strcat(outstring," ");
-					strcat(outstring,unitNames[ut][workUnits[ut]]); }}}}
+					strcat(outstring,us->unitNames[ut][us->workUnits[ut]]); }}}}
 
-	else if(!strcmp(function,"initialize")) {			// allocate and set up unitNames and unitRatios
-		if(unitNames[0]!=NULL) return 0;
+	else if(!strcmp(function,"initialize")) {			// allocate and set up us->unitNames and us->unitRatios
+		if(us->unitNames[0]!=NULL) return 0;
 		for(ut=0;ut<numType;ut++) {
-			CHECKS(unitNames[ut]=(char**) calloc(maxUnits,sizeof(char*)),"strunits. Memory error.");
+			CHECKS(us->unitNames[ut]=(char**) calloc(maxUnits,sizeof(char*)),"strunits. Memory error.");
 			for(ui=0;ui<maxUnits;ui++) {
-				CHECKS(unitNames[ut][ui]=EmptyStringLong(maxUnitChars),"strunits. Memory error."); }
-			CHECKS(unitRatios[ut]=(double*) calloc(maxUnits,sizeof(double)),"strunits. Memory error");
+				CHECKS(us->unitNames[ut][ui]=EmptyStringLong(maxUnitChars),"strunits. Memory error."); }
+			CHECKS(us->unitRatios[ut]=(double*) calloc(maxUnits,sizeof(double)),"strunits. Memory error");
 			for(ui=0;ui<maxUnits;ui++)
-				unitRatios[ut][ui]=1; }
+				us->unitRatios[ut][ui]=1; }
 
 		ut=ui=0;
-		strcpy(unitNames[ut][ui],"L");							// length units
-		unitRatios[ut][ui++]=1;
-		strcpy(unitNames[ut][ui],"m");
-		unitRatios[ut][ui++]=1;
-		strcpy(unitNames[ut][ui],"dam");
-		unitRatios[ut][ui++]=10;
-		strcpy(unitNames[ut][ui],"hm");
-		unitRatios[ut][ui++]=100;
-		strcpy(unitNames[ut][ui],"km");
-		unitRatios[ut][ui++]=1e3;
-		strcpy(unitNames[ut][ui],"Mm");
-		unitRatios[ut][ui++]=1e6;
-		strcpy(unitNames[ut][ui],"dm");
-		unitRatios[ut][ui++]=0.1;
-		strcpy(unitNames[ut][ui],"cm");
-		unitRatios[ut][ui++]=0.01;
-		strcpy(unitNames[ut][ui],"mm");
-		unitRatios[ut][ui++]=0.001;
-		strcpy(unitNames[ut][ui],"um");
-		unitRatios[ut][ui++]=1e-6;
-		strcpy(unitNames[ut][ui],"nm");
-		unitRatios[ut][ui++]=1e-9;
-		strcpy(unitNames[ut][ui],"pm");
-		unitRatios[ut][ui++]=1e-12;
-		strcpy(unitNames[ut][ui],"fm");
-		unitRatios[ut][ui++]=1e-15;
-		numUnits[ut]=ui;
+		strcpy(us->unitNames[ut][ui],"L");							// length units
+		us->unitRatios[ut][ui++]=1;
+		strcpy(us->unitNames[ut][ui],"m");
+		us->unitRatios[ut][ui++]=1;
+		strcpy(us->unitNames[ut][ui],"dam");
+		us->unitRatios[ut][ui++]=10;
+		strcpy(us->unitNames[ut][ui],"hm");
+		us->unitRatios[ut][ui++]=100;
+		strcpy(us->unitNames[ut][ui],"km");
+		us->unitRatios[ut][ui++]=1e3;
+		strcpy(us->unitNames[ut][ui],"Mm");
+		us->unitRatios[ut][ui++]=1e6;
+		strcpy(us->unitNames[ut][ui],"dm");
+		us->unitRatios[ut][ui++]=0.1;
+		strcpy(us->unitNames[ut][ui],"cm");
+		us->unitRatios[ut][ui++]=0.01;
+		strcpy(us->unitNames[ut][ui],"mm");
+		us->unitRatios[ut][ui++]=0.001;
+		strcpy(us->unitNames[ut][ui],"um");
+		us->unitRatios[ut][ui++]=1e-6;
+		strcpy(us->unitNames[ut][ui],"nm");
+		us->unitRatios[ut][ui++]=1e-9;
+		strcpy(us->unitNames[ut][ui],"pm");
+		us->unitRatios[ut][ui++]=1e-12;
+		strcpy(us->unitNames[ut][ui],"fm");
+		us->unitRatios[ut][ui++]=1e-15;
+		us->numUnits[ut]=ui;
 
 		ut++;
 		ui=0;
-		strcpy(unitNames[ut][ui],"T");							// time units
-		unitRatios[ut][ui++]=1;
-		strcpy(unitNames[ut][ui],"s");
-		unitRatios[ut][ui++]=1;
-		strcpy(unitNames[ut][ui],"min");
-		unitRatios[ut][ui++]=60;
-		strcpy(unitNames[ut][ui],"hr");
-		unitRatios[ut][ui++]=3600;
-		strcpy(unitNames[ut][ui],"day");
-		unitRatios[ut][ui++]=86400;
-		strcpy(unitNames[ut][ui],"yr");
-		unitRatios[ut][ui++]=31557600;
-		strcpy(unitNames[ut][ui],"ds");
-		unitRatios[ut][ui++]=0.1;
-		strcpy(unitNames[ut][ui],"cs");
-		unitRatios[ut][ui++]=0.01;
-		strcpy(unitNames[ut][ui],"ms");
-		unitRatios[ut][ui++]=0.001;
-		strcpy(unitNames[ut][ui],"us");
-		unitRatios[ut][ui++]=1e-6;
-		strcpy(unitNames[ut][ui],"ns");
-		unitRatios[ut][ui++]=1e-9;
-		strcpy(unitNames[ut][ui],"ps");
-		unitRatios[ut][ui++]=1e-12;
-		strcpy(unitNames[ut][ui],"fs");
-		unitRatios[ut][ui++]=1e-15;
-		numUnits[ut]=ui;
+		strcpy(us->unitNames[ut][ui],"T");							// time units
+		us->unitRatios[ut][ui++]=1;
+		strcpy(us->unitNames[ut][ui],"s");
+		us->unitRatios[ut][ui++]=1;
+		strcpy(us->unitNames[ut][ui],"min");
+		us->unitRatios[ut][ui++]=60;
+		strcpy(us->unitNames[ut][ui],"hr");
+		us->unitRatios[ut][ui++]=3600;
+		strcpy(us->unitNames[ut][ui],"day");
+		us->unitRatios[ut][ui++]=86400;
+		strcpy(us->unitNames[ut][ui],"yr");
+		us->unitRatios[ut][ui++]=31557600;
+		strcpy(us->unitNames[ut][ui],"ds");
+		us->unitRatios[ut][ui++]=0.1;
+		strcpy(us->unitNames[ut][ui],"cs");
+		us->unitRatios[ut][ui++]=0.01;
+		strcpy(us->unitNames[ut][ui],"ms");
+		us->unitRatios[ut][ui++]=0.001;
+		strcpy(us->unitNames[ut][ui],"us");
+		us->unitRatios[ut][ui++]=1e-6;
+		strcpy(us->unitNames[ut][ui],"ns");
+		us->unitRatios[ut][ui++]=1e-9;
+		strcpy(us->unitNames[ut][ui],"ps");
+		us->unitRatios[ut][ui++]=1e-12;
+		strcpy(us->unitNames[ut][ui],"fs");
+		us->unitRatios[ut][ui++]=1e-15;
+		us->numUnits[ut]=ui;
 
 		ut++;
 		ui=0;
-		strcpy(unitNames[ut][ui],"E");							// energy units
-		unitRatios[ut][ui++]=1;
-		strcpy(unitNames[ut][ui],"J");
-		unitRatios[ut][ui++]=1;
-		strcpy(unitNames[ut][ui],"dJ");
-		unitRatios[ut][ui++]=0.1;
-		strcpy(unitNames[ut][ui],"cJ");
-		unitRatios[ut][ui++]=0.01;
-		strcpy(unitNames[ut][ui],"mJ");
-		unitRatios[ut][ui++]=1e-3;
-		strcpy(unitNames[ut][ui],"uJ");
-		unitRatios[ut][ui++]=1e-6;
-		strcpy(unitNames[ut][ui],"nJ");
-		unitRatios[ut][ui++]=1e-9;
-		strcpy(unitNames[ut][ui],"pJ");
-		unitRatios[ut][ui++]=1e-12;
-		strcpy(unitNames[ut][ui],"fJ");
-		unitRatios[ut][ui++]=1e-15;
-		strcpy(unitNames[ut][ui],"aJ");
-		unitRatios[ut][ui++]=1e-18;
-		strcpy(unitNames[ut][ui],"zJ");
-		unitRatios[ut][ui++]=1e-21;
-		strcpy(unitNames[ut][ui],"yJ");
-		unitRatios[ut][ui++]=1e-24;
-		strcpy(unitNames[ut][ui],"rJ");
-		unitRatios[ut][ui++]=1e-27;
-		strcpy(unitNames[ut][ui],"qJ");
-		unitRatios[ut][ui++]=1e-30;
-		numUnits[ut]=ui;
-
-		numStack=0;
+		strcpy(us->unitNames[ut][ui],"E");							// energy units
+		us->unitRatios[ut][ui++]=1;
+		strcpy(us->unitNames[ut][ui],"J");
+		us->unitRatios[ut][ui++]=1;
+		strcpy(us->unitNames[ut][ui],"dJ");
+		us->unitRatios[ut][ui++]=0.1;
+		strcpy(us->unitNames[ut][ui],"cJ");
+		us->unitRatios[ut][ui++]=0.01;
+		strcpy(us->unitNames[ut][ui],"mJ");
+		us->unitRatios[ut][ui++]=1e-3;
+		strcpy(us->unitNames[ut][ui],"uJ");
+		us->unitRatios[ut][ui++]=1e-6;
+		strcpy(us->unitNames[ut][ui],"nJ");
+		us->unitRatios[ut][ui++]=1e-9;
+		strcpy(us->unitNames[ut][ui],"pJ");
+		us->unitRatios[ut][ui++]=1e-12;
+		strcpy(us->unitNames[ut][ui],"fJ");
+		us->unitRatios[ut][ui++]=1e-15;
+		strcpy(us->unitNames[ut][ui],"aJ");
+		us->unitRatios[ut][ui++]=1e-18;
+		strcpy(us->unitNames[ut][ui],"zJ");
+		us->unitRatios[ut][ui++]=1e-21;
+		strcpy(us->unitNames[ut][ui],"yJ");
+		us->unitRatios[ut][ui++]=1e-24;
+		strcpy(us->unitNames[ut][ui],"rJ");
+		us->unitRatios[ut][ui++]=1e-27;
+		strcpy(us->unitNames[ut][ui],"qJ");
+		us->unitRatios[ut][ui++]=1e-30;
+		us->numUnits[ut]=ui;
+
+		us->numStack=0;
 		for(is=0;is<maxStack;is++) {
-			CHECKS(nameStack[is]=EmptyString(),"Memory error in strunits."); }
+			CHECKS(us->nameStack[is]=EmptyString(),"Memory error in strunits."); }
 		for(ut=0;ut<numType;ut++)
-			workUnits[ut]=0; }
+			us->workUnits[ut]=0; }
 
 	else if(!strcmp(function,"free")) {							// free all internal memory
 		for(ut=0;ut<numType;ut++) {
-			for(ui=0;ui<numUnits[ut];ui++)
-				free(unitNames[ut][ui]);
-			free(unitNames[ut]);
-			free(unitRatios[ut]);
-			unitNames[ut]=NULL;
-			unitRatios[ut]=NULL;
-			workUnits[ut]=0;
-			numUnits[ut]=0; }
+			if(us->unitNames[ut])
+				for(ui=0;ui<maxUnits;ui++)
+					free(us->unitNames[ut][ui]);
+			free(us->unitNames[ut]);
+			free(us->unitRatios[ut]);
+			us->unitNames[ut]=NULL;
+			us->unitRatios[ut]=NULL;
+			us->workUnits[ut]=0;
+			us->numUnits[ut]=0; }
 		for(is=0;is<maxStack;is++) {
-			free(nameStack[is]);
-			nameStack[is]=NULL; }
-		numStack=0;
-		haveWorkUnits=0; }
+			free(us->nameStack[is]);
+			us->nameStack[is]=NULL; }
+		us->numStack=0;
+		us->haveWorkUnits=0; }
 
 	else if(!strcmp(function,"debug")) {						// print contents of all internal data structures
 		printf("data in strunit function:\n");
 		printf("%i unit types and %i units allocated per type\n",numType,maxUnits);
 		for(ut=0;ut<numType;ut++) {
-			printf("%i unit names and (ratios) in type %i:\n",numUnits[ut],ut);
-			for(ui=0;ui<numUnits[ut];ui++)
-				printf(" %s (%g)",unitNames[ut][ui],unitRatios[ut][ui]);
+			printf("%i unit names and (ratios) in type %i:\n",us->numUnits[ut],ut);
+			for(ui=0;ui<us->numUnits[ut];ui++)
+				printf(" %s (%g)",us->unitNames[ut][ui],us->unitRatios[ut][ui]);
 			printf("\n"); }
-		printf("Unit stack has %i rows:\n",numStack);
-		for(is=0;is<numStack;is++) {
-			printf("row %i (filname='%s'):",is,nameStack[is]);
+		printf("Unit stack has %i rows:\n",us->numStack);
+		for(is=0;is<us->numStack;is++) {
+			printf("row %i (filname='%s'):",is,us->nameStack[is]);
 			for(ut=0;ut<numType;ut++)
-				printf(" %s",unitNames[ut][unitStack[ut][is]]);
+				printf(" %s",us->unitNames[ut][us->unitStack[ut][is]]);
 			printf("\n"); }
-		printf("Working units (%s):",haveWorkUnits?"defined":"undefined");
+		printf("Working units (%s):",us->haveWorkUnits?"defined":"undefined");
 		for(ut=0;ut<numType;ut++)
-			printf(" %s",unitNames[ut][workUnits[ut]]);
+			printf(" %s",us->unitNames[ut][us->workUnits[ut]]);
 		printf("\n\n"); }
 
 	else if(!strcmp(function,"push")) {						// push new units onto stack. example string="um ms"
@@ -1863,30 +1907,30 @@ double strunits(const char *unitstring,const char *dimstring,double value,char *
 			count=sscanf(strptr,"%s",word);
 			CHECKS(count==1,"strunits. Failed to read unit during 'push' operation");
 			for(ut=0;ut<numType;ut++) {
-				ui=stringfind(unitNames[ut],numUnits[ut],word);
+				ui=stringfind(us->unitNames[ut],us->numUnits[ut],word);
 				if(ui>=0) break; }
 			CHECKS(ui>=0,"strunits. Unit '%s' is not a recognized unit name",word);
 			tempunit[ut]=ui;
 			strptr=strnword(strptr,2); }
-		if(!haveWorkUnits) {
+		if(!us->haveWorkUnits) {
 			for(ut=0;ut<numType;ut++)
-				workUnits[ut]=tempunit[ut];
-			haveWorkUnits=1; }
-		CHECKS(numStack<maxStack,"strunits. Unit stack is full.");
+				us->workUnits[ut]=tempunit[ut];
+			us->haveWorkUnits=1; }
+		CHECKS(us->numStack<maxStack,"strunits. Unit stack is full.");
 		for(ut=0;ut<numType;ut++)
-			unitStack[ut][numStack]=tempunit[ut];
-		strcpy(nameStack[numStack],dstring);
-		numStack++; }
+			us->unitStack[ut][us->numStack]=tempunit[ut];
+		strcpy(us->nameStack[us->numStack],dstring);
+		us->numStack++; }
 
 	else if(!strcmp(function,"pop")) {						// pop units either down to the filename or down by 1
 		if(dstring[0]) {
-			for(is=0;is<numStack;is++)
-				if(!strcmp(nameStack[is],dstring)) {
-					numStack=is;
+			for(is=0;is<us->numStack;is++)
+				if(!strcmp(us->nameStack[is],dstring)) {
+					us->numStack=is;
 					break; }}
 		else
-			if(numStack>0)
-				numStack--; }
+			if(us->numStack>0)
+				us->numStack--; }
 
 	else if(!strcmp(function,"working")) {
 		for(ut=0;ut<numType;ut++)
@@ -1896,21 +1940,21 @@ double strunits(const char *unitstring,const char *dimstring,double value,char *
 			count=sscanf(strptr,"%s",word);
 			CHECKS(count==1,"strunits. Failed to read unit during 'working' operation");
 			for(ut=0;ut<numType;ut++) {
-				ui=stringfind(unitNames[ut],numUnits[ut],word);
+				ui=stringfind(us->unitNames[ut],us->numUnits[ut],word);
 				if(ui>=0) break; }
 			CHECKS(ui>0,"strunits. Unit '%s' is not a recognized unit name",word);
 			tempunit[ut]=ui;
 			strptr=strnword(strptr,2); }
 		for(ut=0;ut<numType;ut++)
-			workUnits[ut]=tempunit[ut];
-		haveWorkUnits=1; }
+			us->workUnits[ut]=tempunit[ut];
+		us->haveWorkUnits=1; }
 
 	else if(!strcmp(function,"parse")) {				// parse from unitstring
 		strptr=ustring;
 		factor=1;
 		mult=1;
 		for(ut=0;ut<numType;ut++)
-			dimUnit[ut]=0;
+			us->dimUnit[ut]=0;
 		while(strptr && *strptr) {
 			if(*strptr=='.') {												// parse . or /
 				mult=1;
@@ -1922,7 +1966,7 @@ double strunits(const char *unitstring,const char *dimstring,double value,char *
 				strptr+=strfirstwordpbrk(word,strptr,"./^0123456789-");
 				CHECKS(word[0]!='\0',"Parse error in strunits, with '%s'",unitstring);
 				for(ut=0;ut<numType;ut++) {
-					ui=stringfind(unitNames[ut],numUnits[ut],word);
+					ui=stringfind(us->unitNames[ut],us->numUnits[ut],word);
 					if(ui>=0) break; }
 				CHECKS(ui>=0,"strunits. Unit '%s' (in '%s') is not a recognized unit name",word,unitstring);
 				strptr+=strfirstwordpbrk(word,strptr,"./");
@@ -1934,11 +1978,11 @@ double strunits(const char *unitstring,const char *dimstring,double value,char *
 					if(mult==0) {
 						mult=1;
 						power*=-1; }}
-				dimUnit[ut]+=mult?power:-power;
+				us->dimUnit[ut]+=mult?power:-power;
 				if(ui>0) {
-					if(mult==1 && power==1) factor*=unitRatios[ut][ui]/unitRatios[ut][workUnits[ut]];
-					else if(mult==0 && power==1) factor*=unitRatios[ut][workUnits[ut]]/unitRatios[ut][ui];
-					else factor*=pow(unitRatios[ut][ui]/unitRatios[ut][workUnits[ut]],power); }}}
+					if(mult==1 && power==1) factor*=us->unitRatios[ut][ui]/us->unitRatios[ut][us->workUnits[ut]];
+					else if(mult==0 && power==1) factor*=us->unitRatios[ut][us->workUnits[ut]]/us->unitRatios[ut][ui];
+					else factor*=pow(us->unitRatios[ut][ui]/us->unitRatios[ut][us->workUnits[ut]],power); }}}
 		answer=value*factor; }
 
 	return answer;
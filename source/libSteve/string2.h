@@ -95,5 +95,8 @@ double strmatheval(const char *expression,char **varnames,const double *varvalue
 int strmatherror(char *string,int clear);
 int strmathsscanf(const char *str,const char *format,char **varnames,const double *varvalues,int nvar,...);
 double strunits(const char *unitstring,const char *dimstring,double value,char *outstring,const char* function);
+void *strunitsalloc(void);
+void strunitsfree(void *units);
+void *strunitsuse(void *units);
 
 #endif
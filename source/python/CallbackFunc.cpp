@@ -40,19 +40,85 @@ CallbackFunc::evalAndUpdate(double t)
         return std::nan("invalid.");
     }
 
-    py::module m = py::module::import("__main__");
+    // The simulation may be running with the GIL released.
+    py::gil_scoped_acquire acquire;
+    return update(t);
+}
 
-    double v = func_ ? func_(t, args_).cast<double>()
-                     : m.attr(funcName_.c_str())(t, args_).cast<double>();
+void
+CallbackFunc::evalAll(CallbackFunc** callbacks, unsigned int n, size_t simstep, double t)
+{
+    unsigned int i;
+
+    for (i = 0; i < n; i++)
+        if (callbacks[i]->isDue(simstep))
+            break;
+    if (i == n)
+        return;
+
+    py::gil_scoped_acquire acquire;
+    for (; i < n; i++)
+        if (callbacks[i]->isDue(simstep))
+            callbacks[i]->update(t);
+}
+
+// Must be called with the GIL held.
+bool
+CallbackFunc::update(double t)
+{
+    if (!func_)
+        func_ = py::module::import("__main__").attr(funcName_.c_str());
+    if (!setter_ && !resolveTarget())
+        throw py::value_error("Could not resolve callback target '" + py::str(target_).cast<string>() + "'.");
 
-    // If target_ is a function, call the function, else use the magic string.
-    if (true == py::isinstance<py::function>(target_))
-        target_(v);
-    else
-        py::exec(target_.cast<string>() + '=' + std::to_string(v), m.attr("__dict__"));
+    setter_(func_(t, args_).cast<double>());
     return true;
 }
 
+// Turns the target into a setter once, so that each update is a direct call
+// or attribute assignment rather than an evaluated string. A string target is
+// either "name", a global in __main__, or "object.attribute", whose object is
+// looked up in __main__ here. Returns false if the object does not exist yet,
+// in which case this is tried again at the first update.
+bool
+CallbackFunc::resolveTarget()
+{
+    if (setter_)
+        return true;
+    if (!target_)
+        return false;
+
+    if (py::isinstance<py::function>(target_)) {
+        py::function f = target_;
+        setter_ = [f](double v) { f(v); };
+        return true;
+    }
+
+    string name = target_.cast<string>();
+    py::dict globals = py::module::import("__main__").attr("__dict__");
+    size_t dot = name.rfind('.');
+    if (dot == string::npos) {
+        setter_ = [globals, name](double v) { globals[name.c_str()] = v; };
+        return true;
+    }
+
+    py::object obj;
+    try {
+        obj = py::eval(py::str(name.substr(0, dot)), globals);
+    } catch (py::error_already_set&) {
+        return false;
+    }
+    string attr = name.substr(dot + 1);
+    setter_ = [obj, attr](double v) { py::setattr(obj, attr.c_str(), py::float_(v)); };
+    return true;
+}
+
+bool
+CallbackFunc::isDue(size_t simstep) const
+{
+    return (simstep % step_ == 0) && isValid();
+}
+
 bool
 CallbackFunc::isValid() const
 {
@@ -88,7 +154,7 @@ CallbackFunc::getFuncName() const
 void
 CallbackFunc::setStep(size_t step)
 {
-    step_ = step;
+    step_ = step > 0 ? step : 1;
 }
 
 size_t
@@ -100,7 +166,14 @@ CallbackFunc::getStep() const
 void
 CallbackFunc::setTarget(const py::handle& target)
 {
-    target_ = target;
+    target_ = py::reinterpret_borrow<py::object>(target);
+    setter_ = nullptr;
+}
+
+void
+CallbackFunc::setSetter(const std::function<void(double)>& setter)
+{
+    setter_ = setter;
 }
 
 py::handle
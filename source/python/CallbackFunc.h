@@ -32,21 +32,34 @@ class CallbackFunc
     void setTarget(const py::handle& target);
     py::handle getTarget() const;
 
+    // Sets the target to a C++ setter, such as a simulation variable or a
+    // reaction rate, so that no Python code is run to apply the value.
+    void setSetter(const std::function<void(double)>& setter);
+    bool resolveTarget();
+
     void setFunc(const py::function& target);
     py::function getFunc() const;
 
     bool isValid() const;
+    bool isDue(size_t simstep) const;
     bool evalAndUpdate(double t);
 
+    // Evaluates all callbacks that are due at this step, acquiring the GIL
+    // only once and only if at least one of them is due.
+    static void evalAll(CallbackFunc** callbacks, unsigned int n, size_t simstep, double t);
+
     void setArgs(const py::list& args);
     py::list getArgs() const;
 
   private:
+    bool update(double t);
+
     /* data */
     std::string funcName_;
     py::function func_;
     size_t step_;
-    py::handle target_;
+    py::object target_;
+    std::function<void(double)> setter_;
     py::list args_;
 };
 
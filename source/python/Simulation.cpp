@@ -25,6 +25,7 @@ Simulation::Simulation(vector<double>& low,
   , high_(high)
   , curtime_(0.0)
   , initDisplay_(false)
+  , initSteps_(false)
   , debug_(false)
 {
     assert(low.size() == high.size());
@@ -43,10 +44,11 @@ Simulation::Simulation(vector<double>& low,
 }
 
 // Factory function.
-Simulation::Simulation(const char* filepath, const char* flags)
+Simulation::Simulation(const char* filepath, const char* flags, long int seed)
   : sim_(nullptr)
   , curtime_(0.0)
   , initDisplay_(false)
+  , initSteps_(false)
   , debug_(false)
 {
     auto path = splitPath(string(filepath));
@@ -55,7 +57,10 @@ Simulation::Simulation(const char* filepath, const char* flags)
     // WARN: sim_ could be null if the model file could not parsed successfully. See
     // issue #113.
     //
-    auto sim = smolPrepareSimFromFile(path.first.c_str(), path.second.c_str(), flags);
+    auto sim = seed < 0
+                 ? smolPrepareSimFromFile(path.first.c_str(), path.second.c_str(), flags)
+                 : smolPrepareSimFromFileWithSeed(
+                     path.first.c_str(), path.second.c_str(), flags, seed);
     if (sim) {
         sim_.reset(sim, simfree);
         return;
@@ -189,7 +194,12 @@ Simulation::runSim(double stoptime, double dt, bool display, bool overwrite)
         initDisplay_ = true;
     }
 
-    er = smolRunSim(sim_.get());
+    // Release the GIL so that other Python threads can run while this
+    // simulation runs. Callbacks reacquire it, see CallbackFunc::evalAndUpdate.
+    {
+        py::gil_scoped_release release;
+        er = smolRunSim(sim_.get());
+    }
     curtime_ = stoptime;
 
     return er;
@@ -224,9 +234,33 @@ Simulation::runUntil(const double breaktime,
         smolDisplaySim(sim_.get());
         initDisplay_ = true;
     }
+
+    py::gil_scoped_release release;
     return smolRunSimUntil(sim_.get(), breaktime);
 }
 
+ErrorCode
+Simulation::runSteps(size_t nsteps, double dt, bool overwrite)
+{
+    assert(sim_);
+
+    if (!initSteps_) {
+        auto er = smolOpenOutputFiles(sim_.get(), overwrite);
+        if (er != ErrorCode::ECok) {
+            cerr << __FUNCTION__ << ": Could not open output files." << endl;
+            return er;
+        }
+        initSteps_ = true;
+    }
+
+    if (dt > 0.0)
+        smolSetTimeStep(sim_.get(), dt);
+    smolUpdateSim(sim_.get());
+
+    py::gil_scoped_release release;
+    return smolRunTimeSteps(sim_.get(), (int)nsteps);
+}
+
 bool
 Simulation::connect(const py::function& func,
   const py::handle& target,
@@ -251,11 +285,74 @@ Simulation::connect(const py::function& func,
     f->setTarget(target);
     f->setArgs(args);
 
+    // A "var:name" or "rxn:name" target is a simulation variable or the rate
+    // of a reaction, which is set directly, without going through Python.
+    // Other names are Python globals or attributes.
+    if (py::isinstance<py::str>(target)) {
+        string name = target.cast<string>();
+        simptr sim = sim_.get();
+        if (name.compare(0, 4, "var:") == 0) {
+            name = name.substr(4);
+            f->setSetter([sim, name](double v) {
+                if (simsetvariable(sim, name.c_str(), v))
+                    throw py::value_error("Could not set variable '" + name + "'.");
+            });
+        }
+        else if (name.compare(0, 4, "rxn:") == 0) {
+            int order = -1, r;
+            name = name.substr(4);
+            r = smolGetReactionIndexNT(sim, &order, name.c_str());
+            if (r < 0) {
+                delete f;
+                throw py::value_error("Unknown reaction '" + name + "' in callback target.");
+            }
+            rxnptr rxn = sim->rxnss[order]->rxn[r];
+            f->setSetter([sim, rxn, name](double v) {
+                double rate = rxn->rate;
+                if (RxnSetValue(sim, "rate", rxn, v)) {
+                    rxn->rate = rate;
+                    throw py::value_error("Callback returned invalid rate " + std::to_string(v) + " for reaction '" + name + "'.");
+                }
+            });
+        }
+    }
+    f->resolveTarget();
+
     sim_->callbacks[sim_->ncallbacks] = f;
     sim_->ncallbacks += 1;
     return true;
 }
 
+//
+// Step hook that calls a python function. The simulation may run with the GIL
+// released, so it is taken here. A python exception is reported and stops
+// the simulation, since it cannot pass through the simulation loop.
+//
+static int
+pyStepHook(simptr sim, void* userdata)
+{
+    py::gil_scoped_acquire acquire;
+    auto func = static_cast<py::function*>(userdata);
+    try {
+        return py::cast<bool>((*func)(sim->time)) ? 1 : 0;
+    } catch (py::error_already_set& e) {
+        e.discard_as_unraisable("smoldyn step hook");
+        return 1;
+    }
+}
+
+bool
+Simulation::addStepHook(const py::function& func, size_t every)
+{
+    // The list keeps the function alive and its address fixed.
+    stepHooks_.push_back(func);
+    if (smolAddStepHook(sim_.get(), &pyStepHook, &stepHooks_.back(), (int)every) != ECok) {
+        stepHooks_.pop_back();
+        return false;
+    }
+    return true;
+}
+
 //
 // get the pointer to simptr (use with care).
 //
@@ -7,6 +7,7 @@
 #define SIMULATION_H
 
 #include <iostream>
+#include <list>
 #include <memory>
 #include <vector>
 
@@ -35,8 +36,8 @@ class Simulation
   public:
     Simulation(vector<double>& low, vector<double>& high, vector<string>& boundary_type);
 
-    // Factory function.
-    Simulation(const char* filepath, const char* flags);
+    // Factory function. A non-negative seed is applied before the file is read.
+    Simulation(const char* filepath, const char* flags, long int seed = -1);
 
     ~Simulation();
 
@@ -64,11 +65,19 @@ class Simulation
       bool display,
       bool overwrite);
 
+    // Runs nsteps time steps. Output files are opened on the first call only,
+    // so that repeated calls append to them.
+    ErrorCode runSteps(size_t nsteps, double dt, bool overwrite);
+
     bool connect(const py::function& func,
       const py::handle& target,
       const size_t step,
       const py::list& args);
 
+    // Registers func to be called with the simulation time after every
+    // `every` time steps. The simulation stops if func returns True.
+    bool addStepHook(const py::function& func, size_t every);
+
     //
     // get the simptr
     //
@@ -97,9 +106,11 @@ class Simulation
     vector<double> high_;
     double curtime_;
     bool initDisplay_;
+    bool initSteps_;
     bool debug_;
 
     vector<std::unique_ptr<Command>> commands_;
+    std::list<py::function> stepHooks_;
 };
 
 #endif /* end of include guard:  */
@@ -20,6 +20,7 @@ using namespace std;
 #include "Simulation.h"
 #include "module.h"
 #include "pybind11/functional.h"
+#include "pybind11/numpy.h"
 #include "pybind11/pybind11.h"
 #include "pybind11/stl.h"
 #include "pybind11/stl_bind.h"
@@ -100,7 +101,7 @@ init_and_run(const string& filepath,
 #endif
     if (!er) {
         pSim->quitatend = quit_at_end;
-        if (pSim->graphss && pSim->graphss->graphics != 0)
+        if (pSim->graphss && pSim->graphss->graphics != 0 && !pSim->graphss->offscreen)
             gl2glutInit(0, nullptr);
         er = simUpdateAndDisplay(pSim);
     }
@@ -111,7 +112,8 @@ init_and_run(const string& filepath,
     } else {
         fflush(stdout);
         fflush(stderr);
-        if (!pSim->graphss || pSim->graphss->graphics == 0 || strchr(pSim->flags, 't')) {
+        if (!pSim->graphss || pSim->graphss->graphics == 0 || pSim->graphss->offscreen ||
+            strchr(pSim->flags, 't')) {
             er = smolsimulate(pSim);
             endsimulate(pSim, er);
         } else {
@@ -389,10 +391,14 @@ PYBIND11_MODULE(_smoldyn, m)
     py::class_<Simulation>(m, "Simulation")
       .def(py::init<vector<double>&, vector<double>&, vector<string>&>())
       .def(py::init<const char*, const char*>())
+      .def(py::init<const char*, const char*, long int>())
 
       // Connect a python callback function.
       .def("connect", &Simulation::connect)
 
+      // Python function called after every few time steps.
+      .def("addStepHook", &Simulation::addStepHook, "func"_a, "every"_a = 1)
+
       // utility functions.
       .def("getSimPtr", &Simulation::getSimPtr, py::return_value_policy::reference)
 
@@ -412,6 +418,11 @@ PYBIND11_MODULE(_smoldyn, m)
         "display"_a = true,
         "overwrite"_a = false)
       .def("updateSim", [](const Simulation& sim) { smolUpdateSim(sim.getSimPtr()); })
+      .def("runSteps",
+        &Simulation::runSteps,
+        "nsteps"_a,
+        "dt"_a = 0.0,
+        "overwrite"_a = false)
 
       /* Data */
       .def("getOutputData",
@@ -429,6 +440,37 @@ PYBIND11_MODULE(_smoldyn, m)
             return cppdata;
         })
 
+      // enum ErrorCode smolGetOutputDataRows(simptr sim, const char *dataname,
+      //     int firstrow, int maxrow, int *nrowptr, int *ncolptr, double *array);
+      .def(
+        "getOutputDataRows",
+        [](Simulation& sim, const char* dataname, int firstrow) {
+            auto simptr = sim.getSimPtr();
+            int nrow = 0, ncol = 0;
+            char errstr[512];
+
+            auto er = smolGetOutputDataRows(
+              simptr, dataname, firstrow, 0, &nrow, &ncol, NULL);
+            if (er != ErrorCode::ECok) {
+                smolGetError(NULL, errstr, 1);
+                throw py::value_error(errstr);
+            }
+            py::array_t<double> rows({ (py::ssize_t)nrow, (py::ssize_t)ncol });
+            smolGetOutputDataRows(
+              simptr, dataname, firstrow, nrow, &nrow, &ncol, rows.mutable_data());
+            return rows;
+        },
+        "dataname"_a,
+        "firstrow"_a = 0)
+      .def("getOutputDataNames",
+        [](Simulation& sim) {
+            vector<string> names;
+            char dataname[STRCHAR];
+            for (int i = 0; smolGetOutputDataName(sim.getSimPtr(), i, dataname); i++)
+                names.push_back(dataname);
+            return names;
+        })
+
       .def("addOutputData",
         [](Simulation& sim, char* dataname) {
             return smolAddOutputData(sim.getSimPtr(), dataname);
@@ -538,6 +580,13 @@ PYBIND11_MODULE(_smoldyn, m)
               sim.getSimPtr(), timesteps, tiffname, lowcount, highcount);
         })
 
+      // enum ErrorCode smolSetImageParams(simptr sim, const char *format,
+      //     int width, int height);
+      .def("setImageParams",
+        [](Simulation& sim, const char* format, int width, int height) {
+            return smolSetImageParams(sim.getSimPtr(), format, width, height);
+        })
+
       // enum ErrorCode smolSetLightParams( simptr sim, int lightindex, double *ambient,
       //     double *diffuse, double *specular, double *position);
       .def("setLightParams",
@@ -747,6 +796,12 @@ PYBIND11_MODULE(_smoldyn, m)
             return smolSetMaxMolecules(sim.getSimPtr(), maxmolecules);
         })
 
+      // enum ErrorCode smolReserveMolecules(simptr sim, int nmolecules);
+      .def("reserveMolecules",
+        [](Simulation& sim, int nmolecules) {
+            return smolReserveMolecules(sim.getSimPtr(), nmolecules);
+        })
+
       // enum ErrorCode smolAddSolutionMolecules(simptr sim, const char
       // *species,
       //     int number, double *lowposition, double *highposition);
@@ -765,6 +820,27 @@ PYBIND11_MODULE(_smoldyn, m)
         "lowpos"_a = vector<double>(),
         "highpos"_a = vector<double>())
 
+      // enum ErrorCode smolAddMoleculesAtPositions(simptr sim, const char
+      // *species, enum MolecState state, int number, double *positions);
+      .def(
+        "addMoleculesAtPositions",
+        [](Simulation& sim,
+          const char* species,
+          MolecState state,
+          py::array_t<double, py::array::c_style | py::array::forcecast> positions) {
+            auto simptr = sim.getSimPtr();
+            if (positions.ndim() != 2 || positions.shape(1) != simptr->dim)
+                throw py::value_error("positions must have one row per molecule and one column per dimension");
+            return smolAddMoleculesAtPositions(simptr,
+              species,
+              state,
+              (int)positions.shape(0),
+              const_cast<double*>(positions.data()));
+        },
+        "species"_a,
+        "state"_a,
+        "positions"_a)
+
       // enum ErrorCode smolAddCompartmentMolecules(
       //     simptr sim, const char *species, int number, const char
       //     *compartment);
@@ -797,6 +873,25 @@ PYBIND11_MODULE(_smoldyn, m)
               &position[0]);
         })
 
+      // enum ErrorCode smolKillMolecules(simptr sim, int number,
+      //     const unsigned long long *serials, int *nkilledptr);
+      .def(
+        "killMolecules",
+        [](Simulation& sim,
+          py::array_t<unsigned long long, py::array::c_style | py::array::forcecast> serials) {
+            int nkilled = 0;
+            char errstr[512];
+
+            auto er = smolKillMolecules(
+              sim.getSimPtr(), (int)serials.size(), serials.data(), &nkilled);
+            if (er != ErrorCode::ECok) {
+                smolGetError(NULL, errstr, 1);
+                throw py::value_error(errstr);
+            }
+            return nkilled;
+        },
+        "serials"_a)
+
       // int smolGetMoleculeCount(simptr sim, const char *species, enum
       // MolecState state);
       .def("getMoleculeCount",
@@ -804,6 +899,51 @@ PYBIND11_MODULE(_smoldyn, m)
             return smolGetMoleculeCount(sim.getSimPtr(), species, state);
         })
 
+      // enum ErrorCode smolGetMoleculeArrays(simptr sim, const char *species,
+      //     enum MolecState state, const char *mollist, int maxmol, int *nmolptr,
+      //     double *positions, int *identities, int *states,
+      //     unsigned long long *serials);
+      // The molecule lists hold pointers, in an order that changes as molecules
+      // are created and removed, so the arrays are filled with one pass over
+      // the lists rather than being views.
+      .def(
+        "getMoleculeArrays",
+        [](Simulation& sim, const char* species, MolecState state, const char* mollist) {
+            auto simptr = sim.getSimPtr();
+            int nmol = 0;
+            char errstr[512];
+
+            auto er = smolGetMoleculeArrays(
+              simptr, species, state, mollist, 0, &nmol, NULL, NULL, NULL, NULL);
+            if (er != ErrorCode::ECok) {
+                smolGetError(NULL, errstr, 1);
+                throw py::value_error(errstr);
+            }
+
+            py::array_t<double> positions({ (py::ssize_t)nmol, (py::ssize_t)simptr->dim });
+            py::array_t<int> identities(nmol);
+            py::array_t<int> states(nmol);
+            py::array_t<unsigned long long> serials(nmol);
+            er = smolGetMoleculeArrays(simptr,
+              species,
+              state,
+              mollist,
+              nmol,
+              &nmol,
+              positions.mutable_data(),
+              identities.mutable_data(),
+              states.mutable_data(),
+              serials.mutable_data());
+            if (er != ErrorCode::ECok) {
+                smolGetError(NULL, errstr, 1);
+                throw py::value_error(errstr);
+            }
+            return py::make_tuple(positions, identities, states, serials);
+        },
+        "species"_a = "all",
+        "state"_a = MolecState::MSall,
+        "mollist"_a = "")
+
       // enum ErrorCode smolSetMoleculeStyle(simptr sim, const char *species,
       //     enum MolecState state, double size, double *color);
       .def("setMoleculeStyle",
@@ -1379,13 +1519,19 @@ PYBIND11_MODULE(_smoldyn, m)
                 py::print("Please set the dt to non-zero value");
                 return ErrorCode::ECmissing;
             }
+            py::gil_scoped_release release;
             return smolRunTimeStep(sim.getSimPtr());
         })
-      .def("runSim", [](Simulation& sim) { return smolRunSim(sim.getSimPtr()); })
-      .def("runSimUntil",
+      .def(
+        "runSim",
+        [](Simulation& sim) { return smolRunSim(sim.getSimPtr()); },
+        py::call_guard<py::gil_scoped_release>())
+      .def(
+        "runSimUntil",
         [](Simulation& sim, double breaktime) {
             return smolRunSimUntil(sim.getSimPtr(), breaktime);
-        })
+        },
+        py::call_guard<py::gil_scoped_release>())
 
       .def("displaySim", [](Simulation& sim) { return smolDisplaySim(sim.getSimPtr()); });
 
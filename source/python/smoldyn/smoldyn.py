@@ -23,17 +23,21 @@ __all__ = [
     "Compartment",
     "Reaction",
     "BidirectionalReaction",
+    "runReplicas",
 ]
 
 import operator
 import functools
 import math
+import os
+import random
+import sys
 import warnings
 from pathlib import Path
 from dataclasses import dataclass
 
 from typing import Union, Tuple, List, Dict, Optional, Sequence, Literal, TypeAlias
-from collections.abc import Callable
+from collections.abc import Callable, Iterator
 
 
 from smoldyn.types import Color, BoundType, ColorType, DiffConst
@@ -1739,11 +1743,13 @@ class Simulation(_smoldyn.Simulation):  # type: ignore
             self.accuracy: float = accuracy
         self.setOutputFiles(output_files)
         if seed >= 0:
-            self.randomSeed = seed
+            self.seed = seed
         self.quitatend = quit_at_end
 
     @classmethod
-    def fromFile(cls, path: Union[Path, str], arg: str = "") -> "Simulation":
+    def fromFile(
+        cls, path: Union[Path, str], arg: str = "", seed: Optional[int] = None
+    ) -> "Simulation":
         """Create `_smoldyn.Simulation` object from model file.
 
         Parameters
@@ -1752,11 +1758,18 @@ class Simulation(_smoldyn.Simulation):  # type: ignore
             path
         arg : str
             arg
+        seed : int, optional
+            Random number seed, which is applied before the file is read, so
+            it also determines where the file places molecules. A
+            `random_seed` statement in the file replaces it.
         """
         #  return _smoldyn.Simulation(str(path), arg)
         obj = cls.__new__(cls)
         path = Path(path).resolve()  # critical.
-        super(Simulation, obj).__init__(str(path), arg)
+        if seed is None:
+            super(Simulation, obj).__init__(str(path), arg)
+        else:
+            super(Simulation, obj).__init__(str(path), arg, seed)
         return obj
 
     def setOutputFiles(self, outfiles: List[str | Path], append: bool = True) -> None:
@@ -1819,7 +1832,9 @@ class Simulation(_smoldyn.Simulation):  # type: ignore
         Parameters
         ----------
         method : str
-            Avaibale options: "none", "opengl", "opengl_good", "opengl_better"
+            Avaibale options: "none", "opengl", "opengl_good", "opengl_better",
+            "offscreen", "offscreen_good", "offscreen_better". The offscreen
+            methods open no window; they only save image files, see setTiff.
         iter : int
             Update graphics after every nth step (default 20)
         delay : int
@@ -1889,6 +1904,8 @@ class Simulation(_smoldyn.Simulation):  # type: ignore
         minsuffix: int = 1,
         maxsuffix: int = 999,
         every: int = 5,
+        format: str = "",
+        size: Tuple[int, int] | None = None,
     ) -> None:
         """TIFF related parameters.
 
@@ -1908,9 +1925,19 @@ class Simulation(_smoldyn.Simulation):  # type: ignore
         every: int
             ``every`` is the number of simulation timesteps that should elapse
             between subsequent snapshots.
+        format: str
+            Image format for offscreen graphics, "tiff" or "png". Default is
+            to leave it unchanged, which is TIFF initially.
+        size: (int, int)
+            Image width and height in pixels for offscreen graphics. Default
+            is to leave it unchanged, which is 400 by 400 initially.
         """
         k = super().setTiffParams(every, str(tiffname), minsuffix, maxsuffix)
         assert k == _smoldyn.ErrorCode.ok
+        if format or size:
+            width, height = size if size else (-1, -1)
+            k = super().setImageParams(format or "", width, height)
+            assert k == _smoldyn.ErrorCode.ok, f"Invalid image format or size: {format} {size}"
 
     def setLight(
         self,
@@ -2020,6 +2047,61 @@ class Simulation(_smoldyn.Simulation):  # type: ignore
         assert self.stop > 0.0, f"stop time can't be <= 0.0! stop={self.stop}"
         super().runUntil(self.stop, self.dt, display, overwrite)
 
+    def step(
+        self, n: int, dt: float | None = None, *, stride: int = 1, overwrite: bool = False
+    ) -> Iterator[Dict[str, "numpy.ndarray"]]:
+        """Advances the simulation by `n` time steps, yielding the new output
+        data after every `stride` steps.
+
+        Each yielded value is a dictionary that maps the name of each data
+        table (see `addOutputData`) to a NumPy array of only the rows that
+        were added since they were last returned, so the cost of each
+        iteration does not grow with the amount of data already recorded.
+        The stop time needs to be set first, because the command schedule is
+        computed from it. The generator ends early if the simulation reaches
+        its stop time or is stopped by a command. Calling `step` again continues where it left
+        off.
+
+        Parameters
+        ----------
+        n : int
+            Number of time steps to run.
+        dt : float, optional
+            Time step. If not given, the current time step is used.
+        stride : int
+            Number of time steps between yields (default 1).
+        overwrite : bool
+            Overwrite existing output files (default `False`). Files are opened
+            only on the first call.
+
+        Example
+        -------
+        >>> s.addOutputData("counts")
+        >>> s.addCommand("molcount counts", "E")
+        >>> for data in s.step(1000, dt=0.01, stride=10):
+        ...     controller.update(data["counts"])
+        """
+        assert n >= 0, f"n can't be < 0! n={n}"
+        assert stride > 0, f"stride must be > 0! stride={stride}"
+        if self.stop >= sys.float_info.max:
+            raise ValueError("Set the stop time (e.g. with setSimTimes) before stepping")
+        rows = self.__dict__.setdefault("_datarows", {})
+        done = 0
+        while done < n:
+            k = min(stride, n - done)
+            r = super().runSteps(k, 0.0 if dt is None else float(dt), overwrite)
+            assert r in (_smoldyn.ErrorCode.ok, _smoldyn.ErrorCode.notify), (
+                f"Failed to run time steps: {r}"
+            )
+            done += k
+            data = {}
+            for name in super().getOutputDataNames():
+                data[name] = super().getOutputDataRows(name, rows.get(name, 0))
+                rows[name] = rows.get(name, 0) + data[name].shape[0]
+            yield data
+            if r != _smoldyn.ErrorCode.ok:
+                return
+
     def updateSim(self) -> None:
         """updateSim"""
         super().updateSim()
@@ -2230,12 +2312,93 @@ class Simulation(_smoldyn.Simulation):  # type: ignore
         """
         assert " " not in dataname, f"Must not contain spaces: '{dataname}'"
         y: List[List[float]] = super().getOutputData(dataname, erase)
+        if erase:
+            self.__dict__.get("_datarows", {}).pop(dataname, None)
         return y
 
+    def getMoleculeArrays(
+        self,
+        species: Union[str, Species] = "all",
+        state: SpeciesState = "all",
+        mol_list: str = "",
+    ) -> Tuple["numpy.ndarray", "numpy.ndarray", "numpy.ndarray", "numpy.ndarray"]:
+        """Returns the current molecules as NumPy arrays, for analysis without
+        writing them to a file.
+
+        Parameters
+        ----------
+        species : str or Species
+            Species to return, or "all" (default) for all species. This is one
+            species name; wildcards and species groups raise a ValueError.
+        state : str or MolecState
+            State to return, or "all" (default) for all states.
+        mol_list : str
+            Molecule list to return, or "" (default) for all lists.
+
+        Returns
+        -------
+        (positions, species, states, serials)
+            `positions` has one row per molecule and one column per dimension.
+            `species` holds the species indices, `states` the MolecState values,
+            and `serials` the molecule serial numbers. Rows are in the same
+            order in all four arrays. The arrays are copies, so they do not
+            change as the simulation continues.
+        """
+        if isinstance(species, Species):
+            species = species.name
+        return super().getMoleculeArrays(species, _toMS(state), mol_list)
+
+    def positions(
+        self,
+        species: Union[str, Species] = "all",
+        state: SpeciesState = "all",
+        mol_list: str = "",
+    ) -> "numpy.ndarray":
+        """Returns the positions of the current molecules as a NumPy array with
+        one row per molecule. See `getMoleculeArrays` for the parameters.
+        """
+        return self.getMoleculeArrays(species, state, mol_list)[0]
+
+    def addMoleculesAtPositions(
+        self,
+        species: Union[str, Species],
+        positions: "numpy.ndarray",
+        state: SpeciesState = "soln",
+    ) -> None:
+        """Adds one molecule at each row of `positions`, which needs one column
+        per dimension. All molecules are added in a single call, so this is
+        much faster than adding them one at a time.
+
+        Parameters
+        ----------
+        species : str or Species
+            Species to add.
+        positions : array_like
+            Molecule positions, with shape (number, dimensions).
+        state : str or MolecState
+            Only "soln" (default) is supported.
+        """
+        if isinstance(species, Species):
+            species = species.name
+        k = super().addMoleculesAtPositions(species, _toMS(state), positions)
+        assert k == _smoldyn.ErrorCode.ok, f"Failed to add molecules: {k}"
+
+    def killMolecules(self, serials: "numpy.ndarray") -> int:
+        """Removes the molecules with the given serial numbers, such as those
+        returned by `getMoleculeArrays`. Serial numbers that do not match a
+        current molecule are ignored.
+
+        Returns
+        -------
+        int
+            Number of molecules that were removed.
+        """
+        return super().killMolecules(serials)
+
     def connect(
         self,
         func: Callable[[float, List[float]], float],
-        target: Callable[[float], None],
+        target: Union[Callable[[float], None], str, "Reaction"],
         step: int,
         args: List[float] = [],
     ) -> None:
@@ -2250,7 +2413,11 @@ class Simulation(_smoldyn.Simulation):  # type: ignore
             list of float which refers to `args` (4th argument of this function)
         target :
             Target function or a property. The return value of the connected function
-            i.e., func is the argument to this function.
+            i.e., func is the argument to this function. A string target may be
+            "object.attribute" or the name of a global variable. A Reaction, or
+            a string "rxn:name", has its rate set, and a string "var:name" sets
+            a simulation variable; these are set without running Python code.
+            The target is resolved once, here.
         step : int
             The connected function func is called after these many simulation
             steps.
@@ -2290,8 +2457,29 @@ class Simulation(_smoldyn.Simulation):  # type: ignore
          (81.0, 1.9510546532543747),
          (91.0, 0.37011200572554614)]
         """
+        if isinstance(target, Reaction):
+            target = "rxn:" + target.name
         super().connect(func, target, step, args)
 
+    def addStepHook(self, func: Callable[[float], bool], every: int = 1) -> None:
+        """Call a Python function after every `every` time steps, once the
+        step's runtime commands have run. Unlike :func:`connect`, the function
+        only observes the simulation, e.g. with `getMoleculeCount` or
+        `getMoleculeArrays`. The simulation stops if it returns True.
+
+        C and C++ programs that embed libsmoldyn use `smolAddStepHook`
+        instead, which gives the hook the simulation structure itself.
+
+        Parameters
+        ----------
+        func :
+            Function of the simulation time 't'.
+        every : int
+            Number of time steps between calls.
+        """
+        if not super().addStepHook(func, every):
+            raise ValueError(f"Could not add step hook with every={every}")
+
     def addPath2D(self, *points: Tuple[float, float], closed: bool = False) -> Path2D:
         return Path2D(*points, simulation=super(), closed=closed)
 
@@ -2408,3 +2596,112 @@ class Simulation(_smoldyn.Simulation):  # type: ignore
             vector=vector,
             name=name,
         )
+
+
+def runReplicas(
+    model: Union[str, Path, Callable[[int], Simulation]],
+    n: int,
+    *,
+    seeds: Sequence[int] | None = None,
+    stop: float | None = None,
+    dt: float | None = None,
+    prepare: Callable[[Simulation, int], None] | None = None,
+    workers: int | None = None,
+) -> Dict[str, "numpy.ndarray | List[numpy.ndarray]"]:
+    """Runs `n` independent replicas of a model in this process, on a pool of
+    threads, and returns their output data.
+
+    This is a thread-pool helper. Each replica builds its own simulation from
+    `model`, so a configuration file is read and set up once per replica;
+    nothing is shared between replicas. Each simulation releases the GIL while
+    it runs, so the replicas run in parallel, but models are built one at a
+    time, since that needs the GIL. Each replica has its own random number
+    stream, so the results do not depend on the number of threads or on how
+    the replicas are scheduled.
+
+    Parameters
+    ----------
+    model : str, Path or callable
+        A Smoldyn configuration file, which is loaded in text-only mode, or a
+        function that takes a random seed and returns a new `Simulation`. A
+        file is read again for each replica, with the replica's seed applied
+        first, so the file should not have its own `random_seed` statement.
+    n : int
+        Number of replicas.
+    seeds : list of int, optional
+        One random seed for each replica. If not given, the seeds are chosen
+        at random.
+    stop, dt : float, optional
+        Stop time and time step. If not given, those of the model are used.
+    prepare : callable, optional
+        Called as `prepare(sim, i)` for replica `i` before it runs, for
+        example to add output data tables and commands to a file model.
+    workers : int, optional
+        Number of threads (default: the number of CPUs, `os.cpu_count()`).
+
+    Returns
+    -------
+    dict
+        Maps each output data table name to an array with shape
+        (replicas, rows, columns), or to a list of per-replica arrays if the
+        replicas recorded different numbers of rows.
+
+    Note
+    ----
+    Replicas should record with `addOutputData` rather than to output files,
+    since they would all write to the same files.
+
+    Example
+    -------
+    >>> def model(seed):
+    ...     s = smoldyn.Simulation(low=[0, 0], high=[10, 10], seed=seed)
+    ...     ...
+    ...     return s
+    >>> data = smoldyn.runReplicas(model, 1000, stop=10, dt=0.01)
+    >>> data["counts"].mean(axis=0)
+    """
+    import numpy as np
+    from concurrent.futures import ThreadPoolExecutor
+
+    assert n >= 0, f"n can't be < 0! n={n}"
+    if seeds is None:
+        seeds = [random.randrange(2**31 - 1) for _ in range(n)]
+    assert len(seeds) == n, f"Expected {n} seeds, got {len(seeds)}"
+
+    def replica(i: int) -> Dict[str, "numpy.ndarray"]:
+        if callable(model):
+            sim = model(seeds[i])
+        else:
+            sim = Simulation.fromFile(model, "qt", seed=seeds[i])
+        if prepare is not None:
+            prepare(sim, i)
+        if stop is None and dt is None:
+            k = _smoldyn.Simulation.runSim(sim)
+            assert k in (_smoldyn.ErrorCode.ok, _smoldyn.ErrorCode.notify), (
+                f"Replica {i} failed: {k}"
+            )
+        else:
+            sim.run(
+                sim.stop if stop is None else stop,
+                sim.dt if dt is None else dt,
+                display=False,
+                overwrite=True,
+                quit_at_end=True,
+            )
+        return {
+            name: sim.getOutputDataRows(name, 0) for name in sim.getOutputDataNames()
+        }
+
+    if workers is None:
+        workers = os.cpu_count() or 1
+    with ThreadPoolExecutor(max_workers=workers) as pool:
+        results = list(pool.map(replica, range(n)))
+
+    data: Dict[str, "numpy.ndarray | List[numpy.ndarray]"] = {}
+    for name in results[0] if results else []:
+        arrays = [r[name] for r in results]
+        if all(a.shape == arrays[0].shape for a in arrays):
+            data[name] = np.stack(arrays)
+        else:
+            data[name] = arrays
+    return data
@@ -8,6 +8,29 @@ FIXME: Two Simulations could not be run in the serial mode.
 import smoldyn
 import time
 import threading
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+
+sdir = Path(__file__).parent
+
+units_config = """
+units um ms
+random_seed {seed}
+dim 2
+species A B
+boundaries x 0 10
+boundaries y 0 10
+time_start 0
+time_stop 5
+time_step 0.01
+difc all 1
+reaction fwd A -> B 0.5
+reaction back B -> A 0.5
+mol 200 A u u
+output_data counts
+cmd N 10 molcountinbox 0|um 5000|nm 0 10000|nm counts
+end_file
+"""
 
 
 def sim1():
@@ -85,6 +108,82 @@ def sim2():
     sim.addCommand("molcount data2", 'E')
     return sim
 
+def seeded(seed):
+    s = smoldyn.Simulation(low=[0, 0], high=[100, 100], seed=seed)
+    a = s.addSpecies("A", difc=3)
+    b = s.addSpecies("B", difc=3)
+    a.addToSolution(200)
+    s.addBidirectionalReaction("r1", subs=[a], prds=[b], kf=0.5, kb=0.5)
+    s.addOutputData("counts")
+    s.addCommand("molcount counts", "E")
+    return s
+
+
+def run_seeded(seed):
+    s = seeded(seed)
+    s.run(20, dt=0.01, overwrite=True)
+    return s.getOutputData("counts")
+
+
+def run_units(seed):
+    # Loads a model whose runtime command converts units, and runs it.
+    path = sdir / f"_units_model_{threading.get_ident()}.txt"
+    path.write_text(units_config.format(seed=seed))
+    try:
+        s = smoldyn.Simulation.fromFile(path, "qt")
+    finally:
+        path.unlink()
+    assert smoldyn._smoldyn.Simulation.runSim(s) == smoldyn._smoldyn.ErrorCode.ok
+    return s.getOutputData("counts")
+
+
+def gaussian(seed):
+    # Each step places one molecule, which uses an odd number of Gaussian
+    # deviates in 1D.
+    s = smoldyn.Simulation(low=[0], high=[10], seed=seed)
+    s.addSpecies("A", difc=0)
+    s.addCommand("gaussiansource A 1 5 1", "E")
+    return s
+
+
+def test_gaussian_per_simulation():
+    # Gaussian deviates are made in pairs and the second is stored. It belongs
+    # to the simulation that made it, so two simulations that take turns on
+    # one thread get the same results as when each runs alone.
+    alone = []
+    for seed in (1, 2):
+        s = gaussian(seed)
+        for t in range(1, 6):
+            s.runUntil(t * 0.1, dt=0.01, display=False, overwrite=True)
+        alone.append(s.positions().tolist())
+    sims = [gaussian(1), gaussian(2)]
+    for t in range(1, 6):
+        for s in sims:
+            s.runUntil(t * 0.1, dt=0.01, display=False, overwrite=True)
+    assert [s.positions().tolist() for s in sims] == alone
+
+
+def test_reproducible_in_threads():
+    # Each simulation has its own random number stream, so the results for a
+    # seed do not depend on what other simulations run at the same time.
+    seeds = [1, 2, 3, 1]
+    serial = [run_seeded(seed) for seed in seeds]
+    with ThreadPoolExecutor(max_workers=len(seeds)) as pool:
+        threaded = list(pool.map(run_seeded, seeds))
+    assert serial == threaded
+    assert threaded[0] == threaded[3]
+    assert threaded[0] != threaded[1]
+
+    # Each simulation also has its own unit tables, which its runtime commands
+    # use while other simulations are loaded, run and freed.
+    serial = [run_units(seed) for seed in seeds]
+    assert len(serial[0]) == 51, len(serial[0])
+    assert all(0 < row[1] + row[2] < 200 for row in serial[0][1:])
+    with ThreadPoolExecutor(max_workers=len(seeds)) as pool:
+        threaded = list(pool.map(run_units, seeds * 2))
+    assert threaded == serial * 2
+
+
 def main():
     s1, s2 = sim1(), sim2()
 
@@ -108,3 +207,5 @@ def main():
 
 if __name__ == "__main__":
     main()
+    test_reproducible_in_threads()
+    test_gaussian_per_simulation()
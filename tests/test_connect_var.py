@@ -58,7 +58,8 @@ expected_b = [
 def tuple_isclose(a, b) -> bool:
     res = True
     for _a, _b in zip(a, b):
-        if not math.isclose(_a, _b):
+        # Expected values were recorded with 6 decimal places.
+        if not math.isclose(_a, _b, rel_tol=1e-6, abs_tol=1e-6):
             res = False
     return res
 
@@ -105,12 +106,66 @@ def test_connect_2():
         assert tuple_isclose(_x, _y), (_x, _y)
 
 
+def switch_on(t, args):
+    return 0.0 if t < 5 else 100.0
+
+
+def reaction_sim():
+    s = smoldyn.Simulation(low=(0, 0), high=(10, 10), seed=1)
+    A = s.addSpecies("A", difc=1)
+    B = s.addSpecies("B", difc=1)
+    A.addToSolution(200)
+    r1 = s.addReaction("r1", subs=[A], prds=[B], rate=0)
+    return s, r1
+
+
+def test_connect_reaction():
+    for target in ("rxn:r1", None):
+        s, r1 = reaction_sim()
+        s.connect(switch_on, target or r1, step=5)
+        s.run(5, dt=0.1)
+        assert s.getMoleculeCount("B", smoldyn._smoldyn.MolecState.all) == 0
+        s.runUntil(10, dt=0.1)
+        assert s.getMoleculeCount("B", smoldyn._smoldyn.MolecState.all) == 200
+
+    # A plain name is a Python global, even if a reaction has that name.
+    import __main__
+    s, r1 = reaction_sim()
+    s.connect(switch_on, "r1", step=5)
+    s.run(10, dt=0.1)
+    assert s.getMoleculeCount("B", smoldyn._smoldyn.MolecState.all) == 0
+    assert __main__.r1 == 100.0
+    del __main__.r1
+
+
+def test_connect_reaction_errors():
+    s, r1 = reaction_sim()
+    try:
+        s.connect(switch_on, "rxn:nosuch", step=5)
+    except ValueError:
+        pass
+    else:
+        assert False, "unknown reaction should be rejected"
+
+    s.connect(lambda t, args: -1.0, r1, step=5)
+    try:
+        s.run(1, dt=0.1)
+    except ValueError:
+        pass
+    else:
+        assert False, "negative rate should raise"
+
+
 def main():
     global avals, bvals
     print("==== test connect 1")
     test_connect_1()
     print("==== test connect 2")
     test_connect_2()
+    print("==== test connect reaction")
+    test_connect_reaction()
+    print("==== test connect reaction errors")
+    test_connect_reaction_errors()
 
 
 if __name__ == "__main__":
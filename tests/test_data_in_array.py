@@ -4,6 +4,7 @@
 
 import smoldyn
 import math
+import numpy as np
 
 
 def is_close(listA, listB):
@@ -13,7 +14,7 @@ def is_close(listA, listB):
     return True
 
 
-def test_data():
+def build_model():
     s = smoldyn.Simulation(low=[0, 0, 0], high=[100, 100, 100])
     s.seed = 100
 
@@ -26,6 +27,11 @@ def test_data():
     B.addToSolution(1, pos=[50, 50, 50])
     s.addOutputData("mydata")
     s.addCommand("molcount mydata", "E")
+    return s
+
+
+def test_data():
+    s = build_model()
 
     # s.setGraphics( "opengl" )
     s.run(stop=10, dt=0.01)
@@ -40,8 +46,28 @@ def test_data():
         print(row)
 
 
+def test_step_data():
+    s = build_model()
+    s.run(stop=10, dt=0.01)
+    expected = s.getOutputData("mydata", 0)
+
+    s = build_model()
+    s.setSimTimes(0, 10, 0.01)
+    chunks = [d["mydata"] for d in s.step(600, stride=100)]
+    assert len(chunks) == 6
+    assert chunks[0].shape == (101, 3), chunks[0].shape
+    assert all(c.shape == (100, 3) for c in chunks[1:])
+
+    # Continues where it left off, and stops at the stop time.
+    chunks += [d["mydata"] for d in s.step(1000, stride=7)]
+    assert len(chunks) == 6 + 58, len(chunks)
+    data = np.concatenate(chunks)
+    assert (data == np.array(expected)).all()
+
+
 def main():
     test_data()
+    test_step_data()
 
 
 if __name__ == "__main__":
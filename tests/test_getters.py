@@ -3,6 +3,7 @@ __author__ = "Dilawar Singh"
 __email__ = "dilawar.s.rajput@gmail.com"
 
 import smoldyn
+import numpy as np
 
 
 def test_getter():
@@ -33,8 +34,66 @@ def test_getter():
     print(d)
 
 
+def test_molecule_arrays():
+    s = smoldyn.Simulation(low=[0, 0, 0], high=[10, 20, 30], seed=3)
+    A = s.addSpecies("A", difc=1)
+    B = s.addSpecies("B", difc=1)
+    A.addToSolution(100)
+    B.addToSolution(50, lowpos=[0, 0, 0], highpos=[5, 5, 5])
+    s.addReaction("r1", subs=[A], prds=[B], rate=0.1)
+    s.run(10, dt=0.1, overwrite=True)
+
+    pos, species, states, serials = s.getMoleculeArrays()
+    n = s.getMoleculeCount("all", smoldyn._smoldyn.MolecState.all)
+    assert pos.shape == (n, 3), (pos.shape, n)
+    assert species.shape == states.shape == serials.shape == (n,)
+    assert (pos >= 0).all() and (pos <= [10, 20, 30]).all()
+    assert len(set(serials.tolist())) == n
+
+    posB = s.positions(B)
+    nB = s.getMoleculeCount("B", smoldyn._smoldyn.MolecState.all)
+    assert posB.shape == (nB, 3)
+    assert nB > 50
+    assert (species == s.getSpeciesIndex("B")).sum() == nB
+    assert (posB == pos[species == s.getSpeciesIndex("B")]).all()
+    assert s.positions("A", state="front").shape == (0, 3)
+
+    # Only exact species names are accepted, not patterns or groups.
+    for pattern in ["A*", "[AB]", "C"]:
+        try:
+            s.getMoleculeArrays(pattern)
+        except ValueError:
+            pass
+        else:
+            assert False, f"'{pattern}' should be rejected"
+
+
+def test_add_and_kill_arrays():
+    s = smoldyn.Simulation(low=[0, 0], high=[10, 10], seed=5)
+    A = s.addSpecies("A", difc=0)
+    s.run(1, dt=0.1, overwrite=True)
+
+    rng = np.random.default_rng(1)
+    pts = rng.uniform(0, 10, size=(500, 2))
+    s.addMoleculesAtPositions(A, pts)
+    pos, species, states, serials = s.getMoleculeArrays(A)
+    assert pos.shape == (500, 2), pos.shape
+    assert np.allclose(np.sort(pos, axis=0), np.sort(pts, axis=0))
+
+    doomed = serials[pos[:, 0] < 5]
+    nkilled = s.killMolecules(doomed)
+    assert nkilled == (pts[:, 0] < 5).sum()
+    assert s.killMolecules(doomed) == 0
+    s.runUntil(2, dt=0.1)
+    left = s.positions(A)
+    assert (left[:, 0] >= 5).all()
+    assert left.shape[0] + nkilled == 500
+
+
 def main():
     test_getter()
+    test_molecule_arrays()
+    test_add_and_kill_arrays()
 
 
 if __name__ == "__main__":
@@ -58,8 +58,38 @@ def test_library():
     s.runSim(200.0, 0.01, True, True)
 
 
+def birth_model(reserve):
+    s = CppApi.Simulation([0, 0], [10, 10], ["r", "r"])
+    s.setRandomSeed(1)
+    s.addSpecies("A")
+    s.setSpeciesMobility("A", CppApi.MolecState.all, 1.0)
+    if reserve:
+        assert s.reserveMolecules(reserve) == CppApi.ErrorCode.ok
+    s.addSolutionMolecules("A", 100, [0, 0], [10, 10])
+    s.addReaction("birth", "A", CppApi.MolecState.soln, "", CppApi.MolecState.all,
+                  ["A", "A"], [CppApi.MolecState.soln] * 2, 1.0)
+    s.addOutputData("counts")
+    s.addCommand("molcount counts", "E")
+    s.runSim(2.0, 0.01, False, True)
+    return s
+
+
+def test_reserve():
+    """Preallocated molecules are used without changing the simulation"""
+    s = birth_model(5000)
+    counts = s.getOutputData("counts", False)
+    assert counts[-1][1] > 100, counts[-1]
+    # The population stayed within the reservation, so nothing was reallocated:
+    # a limit is refused once the molecule list has grown past it.
+    assert s.setMaxMolecules(5000) == CppApi.ErrorCode.ok
+
+    plain = birth_model(0)
+    assert plain.getOutputData("counts", False) == counts
+
+
 def main():
     test_library()
+    test_reserve()
 
 
 if __name__ == "__main__":
@@ -0,0 +1,135 @@
+"""Offscreen graphics save image files without opening a window."""
+
+import struct
+import zlib
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+
+import smoldyn
+
+sdir = Path(__file__).parent
+
+
+def build_model(dim, method):
+    s = smoldyn.Simulation(low=[0] * dim, high=[100] * dim, seed=1)
+    A = s.addSpecies("A", difc=1, color="red", display_size=3)
+    A.addToSolution(100)
+    s.setGraphics(method, iter=10)
+    return s
+
+
+def read_tiff(path):
+    b = path.read_bytes()
+    assert b[:4] == b"II*\x00"
+    (ifd,) = struct.unpack("<I", b[4:8])
+    (ntags,) = struct.unpack("<H", b[ifd : ifd + 2])
+    tags = {}
+    for k in range(ntags):
+        tag, typ, count, value = struct.unpack("<HHII", b[ifd + 2 + 12 * k : ifd + 14 + 12 * k])
+        tags[tag] = value
+    width, height, offset = tags[256], tags[257], tags[273]
+    return width, height, b[offset : offset + 3 * width * height]
+
+
+def read_png(path):
+    b = path.read_bytes()
+    assert b[:8] == b"\x89PNG\r\n\x1a\n"
+    i, data = 8, b""
+    while i < len(b):
+        (n,) = struct.unpack(">I", b[i : i + 4])
+        kind, chunk = b[i + 4 : i + 8], b[i + 8 : i + 8 + n]
+        (crc,) = struct.unpack(">I", b[i + 8 + n : i + 12 + n])
+        assert zlib.crc32(kind + chunk) == crc, kind
+        if kind == b"IHDR":
+            width, height = struct.unpack(">II", chunk[:8])
+        elif kind == b"IDAT":
+            data += chunk
+        i += 12 + n
+    raw = zlib.decompress(data)
+    rows = [raw[r * (3 * width + 1) + 1 : (r + 1) * (3 * width + 1)] for r in range(height)]
+    return width, height, b"".join(rows)
+
+
+def colors(rgb):
+    return {rgb[i : i + 3] for i in range(0, len(rgb), 3)}
+
+
+def test_offscreen_tiff():
+    # Image names are relative to the model file, like output files.
+    root = "_offscreen_tiff"
+    s = build_model(2, "offscreen")
+    s.setTiff(root, minsuffix=1, maxsuffix=99, every=10)
+    s.run(stop=1, dt=0.01)
+    files = sorted(sdir.glob(root + "*.tif"))
+    try:
+        # The starting state and the state after every 10th step, up to the end.
+        assert [f.name for f in files] == [f"{root}{i:02d}.tif" for i in range(1, 12)]
+        width, height, rgb = read_tiff(files[-1])
+        assert (width, height) == (400, 400)
+        found = colors(rgb)
+        assert b"\xff\xff\xff" in found, "white background"
+        assert b"\xff\x00\x00" in found, "red molecules"
+        assert b"\x00\x00\x00" in found, "black frame"
+    finally:
+        for f in files:
+            f.unlink()
+
+
+def test_offscreen_png():
+    root = "_offscreen_png"
+    s = build_model(3, "offscreen_better")
+    s.setTiff(root, maxsuffix=9, every=50, format="png", size=(120, 80))
+    s.run(stop=1, dt=0.01)
+    files = sorted(sdir.glob(root + "*.png"))
+    try:
+        assert [f.name for f in files] == [f"{root}{i}.png" for i in range(1, 4)]
+        width, height, rgb = read_png(files[0])
+        assert (width, height) == (120, 80)
+        assert any(c[0] > 100 and c[1] == 0 and c[2] == 0 for c in colors(rgb)), "shaded red molecules"
+    finally:
+        for f in files:
+            f.unlink()
+
+
+def run_concurrent(root):
+    s = build_model(2, "offscreen")
+    s.setTiff(root, minsuffix=1, maxsuffix=99, every=10, size=(60, 60))
+    s.run(stop=1, dt=0.01)
+    return sorted(f.name for f in sdir.glob(root + "*.tif"))
+
+
+def test_offscreen_concurrent():
+    # Each simulation keeps its own image name and counter.
+    roots = [f"_offscreen_thread{k}_" for k in range(4)]
+    try:
+        with ThreadPoolExecutor(max_workers=len(roots)) as pool:
+            names = list(pool.map(run_concurrent, roots))
+        for root, found in zip(roots, names):
+            assert found == [f"{root}{i:02d}.tif" for i in range(1, 12)], found
+    finally:
+        for root in roots:
+            for f in sdir.glob(root + "*.tif"):
+                f.unlink()
+
+
+def test_offscreen_size_limit():
+    s = build_model(2, "offscreen")
+    for size in [(65535, 65535), (8192, 4096)]:
+        try:
+            s.setTiff("_offscreen_big", size=size)
+        except AssertionError:
+            pass
+        else:
+            assert False, f"{size} should be rejected"
+    s.setTiff("_offscreen_big", size=(4096, 4096))
+
+
+def main():
+    test_offscreen_tiff()
+    test_offscreen_png()
+    test_offscreen_concurrent()
+    test_offscreen_size_limit()
+
+
+if __name__ == "__main__":
+    main()
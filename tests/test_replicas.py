@@ -0,0 +1,96 @@
+"""Replicas of a model run on a thread pool."""
+
+import math
+from pathlib import Path
+
+import numpy as np
+import smoldyn
+
+sdir = Path(__file__).parent
+
+config = """
+dim 2
+species A
+boundaries x 0 10
+boundaries y 0 10
+time_start 0
+time_stop 5
+time_step 0.01
+difc A 1
+reaction r1 A -> 0 0.5
+mol 200 A u u
+output_data counts box
+cmd N 10 molcount counts
+cmd N 10 molcountinbox 0 5 0 10 box
+end_file
+"""
+
+
+def decay(seed):
+    s = smoldyn.Simulation(low=[0, 0], high=[10, 10], seed=seed)
+    A = s.addSpecies("A", difc=1)
+    A.addToSolution(200)
+    s.addReaction("r1", subs=[A], prds=[], rate=0.5)
+    s.addOutputData("counts")
+    s.addCommand("molcount counts", "N", step=10)
+    return s
+
+
+def test_replicas_function():
+    data = smoldyn.runReplicas(decay, 8, seeds=range(8), stop=5, dt=0.01, workers=4)
+    counts = data["counts"]
+    assert counts.shape == (8, 51, 2), counts.shape
+    assert (counts[:, 0, 1] == 200).all()
+    assert len({tuple(c[:, 1]) for c in counts}) == 8, "replicas should differ"
+
+    # Mean follows the exponential decay.
+    mean = counts[:, -1, 1].mean()
+    assert abs(mean - 200 * math.exp(-0.5 * 5)) < 10, mean
+
+    # Same seeds give the same results, whatever the number of threads.
+    again = smoldyn.runReplicas(decay, 8, seeds=range(8), stop=5, dt=0.01, workers=2)
+    assert np.array_equal(again["counts"], counts)
+
+
+def test_replicas_file(tmp_path=None):
+    path = Path(tmp_path or sdir) / "_replicas_model.txt"
+    path.write_text(config)
+    try:
+        data = smoldyn.runReplicas(path, 4, seeds=[1, 2, 3, 4], workers=2)
+    finally:
+        path.unlink()
+    counts = data["counts"]
+    assert counts.shape == (4, 51, 2), counts.shape
+    assert (counts[:, 0, 1] == 200).all()
+    assert (counts[:, -1, 1] < 200).all()
+
+
+def test_replicas_file_seeds(tmp_path=None):
+    # The seed is applied before the file places its molecules, so a replica
+    # matches the same file with that seed as its first statement.
+    path = Path(tmp_path or sdir) / "_replicas_model.txt"
+    seeded = Path(tmp_path or sdir) / "_replicas_seeded.txt"
+    path.write_text(config)
+    seeded.write_text("random_seed 7\n" + config)
+    try:
+        data = smoldyn.runReplicas(path, 3, seeds=[7, 8, 7], workers=2)
+        again = smoldyn.runReplicas(path, 3, seeds=[7, 8, 7], workers=1)
+        ref = smoldyn.runReplicas(seeded, 1, seeds=[12345], workers=1)
+    finally:
+        path.unlink()
+        seeded.unlink()
+    for name in ["counts", "box"]:
+        assert np.array_equal(data[name], again[name]), name
+        assert np.array_equal(data[name][0], data[name][2]), name
+        assert np.array_equal(data[name][0], ref[name][0]), name
+    assert not np.array_equal(data["box"][0], data["box"][1])
+
+
+def main():
+    test_replicas_function()
+    test_replicas_file()
+    test_replicas_file_seeds()
+
+
+if __name__ == "__main__":
+    main()
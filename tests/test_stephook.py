@@ -0,0 +1,83 @@
+"""Step hooks are called after time steps and can stop the simulation."""
+
+import smoldyn
+import smoldyn._smoldyn as S
+
+
+def decay():
+    s = smoldyn.Simulation(low=[0, 0], high=[10, 10], seed=1)
+    A = s.addSpecies("A", difc=1)
+    A.addToSolution(200)
+    s.addReaction("r1", subs=[A], prds=[], rate=0.5)
+    s.addOutputData("counts")
+    s.addCommand("molcount counts", "N", step=10)
+    return s
+
+
+def test_step_hook():
+    s = decay()
+    seen = []
+    s.addStepHook(lambda t: seen.append((t, s.getMoleculeCount("A", S.MolecState.soln))), every=10)
+    s.run(stop=2, dt=0.01)
+    counts = s.getOutputData("counts", False)
+    assert len(seen) == 20, len(seen)
+
+    # Hooks see the same state as the commands at that time.
+    for (t, n), row in zip(seen, counts[1:]):
+        assert abs(t - row[0]) < 1e-9, (t, row)
+        assert n == row[1], (n, row)
+
+
+def test_step_hook_stop():
+    s = decay()
+    times = []
+
+    def hook(t):
+        times.append(t)
+        return t > 0.495
+
+    s.addStepHook(hook)
+    s.run(stop=2, dt=0.01)
+    assert len(times) == 50, len(times)
+    counts = s.getOutputData("counts", False)
+    assert max(row[0] for row in counts) == times[-1]
+
+
+def test_step_hook_every():
+    s = decay()
+    try:
+        s.addStepHook(lambda t: False, every=0)
+    except ValueError:
+        pass
+    else:
+        assert False, "every=0 should be rejected"
+
+
+def test_step_hook_adds_hooks():
+    s = decay()
+    calls = []
+
+    def adder(t):
+        n = len(calls)
+        calls.append([])
+        s.addStepHook(lambda t: calls[n].append(t))
+        return False
+
+    # Each step grows the hook list, so it is reallocated while hooks run.
+    s.addStepHook(adder)
+    s.run(stop=0.5, dt=0.01)
+    assert len(calls) == 50, len(calls)
+    for n, times in enumerate(calls):
+        # A hook added during a step is first called after the next step.
+        assert len(times) == len(calls) - 1 - n, (n, times)
+
+
+def main():
+    test_step_hook()
+    test_step_hook_stop()
+    test_step_hook_every()
+    test_step_hook_adds_hooks()
+
+
+if __name__ == "__main__":
+    main()